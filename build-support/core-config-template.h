@@ -15,6 +15,9 @@
 #cmakedefine01 HAVE_STDLIB_H
 #cmakedefine01 HAVE_GETENV
 #cmakedefine01 HAVE_SIGNAL_H
+#cmakedefine01 HAVE_DLADDR
 #cmakedefine   HAVE_RT
+#cmakedefine01 HAVE_ZLIB
+#cmakedefine01 HAVE_ZSTD
 
 #endif //NS3_CORE_CONFIG_H
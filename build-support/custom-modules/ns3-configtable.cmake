@@ -142,6 +142,9 @@ macro(write_configtable)
   string(APPEND out "GtkConfigStore                : ")
   check_on_or_off("${NS3_GTK3}" "${GTK3_FOUND}")
 
+  string(APPEND out "Gzip compressed traces        : ")
+  check_on_or_off("${NS3_COMPRESSION}" "${HAVE_ZLIB}")
+
   string(APPEND out "LibXml2 support               : ")
   check_on_or_off("ON" "${LIBXML2_FOUND}")
 
@@ -183,6 +186,9 @@ macro(write_configtable)
   string(APPEND out "Tests                         : ")
   check_on_or_off("${ENABLE_TESTS}" "${ENABLE_TESTS}")
 
+  string(APPEND out "Zstd compressed traces        : ")
+  check_on_or_off("${NS3_COMPRESSION}" "${HAVE_ZSTD}")
+
   # string(APPEND out "Use sudo to set suid bit      : not enabled (option
   # --enable-sudo not selected) string(APPEND out "XmlIo : enabled
   string(APPEND out "\n\n")
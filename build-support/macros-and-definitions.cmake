@@ -543,6 +543,28 @@ macro(process_options)
     endif()
   endif()
 
+  set(HAVE_ZLIB FALSE) # for core-config.h
+  set(HAVE_ZSTD FALSE) # for core-config.h
+  if(${NS3_COMPRESSION})
+    find_package(ZLIB QUIET)
+    if(${ZLIB_FOUND})
+      set(HAVE_ZLIB TRUE)
+      include_directories(${ZLIB_INCLUDE_DIRS})
+    else()
+      message(${HIGHLIGHTED_STATUS} "zlib was not found")
+    endif()
+
+    find_external_library(
+      DEPENDENCY_NAME zstd HEADER_NAME zstd.h LIBRARY_NAME zstd
+    )
+    if(${zstd_FOUND})
+      set(HAVE_ZSTD TRUE)
+      include_directories(${zstd_INCLUDE_DIRS})
+    else()
+      message(${HIGHLIGHTED_STATUS} "zstd was not found")
+    endif()
+  endif()
+
   if(${NS3_NATIVE_OPTIMIZATIONS} AND ${GCC})
     add_compile_options(-march=native -mtune=native)
   endif()
@@ -1126,6 +1148,7 @@ macro(process_options)
   include(CheckIncludeFileCXX) # Used to check a single header at a time
   include(CheckIncludeFiles) # Used to check multiple headers at once
   include(CheckFunctionExists)
+  include(CheckSymbolExists)
 
   # Check for required headers and functions, set flags if they're found or warn
   # if they're not found
@@ -1138,6 +1161,11 @@ macro(process_options)
   check_include_file_cxx("signal.h" "HAVE_SIGNAL_H")
   check_include_file_cxx("netpacket/packet.h" "HAVE_PACKETH")
   check_function_exists("getenv" "HAVE_GETENV")
+  set(CMAKE_REQUIRED_DEFINITIONS -D_GNU_SOURCE)
+  set(CMAKE_REQUIRED_LIBRARIES ${CMAKE_DL_LIBS})
+  check_symbol_exists("dladdr" "dlfcn.h" "HAVE_DLADDR")
+  unset(CMAKE_REQUIRED_DEFINITIONS)
+  unset(CMAKE_REQUIRED_LIBRARIES)
 
   configure_file(
     build-support/core-config-template.h
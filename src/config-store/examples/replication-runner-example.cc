@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/core-module.h"
+#include "ns3/config-store-module.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * \ingroup configstore-examples
+ * \ingroup examples
+ *
+ * Scenario run by each replication.  It is written exactly like the
+ * body of a stand-alone main (): it parses its own command line, so
+ * the RngRun value and the overrides given to the runner reach it
+ * as ordinary arguments.
+ *
+ * \param argc argument count
+ * \param argv argument values
+ * \return the exit status of the replication
+ */
+int
+Scenario (int argc, char *argv[])
+{
+  uint32_t samples = 10;
+  double mean = 1.0;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("samples", "Number of samples to draw", samples);
+  cmd.AddValue ("mean", "Mean of the exponential distribution", mean);
+  cmd.Parse (argc, argv);
+
+  Ptr<ExponentialRandomVariable> x = CreateObject<ExponentialRandomVariable> ();
+  x->SetAttribute ("Mean", DoubleValue (mean));
+
+  // Relative paths end up in the directory of the replication
+  std::ofstream trace ("samples.txt");
+  double sum = 0;
+  for (uint32_t i = 0; i < samples; ++i)
+    {
+      double v = x->GetValue ();
+      trace << v << std::endl;
+      sum += v;
+    }
+  std::cout << "run " << RngSeedManager::GetRun ()
+            << " mean " << mean
+            << " sample mean " << sum / samples << std::endl;
+  return 0;
+}
+
+// Sweep two means over four independent runs each, in parallel.
+// The results are in replications/manifest.csv.
+int main (int argc, char *argv[])
+{
+  uint32_t runs = 4;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Run the same scenario for several RngRun values and parameter\n"
+             "sets in parallel worker processes.  Use\n"
+             "--ns3::ReplicationRunner::MaxWorkers=<n> to bound the number of\n"
+             "concurrent workers."
+            );
+  cmd.AddValue ("runs", "Number of runs per parameter set", runs);
+  cmd.Parse (argc, argv);
+
+  ReplicationRunner runner;
+  runner.SetScenario (MakeCallback (&Scenario));
+  runner.AddArgument ("--samples=1000");
+  runner.AddRuns (1, runs, {{"mean", "1.0"}});
+  runner.AddRuns (1, runs, {{"mean", "2.0"}});
+  uint32_t failed = runner.Run ();
+
+  runner.WriteManifest (std::cout);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,432 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "replication-runner.h"
+#include "config-store.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/attribute-construction-list.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/system-path.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <limits.h>
+#include <list>
+#include <map>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+NS_OBJECT_ENSURE_REGISTERED (ReplicationRunner);
+
+namespace {
+
+/** Name of the file receiving the standard output of a replication. */
+const char *STDOUT_FILE = "stdout.txt";
+/** Name of the file receiving the standard error of a replication. */
+const char *STDERR_FILE = "stderr.txt";
+/** Name of the ConfigStore file saved by a replication. */
+const char *CONFIG_FILE = "config.txt";
+/** Name of the manifest in the output directory. */
+const char *MANIFEST_FILE = "manifest.csv";
+
+/**
+ * Quote a CSV field if it contains a separator or a quote.
+ * \param field the raw field
+ * \return the field, ready to be written
+ */
+std::string
+CsvField (const std::string &field)
+{
+  if (field.find_first_of (",\"\n") == std::string::npos)
+    {
+      return field;
+    }
+  std::string quoted = "\"";
+  for (char c : field)
+    {
+      if (c == '"')
+        {
+          quoted += '"';
+        }
+      quoted += c;
+    }
+  return quoted + "\"";
+}
+
+/**
+ * Redirect a file descriptor to a file, truncating it.
+ * \param fd the descriptor to redirect
+ * \param filename the file
+ * \return true on success
+ */
+bool
+RedirectTo (int fd, const std::string &filename)
+{
+  int file = open (filename.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (file < 0)
+    {
+      return false;
+    }
+  bool ok = dup2 (file, fd) >= 0;
+  close (file);
+  return ok;
+}
+
+} // unnamed namespace
+
+TypeId
+ReplicationRunner::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ReplicationRunner")
+    .SetParent<ObjectBase> ()
+    .SetGroupName ("ConfigStore")
+    .AddAttribute ("MaxWorkers",
+                   "Maximum number of replications running at the same time; "
+                   "0 uses the number of hardware threads.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ReplicationRunner::m_maxWorkers),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("OutputDirectory",
+                   "Directory under which each replication gets its own "
+                   "run-<index> directory and where the manifest is written.",
+                   StringValue ("replications"),
+                   MakeStringAccessor (&ReplicationRunner::m_outputDirectory),
+                   MakeStringChecker ())
+    .AddAttribute ("SaveConfig",
+                   "Save the attribute defaults of each callback replication "
+                   "with a ConfigStore.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ReplicationRunner::m_saveConfig),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+TypeId
+ReplicationRunner::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+ReplicationRunner::ReplicationRunner ()
+{
+  NS_LOG_FUNCTION (this);
+  ObjectBase::ConstructSelf (AttributeConstructionList ());
+}
+
+ReplicationRunner::~ReplicationRunner ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ReplicationRunner::SetScenario (Scenario scenario)
+{
+  NS_LOG_FUNCTION (this);
+  m_scenario = scenario;
+  m_program.clear ();
+}
+
+void
+ReplicationRunner::SetProgram (std::string program)
+{
+  NS_LOG_FUNCTION (this << program);
+  // Workers chdir into their directory before exec, so resolve it now
+  char resolved[PATH_MAX];
+  if (program.find ('/') != std::string::npos
+      && realpath (program.c_str (), resolved) != 0)
+    {
+      program = resolved;
+    }
+  m_program = program;
+  m_scenario.Nullify ();
+}
+
+void
+ReplicationRunner::AddArgument (std::string arg)
+{
+  NS_LOG_FUNCTION (this << arg);
+  m_args.push_back (arg);
+}
+
+void
+ReplicationRunner::AddReplication (uint32_t run, const Overrides &overrides)
+{
+  NS_LOG_FUNCTION (this << run);
+  Result result;
+  result.run = run;
+  result.overrides = overrides;
+  result.exitStatus = -1;
+  result.signal = 0;
+  result.wallSeconds = 0;
+  m_results.push_back (result);
+}
+
+void
+ReplicationRunner::AddRuns (uint32_t first, uint32_t last, const Overrides &overrides)
+{
+  NS_LOG_FUNCTION (this << first << last);
+  for (uint32_t run = first; run <= last; ++run)
+    {
+      AddReplication (run, overrides);
+    }
+}
+
+std::vector<std::string>
+ReplicationRunner::GetArguments (uint32_t index) const
+{
+  const Result &result = m_results[index];
+  std::vector<std::string> args;
+  args.push_back (m_program.empty () ? std::string ("replication") : m_program);
+  std::ostringstream run;
+  run << "--RngRun=" << result.run;
+  args.push_back (run.str ());
+  for (const auto &o : result.overrides)
+    {
+      args.push_back ("--" + o.first + "=" + o.second);
+    }
+  args.insert (args.end (), m_args.begin (), m_args.end ());
+  return args;
+}
+
+uint32_t
+ReplicationRunner::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_scenario.IsNull () && m_program.empty (),
+                   "ReplicationRunner: no scenario or program set");
+
+  uint32_t maxWorkers = m_maxWorkers;
+  if (maxWorkers == 0)
+    {
+      maxWorkers = std::max (1U, std::thread::hardware_concurrency ());
+    }
+  SystemPath::MakeDirectories (m_outputDirectory);
+
+  typedef std::chrono::steady_clock Clock;
+  std::map<pid_t, std::pair<uint32_t, Clock::time_point> > running;
+  uint32_t next = 0;
+  uint32_t failed = 0;
+
+  while (next < m_results.size () || !running.empty ())
+    {
+      while (next < m_results.size () && running.size () < maxWorkers)
+        {
+          pid_t pid = Spawn (next);
+          running[pid] = std::make_pair (next, Clock::now ());
+          ++next;
+        }
+
+      // Wait on the workers only: the children the scenario or the
+      // program started itself are theirs to reap
+      bool reaped = false;
+      for (auto it = running.begin (); it != running.end (); )
+        {
+          int status;
+          pid_t pid = waitpid (it->first, &status, WNOHANG);
+          if (pid < 0)
+            {
+              NS_ABORT_MSG_IF (errno != EINTR,
+                               "ReplicationRunner: waitpid failed: " << std::strerror (errno));
+              ++it;
+              continue;
+            }
+          if (pid == 0)
+            {
+              ++it;
+              continue;
+            }
+          Result &result = m_results[it->second.first];
+          result.wallSeconds =
+            std::chrono::duration<double> (Clock::now () - it->second.second).count ();
+          if (WIFEXITED (status))
+            {
+              result.exitStatus = WEXITSTATUS (status);
+              result.signal = 0;
+            }
+          else
+            {
+              result.exitStatus = -1;
+              result.signal = WIFSIGNALED (status) ? WTERMSIG (status) : 0;
+            }
+          CollectOutputs (result);
+          if (result.exitStatus != 0)
+            {
+              ++failed;
+            }
+          NS_LOG_INFO ("run " << result.run << " in " << result.directory
+                       << " exited with " << result.exitStatus
+                       << " after " << result.wallSeconds << "s");
+          it = running.erase (it);
+          reaped = true;
+        }
+      if (!reaped)
+        {
+          std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        }
+    }
+
+  std::string manifest = SystemPath::Append (m_outputDirectory, MANIFEST_FILE);
+  std::ofstream os (manifest.c_str ());
+  NS_ABORT_MSG_UNLESS (os.is_open (),
+                       "ReplicationRunner: cannot write " << manifest);
+  WriteManifest (os);
+  return failed;
+}
+
+int
+ReplicationRunner::Spawn (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  std::ostringstream dir;
+  dir << "run-" << index;
+  m_results[index].directory = SystemPath::Append (m_outputDirectory, dir.str ());
+  SystemPath::MakeDirectories (m_results[index].directory);
+
+  // Do not let the child inherit and flush pending parent output twice
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "ReplicationRunner: fork failed: " << std::strerror (errno));
+  if (pid == 0)
+    {
+      RunChild (index);
+    }
+  return pid;
+}
+
+void
+ReplicationRunner::RunChild (uint32_t index)
+{
+  const std::string &directory = m_results[index].directory;
+  if (chdir (directory.c_str ()) != 0
+      || !RedirectTo (STDOUT_FILENO, STDOUT_FILE)
+      || !RedirectTo (STDERR_FILENO, STDERR_FILE))
+    {
+      _exit (127);
+    }
+
+  std::vector<std::string> args = GetArguments (index);
+  std::vector<char *> argv;
+  for (auto &arg : args)
+    {
+      argv.push_back (&arg[0]);
+    }
+  argv.push_back (0);
+
+  if (!m_program.empty ())
+    {
+      execvp (argv[0], argv.data ());
+      std::cerr << "ReplicationRunner: cannot execute " << argv[0]
+                << ": " << std::strerror (errno) << std::endl;
+      _exit (127);
+    }
+
+  int status = m_scenario (static_cast<int> (args.size ()), argv.data ());
+  if (m_saveConfig)
+    {
+      Config::SetDefault ("ns3::ConfigStore::Filename", StringValue (CONFIG_FILE));
+      Config::SetDefault ("ns3::ConfigStore::FileFormat", EnumValue (ConfigStore::RAW_TEXT));
+      Config::SetDefault ("ns3::ConfigStore::Mode", EnumValue (ConfigStore::SAVE));
+      ConfigStore config;
+      config.ConfigureDefaults ();
+    }
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  // Skip the static destructors inherited from the parent
+  _exit (status);
+}
+
+void
+ReplicationRunner::CollectOutputs (Result &result) const
+{
+  NS_LOG_FUNCTION (this << result.directory);
+  result.outputs.clear ();
+  std::list<std::string> files = SystemPath::ReadFiles (result.directory);
+  for (const auto &f : files)
+    {
+      if (f != "." && f != "..")
+        {
+          result.outputs.push_back (f);
+        }
+    }
+  std::sort (result.outputs.begin (), result.outputs.end ());
+}
+
+const std::vector<ReplicationRunner::Result> &
+ReplicationRunner::GetResults (void) const
+{
+  return m_results;
+}
+
+void
+ReplicationRunner::WriteManifest (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "run,overrides,directory,exit_status,signal,wall_seconds,stdout,stderr,outputs"
+     << std::endl;
+  for (const auto &result : m_results)
+    {
+      std::string overrides;
+      for (const auto &o : result.overrides)
+        {
+          overrides += (overrides.empty () ? "" : " ") + o.first + "=" + o.second;
+        }
+      std::string outputs;
+      for (const auto &f : result.outputs)
+        {
+          if (f != STDOUT_FILE && f != STDERR_FILE)
+            {
+              outputs += (outputs.empty () ? "" : ";") + f;
+            }
+        }
+      os << result.run << ","
+         << CsvField (overrides) << ","
+         << CsvField (result.directory) << ","
+         << result.exitStatus << ","
+         << result.signal << ","
+         << result.wallSeconds << ","
+         << CsvField (SystemPath::Append (result.directory, STDOUT_FILE)) << ","
+         << CsvField (SystemPath::Append (result.directory, STDERR_FILE)) << ","
+         << CsvField (outputs)
+         << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include "ns3/object-base.h"
+#include "ns3/callback.h"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup configstore
+ *
+ * \brief Run independent replications of a scenario in parallel worker
+ * processes.
+ *
+ * Each replication is described by a run number and a list of
+ * attribute overrides.  Every replication is executed in its own
+ * process, inside its own directory under the output directory, with
+ * the command line
+ *
+ * \code
+ *   <program> --RngRun=<run> --<name>=<value> ... <extra arguments>
+ * \endcode
+ *
+ * so that a scenario which already calls CommandLine::Parse() picks up
+ * the run number and the overrides without modification.  Names of the
+ * form \c ns3::Type::Attribute set attribute defaults; other names are
+ * matched against the scenario's own CommandLine::AddValue() options.
+ *
+ * The scenario is either a callback with the signature of \c main(),
+ * executed in a forked child (SetScenario()), or an existing program
+ * which is executed as is (SetProgram()).  At most \c MaxWorkers
+ * replications run at the same time.  The standard output and error of
+ * each replication are redirected to files in its directory, and any
+ * trace file the scenario writes with a relative path lands there too.
+ * When the scenario is a callback and \c SaveConfig is true, the
+ * attribute defaults in effect at the end of the replication are saved
+ * with a ConfigStore to \c config.txt.
+ *
+ * After Run() returns, the exit status, wall-clock duration and output
+ * files of every replication are available from GetResults() and are
+ * written as a CSV manifest to \c manifest.csv in the output directory.
+ *
+ * The runner itself is configured through attributes, so a sweep
+ * driver can expose them with CommandLine:
+ *
+ * \code
+ *   int Scenario (int argc, char *argv[]);  // former main ()
+ *
+ *   int main (int argc, char *argv[])
+ *   {
+ *     CommandLine cmd (__FILE__);
+ *     cmd.Parse (argc, argv);  // --ns3::ReplicationRunner::MaxWorkers=8
+ *
+ *     ReplicationRunner runner;
+ *     runner.SetScenario (MakeCallback (&Scenario));
+ *     runner.AddRuns (1, 10, {{"ns3::TcpL4Protocol::SocketType", "ns3::TcpCubic"}});
+ *     runner.AddRuns (1, 10, {{"ns3::TcpL4Protocol::SocketType", "ns3::TcpBbr"}});
+ *     return runner.Run () == 0 ? 0 : 1;
+ *   }
+ * \endcode
+ *
+ * Worker processes are created with fork(), so Run() must be called
+ * before the parent process schedules any event or creates any object
+ * whose state should not be shared with the replications.
+ */
+class ReplicationRunner : public ObjectBase
+{
+public:
+  /** A list of (name, value) pairs passed as --name=value arguments. */
+  typedef std::vector<std::pair<std::string, std::string> > Overrides;
+
+  /**
+   * Scenario entry point, with the signature of \c main().
+   * The return value is the exit status of the replication.
+   */
+  typedef Callback<int, int, char **> Scenario;
+
+  /** The description and outcome of one replication. */
+  struct Result
+  {
+    uint32_t run;                     //!< The RngRun value.
+    Overrides overrides;              //!< The attribute overrides.
+    std::string directory;            //!< Directory the replication ran in.
+    int exitStatus;                   //!< Exit status, or -1 if killed by a signal.
+    int signal;                       //!< Terminating signal, or 0.
+    double wallSeconds;               //!< Wall-clock duration of the replication.
+    std::vector<std::string> outputs; //!< Files found in the directory afterwards.
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  ReplicationRunner ();
+  ~ReplicationRunner ();
+
+  /**
+   * Execute replications by calling \p scenario in a forked child.
+   * \param scenario the scenario entry point
+   */
+  void SetScenario (Scenario scenario);
+  /**
+   * Execute replications by running an existing program.
+   * \param program path of the program to execute
+   */
+  void SetProgram (std::string program);
+  /**
+   * Append an argument passed unchanged to every replication.
+   * \param arg the argument
+   */
+  void AddArgument (std::string arg);
+
+  /**
+   * Queue one replication.
+   * \param run the RngRun value
+   * \param overrides the --name=value arguments of this replication
+   */
+  void AddReplication (uint32_t run, const Overrides &overrides = Overrides ());
+  /**
+   * Queue the replications \p first to \p last inclusive, sharing the
+   * same overrides.
+   * \param first the first RngRun value
+   * \param last the last RngRun value
+   * \param overrides the --name=value arguments of these replications
+   */
+  void AddRuns (uint32_t first, uint32_t last, const Overrides &overrides = Overrides ());
+
+  /**
+   * Execute all queued replications and write the manifest.
+   * \return the number of replications which did not exit with status 0
+   */
+  uint32_t Run (void);
+  /**
+   * \return the outcome of every replication, in the order they were queued
+   */
+  const std::vector<Result> & GetResults (void) const;
+  /**
+   * Write the results as CSV.
+   * \param os the output stream
+   */
+  void WriteManifest (std::ostream &os) const;
+
+private:
+  /**
+   * Build the argument vector of a replication.
+   * \param index index of the replication
+   * \return the arguments, starting with the program name
+   */
+  std::vector<std::string> GetArguments (uint32_t index) const;
+  /**
+   * Start a replication in a new process.
+   * \param index index of the replication
+   * \return the process id of the worker
+   */
+  int Spawn (uint32_t index);
+  /**
+   * Body of a worker process; never returns.
+   * \param index index of the replication
+   */
+  void RunChild (uint32_t index);
+  /**
+   * List the files a finished replication left in its directory.
+   * \param result the replication to update
+   */
+  void CollectOutputs (Result &result) const;
+
+  Scenario m_scenario;              //!< Scenario run in forked workers.
+  std::string m_program;            //!< Program executed by workers.
+  std::vector<std::string> m_args;  //!< Arguments common to all replications.
+  std::vector<Result> m_results;    //!< Queued replications and their outcome.
+  uint32_t m_maxWorkers;            //!< Maximum number of concurrent workers.
+  std::string m_outputDirectory;    //!< Root of the per-replication directories.
+  bool m_saveConfig;                //!< Save attribute defaults of each replication.
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
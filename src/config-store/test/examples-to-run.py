@@ -9,4 +9,5 @@
 # See test.py for more information.
 cpp_examples = [
     ("config-store-save", "True", "False"),
+    ("replication-runner-example", "True", "False"),
 ]
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/replication-runner.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-path.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup configstore
+ * \defgroup configstore-tests ConfigStore module tests
+ */
+
+/**
+ * \ingroup configstore-tests
+ *
+ * \brief ReplicationRunner test: run numbers, overrides and arguments of
+ * the replications, and collection of their outcome.
+ *
+ * Each replication writes its arguments to a file of its directory, and
+ * exits with the status given by its "status" override.
+ */
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  ReplicationRunnerTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Scenario of the replications.
+   * \param argc argument count
+   * \param argv argument values
+   * \return the value of the --status argument
+   */
+  static int Scenario (int argc, char *argv[]);
+
+  /**
+   * Read the lines of a file.
+   * \param filename the file
+   * \return the lines
+   */
+  static std::vector<std::string> ReadLines (std::string filename);
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Check the arguments and the results of the replications")
+{
+}
+
+int
+ReplicationRunnerTestCase::Scenario (int argc, char *argv[])
+{
+  std::ofstream args ("args.txt");
+  int status = 0;
+  for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      args << arg << std::endl;
+      if (arg.find ("--status=") == 0)
+        {
+          status = std::atoi (arg.substr (9).c_str ());
+        }
+    }
+  std::cout << "status " << status << std::endl;
+  return status;
+}
+
+std::vector<std::string>
+ReplicationRunnerTestCase::ReadLines (std::string filename)
+{
+  std::ifstream is (filename.c_str ());
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      lines.push_back (line);
+    }
+  return lines;
+}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  std::string directory = CreateTempDirFilename ("replications");
+
+  // A child of the program itself, which the runner must leave alone
+  pid_t userChild = fork ();
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (userChild, 0, "fork failed");
+  if (userChild == 0)
+    {
+      _exit (7);
+    }
+
+  ReplicationRunner runner;
+  runner.SetAttribute ("MaxWorkers", UintegerValue (2));
+  runner.SetAttribute ("OutputDirectory", StringValue (directory));
+  runner.SetAttribute ("SaveConfig", BooleanValue (false));
+  runner.SetScenario (MakeCallback (&ReplicationRunnerTestCase::Scenario));
+  runner.AddArgument ("--extra=1");
+  runner.AddRuns (1, 2, {{"status", "0"}});
+  runner.AddRuns (5, 6, {{"status", "3"}});
+  uint32_t failed = runner.Run ();
+
+  int status;
+  NS_TEST_EXPECT_MSG_EQ (waitpid (userChild, &status, 0), userChild,
+                         "The runner reaped a child it did not start");
+  NS_TEST_EXPECT_MSG_EQ (WIFEXITED (status) && WEXITSTATUS (status) == 7, true,
+                         "Wrong exit status of the child of the program");
+
+  NS_TEST_EXPECT_MSG_EQ (failed, 2, "Wrong number of failed replications");
+  const std::vector<ReplicationRunner::Result> &results = runner.GetResults ();
+  NS_TEST_ASSERT_MSG_EQ (results.size (), 4, "Wrong number of replications");
+
+  uint32_t runs[] = {1, 2, 5, 6};
+  int statuses[] = {0, 0, 3, 3};
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      const ReplicationRunner::Result &result = results[i];
+      std::ostringstream runDirectory;
+      runDirectory << "run-" << i;
+      NS_TEST_EXPECT_MSG_EQ (result.run, runs[i], "Wrong run of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (result.directory, SystemPath::Append (directory, runDirectory.str ()),
+                             "Wrong directory of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (result.exitStatus, statuses[i], "Wrong exit status of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (result.signal, 0, "Replication " << i << " was killed");
+
+      std::vector<std::string> outputs = {"args.txt", "stderr.txt", "stdout.txt"};
+      NS_TEST_EXPECT_MSG_EQ ((result.outputs == outputs), true, "Wrong outputs of replication " << i);
+
+      std::vector<std::string> args = ReadLines (SystemPath::Append (result.directory, "args.txt"));
+      std::ostringstream rngRun, statusArg;
+      rngRun << "--RngRun=" << runs[i];
+      statusArg << "--status=" << statuses[i];
+      NS_TEST_ASSERT_MSG_EQ (args.size (), 3, "Wrong number of arguments of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (args[0], rngRun.str (), "Wrong run argument of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (args[1], statusArg.str (), "Wrong override of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (args[2], "--extra=1", "Wrong common argument of replication " << i);
+
+      std::vector<std::string> stdoutLines = ReadLines (SystemPath::Append (result.directory, "stdout.txt"));
+      NS_TEST_ASSERT_MSG_EQ (stdoutLines.size (), 1, "Wrong output of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (stdoutLines[0], "status " + std::to_string (statuses[i]),
+                             "Wrong output of replication " << i);
+    }
+
+  std::vector<std::string> manifest = ReadLines (SystemPath::Append (directory, "manifest.csv"));
+  NS_TEST_ASSERT_MSG_EQ (manifest.size (), 5, "Wrong number of lines in the manifest");
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      std::ostringstream start;
+      start << runs[i] << ",status=" << statuses[i] << "," << results[i].directory
+            << "," << statuses[i] << ",0,";
+      NS_TEST_EXPECT_MSG_EQ (manifest[i + 1].substr (0, start.str ().size ()), start.str (),
+                             "Wrong manifest line of replication " << i);
+      NS_TEST_EXPECT_MSG_EQ (manifest[i + 1].substr (manifest[i + 1].size () - 9), ",args.txt",
+                             "Wrong outputs in the manifest line of replication " << i);
+    }
+}
+
+/**
+ * \ingroup configstore-tests
+ *
+ * \brief ReplicationRunner TestSuite
+ */
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  ReplicationRunnerTestSuite ()
+    : TestSuite ("replication-runner", UNIT)
+  {
+    AddTestCase (new ReplicationRunnerTestCase, TestCase::QUICK);
+  }
+};
+
+static ReplicationRunnerTestSuite g_replicationRunnerTestSuite; //!< Static variable for test initialization
@@ -31,6 +31,10 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Callback");
 
+CallbackBase::CallbackBase (CallbackImplBase *impl)
+  : m_impl (impl), m_storage (), m_stub (0), m_materialize (0)
+{}
+
 CallbackValue::CallbackValue ()
   : m_value ()
 {
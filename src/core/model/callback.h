@@ -28,7 +28,9 @@
 #include "attribute.h"
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
+#include <cstring>
 #include <typeinfo>
+#include <type_traits>
 
 /**
  * \file
@@ -1187,30 +1189,233 @@ private:
   typename TypeTraits<TX3>::ReferencedType m_a3;  //!< third bound argument
 };
 
+/**
+ * \ingroup callbackimpl
+ * Inline storage for the target of a Callback which does not need
+ * a heap-allocated CallbackImpl: a raw object pointer together with a
+ * pointer to member function, or a plain function pointer.
+ */
+struct CallbackInlineStorage
+{
+  /** Generic pointer to member function, used only for its size. */
+  typedef void (CallbackImplBase::*MemPtr)(void);
+
+  void *object;                         //!< the target object, if any
+  /** the pointer to member function or the function pointer */
+  alignas (MemPtr) unsigned char code[sizeof (MemPtr)];
+};
+
+/**
+ * \ingroup callbackimpl
+ * Type list of the non-empty argument types of a Callback.
+ * \tparam Ts \explicit The argument types.
+ */
+template <typename... Ts>
+struct CallbackArgList
+{};
+
+/**
+ * \ingroup callbackimpl
+ * Strip the trailing \c empty types from the argument types of a Callback.
+ * \tparam L \explicit The CallbackArgList accumulated so far.
+ * \tparam Ts \explicit The remaining argument types.
+ */
+template <typename L, typename... Ts>
+struct CallbackStripEmpty;
+
+/** All argument types have been consumed. */
+template <typename... As>
+struct CallbackStripEmpty<CallbackArgList<As...> >
+{
+  typedef CallbackArgList<As...> Type;  //!< The non-empty argument types.
+};
+
+/** The first \c empty type ends the argument list. */
+template <typename... As, typename... Ts>
+struct CallbackStripEmpty<CallbackArgList<As...>, empty, Ts...>
+{
+  typedef CallbackArgList<As...> Type;  //!< The non-empty argument types.
+};
+
+/** Move one non-empty argument type to the result. */
+template <typename... As, typename T, typename... Ts>
+struct CallbackStripEmpty<CallbackArgList<As...>, T, Ts...>
+  : public CallbackStripEmpty<CallbackArgList<As..., T>, Ts...>
+{};
+
+/**
+ * \ingroup callbackimpl
+ * Invoker and materializer for a pointer to member function bound to
+ * a raw pointer to a polymorphic object held in CallbackInlineStorage.
+ *
+ * \tparam OBJ_PTR \explicit Type of the target object, as a raw pointer.
+ * \tparam MEM_PTR \explicit Type of the class member function.
+ * \tparam R \explicit The return type of the Callback.
+ * The remaining template arguments are the types of any arguments
+ * to the Callback.
+ */
+template <typename OBJ_PTR, typename MEM_PTR, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+struct MemPtrCallbackInline
+{
+  /**
+   * Call the member function on the object.
+   * \tparam As \explicit The non-empty argument types.
+   * \param [in] storage The inline storage
+   * \param [in] args The arguments
+   * \return Callback value
+   */
+  template <typename... As>
+  static R Invoke (const CallbackInlineStorage &storage, As... args)
+  {
+    OBJ_PTR objPtr = static_cast<OBJ_PTR> (storage.object);
+    MEM_PTR memPtr;
+    std::memcpy (&memPtr, storage.code, sizeof (MEM_PTR));
+    return (objPtr->*memPtr)(args...);
+  }
+  /**
+   * Build the equivalent heap-allocated implementation.
+   * \param [in] storage The inline storage
+   * \return The CallbackImpl
+   */
+  static Ptr<CallbackImplBase> Materialize (const CallbackInlineStorage &storage);
+};
+
+/**
+ * \ingroup callbackimpl
+ * Invoker and materializer for a plain function pointer held in
+ * CallbackInlineStorage.
+ *
+ * \tparam FN_PTR \explicit The function pointer type.
+ * \tparam R \explicit The return type of the Callback.
+ * The remaining template arguments are the types of any arguments
+ * to the Callback.
+ */
+template <typename FN_PTR, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+struct FunctorCallbackInline
+{
+  /**
+   * Call the function.
+   * \tparam As \explicit The non-empty argument types.
+   * \param [in] storage The inline storage
+   * \param [in] args The arguments
+   * \return Callback value
+   */
+  template <typename... As>
+  static R Invoke (const CallbackInlineStorage &storage, As... args)
+  {
+    FN_PTR fnPtr;
+    std::memcpy (&fnPtr, storage.code, sizeof (FN_PTR));
+    return (*fnPtr)(args...);
+  }
+  /**
+   * Build the equivalent heap-allocated implementation.
+   * \param [in] storage The inline storage
+   * \return The CallbackImpl
+   */
+  static Ptr<CallbackImplBase> Materialize (const CallbackInlineStorage &storage);
+};
+
 /**
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * The two most common targets, a pointer to member function bound to
+ * a raw pointer to a polymorphic object and a plain function pointer,
+ * are held inline
+ * instead: the call goes through a single function pointer with no
+ * virtual dispatch, and the CallbackImpl is only allocated on demand
+ * by GetImpl(), e.g. when the Callback is bound or compared with a
+ * Callback of a different kind.
  */
 class CallbackBase
 {
 public:
-  CallbackBase () : m_impl ()
+  CallbackBase () : m_impl (), m_storage (), m_stub (0), m_materialize (0)
   {}
   /** \return The impl pointer */
   Ptr<CallbackImplBase> GetImpl (void) const
   {
+    if (m_impl == 0 && m_materialize != 0)
+      {
+        m_impl = m_materialize (m_storage);
+      }
     return m_impl;
   }
 
 protected:
+  /** Type-erased invoker of an inline target. */
+  typedef void (*Stub)(void);
+  /** Builder of the CallbackImpl equivalent to an inline target. */
+  typedef Ptr<CallbackImplBase> (*Materializer)(const CallbackInlineStorage &);
+
   /**
    * Construct from a pimpl
-   * \param [in] impl The CallbackImplBase Ptr
+   *
+   * This constructor is out of line: once inlined in the callers, which
+   * release their own reference right after, GCC 12 can no longer tell
+   * that the pimpl outlives them, and warns of a use after free.
+   *
+   * \param [in] impl The CallbackImplBase
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl)
-  {}
-  Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  CallbackBase (CallbackImplBase *impl);
+  /**
+   * Check whether two Callbacks hold the same inline target.
+   *
+   * A \c false result is not conclusive: the targets may still compare
+   * equal through CallbackImplBase::IsEqual().
+   *
+   * \param [in] other The other Callback
+   * \return \c true if both targets are inline and identical
+   */
+  bool InlineEquals (const CallbackBase &other) const
+  {
+    return m_stub != 0
+           && m_stub == other.m_stub
+           && m_materialize == other.m_materialize
+           && m_storage.object == other.m_storage.object
+           && std::memcmp (m_storage.code, other.m_storage.code, sizeof (m_storage.code)) == 0;
+  }
+  /**
+   * Get the implementation of a Callback, building it if needed.
+   *
+   * Unlike GetImpl(), no temporary Ptr is created, so the implementation
+   * stays referenced by \pname{callback} only.
+   *
+   * \param [in] callback The Callback
+   * 
+eturn The impl pointer
+   */
+  static CallbackImplBase * PeekImpl (const CallbackBase &callback)
+  {
+    if (callback.m_impl == 0 && callback.m_materialize != 0)
+      {
+        callback.m_impl = callback.m_materialize (callback.m_storage);
+      }
+    return PeekPointer (callback.m_impl);
+  }
+  /**
+   * Copy the inline target, if any, of another Callback.
+   * \param [in] other The other Callback
+   */
+  void AssignInline (const CallbackBase &other)
+  {
+    m_storage = other.m_storage;
+    m_stub = other.m_stub;
+    m_materialize = other.m_materialize;
+  }
+  /** Drop the inline target, if any. */
+  void NullifyInline (void)
+  {
+    m_storage = CallbackInlineStorage ();
+    m_stub = 0;
+    m_materialize = 0;
+  }
+
+  mutable Ptr<CallbackImplBase> m_impl; //!< the pimpl
+  CallbackInlineStorage m_storage;      //!< the inline target
+  Stub m_stub;                          //!< invoker of the inline target
+  Materializer m_materialize;           //!< builder of m_impl from m_storage
 };
 
 /**
@@ -1293,8 +1498,21 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool)
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    if constexpr (std::is_pointer<FUNCTOR>::value
+                  && std::is_function<typename std::remove_pointer<FUNCTOR>::type>::value
+                  && sizeof (FUNCTOR) <= sizeof (CallbackInlineStorage::code))
+      {
+        typedef FunctorCallbackInline<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> Inline;
+        std::memcpy (m_storage.code, &functor, sizeof (FUNCTOR));
+        m_stub = GetStub<Inline> (ArgList ());
+        m_materialize = &Inline::Materialize;
+      }
+    else
+      {
+        m_impl = Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor);
+      }
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -1306,8 +1524,26 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    // The call through the pointer to member function may read the
+    // virtual table pointer of the object, so only objects which have
+    // one are held inline: the others could be smaller than that pointer.
+    if constexpr (std::is_pointer<OBJ_PTR>::value
+                  && std::is_polymorphic<typename std::remove_cv<typename std::remove_pointer<OBJ_PTR>::type>::type>::value
+                  && std::is_trivially_copyable<MEM_PTR>::value
+                  && sizeof (MEM_PTR) <= sizeof (CallbackInlineStorage::code))
+      {
+        typedef MemPtrCallbackInline<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> Inline;
+        m_storage.object = const_cast<void *> (static_cast<const volatile void *> (objPtr));
+        std::memcpy (m_storage.code, &memPtr, sizeof (MEM_PTR));
+        m_stub = GetStub<Inline> (ArgList ());
+        m_materialize = &Inline::Materialize;
+      }
+    else
+      {
+        m_impl = Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr);
+      }
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1315,7 +1551,7 @@ public:
    * \param [in] impl The CallbackImpl Ptr
    */
   Callback (Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > const &impl)
-    : CallbackBase (impl)
+    : CallbackBase (PeekPointer (impl))
   {}
 
   /**
@@ -1385,12 +1621,13 @@ public:
    */
   bool IsNull (void) const
   {
-    return (DoPeekImpl () == 0);
+    return (m_stub == 0 && DoPeekImpl () == 0);
   }
   /** Discard the implementation, set it to null */
   void Nullify (void)
   {
     m_impl = 0;
+    NullifyInline ();
   }
 
   /**
@@ -1400,6 +1637,10 @@ public:
   /** \return Callback value */
   R operator() (void) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &)> (m_stub)(m_storage);
+      }
     return (*(DoPeekImpl ()))();
   }
   /**
@@ -1408,6 +1649,10 @@ public:
    */
   R operator() (T1 a1) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1)> (m_stub)(m_storage, a1);
+      }
     return (*(DoPeekImpl ()))(a1);
   }
   /**
@@ -1417,6 +1662,10 @@ public:
    */
   R operator() (T1 a1, T2 a2) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2)> (m_stub)(m_storage, a1, a2);
+      }
     return (*(DoPeekImpl ()))(a1,a2);
   }
   /**
@@ -1427,6 +1676,10 @@ public:
    */
   R operator() (T1 a1, T2 a2, T3 a3) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2, T3)> (m_stub)(m_storage, a1, a2, a3);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3);
   }
   /**
@@ -1438,6 +1691,10 @@ public:
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2, T3, T4)> (m_stub)(m_storage, a1, a2, a3, a4);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4);
   }
   /**
@@ -1450,6 +1707,10 @@ public:
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2, T3, T4, T5)> (m_stub)(m_storage, a1, a2, a3, a4, a5);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5);
   }
   /**
@@ -1463,6 +1724,10 @@ public:
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2, T3, T4, T5, T6)> (m_stub)(m_storage, a1, a2, a3, a4, a5, a6);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6);
   }
   /**
@@ -1477,6 +1742,10 @@ public:
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6,T7 a7) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2, T3, T4, T5, T6, T7)> (m_stub)(m_storage, a1, a2, a3, a4, a5, a6, a7);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6,a7);
   }
   /**
@@ -1492,6 +1761,10 @@ public:
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6,T7 a7,T8 a8) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2, T3, T4, T5, T6, T7, T8)> (m_stub)(m_storage, a1, a2, a3, a4, a5, a6, a7, a8);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6,a7,a8);
   }
   /**
@@ -1508,6 +1781,10 @@ public:
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6,T7 a7,T8 a8, T9 a9) const
   {
+    if (m_stub != 0)
+      {
+        return reinterpret_cast<R (*)(const CallbackInlineStorage &, T1, T2, T3, T4, T5, T6, T7, T8, T9)> (m_stub)(m_storage, a1, a2, a3, a4, a5, a6, a7, a8, a9);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6,a7,a8,a9);
   }
   /**@}*/
@@ -1520,7 +1797,11 @@ public:
    */
   bool IsEqual (const CallbackBase &other) const
   {
-    return m_impl->IsEqual (other.GetImpl ());
+    if (InlineEquals (other))
+      {
+        return true;
+      }
+    return GetImpl ()->IsEqual (other.GetImpl ());
   }
 
   /**
@@ -1541,10 +1822,31 @@ public:
    */
   bool Assign (const CallbackBase &other)
   {
-    return DoAssign (other.GetImpl ());
+    if (!DoAssign (PeekImpl (other)))
+      {
+        return false;
+      }
+    AssignInline (other);
+    return true;
   }
 
 private:
+  /** The non-empty argument types of this Callback. */
+  typedef typename CallbackStripEmpty<CallbackArgList<>,T1,T2,T3,T4,T5,T6,T7,T8,T9>::Type ArgList;
+
+  /**
+   * Get the type-erased invoker of an inline target.
+   * \tparam INLINE \explicit The MemPtrCallbackInline or FunctorCallbackInline.
+   * \tparam As \deduced The non-empty argument types.
+   * \return The invoker, to be cast back to its real type by operator()
+   */
+  template <typename INLINE, typename... As>
+  static Stub GetStub (CallbackArgList<As...>)
+  {
+    R (*invoke)(const CallbackInlineStorage &, As...) = &INLINE::template Invoke<As...>;
+    return reinterpret_cast<Stub> (invoke);
+  }
+
   /** \return The pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> * DoPeekImpl (void) const
   {
@@ -1596,6 +1898,26 @@ private:
 };
 
 
+template <typename OBJ_PTR, typename MEM_PTR, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+Ptr<CallbackImplBase>
+MemPtrCallbackInline<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::Materialize (const CallbackInlineStorage &storage)
+{
+  OBJ_PTR objPtr = static_cast<OBJ_PTR> (storage.object);
+  MEM_PTR memPtr;
+  std::memcpy (&memPtr, storage.code, sizeof (MEM_PTR));
+  return Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr);
+}
+
+template <typename FN_PTR, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+Ptr<CallbackImplBase>
+FunctorCallbackInline<FN_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::Materialize (const CallbackInlineStorage &storage)
+{
+  FN_PTR fnPtr;
+  std::memcpy (&fnPtr, storage.code, sizeof (FN_PTR));
+  return Create<FunctorCallbackImpl<FN_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (fnPtr);
+}
+
+
 /**
  * Inequality test.
  *
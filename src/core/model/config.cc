@@ -26,6 +26,7 @@
 #include "pointer.h"
 #include "log.h"
 
+#include <limits>
 #include <sstream>
 
 /**
@@ -209,8 +210,20 @@ private:
    * \returns \c true if the string could be converted.
    */
   bool StringToUint32 (std::string str, uint32_t *value) const;
+  /**
+   * Parse one alternative of the Config path specification,
+   * and append the range of indices it matches.
+   *
+   * \param [in] element The alternative: \c *, \c n or \c [n-m].
+   */
+  void Parse (std::string element);
+
+  /** A closed range of matching indices. */
+  typedef std::pair<std::size_t, std::size_t> Range;
   /** The Config path element. */
   std::string m_element;
+  /** The matching indices, parsed from the element. */
+  std::vector<Range> m_ranges;
 
 };  // class ArrayMatcher
 
@@ -219,66 +232,58 @@ ArrayMatcher::ArrayMatcher (std::string element)
   : m_element (element)
 {
   NS_LOG_FUNCTION (this << element);
-}
-bool
-ArrayMatcher::Matches (std::size_t i) const
-{
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  std::string::size_type start = 0;
+  std::string::size_type bar;
+  while ((bar = element.find ("|", start)) != std::string::npos)
     {
-      NS_LOG_DEBUG ("Array " << i << " matches *");
-      return true;
+      Parse (element.substr (start, bar - start));
+      start = bar + 1;
     }
-  std::string::size_type tmp;
-  tmp = m_element.find ("|");
-  if (tmp != std::string::npos)
+  Parse (element.substr (start));
+}
+void
+ArrayMatcher::Parse (std::string element)
+{
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      std::string left = m_element.substr (0, tmp - 0);
-      std::string right = m_element.substr (tmp + 1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
-      return false;
+      m_ranges.push_back (Range (0, std::numeric_limits<std::size_t>::max ()));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1
       && dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min)
-          && StringToUint32 (upperBound, &max)
-          && i >= min && i <= max)
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
-          return true;
-        }
-      else
+          && StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array " << i << " does not " << m_element);
-          return false;
+          m_ranges.push_back (Range (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value)
-      && i == value)
+  if (StringToUint32 (element, &value))
     {
-      NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
-      return true;
+      m_ranges.push_back (Range (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  for (std::vector<Range>::const_iterator r = m_ranges.begin (); r != m_ranges.end (); ++r)
+    {
+      if (i >= r->first && i <= r->second)
+        {
+          NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
+          return true;
+        }
     }
   NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
   return false;
@@ -322,21 +327,37 @@ public:
 private:
   /** Ensure the Config path starts and ends with a '/'. */
   void Canonicalize (void);
+  /**
+   * Split the Config path into its elements, and parse each element
+   * as an array index specification.
+   */
+  void Compile (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] element The index of the next element of the Config path.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t element, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
+   * \param [in] element The index of the next element of the Config path.
    * \param [in,out] vector The resulting list of matching objects.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t element, const ObjectPtrContainerValue &vector);
+  /**
+   * Descend into an attribute of an object, if it holds objects.
+   *
+   * \param [in] element The index of the next element of the Config path.
+   * \param [in] root The object holding the attribute.
+   * \param [in] info The attribute.
+   * \returns \c true if the attribute is a Pointer or an
+   *          ObjectPtrContainer attribute.
+   */
+  bool DoAttributeResolve (std::size_t element, Ptr<Object> root,
+                           const struct TypeId::AttributeInformation &info);
   /**
    * Handle one object found on the path.
    *
@@ -361,6 +382,10 @@ private:
   std::vector<std::string> m_workStack;
   /** The Config path. */
   std::string m_path;
+  /** The elements of the Config path, between slashes. */
+  std::vector<std::string> m_elements;
+  /** The elements of the Config path, parsed as array indices. */
+  std::vector<ArrayMatcher> m_matchers;
 
 };  // class Resolver
 
@@ -369,6 +394,7 @@ Resolver::Resolver (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+  Compile ();
 }
 Resolver::~Resolver ()
 {
@@ -394,12 +420,28 @@ Resolver::Canonicalize (void)
     }
 }
 
+void
+Resolver::Compile (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = m_path.find ("/", start)) != std::string::npos)
+    {
+      std::string element = m_path.substr (start, next - start);
+      m_elements.push_back (element);
+      m_matchers.push_back (ArrayMatcher (element));
+      start = next + 1;
+    }
+}
+
 void
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -425,13 +467,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (std::size_t element, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << element << root);
 
-  if (next == std::string::npos)
+  if (element == m_elements.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name
@@ -447,8 +487,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
+  const std::string &item = m_elements[element];
 
   //
   // If root is zero, we're beginning to see if we can use the object name
@@ -459,11 +498,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (element + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -480,7 +518,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (element + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -510,12 +548,25 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (element + 1, object);
       m_workStack.pop_back ();
     }
+  else if (item != "*")
+    {
+      // this is a normal attribute: look it up by name.  Path resolution
+      // only walks the object graph, so the support level of the
+      // attribute is not checked, as for the "*" wildcard below.
+      struct TypeId::AttributeInformation info;
+      if (!root->GetInstanceTypeId ().LookupAttributeByName (item, &info, true)
+          || !DoAttributeResolve (element, root, info))
+        {
+          NS_LOG_DEBUG ("Requested item=" << item << " does not exist on path=" << GetResolvedPath ());
+          return;
+        }
+    }
   else
     {
-      // this is a normal attribute.
+      // this is a wildcard: try all attributes.
       TypeId tid;
       TypeId nextTid = root->GetInstanceTypeId ();
       bool foundMatch = false;
@@ -528,45 +579,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
             {
               struct TypeId::AttributeInformation info;
               info = tid.GetAttribute (i);
-              if (info.name != item && item != "*")
+              if (DoAttributeResolve (element, root, info))
                 {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)=" << info.name << " on path=" << GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\"" << item <<
-                                    "\" exists on path=\"" << GetResolvedPath () << "\""
-                                    " but is null.");
-                      continue;
-                    }
                   foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker =
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)=" << info.name << " on path=" << GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
             }
 
           nextTid = tid.GetParent ();
@@ -581,21 +597,60 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     }
 }
 
+bool
+Resolver::DoAttributeResolve (std::size_t element, Ptr<Object> root,
+                              const struct TypeId::AttributeInformation &info)
+{
+  NS_LOG_FUNCTION (this << element << root << info.name);
+
+  // attempt to cast to a pointer checker.
+  const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
+  if (pChecker != 0)
+    {
+      NS_LOG_DEBUG ("GetAttribute(ptr)=" << info.name << " on path=" << GetResolvedPath ());
+      PointerValue pValue;
+      root->GetAttribute (info.name, pValue);
+      Ptr<Object> object = pValue.Get<Object> ();
+      if (object == 0)
+        {
+          NS_LOG_ERROR ("Requested object name=\"" << m_elements[element] <<
+                        "\" exists on path=\"" << GetResolvedPath () << "\""
+                        " but is null.");
+          return false;
+        }
+      m_workStack.push_back (info.name);
+      DoResolve (element + 1, object);
+      m_workStack.pop_back ();
+      return true;
+    }
+  // attempt to cast to an object vector.
+  const ObjectPtrContainerChecker *vectorChecker =
+    dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
+  if (vectorChecker != 0)
+    {
+      NS_LOG_DEBUG ("GetAttribute(vector)=" << info.name << " on path=" << GetResolvedPath ());
+      ObjectPtrContainerValue vector;
+      root->GetAttribute (info.name, vector);
+      m_workStack.push_back (info.name);
+      DoArrayResolve (element + 1, vector);
+      m_workStack.pop_back ();
+      return true;
+    }
+  // this could be anything else and we don't know what to do with it.
+  // So, we just ignore it.
+  return false;
+}
+
 void
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t element, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION (this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << element << &container);
+  if (element == m_elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  const ArrayMatcher &matcher = m_matchers[element];
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -604,7 +659,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (element + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -24,8 +24,14 @@
 #include "scheduler.h"
 #include "assert.h"
 #include "log.h"
+#include "boolean.h"
+#include "string.h"
+#include "uinteger.h"
 
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 
 /**
@@ -50,6 +56,25 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EventProfile",
+                   "Measure the wall-clock time spent in the events invoking "
+                   "each function, and print the hot list when the simulator "
+                   "is destroyed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EventProfileFile",
+                   "The file the event profile is written to; "
+                   "if empty, it is written to the standard error.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("EventProfileRows",
+                   "The maximum number of functions shown in the event "
+                   "profile; 0 shows all of them.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profileRows),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -66,6 +91,8 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_mainThreadId = std::this_thread::get_id ();
+  m_profile = false;
+  m_profileRows = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -101,6 +128,28 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profile)
+    {
+      if (m_profileFile.empty ())
+        {
+          m_profiler.Print (std::clog, m_profileRows);
+        }
+      else
+        {
+          std::ofstream os (m_profileFile.c_str ());
+          if (os.is_open ())
+            {
+              m_profiler.Print (os, m_profileRows);
+            }
+          else
+            {
+              std::clog << "Could not open event profile file "
+                        << m_profileFile << std::endl;
+              m_profiler.Print (std::clog, m_profileRows);
+            }
+        }
+      m_profiler.Clear ();
+    }
 }
 
 void
@@ -143,7 +192,19 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profile && !next.impl->IsCancelled ())
+    {
+      // Look the event up before invoking it, since it may destroy its target.
+      std::size_t entry = m_profiler.Lookup (next.impl);
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      next.impl->Invoke ();
+      std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+      m_profiler.Record (entry, std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ());
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
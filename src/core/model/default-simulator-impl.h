@@ -22,6 +22,7 @@
 #define DEFAULT_SIMULATOR_IMPL_H
 
 #include "simulator-impl.h"
+#include "event-profiler.h"
 #include <list>
 #include <mutex>
 #include <thread>
@@ -134,6 +135,15 @@ private:
 
   /** Main execution thread. */
   std::thread::id m_mainThreadId;
+
+  /** Measure the time spent in each event. */
+  bool m_profile;
+  /** The file the event profile is written to, or empty for std::clog. */
+  std::string m_profileFile;
+  /** The number of functions shown in the event profile. */
+  uint32_t m_profileRows;
+  /** The event profile. */
+  EventProfiler m_profiler;
 };
 
 } // namespace ns3
@@ -66,4 +66,12 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const std::type_info &
+EventImpl::GetTarget (uintptr_t *function, const ObjectBase **object) const
+{
+  *function = 0;
+  *object = 0;
+  return typeid (*this);
+}
+
 } // namespace ns3
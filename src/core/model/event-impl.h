@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <typeinfo>
 #include "simple-ref-count.h"
 
 /**
@@ -31,6 +32,8 @@
 
 namespace ns3 {
 
+class ObjectBase;
+
 /**
  * \ingroup events
  * \brief A simulation event.
@@ -65,6 +68,22 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Describe the function this event invokes.
+   *
+   * Used by the event profiler to attribute the cost of each event
+   * to its target.  The default implementation only knows the
+   * dynamic type of the event.
+   *
+   * \param [out] function The address of the function invoked or,
+   *              for a member function, the first word of the member
+   *              function pointer; 0 if unknown.
+   * \param [out] object The object the member function is invoked on,
+   *              if it is an ObjectBase; 0 otherwise.
+   * \returns The type of the function invoked.
+   */
+  virtual const std::type_info & GetTarget (uintptr_t *function,
+                                            const ObjectBase **object) const;
 
 protected:
   /**
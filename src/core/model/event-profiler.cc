@@ -0,0 +1,302 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "object-base.h"
+#include "log.h"
+#include "assert.h"
+
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#if HAVE_DLADDR
+#include <dlfcn.h>
+#endif
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * \ingroup events
+ * Demangle a C++ symbol or type name, if the compiler supports it.
+ *
+ * \param [in] mangled The mangled name.
+ * \returns The demangled name, or \pname{mangled}.
+ */
+std::string
+Demangle (const char *mangled)
+{
+  std::string ret = mangled;
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, NULL, NULL, &status);
+  if (status == 0)
+    {
+      ret = demangled;
+    }
+  std::free (demangled);
+#endif
+  return ret;
+}
+
+/**
+ * \ingroup events
+ * Order profile entries by decreasing time, then decreasing count.
+ *
+ * \param [in] a The first entry.
+ * \param [in] b The second entry.
+ * \returns \c true if \pname{a} is hotter than \pname{b}.
+ */
+bool
+IsHotter (const EventProfiler::Entry &a, const EventProfiler::Entry &b)
+{
+  if (a.nanoseconds != b.nanoseconds)
+    {
+      return a.nanoseconds > b.nanoseconds;
+    }
+  if (a.count != b.count)
+    {
+      return a.count > b.count;
+    }
+  return a.function < b.function;
+}
+
+} // unnamed namespace
+
+std::size_t
+EventProfiler::KeyHash::operator() (const Key &key) const
+{
+  std::size_t h = std::hash<const void *> () (std::get<0> (key));
+  h ^= std::hash<uintptr_t> () (std::get<1> (key)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  return h ^ (std::hash<uint16_t> () (std::get<2> (key)) + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+EventProfiler::EventProfiler ()
+  : m_count (0),
+    m_nanoseconds (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::size_t
+EventProfiler::Lookup (const EventImpl *event)
+{
+  uintptr_t function;
+  const ObjectBase *object;
+  const std::type_info &type = event->GetTarget (&function, &object);
+  TypeId tid;
+  if (object != 0)
+    {
+      tid = object->GetInstanceTypeId ();
+    }
+  Key key (&type, function, tid.GetUid ());
+  std::unordered_map<Key, std::size_t, KeyHash>::const_iterator i = m_index.find (key);
+  if (i != m_index.end ())
+    {
+      return i->second;
+    }
+  Entry entry;
+  entry.function = GetFunctionName (type, function);
+  entry.module = object != 0 ? GetModuleName (tid) : "";
+  entry.count = 0;
+  entry.nanoseconds = 0;
+  std::size_t index = m_entries.size ();
+  m_entries.push_back (entry);
+  m_index[key] = index;
+  return index;
+}
+
+void
+EventProfiler::Record (std::size_t entry, int64_t nanoseconds)
+{
+  NS_ASSERT (entry < m_entries.size ());
+  m_entries[entry].count++;
+  m_entries[entry].nanoseconds += nanoseconds;
+  m_count++;
+  m_nanoseconds += nanoseconds;
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_index.clear ();
+  m_entries.clear ();
+  m_count = 0;
+  m_nanoseconds = 0;
+}
+
+uint64_t
+EventProfiler::GetEventCount (void) const
+{
+  return m_count;
+}
+
+int64_t
+EventProfiler::GetNanoseconds (void) const
+{
+  return m_nanoseconds;
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetHotList (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // The same function may have been recorded under several keys when
+  // its type_info is not unique across shared libraries: merge them.
+  std::map<std::pair<std::string, std::string>, Entry> merged;
+  for (std::vector<Entry>::const_iterator i = m_entries.begin (); i != m_entries.end (); ++i)
+    {
+      std::pair<std::string, std::string> name (i->function, i->module);
+      std::map<std::pair<std::string, std::string>, Entry>::iterator j = merged.find (name);
+      if (j == merged.end ())
+        {
+          merged[name] = *i;
+        }
+      else
+        {
+          j->second.count += i->count;
+          j->second.nanoseconds += i->nanoseconds;
+        }
+    }
+  std::vector<Entry> hotList;
+  for (std::map<std::pair<std::string, std::string>, Entry>::const_iterator i = merged.begin ();
+       i != merged.end (); ++i)
+    {
+      hotList.push_back (i->second);
+    }
+  std::sort (hotList.begin (), hotList.end (), &IsHotter);
+  return hotList;
+}
+
+void
+EventProfiler::Print (std::ostream &os, uint32_t rows) const
+{
+  NS_LOG_FUNCTION (this << &os << rows);
+  std::vector<Entry> hotList = GetHotList ();
+  double total = m_nanoseconds > 0 ? static_cast<double> (m_nanoseconds) : 1.0;
+
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed;
+  os << "Event profile: " << m_count << " events, "
+     << std::setprecision (3) << m_nanoseconds / 1e9 << " s" << std::endl;
+  os << std::setw (12) << "count"
+     << std::setw (12) << "time (ms)"
+     << std::setw (8) << "%"
+     << std::setw (12) << "mean (ns)"
+     << "  " << std::left << std::setw (16) << "module" << std::right
+     << "function" << std::endl;
+  std::map<std::string, Entry> modules;
+  for (std::size_t i = 0; i < hotList.size (); ++i)
+    {
+      const Entry &entry = hotList[i];
+      Entry &module = modules[entry.module];
+      module.count += entry.count;
+      module.nanoseconds += entry.nanoseconds;
+      if (rows != 0 && i >= rows)
+        {
+          continue;
+        }
+      os << std::setw (12) << entry.count
+         << std::setw (12) << std::setprecision (3) << entry.nanoseconds / 1e6
+         << std::setw (8) << std::setprecision (2) << 100.0 * entry.nanoseconds / total
+         << std::setw (12) << std::setprecision (0)
+         << static_cast<double> (entry.nanoseconds) / entry.count
+         << "  " << std::left << std::setw (16) << (entry.module.empty () ? "-" : entry.module)
+         << std::right << entry.function << std::endl;
+    }
+  if (rows != 0 && hotList.size () > rows)
+    {
+      os << "  (" << hotList.size () - rows << " more functions not shown)" << std::endl;
+    }
+
+  std::vector<Entry> moduleList;
+  for (std::map<std::string, Entry>::const_iterator i = modules.begin (); i != modules.end (); ++i)
+    {
+      Entry entry = i->second;
+      entry.function = i->first.empty () ? "-" : i->first;
+      moduleList.push_back (entry);
+    }
+  std::sort (moduleList.begin (), moduleList.end (), &IsHotter);
+  os << "Time per module:" << std::endl;
+  for (std::vector<Entry>::const_iterator i = moduleList.begin (); i != moduleList.end (); ++i)
+    {
+      os << std::setw (12) << i->count
+         << std::setw (12) << std::setprecision (3) << i->nanoseconds / 1e6
+         << std::setw (8) << std::setprecision (2) << 100.0 * i->nanoseconds / total
+         << "  " << i->function << std::endl;
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+std::string
+EventProfiler::GetFunctionName (const std::type_info &type, uintptr_t function)
+{
+  NS_LOG_FUNCTION (type.name () << function);
+#if HAVE_DLADDR
+  if (function != 0)
+    {
+      Dl_info info;
+      void *address = reinterpret_cast<void *> (function);
+      if (dladdr (address, &info) != 0
+          && info.dli_sname != 0
+          && info.dli_saddr == address)
+        {
+          return Demangle (info.dli_sname);
+        }
+    }
+#endif
+  std::ostringstream oss;
+  oss << Demangle (type.name ());
+  if (function != 0)
+    {
+      oss << " [0x" << std::hex << function << "]";
+    }
+  return oss.str ();
+}
+
+std::string
+EventProfiler::GetModuleName (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  while (tid.GetGroupName ().empty () && tid.HasParent () && tid.GetParent () != tid)
+    {
+      tid = tid.GetParent ();
+    }
+  return tid.GetGroupName ();
+}
+
+} // namespace ns3
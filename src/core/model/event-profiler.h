@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "type-id.h"
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+class ObjectBase;
+
+/**
+ * \ingroup events
+ * \brief Attribute the wall-clock time spent in simulation events
+ * to the functions they invoke.
+ *
+ * Each event reports the function it invokes through
+ * EventImpl::GetTarget(), which the MakeEvent() templates implement.
+ * Events are grouped by the type and address of that function and by
+ * the TypeId of the object it is invoked on; each group is labelled with
+ * the function name and with the module, that is the TypeId group name,
+ * of that object.
+ *
+ * The simulator implementations call Lookup() before invoking each
+ * event, since the event may destroy the object it is invoked on, then
+ * measure the duration of the event and call Record().  DefaultSimulatorImpl does so when its
+ * \c EventProfile attribute is set, and prints the hot list when the
+ * simulator is destroyed:
+ *
+ * \code
+ *   ./ns3 run "my-program --ns3::DefaultSimulatorImpl::EventProfile=true"
+ * \endcode
+ *
+ * Function names are read from the dynamic symbol table when the
+ * platform provides \c dladdr(); otherwise, and for virtual methods, the
+ * signature of the function is shown along with its address.
+ */
+class EventProfiler
+{
+public:
+  /** The profile of the events invoking one function. */
+  struct Entry
+  {
+    std::string function;  //!< The function invoked.
+    std::string module;    //!< The module of the object it is invoked on.
+    uint64_t count;        //!< The number of events.
+    int64_t nanoseconds;   //!< The wall-clock time spent in the events.
+  };
+
+  EventProfiler ();
+
+  /**
+   * Find the profile entry of an event which is about to be invoked.
+   *
+   * \param [in] event The event.
+   * \returns The index of its entry, to be passed to Record().
+   */
+  std::size_t Lookup (const EventImpl *event);
+  /**
+   * Account for one event.
+   *
+   * \param [in] entry The index of its entry, returned by Lookup().
+   * \param [in] nanoseconds The wall-clock time spent invoking it.
+   */
+  void Record (std::size_t entry, int64_t nanoseconds);
+  /** Forget all the events recorded so far. */
+  void Clear (void);
+
+  /** \returns The number of events recorded. */
+  uint64_t GetEventCount (void) const;
+  /** \returns The wall-clock time spent in the events recorded, in ns. */
+  int64_t GetNanoseconds (void) const;
+  /**
+   * \returns The profile of each function, by decreasing time spent.
+   */
+  std::vector<Entry> GetHotList (void) const;
+  /**
+   * Print the hot list, followed by the time spent in each module.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] rows The maximum number of functions shown, 0 for all.
+   */
+  void Print (std::ostream &os, uint32_t rows = 0) const;
+
+private:
+  /**
+   * The type and address of the function invoked by an event,
+   * and the TypeId uid of the object it is invoked on.
+   */
+  typedef std::tuple<const std::type_info *, uintptr_t, uint16_t> Key;
+  /** Hash function for Key. */
+  struct KeyHash
+  {
+    /**
+     * \param [in] key The key.
+     * \returns The hash of \pname{key}.
+     */
+    std::size_t operator() (const Key &key) const;
+  };
+
+  /**
+   * Name a function.
+   *
+   * \param [in] type The type of the function.
+   * \param [in] function The address of the function, or 0.
+   * \returns The name of the function.
+   */
+  static std::string GetFunctionName (const std::type_info &type, uintptr_t function);
+  /**
+   * Find the module a type of object belongs to.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \returns The first non-empty group name of \pname{tid} and its parents.
+   */
+  static std::string GetModuleName (TypeId tid);
+
+  /** Index of the entry of each function in m_entries. */
+  std::unordered_map<Key, std::size_t, KeyHash> m_index;
+  /** The profile of each function, in order of first appearance. */
+  std::vector<Entry> m_entries;
+  /** The number of events recorded. */
+  uint64_t m_count;
+  /** The wall-clock time spent in the events recorded, in ns. */
+  int64_t m_nanoseconds;
+
+};  // class EventProfiler
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -51,6 +51,13 @@ EventImpl * MakeEvent (void (*f)(void))
     {
       (*m_function)();
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = reinterpret_cast<uintptr_t> (m_function);
+      *object = 0;
+      return typeid (F);
+    }
 
   private:
     F m_function;
@@ -328,6 +328,9 @@ EventImpl * MakeEvent (T function);
 #include "event-impl.h"
 #include "type-traits.h"
 
+#include <cstring>
+#include <type_traits>
+
 namespace ns3 {
 
 /**
@@ -366,6 +369,47 @@ struct EventMemberImplObjTraits<T *>
   }
 };
 
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the event profiler: identify a class method.
+ *
+ * \tparam MEM \deduced The class method function signature.
+ * \param [in] function The class method.
+ * \returns The first word of the member function pointer which, for
+ *          a non-virtual method with the Itanium C++ ABI, is the
+ *          address of the method.
+ */
+template <typename MEM>
+uintptr_t
+EventMemberImplFunction (MEM function)
+{
+  uintptr_t word = 0;
+  std::memcpy (&word, &function, sizeof (word) < sizeof (function) ? sizeof (word) : sizeof (function));
+  return word;
+}
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the event profiler: get the object an event is invoked on.
+ *
+ * \tparam T \deduced The class type.
+ * \param [in] obj The object.
+ * \returns \pname{obj} if it is an ObjectBase, 0 otherwise.
+ */
+template <typename T>
+const ObjectBase *
+EventMemberImplObject (const T &obj)
+{
+  if constexpr (std::is_base_of<ObjectBase, T>::value)
+    {
+      return &obj;
+    }
+  else
+    {
+      return 0;
+    }
+}
+
 template <typename MEM, typename OBJ>
 EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
 {
@@ -385,6 +429,13 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = EventMemberImplFunction (m_function);
+      *object = EventMemberImplObject (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      return typeid (MEM);
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -415,6 +466,13 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = EventMemberImplFunction (m_function);
+      *object = EventMemberImplObject (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      return typeid (MEM);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -446,6 +504,13 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = EventMemberImplFunction (m_function);
+      *object = EventMemberImplObject (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      return typeid (MEM);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -479,6 +544,13 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = EventMemberImplFunction (m_function);
+      *object = EventMemberImplObject (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      return typeid (MEM);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -514,6 +586,13 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = EventMemberImplFunction (m_function);
+      *object = EventMemberImplObject (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      return typeid (MEM);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -552,6 +631,13 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = EventMemberImplFunction (m_function);
+      *object = EventMemberImplObject (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      return typeid (MEM);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -592,6 +678,13 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = EventMemberImplFunction (m_function);
+      *object = EventMemberImplObject (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      return typeid (MEM);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -628,6 +721,13 @@ EventImpl * MakeEvent (void (*f)(U1), T1 a1)
     {
       (*m_function)(m_a1);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = reinterpret_cast<uintptr_t> (m_function);
+      *object = 0;
+      return typeid (F);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -659,6 +759,13 @@ EventImpl * MakeEvent (void (*f)(U1,U2), T1 a1, T2 a2)
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = reinterpret_cast<uintptr_t> (m_function);
+      *object = 0;
+      return typeid (F);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -693,6 +800,13 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3)
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = reinterpret_cast<uintptr_t> (m_function);
+      *object = 0;
+      return typeid (F);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -729,6 +843,13 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4), T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = reinterpret_cast<uintptr_t> (m_function);
+      *object = 0;
+      return typeid (F);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -767,6 +888,13 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = reinterpret_cast<uintptr_t> (m_function);
+      *object = 0;
+      return typeid (F);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -807,6 +935,13 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = reinterpret_cast<uintptr_t> (m_function);
+      *object = 0;
+      return typeid (F);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -836,6 +971,13 @@ private:
     {
       m_function();
     }
+    virtual const std::type_info & GetTarget (uintptr_t *function,
+                                              const ObjectBase **object) const
+    {
+      *function = 0;
+      *object = 0;
+      return typeid (T);
+    }
     T m_function;
   } *ev = new EventImplFunctional (function);
   return ev;
@@ -16,7 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <unordered_map>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
@@ -75,8 +75,8 @@ public:
   /** The object corresponding to this NameNode. */
   Ptr<Object> m_object;
 
-  /** Children of this NameNode. */
-  std::map<std::string, NameNode *> m_nameMap;
+  /** Children of this NameNode, by name. */
+  std::unordered_map<std::string, NameNode *> m_nameMap;
 };
 
 NameNode::NameNode ()
@@ -156,6 +156,17 @@ public:
    * \return \c true if the object was named successfully.
    */
   bool Add (Ptr<Object> context, std::string name, Ptr<Object> object);
+  /**
+   * Internal implementation for
+   * Names::Add(std::string,std::string,const std::vector<Ptr<Object> >&)
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined.
+   * \param [in] prefix The prefix of the names.
+   * \param [in] objects The objects to name.
+   * \return \c true if all the objects were named successfully.
+   */
+  bool Add (std::string path, std::string prefix, const std::vector<Ptr<Object> > &objects);
 
   /**
    * Internal implementation for Names::Rename(std::string,std::string)
@@ -256,7 +267,23 @@ private:
    * \param [in] object The object to check.
    * \returns The corresponding NameNode, if it exists.
    */
-  NameNode * IsNamed (Ptr<Object> object);
+  NameNode * IsNamed (const Object *object);
+  /**
+   * Find the NameNode under which names are added for a context.
+   *
+   * \param [in] context The context object, or 0 for the root.
+   * \returns The NameNode, or 0 if the context is not named.
+   */
+  NameNode * GetContextNode (Ptr<Object> context);
+  /**
+   * Name an object under a NameNode.
+   *
+   * \param [in] node The parent NameNode.
+   * \param [in] name The name of the object.
+   * \param [in] object The object.
+   * \returns \c true if the object was named successfully.
+   */
+  bool AddNode (NameNode *node, const std::string &name, Ptr<Object> object);
   /**
    * Check if a name already exists as a child of a NameNode.
    *
@@ -264,13 +291,16 @@ private:
    * \param [in] name The name to search for.
    * \returns \c true if \c name already exists as a child of \c node.
    */
-  bool IsDuplicateName (NameNode *node, std::string name);
+  bool IsDuplicateName (NameNode *node, const std::string &name);
 
   /** The root NameNode. */
   NameNode m_root;
 
-  /** Map from object pointers to their NameNodes. */
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  /**
+   * Map from object pointers to their NameNodes.  The NameNode holds
+   * a reference to the object, which keeps the key valid.
+   */
+  std::unordered_map<const Object *, NameNode *> m_objectMap;
 };
 
 NamesPriv::NamesPriv ()
@@ -297,7 +327,7 @@ NamesPriv::Clear (void)
   // Every name is associated with an object in the object map, so freeing the
   // NameNodes in this map will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::unordered_map<const Object *, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
     {
       delete i->second;
       i->second = 0;
@@ -389,21 +419,65 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << context << name << object);
 
-  if (IsNamed (object))
+  NameNode *node = GetContextNode (context);
+  NS_ASSERT_MSG (node, "NamesPriv::Name(): context must point to a previously named node");
+  return AddNode (node, name, object);
+}
+
+bool
+NamesPriv::Add (std::string path, std::string prefix, const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << path << prefix << objects.size ());
+
+  //
+  // Resolve the path once for the whole batch, and size the maps up
+  // front so that naming a large container does not rehash them over
+  // and over again.
+  //
+  NameNode *node = &m_root;
+  if (path != "/Names")
     {
-      NS_LOG_LOGIC ("Object is already named");
-      return false;
+      Ptr<Object> context = Find (path);
+      if (context == 0)
+        {
+          NS_LOG_LOGIC ("Path does not point to a previously named node");
+          return false;
+        }
+      node = IsNamed (PeekPointer (context));
     }
 
-  NameNode *node = 0;
+  m_objectMap.reserve (m_objectMap.size () + objects.size ());
+  node->m_nameMap.reserve (node->m_nameMap.size () + objects.size ());
+  for (std::size_t i = 0; i < objects.size (); ++i)
+    {
+      if (!AddNode (node, prefix + std::to_string (i), objects[i]))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+NameNode *
+NamesPriv::GetContextNode (Ptr<Object> context)
+{
+  NS_LOG_FUNCTION (this << context);
   if (context)
     {
-      node = IsNamed (context);
-      NS_ASSERT_MSG (node, "NamesPriv::Name(): context must point to a previously named node");
+      return IsNamed (PeekPointer (context));
     }
-  else
+  return &m_root;
+}
+
+bool
+NamesPriv::AddNode (NameNode *node, const std::string &name, Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << node << name << object);
+
+  if (IsNamed (PeekPointer (object)))
     {
-      node = &m_root;
+      NS_LOG_LOGIC ("Object is already named");
+      return false;
     }
 
   if (IsDuplicateName (node, name))
@@ -414,7 +488,7 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
 
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  m_objectMap[PeekPointer (object)] = newNode;
 
   return true;
 }
@@ -499,16 +573,8 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
 {
   NS_LOG_FUNCTION (this << context << oldname << newname);
 
-  NameNode *node = 0;
-  if (context)
-    {
-      node = IsNamed (context);
-      NS_ASSERT_MSG (node, "NamesPriv::Name(): context must point to a previously named node");
-    }
-  else
-    {
-      node = &m_root;
-    }
+  NameNode *node = GetContextNode (context);
+  NS_ASSERT_MSG (node, "NamesPriv::Name(): context must point to a previously named node");
 
   if (IsDuplicateName (node, newname))
     {
@@ -516,7 +582,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Old name does not exist in name map");
@@ -546,17 +612,12 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (PeekPointer (object));
+  if (node == 0)
     {
-      NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
     }
-  else
-    {
-      NS_LOG_LOGIC ("Object exists in object map");
-      return i->second->m_name;
-    }
+  return node->m_name;
 }
 
 std::string
@@ -564,25 +625,34 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *p = IsNamed (PeekPointer (object));
+  if (p == 0)
     {
-      NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
     }
 
-  NameNode *p = i->second;
-  NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
-
-  std::string path;
-
+  //
+  // Collect the segments from the leaf up, then build the path in one go
+  // rather than prepending to it at each level.
+  //
+  std::vector<const NameNode *> nodes;
+  std::size_t size = 0;
   do
     {
-      path = "/" + p->m_name + path;
-      NS_LOG_LOGIC ("path is " << path);
+      nodes.push_back (p);
+      size += p->m_name.size () + 1;
     }
   while ((p = p->m_parent) != 0);
 
+  std::string path;
+  path.reserve (size);
+  for (std::vector<const NameNode *>::reverse_iterator i = nodes.rbegin (); i != nodes.rend (); ++i)
+    {
+      path += "/";
+      path += (*i)->m_name;
+    }
+  NS_LOG_LOGIC ("path is " << path);
+
   return path;
 }
 
@@ -629,52 +699,38 @@ NamesPriv::Find (std::string path)
   // remaining = "ClientNode/eth0"
   //
   // The start of the search is always at the root of the name space.
+  // Walk the segments in place, descending one level per segment.
   //
+  std::string segment;
+  std::string::size_type start = 0;
   for (;;)
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
-      if (offset == std::string::npos)
+      offset = remaining.find ('/', start);
+      segment.assign (remaining, start, offset == std::string::npos ? std::string::npos : offset - start);
+      NS_LOG_LOGIC ("Looking for the object of name " << segment);
+
+      std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
+      if (i == node->m_nameMap.end ())
         {
-          //
-          // There are no remaining slashes so this is the last segment of the
-          // specified name.  We're done when we find it
-          //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
+          NS_LOG_LOGIC ("Name does not exist in name map");
+          return 0;
         }
-      else
+      if (offset == std::string::npos)
         {
           //
-          // There are more slashes so this is an intermediate segment of the
-          // specified name.  We need to "recurse" when we find this segment.
+          // There are no remaining slashes so this is the last segment of the
+          // specified name.  We're done.
           //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
+          NS_LOG_LOGIC ("Name parsed, found object");
+          return i->second->m_object;
         }
+      //
+      // There are more slashes so this is an intermediate segment of the
+      // specified name.  We need to "recurse" into this segment.
+      //
+      node = i->second;
+      start = offset + 1;
+      NS_LOG_LOGIC ("Intermediate segment parsed");
     }
 
   NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
@@ -698,24 +754,14 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
 {
   NS_LOG_FUNCTION (this << context << name);
 
-  NameNode *node = 0;
-
-  if (context == 0)
+  NameNode *node = GetContextNode (context);
+  if (node == 0)
     {
-      NS_LOG_LOGIC ("Zero context implies root NameNode");
-      node = &m_root;
-    }
-  else
-    {
-      node = IsNamed (context);
-      if (node == 0)
-        {
-          NS_LOG_LOGIC ("Context does not point to a previously named node");
-          return 0;
-        }
+      NS_LOG_LOGIC ("Context does not point to a previously named node");
+      return 0;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -729,11 +775,11 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
 }
 
 NameNode *
-NamesPriv::IsNamed (Ptr<Object> object)
+NamesPriv::IsNamed (const Object *object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::unordered_map<const Object *, NameNode *>::iterator i = m_objectMap.find (object);
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
@@ -747,11 +793,11 @@ NamesPriv::IsNamed (Ptr<Object> object)
 }
 
 bool
-NamesPriv::IsDuplicateName (NameNode *node, std::string name)
+NamesPriv::IsDuplicateName (NameNode *node, const std::string &name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -788,6 +834,14 @@ Names::Add (std::string path, std::string name, Ptr<Object> object)
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding " << path << " " << name);
 }
 
+void
+Names::Add (std::string path, std::string prefix, const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (path << prefix << objects.size ());
+  bool result = NamesPriv::Get ()->Add (path, prefix, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding names " << prefix << "* under " << path);
+}
+
 void
 Names::Rename (std::string path, std::string oldname, std::string newname)
 {
@@ -22,6 +22,9 @@
 #include "ptr.h"
 #include "object.h"
 
+#include <string>
+#include <vector>
+
 /**
  * \file
  * \ingroup config
@@ -171,6 +174,45 @@ public:
    */
   static void Add (Ptr<Object> context, std::string name, Ptr<Object> object);
 
+  /**
+   * \brief Name all the objects of a collection under the same path.
+   *
+   * The objects are named \pname{prefix} followed by their index in
+   * \pname{objects}, starting at 0: Names::Add ("/Names", "node", objects)
+   * defines "/Names/node0", "/Names/node1" and so on.  The path is resolved once for the whole
+   * batch, which makes this much faster than naming each object in turn
+   * when the collection is large.
+   *
+   * As with the other forms of Names::Add, every name must be new at
+   * its level and every object must not have been named before.
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined, or
+   *             "/Names" for the root of the name space.
+   * \param [in] prefix The prefix of the names.
+   * \param [in] objects The objects to name.
+   */
+  static void Add (std::string path, std::string prefix, const std::vector<Ptr<Object> > &objects);
+
+  /**
+   * \brief Name all the objects of a range under the same path.
+   *
+   * This is a convenience form of
+   * Names::Add (std::string,std::string,const std::vector<Ptr<Object> >&)
+   * which accepts the iterators of a container such as NodeContainer:
+   * Names::Add ("/Names", "node", nodes.Begin (), nodes.End ()).
+   *
+   * \tparam ITERATOR \deduced An iterator over smart pointers to objects.
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined, or
+   *             "/Names" for the root of the name space.
+   * \param [in] prefix The prefix of the names.
+   * \param [in] begin The first object to name.
+   * \param [in] end Past the last object to name.
+   */
+  template <typename ITERATOR>
+  static void Add (std::string path, std::string prefix, ITERATOR begin, ITERATOR end);
+
   /**
    * \brief Rename a previously associated name.
    *
@@ -450,6 +492,19 @@ private:
 };
 
 
+template <typename ITERATOR>
+/* static */
+void
+Names::Add (std::string path, std::string prefix, ITERATOR begin, ITERATOR end)
+{
+  std::vector<Ptr<Object> > objects;
+  for (ITERATOR i = begin; i != end; ++i)
+    {
+      objects.push_back (*i);
+    }
+  Add (path, prefix, objects);
+}
+
 template <typename T>
 /* static */
 Ptr<T>
@@ -102,6 +102,7 @@ Object::Object ()
 {
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
+  m_aggregates->table = 0;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object ()
@@ -124,7 +125,12 @@ Object::~Object ()
   // delete the aggregate list
   if (m_aggregates->n == 0)
     {
-      std::free (m_aggregates);
+      FreeAggregates (m_aggregates);
+    }
+  else
+    {
+      // the lookup table might point to this object
+      ClearLookupTable (m_aggregates);
     }
   m_aggregates = 0;
 }
@@ -136,6 +142,7 @@ Object::Object (const Object &o)
     m_getObjectCount (0)
 {
   m_aggregates->n = 1;
+  m_aggregates->table = 0;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -147,10 +154,17 @@ Object::Construct (const AttributeConstructionList &attributes)
 
 Ptr<Object>
 Object::DoGetObject (TypeId tid) const
+{
+  NS_LOG_FUNCTION (this << tid);
+  return LookupObject (tid);
+}
+Object *
+Object::ScanAggregates (TypeId tid) const
 {
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  Object *found = 0;
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -173,11 +187,62 @@ Object::DoGetObject (TypeId tid) const
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          found = current;
+          break;
         }
     }
-  return 0;
+
+  // Record the result, growing the table to keep it at most half full.
+  struct LookupTable *table = m_aggregates->table;
+  if (table == 0 || 2 * (table->used + 1) > table->mask + 1)
+    {
+      uint32_t size = table == 0 ? 8 : 2 * (table->mask + 1);
+      struct LookupTable *grown =
+        (struct LookupTable *)std::calloc (1, sizeof (struct LookupTable)
+                                           + (size - 1) * sizeof (struct LookupTable::Slot));
+      grown->mask = size - 1;
+      grown->used = 0;
+      for (uint32_t i = 0; table != 0 && i <= table->mask; i++)
+        {
+          if (table->slots[i].uid != 0)
+            {
+              uint32_t j = table->slots[i].uid & grown->mask;
+              while (grown->slots[j].uid != 0)
+                {
+                  j = (j + 1) & grown->mask;
+                }
+              grown->slots[j] = table->slots[i];
+              grown->used++;
+            }
+        }
+      std::free (table);
+      table = grown;
+      m_aggregates->table = table;
+    }
+  uint16_t uid = tid.GetUid ();
+  uint32_t i = uid & table->mask;
+  while (table->slots[i].uid != 0)
+    {
+      i = (i + 1) & table->mask;
+    }
+  table->slots[i].uid = uid;
+  table->slots[i].object = found;
+  table->used++;
+  return found;
+}
+void
+Object::FreeAggregates (struct Aggregates *aggregates)
+{
+  NS_LOG_FUNCTION (aggregates);
+  std::free (aggregates->table);
+  std::free (aggregates);
+}
+void
+Object::ClearLookupTable (struct Aggregates *aggregates)
+{
+  NS_LOG_FUNCTION (aggregates);
+  std::free (aggregates->table);
+  aggregates->table = 0;
 }
 void
 Object::Initialize (void)
@@ -263,6 +328,7 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates =
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates) + (total - 1) * sizeof(Object*));
   aggregates->n = total;
+  aggregates->table = 0;
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0],
@@ -314,8 +380,8 @@ Object::AggregateObject (Ptr<Object> o)
     }
 
   // Now that we are done with them, we can free our old aggregate buffers
-  std::free (a);
-  std::free (b);
+  FreeAggregates (a);
+  FreeAggregates (b);
 }
 /**
  * This function must be implemented in the stack that needs to notify
@@ -340,6 +406,7 @@ Object::SetTypeId (TypeId tid)
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (Check ());
   m_tid = tid;
+  ClearLookupTable (m_aggregates);
 }
 
 void
@@ -330,6 +330,8 @@ private:
   friend struct ObjectDeleter;
   /**@}*/
 
+  struct LookupTable;
+
   /**
    * The list of Objects aggregated to this one.
    *
@@ -346,10 +348,41 @@ private:
   {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /** The results of past lookups, or 0 if there was none yet. */
+    LookupTable *table;
     /** The array of Objects. */
     Object *buffer[1];
   };
 
+  /**
+   * The results of the lookups performed on a set of aggregated Objects,
+   * indexed by the TypeId of the Object requested.
+   *
+   * This is an open-addressing hash table keyed by TypeId::GetUid(),
+   * with linear probing.  Like Aggregates, it is allocated with
+   * a variable-sized \c slots array.  Unsuccessful lookups are recorded
+   * too, with a null \c object.  The table is shared by all the
+   * aggregated Objects, is filled lazily by ScanAggregates() and is
+   * discarded whenever the set of aggregated Objects changes.
+   */
+  struct LookupTable
+  {
+    /** The number of slots minus one; the number of slots is a power of two. */
+    uint32_t mask;
+    /** The number of slots in use. */
+    uint32_t used;
+    /** One lookup result. */
+    struct Slot
+    {
+      /** The TypeId uid requested, or 0 if the slot is free. */
+      uint16_t uid;
+      /** The matching Object, or 0 if there is none. */
+      Object *object;
+    };
+    /** The array of slots. */
+    struct Slot slots[1];
+  };
+
   /**
    * Find an Object of TypeId tid in the aggregates of this Object.
    *
@@ -357,6 +390,34 @@ private:
    * \return The matching Object, if it is found
    */
   Ptr<Object> DoGetObject (TypeId tid) const;
+  /**
+   * Find an Object of TypeId tid in the aggregates of this Object,
+   * using the lookup table when it has the answer.
+   *
+   * \param [in] tid The TypeId we're looking for
+   * \return The matching Object, or 0 if it is not found
+   */
+  inline Object * LookupObject (TypeId tid) const;
+  /**
+   * Find an Object of TypeId tid by scanning the aggregates of this
+   * Object, and record the result in the lookup table.
+   *
+   * \param [in] tid The TypeId we're looking for
+   * \return The matching Object, or 0 if it is not found
+   */
+  Object * ScanAggregates (TypeId tid) const;
+  /**
+   * Free an array of aggregates and its lookup table.
+   *
+   * \param [in] aggregates The array of aggregates.
+   */
+  static void FreeAggregates (struct Aggregates *aggregates);
+  /**
+   * Discard the lookup table of an array of aggregates.
+   *
+   * \param [in,out] aggregates The array of aggregates.
+   */
+  static void ClearLookupTable (struct Aggregates *aggregates);
   /**
    * Verify that this Object is still live, by checking it's reference count.
    * \return \c true if the reference count is non zero.
@@ -465,24 +526,39 @@ ObjectDeleter::Delete (Object *object)
   object->DoDelete ();
 }
 
+Object *
+Object::LookupObject (TypeId tid) const
+{
+  const struct LookupTable *table = m_aggregates->table;
+  if (table != 0)
+    {
+      uint16_t uid = tid.GetUid ();
+      for (uint32_t i = uid & table->mask;
+           table->slots[i].uid != 0;
+           i = (i + 1) & table->mask)
+        {
+          if (table->slots[i].uid == uid)
+            {
+              return table->slots[i].object;
+            }
+        }
+    }
+  return ScanAggregates (tid);
+}
+
 template <typename T>
 Ptr<T>
 Object::GetObject () const
 {
-  // This is an optimization: if the cast works (which is likely),
-  // things will be pretty fast.
-  T *result = dynamic_cast<T *> (m_aggregates->buffer[0]);
-  if (result != 0)
-    {
-      return Ptr<T> (result);
-    }
-  // if the cast does not work, we try to do a full type check.
-  Ptr<Object> found = DoGetObject (T::GetTypeId ());
+  // Once this lookup has been done on any of the aggregates,
+  // the answer is a single probe of the lookup table away.
+  Object *found = LookupObject (T::GetTypeId ());
   if (found != 0)
     {
-      return Ptr<T> (static_cast<T *> (PeekPointer (found)));
+      return Ptr<T> (static_cast<T *> (found));
     }
-  return 0;
+  // T might not register a TypeId of its own: fall back to the cast.
+  return Ptr<T> (dynamic_cast<T *> (m_aggregates->buffer[0]));
 }
 
 /**
@@ -131,6 +131,16 @@ RandomVariableStream::GetStream (void) const
   return m_stream;
 }
 
+void
+RandomVariableStream::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 RngStream *
 RandomVariableStream::Peek (void) const
 {
@@ -208,6 +218,29 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double min = m_min;
+  double max = m_max;
+  Peek ()->RandU01 (values, n);
+  if (IsAntithetic ())
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          double v = min + values[i] * (max - min);
+          values[i] = min + (max - v);
+        }
+    }
+  else
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          values[i] = min + values[i] * (max - min);
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED (ConstantRandomVariable);
 
@@ -444,6 +477,31 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double mean = m_mean;
+  double bound = m_bound;
+  bool antithetic = IsAntithetic ();
+  std::size_t i = 0;
+  while (i < n)
+    {
+      // Each uniform value yields at most one value: drawing only as
+      // many as are missing keeps the stream in step with GetValue ().
+      std::size_t end = n;
+      Peek ()->RandU01 (values + i, end - i);
+      for (std::size_t j = i; j < end; ++j)
+        {
+          double v = antithetic ? (1 - values[j]) : values[j];
+          double r = -mean*std::log (v);
+          if (bound == 0 || r <= bound)
+            {
+              values[i++] = r;
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED (ParetoRandomVariable);
 
@@ -541,6 +599,32 @@ ParetoRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_scale, m_shape, m_bound);
 }
+void
+ParetoRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double scale = m_scale;
+  double shape = m_shape;
+  double bound = m_bound;
+  bool antithetic = IsAntithetic ();
+  std::size_t i = 0;
+  while (i < n)
+    {
+      // Each uniform value yields at most one value: drawing only as
+      // many as are missing keeps the stream in step with GetValue ().
+      std::size_t end = n;
+      Peek ()->RandU01 (values + i, end - i);
+      for (std::size_t j = i; j < end; ++j)
+        {
+          double v = antithetic ? (1 - values[j]) : values[j];
+          double r = (scale * ( 1.0 / std::pow (v, 1.0 / shape)));
+          if (bound == 0 || r <= bound)
+            {
+              values[i++] = r;
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED (WeibullRandomVariable);
 
@@ -760,6 +844,71 @@ NormalRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
+void
+NormalRandomVariable::GetValues (double *values, std::size_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double mean = m_mean;
+  double sd = std::sqrt (m_variance);
+  double bound = m_bound;
+  bool antithetic = IsAntithetic ();
+  std::size_t i = 0;
+  if (n > 0 && m_nextValid)
+    { // use previously generated
+      m_nextValid = false;
+      double x2 = mean + m_v2 * m_y * sd;
+      if (std::fabs (x2 - mean) <= bound)
+        {
+          values[i++] = x2;
+        }
+    }
+  const std::size_t maxPairs = 32;
+  double u[2 * maxPairs];
+  while (i < n)
+    {
+      // Each pair of uniform values yields at most two values: drawing
+      // only enough pairs for the missing values keeps the stream, and
+      // the cached second value, in step with GetValue ().
+      std::size_t pairs = std::min ((n - i + 1) / 2, maxPairs);
+      Peek ()->RandU01 (u, 2 * pairs);
+      for (std::size_t p = 0; p < pairs && i < n; ++p)
+        {
+          double u1 = u[2 * p];
+          double u2 = u[2 * p + 1];
+          if (antithetic)
+            {
+              u1 = (1 - u1);
+              u2 = (1 - u2);
+            }
+          double v1 = 2 * u1 - 1;
+          double v2 = 2 * u2 - 1;
+          double w = v1 * v1 + v2 * v2;
+          if (w > 1.0)
+            {
+              continue;
+            }
+          double y = std::sqrt ((-2 * std::log (w)) / w);
+          double x1 = mean + v1 * y * sd;
+          double x2 = mean + v2 * y * sd;
+          if (std::fabs (x1 - mean) <= bound)
+            {
+              values[i++] = x1;
+              if (i == n)
+                {
+                  // keep the other value for the next call
+                  m_nextValid = true;
+                  m_y = y;
+                  m_v2 = v2;
+                  break;
+                }
+            }
+          if (std::fabs (x2 - mean) <= bound)
+            {
+              values[i++] = x2;
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED (LogNormalRandomVariable);
 
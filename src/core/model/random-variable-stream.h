@@ -30,6 +30,7 @@
 #include "object.h"
 #include "attribute-helper.h"
 #include <stdint.h>
+#include <cstddef>
 
 /**
  * \file
@@ -149,6 +150,21 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next \pname{n} random values drawn from the distribution.
+   *
+   * The values are the same as those returned by \pname{n} successive
+   * calls to GetValue(), so that a model can draw a batch of values
+   * ahead of time without changing its results.  The uniform,
+   * exponential, Pareto and normal streams override this method to
+   * draw the underlying uniform values in one batch and transform
+   * them in a tight loop.
+   *
+   * \param [out] values The array which receives the values.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, std::size_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
@@ -294,6 +310,11 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  /**
+   * \copydoc RandomVariableStream::GetValues()
+   * \note The upper limit is excluded from the output range.
+   */
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -586,6 +607,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -784,6 +806,10 @@ public:
    * which now involves the distance \f$u\f$ is from 1 in the denominator.
    */
   virtual uint32_t GetInteger (void);
+  /**
+   * \copydoc RandomVariableStream::GetValues()
+   */
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The scale parameter for the Pareto distribution returned by this RNG stream. */
@@ -1223,6 +1249,10 @@ public:
    * which now involves the distances \f$u1\f$ and \f$u2\f$ are from 1.
    */
   virtual uint32_t GetInteger (void);
+  /**
+   * \copydoc RandomVariableStream::GetValues()
+   */
+  virtual void GetValues (double *values, std::size_t n);
 
 private:
   /** The mean value for the normal distribution returned by this RNG stream. */
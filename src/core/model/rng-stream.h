@@ -19,6 +19,7 @@
 
 #ifndef RNGSTREAM_H
 #define RNGSTREAM_H
+#include <cstddef>
 #include <string>
 #include <stdint.h>
 
@@ -70,6 +71,17 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \pname{n} random numbers for this stream.
+   *
+   * The numbers are the same as those returned by \pname{n}
+   * successive calls to RandU01(), but the generator state is kept
+   * in registers for the whole batch.
+   *
+   * \param [out] u The array which receives the numbers.
+   * \param [in] n The number of random numbers to generate.
+   */
+  void RandU01 (double *u, std::size_t n);
 
 private:
   /**
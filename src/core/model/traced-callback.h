@@ -21,7 +21,8 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <algorithm>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -110,11 +111,24 @@ private:
   /**
    * Container type for holding the chain of Callbacks.
    *
+   * The chain is stored contiguously: it is walked on every trace hit
+   * but only modified when sinks are connected or disconnected.
+   *
    * \tparam Ts \deduced Types of the functor arguments.
    */
-  typedef std::list<Callback<void,Ts...> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  typedef std::vector<Callback<void,Ts...> > CallbackList;
+  /**
+   * The chain of Callbacks.
+   *
+   * While the chain is invoked, disconnected Callbacks are only set to
+   * null, so that the indices of the other Callbacks do not change; the
+   * outermost invocation removes them when it is done.
+   */
+  mutable CallbackList m_callbackList;
+  /** Number of invocations of the chain in progress. */
+  mutable uint32_t m_firing;
+  /** Whether Callbacks were disconnected while the chain was invoked. */
+  mutable bool m_removed;
 };
 
 } // namespace ns3
@@ -128,7 +142,9 @@ namespace ns3 {
 
 template<typename... Ts>
 TracedCallback<Ts...>::TracedCallback ()
-  : m_callbackList ()
+  : m_callbackList (),
+    m_firing (0),
+    m_removed (false)
 {}
 template<typename... Ts>
 void
@@ -160,9 +176,18 @@ TracedCallback<Ts...>::DisconnectWithoutContext (const CallbackBase & callback)
   for (typename CallbackList::iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if (!(*i).IsNull () && (*i).IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          if (m_firing > 0)
+            {
+              (*i).Nullify ();
+              m_removed = true;
+              i++;
+            }
+          else
+            {
+              i = m_callbackList.erase (i);
+            }
         }
       else
         {
@@ -186,10 +211,25 @@ template<typename... Ts>
 void
 TracedCallback<Ts...>::operator() (Ts... args) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect another sink to this
+  // TracedCallback, which can reallocate the vector.  Sinks disconnected
+  // meanwhile are nullified rather than erased, and skipped.
+  m_firing++;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](args...);
+        }
+    }
+  m_firing--;
+  if (m_firing == 0 && m_removed)
     {
-      (*i)(args...);
+      m_removed = false;
+      m_callbackList.erase (std::remove_if (m_callbackList.begin (), m_callbackList.end (),
+                                            [] (const Callback<void,Ts...> &cb)
+                                            { return cb.IsNull (); }),
+                            m_callbackList.end ());
     }
 }
 
@@ -24,6 +24,7 @@
 #include "trace-source-accessor.h"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -269,6 +270,26 @@ public:
    * \returns \c true if this TypeId should be hidden from the user.
    */
   bool MustHideFromDocumentation (uint16_t uid) const;
+  /**
+   * Find an Attribute by name in a type id or its parents.
+   * \param [in] uid The id.
+   * \param [in] name The Attribute name.
+   * \param [out] owner The id which registered the Attribute.
+   * \param [out] index The index of the Attribute in \pname{owner}.
+   * \returns \c true if the Attribute was found.
+   */
+  bool LookupAttribute (uint16_t uid, const std::string &name,
+                        uint16_t *owner, std::size_t *index) const;
+  /**
+   * Find a TraceSource by name in a type id or its parents.
+   * \param [in] uid The id.
+   * \param [in] name The TraceSource name.
+   * \param [out] owner The id which registered the TraceSource.
+   * \param [out] index The index of the TraceSource in \pname{owner}.
+   * \returns \c true if the TraceSource was found.
+   */
+  bool LookupTraceSource (uint16_t uid, const std::string &name,
+                          uint16_t *owner, std::size_t *index) const;
 
 private:
   /**
@@ -315,6 +336,10 @@ private:
     std::vector<struct TypeId::AttributeInformation> attributes;
     /** The container of TraceSources. */
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
+    /** Index of the Attributes registered by this type id, by name. */
+    std::unordered_map<std::string, std::size_t> attributeIndex;
+    /** Index of the TraceSources registered by this type id, by name. */
+    std::unordered_map<std::string, std::size_t> traceSourceIndex;
     /** Support level/deprecation. */
     TypeId::SupportLevel supportLevel;
     /** Support message. */
@@ -612,34 +637,40 @@ IidManager::GetRegistered (uint16_t i) const
 }
 
 bool
-IidManager::HasAttribute (uint16_t uid,
-                          std::string name)
+IidManager::LookupAttribute (uint16_t uid, const std::string &name,
+                             uint16_t *owner, std::size_t *index) const
 {
   NS_LOG_FUNCTION (IID << uid << name);
-  struct IidInformation *information  = LookupInformation (uid);
   while (true)
     {
-      for (std::vector<struct TypeId::AttributeInformation>::const_iterator i = information->attributes.begin ();
-           i != information->attributes.end (); ++i)
+      struct IidInformation *information = LookupInformation (uid);
+      auto it = information->attributeIndex.find (name);
+      if (it != information->attributeIndex.end ())
         {
-          if (i->name == name)
-            {
-              NS_LOG_LOGIC (IIDL << true);
-              return true;
-            }
+          *owner = uid;
+          *index = it->second;
+          NS_LOG_LOGIC (IIDL << true);
+          return true;
         }
-      struct IidInformation *parent = LookupInformation (information->parent);
-      if (parent == information)
+      if (information->parent == uid)
         {
           // top of inheritance tree
           NS_LOG_LOGIC (IIDL << false);
           return false;
         }
       // check parent
-      information = parent;
+      uid = information->parent;
     }
-  NS_LOG_LOGIC (IIDL << false);
-  return false;
+}
+
+bool
+IidManager::HasAttribute (uint16_t uid,
+                          std::string name)
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  uint16_t owner;
+  std::size_t index;
+  return LookupAttribute (uid, name, &owner, &index);
 }
 
 void
@@ -680,6 +711,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  information->attributeIndex[name] = information->attributes.size () - 1;
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void
@@ -715,34 +747,40 @@ IidManager::GetAttribute (uint16_t uid, std::size_t i) const
 }
 
 bool
-IidManager::HasTraceSource (uint16_t uid,
-                            std::string name)
+IidManager::LookupTraceSource (uint16_t uid, const std::string &name,
+                               uint16_t *owner, std::size_t *index) const
 {
   NS_LOG_FUNCTION (IID << uid << name);
-  struct IidInformation *information  = LookupInformation (uid);
   while (true)
     {
-      for (std::vector<struct TypeId::TraceSourceInformation>::const_iterator i = information->traceSources.begin ();
-           i != information->traceSources.end (); ++i)
+      struct IidInformation *information = LookupInformation (uid);
+      auto it = information->traceSourceIndex.find (name);
+      if (it != information->traceSourceIndex.end ())
         {
-          if (i->name == name)
-            {
-              NS_LOG_LOGIC (IIDL << true);
-              return true;
-            }
+          *owner = uid;
+          *index = it->second;
+          NS_LOG_LOGIC (IIDL << true);
+          return true;
         }
-      struct IidInformation *parent = LookupInformation (information->parent);
-      if (parent == information)
+      if (information->parent == uid)
         {
           // top of inheritance tree
           NS_LOG_LOGIC (IIDL << false);
           return false;
         }
       // check parent
-      information = parent;
+      uid = information->parent;
     }
-  NS_LOG_LOGIC (IIDL << false);
-  return false;
+}
+
+bool
+IidManager::HasTraceSource (uint16_t uid,
+                            std::string name)
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  uint16_t owner;
+  std::size_t index;
+  return LookupTraceSource (uid, name, &owner, &index);
 }
 
 void
@@ -772,6 +810,7 @@ IidManager::AddTraceSource (uint16_t uid,
   source.supportLevel = supportLevel;
   source.supportMsg = supportMsg;
   information->traceSources.push_back (source);
+  information->traceSourceIndex[name] = information->traceSources.size () - 1;
   NS_LOG_LOGIC (IIDL << information->traceSources.size () - 1);
 }
 std::size_t
@@ -879,43 +918,30 @@ TypeId::GetRegistered (uint16_t i)
 }
 
 bool
-TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
+TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info,
+                               bool permissive) const
 {
-  NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do
+  NS_LOG_FUNCTION (this << name << info << permissive);
+  uint16_t owner;
+  std::size_t index;
+  if (!IidManager::Get ()->LookupAttribute (m_tid, name, &owner, &index))
     {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "Attribute '" << name << "' is deprecated: "
-                            << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("Attribute '" << name <<
-                                  "' is obsolete, with no fallback: " <<
-                                  tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
+      return false;
+    }
+  struct TypeId::AttributeInformation tmp = IidManager::Get ()->GetAttribute (owner, index);
+  if (!permissive && tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "Attribute '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (!permissive && tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("Attribute '" << name <<
+                      "' is obsolete, with no fallback: " <<
+                      tmp.supportMsg);
     }
-  while (nextTid != tid);
-  return false;
+  *info = tmp;
+  return true;
 }
 
 TypeId
@@ -1136,41 +1162,26 @@ TypeId::LookupTraceSourceByName (std::string name,
                                  struct TraceSourceInformation *info) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  struct TypeId::TraceSourceInformation tmp;
-  do
+  uint16_t owner;
+  std::size_t index;
+  if (!IidManager::Get ()->LookupTraceSource (m_tid, name, &owner, &index))
     {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          tmp = tid.GetTraceSource (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return tmp.accessor;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "TraceSource '" << name << "' is deprecated: "
-                            << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return tmp.accessor;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("TraceSource '" << name <<
-                                  "' is obsolete, with no fallback: " <<
-                                  tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
+      return 0;
     }
-  while (nextTid != tid);
-  return 0;
+  struct TypeId::TraceSourceInformation tmp = IidManager::Get ()->GetTraceSource (owner, index);
+  if (tmp.supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "TraceSource '" << name << "' is deprecated: "
+                << tmp.supportMsg << std::endl;
+    }
+  else if (tmp.supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("TraceSource '" << name <<
+                      "' is obsolete, with no fallback: " <<
+                      tmp.supportMsg);
+    }
+  *info = tmp;
+  return tmp.accessor;
 }
 
 Ptr<const TraceSourceAccessor>
@@ -1180,12 +1191,6 @@ TypeId::LookupTraceSourceByName (std::string name) const
   return LookupTraceSourceByName (name, &info);
 }
 
-uint16_t
-TypeId::GetUid (void) const
-{
-  NS_LOG_FUNCTION (this);
-  return m_tid;
-}
 void
 TypeId::SetUid (uint16_t uid)
 {
@@ -469,9 +469,13 @@ public:
    * \param [in,out] info A pointer to the TypeId::AttributeInformation
    *              data structure where the result value of this method
    *              will be stored.
+   * \param [in] permissive If \c true, return the attribute whatever its
+   *              SupportLevel, without warning about a deprecated attribute
+   *              or aborting on an obsolete one.
    * \returns \c true if the requested attribute could be found.
    */
-  bool LookupAttributeByName (std::string name, struct AttributeInformation *info) const;
+  bool LookupAttributeByName (std::string name, struct AttributeInformation *info,
+                              bool permissive = false) const;
   /**
    * Find a TraceSource by name.
    *
@@ -504,7 +508,7 @@ public:
    * This is really an internal method which users are not expected
    * to use.
    */
-  uint16_t GetUid (void) const;
+  inline uint16_t GetUid (void) const;
   /**
    * Set the internal id of this TypeId.
    *
@@ -611,6 +615,11 @@ TypeId &TypeId::operator = (const TypeId &o)
 }
 TypeId::~TypeId ()
 {}
+uint16_t
+TypeId::GetUid (void) const
+{
+  return m_tid;
+}
 inline bool operator == (TypeId a, TypeId b)
 {
   return a.m_tid == b.m_tid;
@@ -918,6 +918,131 @@ MakeCallbackTemplatesTestCase::DoRun (void)
   that.CheckParentalRights ();
 }
 
+/**
+ * \ingroup callback-tests
+ *
+ * Target object for InlineCallbackTestCase.
+ */
+class InlineCallbackTarget
+{
+public:
+  InlineCallbackTarget ()
+    : m_sum (0)
+  {}
+  /**
+   * Callback target function.
+   * \param [in] a The value to add to m_sum.
+   * \return The new value of m_sum.
+   */
+  int Add (int a)
+  {
+    m_sum += a;
+    return m_sum;
+  }
+
+  int m_sum; //!< Sum of the values passed to Add().
+};
+
+/**
+ * \ingroup callback-tests
+ *
+ * Polymorphic target object for InlineCallbackTestCase.
+ *
+ * Only Callbacks on polymorphic objects hold their target inline;
+ * the others use a heap-allocated CallbackImpl.
+ */
+class InlineCallbackObject : public InlineCallbackTarget
+{
+public:
+  virtual ~InlineCallbackObject ()
+  {}
+};
+
+/**
+ * Test function for InlineCallbackTestCase.
+ * \param [in] a First value.
+ * \param [in] b Second value.
+ * \return The product of \p a and \p b.
+ */
+static int
+InlineCallbackMultiply (int a, int b)
+{
+  return a * b;
+}
+
+/**
+ * \ingroup callback-tests
+ *
+ * Test Callbacks on raw object pointers and function pointers, whose
+ * target may be held inline rather than in a heap-allocated CallbackImpl.
+ */
+class InlineCallbackTestCase : public TestCase
+{
+public:
+  InlineCallbackTestCase ();
+  virtual ~InlineCallbackTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+};
+
+InlineCallbackTestCase::InlineCallbackTestCase ()
+  : TestCase ("Check Callbacks with inline targets")
+{}
+
+void
+InlineCallbackTestCase::DoRun (void)
+{
+  InlineCallbackTarget target;
+  InlineCallbackTarget other;
+
+  Callback<int, int> a = MakeCallback (&InlineCallbackTarget::Add, &target);
+  Callback<int, int> b = MakeCallback (&InlineCallbackTarget::Add, &target);
+  Callback<int, int> c = MakeCallback (&InlineCallbackTarget::Add, &other);
+  NS_TEST_ASSERT_MSG_EQ (a (2), 2, "Inline member callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (b (3), 5, "Inline member callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (b), true, "Same target reported different");
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (c), false, "Different objects reported equal");
+
+  // Materializing the implementation of one side must not change equality
+  NS_TEST_ASSERT_MSG_EQ ((b.GetImpl () != 0), true, "No implementation built");
+  Callback<int, int> d;
+  NS_TEST_ASSERT_MSG_EQ (d.Assign (b), true, "Assign failed");
+  NS_TEST_ASSERT_MSG_EQ (d.IsEqual (a), true, "Assigned callback reported different");
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (d), true, "Assigned callback reported different");
+  NS_TEST_ASSERT_MSG_EQ (d (1), 6, "Assigned callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (c.IsEqual (d), false, "Different objects reported equal");
+
+  Callback<int> bound = a.Bind (4);
+  NS_TEST_ASSERT_MSG_EQ (bound (), 10, "Bound inline callback did not fire");
+
+  Callback<int, int, int> f = MakeCallback (&InlineCallbackMultiply);
+  Callback<int, int> g = MakeBoundCallback (&InlineCallbackMultiply, 3);
+  NS_TEST_ASSERT_MSG_EQ (f (3, 4), 12, "Inline function callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (g (5), 15, "Bound function callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (f.IsEqual (MakeCallback (&InlineCallbackMultiply)), true,
+                         "Same function reported different");
+
+  a.Nullify ();
+  NS_TEST_ASSERT_MSG_EQ (a.IsNull (), true, "Nullified Callback reports not IsNull()");
+  NS_TEST_ASSERT_MSG_EQ (c (7), 7, "Callback on another object did not fire");
+  NS_TEST_ASSERT_MSG_EQ (other.m_sum, 7, "Callback called the wrong object");
+
+  // Callbacks on a polymorphic object compare and assign like the others
+  InlineCallbackObject object;
+  Callback<int, int> h = MakeCallback (&InlineCallbackTarget::Add, &object);
+  Callback<int, int> i = MakeCallback (&InlineCallbackTarget::Add, &object);
+  NS_TEST_ASSERT_MSG_EQ (h (2), 2, "Polymorphic member callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (h.IsEqual (i), true, "Same target reported different");
+  NS_TEST_ASSERT_MSG_EQ (h.IsEqual (c), false, "Different objects reported equal");
+  Callback<int, int> j;
+  NS_TEST_ASSERT_MSG_EQ (j.Assign (i), true, "Assign failed");
+  NS_TEST_ASSERT_MSG_EQ (j.IsEqual (h), true, "Assigned callback reported different");
+  NS_TEST_ASSERT_MSG_EQ (j (3), 5, "Assigned callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (h.Bind (4) (), 9, "Bound polymorphic callback did not fire");
+}
+
 /**
  * \ingroup callback-tests
  *  
@@ -937,6 +1062,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
+  AddTestCase (new InlineCallbackTestCase, TestCase::QUICK);
 }
 
 static CallbackTestSuite g_gallbackTestSuite; //!< Static variable for test initialization
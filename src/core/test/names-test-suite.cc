@@ -975,6 +975,76 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+/**
+ * \ingroup names-tests
+ * Test the Object Name Service can name a collection of objects at once.
+ *
+ *     Add (std::string path, std::string prefix, const std::vector<Ptr<Object> > &objects);
+ *     Add (std::string path, std::string prefix, ITERATOR begin, ITERATOR end);
+ */
+class BatchAddTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  BatchAddTestCase ();
+  /** Destructor. */
+  virtual ~BatchAddTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+BatchAddTestCase::BatchAddTestCase ()
+  : TestCase ("Check batch Names::Add functionality")
+{}
+
+BatchAddTestCase::~BatchAddTestCase ()
+{}
+
+void
+BatchAddTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+BatchAddTestCase::DoRun (void)
+{
+  std::vector<Ptr<Object> > nodes;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      nodes.push_back (CreateObject<TestObject> ());
+    }
+  Names::Add ("/Names", "node", nodes);
+
+  std::vector<Ptr<TestObject> > devices;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      devices.push_back (CreateObject<TestObject> ());
+    }
+  Names::Add ("/Names/node42", "eth", devices.begin (), devices.end ());
+
+  for (uint32_t i = 0; i < nodes.size (); ++i)
+    {
+      std::string name = "node" + std::to_string (i);
+      NS_TEST_ASSERT_MSG_EQ (Names::FindName (nodes[i]), name, "Could not batch Names::Add an Object");
+      NS_TEST_ASSERT_MSG_EQ (Names::FindPath (nodes[i]), "/Names/" + name, "Unexpected path of a batch named Object");
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> (name), nodes[i], "Could not Names::Find a batch named Object");
+    }
+  for (uint32_t i = 0; i < devices.size (); ++i)
+    {
+      std::string name = "eth" + std::to_string (i);
+      NS_TEST_ASSERT_MSG_EQ (Names::FindPath (devices[i]), "/Names/node42/" + name, "Unexpected path of a batch named Object");
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/node42/" + name), devices[i],
+                             "Could not Names::Find a batch named Object");
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> (nodes[42], name), devices[i],
+                             "Could not Names::Find a batch named Object by context");
+    }
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/node41/eth0"), 0, "Unexpectedly found an Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/node100"), 0, "Unexpectedly found an Object");
+}
+
 /**
  * \ingroup names-tests
  * Names Test Suite
@@ -993,6 +1063,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new StringContextAddTestCase);
   AddTestCase (new FullyQualifiedAddTestCase);
   AddTestCase (new RelativeAddTestCase);
+  AddTestCase (new BatchAddTestCase);
   AddTestCase (new BasicRenameTestCase);
   AddTestCase (new StringContextRenameTestCase);
   AddTestCase (new FullyQualifiedRenameTestCase);
@@ -475,6 +475,92 @@ ObjectFactoryTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (a->GetObject<DerivedA> (), 0, "Unexpectedly able to work around C++ type system");
 }
 
+/**
+ * \ingroup object-tests
+ * Test that GetObject() lookups are consistent with aggregation while
+ * their results are remembered.
+ */
+class GetObjectLookupTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  GetObjectLookupTestCase ();
+  /** Destructor. */
+  virtual ~GetObjectLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GetObjectLookupTestCase::GetObjectLookupTestCase ()
+  : TestCase ("Check GetObject lookups across aggregation")
+{}
+
+GetObjectLookupTestCase::~GetObjectLookupTestCase ()
+{}
+
+void
+GetObjectLookupTestCase::DoRun (void)
+{
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+
+  //
+  // Failed lookups must not outlive an aggregation.
+  //
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), 0, "Unexpectedly found a BaseA through derivedB");
+  baseA->AggregateObject (derivedB);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), derivedB, "Cannot GetObject (through baseA) for BaseB Object");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), derivedB, "Cannot GetObject (through baseA) for DerivedB Object");
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), baseA, "Cannot GetObject (through derivedB) for BaseA Object");
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<DerivedA> (), 0, "Unexpectedly found a DerivedA through derivedB");
+
+  //
+  // Look up every registered type, twice, so that the recorded results
+  // outgrow the initial lookup table and are then served from it.
+  //
+  std::vector<Ptr<Object> > first;
+  for (uint16_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      Ptr<Object> expected = 0;
+      if (tid == Object::GetTypeId ())
+        {
+          expected = baseA;
+        }
+      else if (tid == BaseA::GetTypeId ()
+               || (BaseA::GetTypeId ().IsChildOf (tid) && tid != ObjectBase::GetTypeId ()))
+        {
+          expected = baseA;
+        }
+      else if (tid == DerivedB::GetTypeId ()
+               || (DerivedB::GetTypeId ().IsChildOf (tid) && tid != ObjectBase::GetTypeId ()))
+        {
+          expected = derivedB;
+        }
+      Ptr<Object> found = baseA->GetObject<Object> (tid);
+      NS_TEST_ASSERT_MSG_EQ (found, expected, "Wrong GetObject result for " << tid.GetName ());
+      first.push_back (found);
+    }
+  for (uint16_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<Object> (tid), first[i], "GetObject result changed for " << tid.GetName ());
+    }
+
+  //
+  // A new aggregate invalidates the lookups done so far.
+  //
+  Ptr<DerivedA> derivedA = CreateObject<DerivedA> ();
+  NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through derivedA");
+  Ptr<Object> object = CreateObject<Object> ();
+  object->AggregateObject (derivedA);
+  NS_TEST_ASSERT_MSG_EQ (object->GetObject<BaseA> (), derivedA, "Cannot GetObject (through object) for BaseA Object");
+  NS_TEST_ASSERT_MSG_EQ (object->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through object");
+}
+
 /**
  * \ingroup object-tests
  * The Test Suite that glues the Test Cases together.
@@ -492,6 +578,7 @@ ObjectTestSuite::ObjectTestSuite ()
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
   AddTestCase (new ObjectFactoryTestCase);
+  AddTestCase (new GetObjectLookupTestCase);
 }
 
 /**
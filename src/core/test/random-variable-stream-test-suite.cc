@@ -2469,6 +2469,119 @@ NormalCachingTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_GT (v2, 0, "Incorrect value returned, expected > 0");
 }
 
+/**
+ * \ingroup rng-tests
+ * Check that GetValues() draws the same values as GetValue().
+ */
+class GetValuesTestCase : public TestCaseBase
+{
+public:
+  // Constructor
+  GetValuesTestCase ();
+
+private:
+  // Inherited
+  virtual void DoRun (void);
+
+  /**
+   * Compare the values drawn one at a time and in batches
+   * from two streams with the same stream number.
+   * \param [in] name The name of the distribution.
+   * \param [in] single The stream sampled with GetValue().
+   * \param [in] batch The stream sampled with GetValues().
+   */
+  void Compare (std::string name,
+                Ptr<RandomVariableStream> single,
+                Ptr<RandomVariableStream> batch);
+};
+
+GetValuesTestCase::GetValuesTestCase ()
+  : TestCaseBase ("Batch sampling with GetValues")
+{}
+
+void
+GetValuesTestCase::Compare (std::string name,
+                            Ptr<RandomVariableStream> single,
+                            Ptr<RandomVariableStream> batch)
+{
+  NS_LOG_FUNCTION (this << name);
+  single->SetStream (7);
+  batch->SetStream (7);
+  const std::size_t sizes[] = {1, 2, 3, 7, 64, 65, 200};
+  std::vector<double> values;
+  for (std::size_t size : sizes)
+    {
+      values.resize (size);
+      batch->GetValues (values.data (), size);
+      for (std::size_t i = 0; i < size; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[i], single->GetValue (),
+                                 name << ": value " << i << " of a batch of " << size);
+        }
+    }
+  // The streams are still in step.
+  NS_TEST_ASSERT_MSG_EQ (batch->GetValue (), single->GetValue (),
+                         name << ": value after the batches");
+}
+
+void
+GetValuesTestCase::DoRun (void)
+{
+  NS_LOG_FUNCTION (this);
+  SetTestSuiteSeed ();
+
+  for (bool antithetic : {false, true})
+    {
+      std::string suffix = antithetic ? " (antithetic)" : "";
+
+      ObjectFactory factory;
+      factory.SetTypeId (UniformRandomVariable::GetTypeId ());
+      factory.Set ("Antithetic", BooleanValue (antithetic));
+      factory.Set ("Min", DoubleValue (-3));
+      factory.Set ("Max", DoubleValue (5));
+      Compare ("uniform" + suffix,
+               factory.Create<RandomVariableStream> (),
+               factory.Create<RandomVariableStream> ());
+
+      factory = ObjectFactory ();
+      factory.SetTypeId (ExponentialRandomVariable::GetTypeId ());
+      factory.Set ("Antithetic", BooleanValue (antithetic));
+      factory.Set ("Mean", DoubleValue (2));
+      factory.Set ("Bound", DoubleValue (3));
+      Compare ("exponential" + suffix,
+               factory.Create<RandomVariableStream> (),
+               factory.Create<RandomVariableStream> ());
+
+      factory = ObjectFactory ();
+      factory.SetTypeId (ParetoRandomVariable::GetTypeId ());
+      factory.Set ("Antithetic", BooleanValue (antithetic));
+      factory.Set ("Scale", DoubleValue (1));
+      factory.Set ("Shape", DoubleValue (1.5));
+      factory.Set ("Bound", DoubleValue (4));
+      Compare ("Pareto" + suffix,
+               factory.Create<RandomVariableStream> (),
+               factory.Create<RandomVariableStream> ());
+
+      factory = ObjectFactory ();
+      factory.SetTypeId (NormalRandomVariable::GetTypeId ());
+      factory.Set ("Antithetic", BooleanValue (antithetic));
+      factory.Set ("Mean", DoubleValue (1));
+      factory.Set ("Variance", DoubleValue (4));
+      factory.Set ("Bound", DoubleValue (2.5));
+      Compare ("normal" + suffix,
+               factory.Create<RandomVariableStream> (),
+               factory.Create<RandomVariableStream> ());
+
+      // The default implementation.
+      factory = ObjectFactory ();
+      factory.SetTypeId (WeibullRandomVariable::GetTypeId ());
+      factory.Set ("Antithetic", BooleanValue (antithetic));
+      Compare ("Weibull" + suffix,
+               factory.Create<RandomVariableStream> (),
+               factory.Create<RandomVariableStream> ());
+    }
+}
+
 /**
  * \ingroup rng-tests
  * RandomVariableStream test suite, covering all random number variable
@@ -2521,6 +2634,7 @@ RandomVariableSuite::RandomVariableSuite ()
   AddTestCase (new EmpiricalAntitheticTestCase);
   /// Issue #302:  NormalRandomVariable produces stale values
   AddTestCase (new NormalCachingTestCase);
+  AddTestCase (new GetValuesTestCase);
 }
 
 static RandomVariableSuite randomVariableSuite;  //!< Static variable for test initialization
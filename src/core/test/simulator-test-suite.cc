@@ -24,6 +24,13 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/event-profiler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+
+#include <fstream>
+#include <sstream>
 
 using namespace ns3;
 
@@ -531,6 +538,191 @@ SimulatorTemplateTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Object whose methods are profiled by EventProfilerTestCase.
+ */
+class EventProfilerTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::EventProfilerTestObject")
+      .SetParent<Object> ()
+      .SetGroupName ("ProfilerTest")
+    ;
+    return tid;
+  }
+  /** Function used for scheduling. @{ */
+  void Fast (void) {}
+  void Slow (void) {}
+  /** @} */
+};
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Object of another module, which inherits the methods
+ * profiled by EventProfilerTestCase.
+ */
+class EventProfilerDerivedTestObject : public EventProfilerTestObject
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::EventProfilerDerivedTestObject")
+      .SetParent<EventProfilerTestObject> ()
+      .SetGroupName ("DerivedProfilerTest")
+    ;
+    return tid;
+  }
+};
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Object which deletes itself in the event profiled by
+ * EventProfilerTestCase.
+ */
+class EventProfilerDyingTestObject : public ObjectBase
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::EventProfilerDyingTestObject")
+      .SetParent<ObjectBase> ()
+      .SetGroupName ("ProfilerTest")
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  /** Function used for scheduling: delete this object. */
+  void Die (void)
+  {
+    delete this;
+  }
+};
+
+/**
+  * Function used for scheduling.
+  */
+static void ProfiledFunction (void)
+{}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the attribution of events by the event profiler.
+ */
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the event profiler")
+{}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  Ptr<EventProfilerTestObject> object = CreateObject<EventProfilerTestObject> ();
+  Ptr<EventImpl> fast = Ptr<EventImpl> (MakeEvent (&EventProfilerTestObject::Fast, object), false);
+  Ptr<EventImpl> slow = Ptr<EventImpl> (MakeEvent (&EventProfilerTestObject::Slow, object), false);
+  Ptr<EventImpl> function = Ptr<EventImpl> (MakeEvent (&ProfiledFunction), false);
+
+  EventProfiler profiler;
+  for (int i = 0; i < 10; ++i)
+    {
+      profiler.Record (profiler.Lookup (PeekPointer (fast)), 10);
+    }
+  profiler.Record (profiler.Lookup (PeekPointer (slow)), 1000);
+  profiler.Record (profiler.Lookup (PeekPointer (slow)), 1000);
+  profiler.Record (profiler.Lookup (PeekPointer (function)), 500);
+
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetEventCount (), 13, "wrong event count");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetNanoseconds (), 2600, "wrong total time");
+
+  std::vector<EventProfiler::Entry> hotList = profiler.GetHotList ();
+  NS_TEST_ASSERT_MSG_EQ (hotList.size (), 3, "events not told apart");
+  NS_TEST_ASSERT_MSG_EQ (hotList[0].count, 2, "hot list not sorted by time");
+  NS_TEST_ASSERT_MSG_EQ (hotList[0].nanoseconds, 2000, "wrong time");
+  NS_TEST_ASSERT_MSG_EQ (hotList[0].module, "ProfilerTest", "wrong module");
+  NS_TEST_ASSERT_MSG_EQ ((hotList[0].function.find ("EventProfilerTestObject") != std::string::npos),
+                         true, "wrong function " << hotList[0].function);
+  NS_TEST_ASSERT_MSG_EQ (hotList[1].count, 1, "hot list not sorted by time");
+  NS_TEST_ASSERT_MSG_EQ (hotList[1].module, "", "function has no module");
+  NS_TEST_ASSERT_MSG_EQ (hotList[2].count, 10, "hot list not sorted by time");
+  NS_TEST_ASSERT_MSG_EQ (hotList[2].nanoseconds, 100, "wrong time");
+  NS_TEST_ASSERT_MSG_NE (hotList[0].function, hotList[2].function,
+                         "methods with the same signature not told apart");
+
+  profiler.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetEventCount (), 0, "profile not cleared");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetHotList ().size (), 0, "profile not cleared");
+
+  // A method shared by objects of two modules is reported for each module.
+  Ptr<EventProfilerDerivedTestObject> derived = CreateObject<EventProfilerDerivedTestObject> ();
+  Ptr<EventImpl> derivedFast = Ptr<EventImpl> (MakeEvent (&EventProfilerTestObject::Fast, derived), false);
+  profiler.Record (profiler.Lookup (PeekPointer (derivedFast)), 10);
+  profiler.Record (profiler.Lookup (PeekPointer (fast)), 20);
+  hotList = profiler.GetHotList ();
+  NS_TEST_ASSERT_MSG_EQ (hotList.size (), 2, "objects of two modules not told apart");
+  NS_TEST_EXPECT_MSG_EQ (hotList[0].module, "ProfilerTest", "wrong module");
+  NS_TEST_EXPECT_MSG_EQ (hotList[0].nanoseconds, 20, "wrong time");
+  NS_TEST_EXPECT_MSG_EQ (hotList[1].module, "DerivedProfilerTest", "wrong module");
+  NS_TEST_EXPECT_MSG_EQ (hotList[1].nanoseconds, 10, "wrong time");
+  NS_TEST_EXPECT_MSG_EQ (hotList[0].function, hotList[1].function, "wrong function");
+  profiler.Clear ();
+
+  // Profile a simulation run; the hot list is written at Destroy.
+  std::string file = CreateTempDirFilename ("event-profile.txt");
+  ObjectFactory factory;
+  factory.SetTypeId (DefaultSimulatorImpl::GetTypeId ());
+  factory.Set ("EventProfile", BooleanValue (true));
+  factory.Set ("EventProfileFile", StringValue (file));
+  Simulator::Destroy ();
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+  for (int i = 0; i < 5; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &EventProfilerTestObject::Fast, object);
+    }
+  EventId cancelled = Simulator::Schedule (Seconds (1), &EventProfilerTestObject::Slow, object);
+  cancelled.Cancel ();
+  // The profiler must not look at the object after the event deleted it.
+  Simulator::Schedule (Seconds (2), &EventProfilerDyingTestObject::Die,
+                       new EventProfilerDyingTestObject ());
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream is (file.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (is.is_open (), true, "event profile not written");
+  std::string line;
+  std::getline (is, line);
+  NS_TEST_ASSERT_MSG_EQ ((line.find ("Event profile: 6 events") == 0), true,
+                         "wrong event profile header: " << line);
+}
+
 /**
  * \ingroup simulator-tests
  *  
@@ -554,6 +746,7 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (PriorityQueueScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventProfilerTestCase, TestCase::QUICK);
   }
 };
 
@@ -19,6 +19,8 @@
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
 
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -134,6 +136,138 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+/**
+ * \ingroup tracedcallback-tests
+ *
+ * TracedCallback Test case, check the sinks which disconnect a sink of
+ * the same TracedCallback while they are called.
+ */
+class DisconnectTracedCallbackTestCase : public TestCase
+{
+public:
+  DisconnectTracedCallbackTestCase ();
+  virtual ~DisconnectTracedCallbackTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Connect three sinks, of which \p by disconnects \p victim when it
+   * is called, and check the sinks called by two invocations.
+   * \param by The sink which disconnects another one.
+   * \param victim The disconnected sink.
+   * \param first The sinks expected to be called by the first invocation.
+   * \param second The sinks expected to be called by the second invocation.
+   */
+  void Check (uint32_t by, uint32_t victim, std::vector<uint32_t> first, std::vector<uint32_t> second);
+
+  /**
+   * Record the call of a sink, and disconnect its victim, if any.
+   * \param sink The sink.
+   */
+  void Called (uint32_t sink);
+
+  /**
+   * The sinks.
+   * \param a The traced value.
+   * @{
+   */
+  void SinkZero (int a);
+  void SinkOne (int a);
+  void SinkTwo (int a);
+  /** @} */
+
+  /** Pointer to a sink. */
+  typedef void (DisconnectTracedCallbackTestCase::*Sink)(int);
+
+  TracedCallback<int> m_trace;      //!< The TracedCallback.
+  std::vector<uint32_t> m_calls;    //!< The sinks called, in order.
+  std::vector<Sink> m_sinks;        //!< The sinks, by index.
+  uint32_t m_by;                    //!< The sink which disconnects another one.
+  uint32_t m_victim;                //!< The disconnected sink.
+};
+
+DisconnectTracedCallbackTestCase::DisconnectTracedCallbackTestCase ()
+  : TestCase ("Check sinks disconnected while the TracedCallback is invoked")
+{}
+
+void
+DisconnectTracedCallbackTestCase::Called (uint32_t sink)
+{
+  m_calls.push_back (sink);
+  if (sink == m_by)
+    {
+      m_trace.DisconnectWithoutContext (MakeCallback (m_sinks[m_victim], this));
+    }
+}
+
+void
+DisconnectTracedCallbackTestCase::SinkZero ([[maybe_unused]] int a)
+{
+  Called (0);
+}
+
+void
+DisconnectTracedCallbackTestCase::SinkOne ([[maybe_unused]] int a)
+{
+  Called (1);
+}
+
+void
+DisconnectTracedCallbackTestCase::SinkTwo ([[maybe_unused]] int a)
+{
+  Called (2);
+}
+
+void
+DisconnectTracedCallbackTestCase::Check (uint32_t by, uint32_t victim,
+                                         std::vector<uint32_t> first, std::vector<uint32_t> second)
+{
+  m_trace = TracedCallback<int> ();
+  m_by = by;
+  m_victim = victim;
+  for (std::vector<Sink>::const_iterator it = m_sinks.begin (); it != m_sinks.end (); it++)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (*it, this));
+    }
+
+  m_calls.clear ();
+  m_trace (1);
+  NS_TEST_EXPECT_MSG_EQ ((m_calls == first), true,
+                         "Wrong sinks called when sink " << by << " disconnects sink " << victim);
+  m_calls.clear ();
+  m_trace (1);
+  NS_TEST_EXPECT_MSG_EQ ((m_calls == second), true,
+                         "Wrong sinks called after sink " << by << " disconnected sink " << victim);
+}
+
+void
+DisconnectTracedCallbackTestCase::DoRun (void)
+{
+  m_sinks = {&DisconnectTracedCallbackTestCase::SinkZero,
+             &DisconnectTracedCallbackTestCase::SinkOne,
+             &DisconnectTracedCallbackTestCase::SinkTwo};
+
+  // A sink disconnecting itself
+  Check (0, 0, {0, 1, 2}, {1, 2});
+  Check (1, 1, {0, 1, 2}, {0, 2});
+  // A sink disconnecting an earlier sink
+  Check (1, 0, {0, 1, 2}, {1, 2});
+  Check (2, 0, {0, 1, 2}, {1, 2});
+  // A sink disconnecting a later sink, which is then not called
+  Check (0, 2, {0, 1}, {0, 1});
+  Check (0, 1, {0, 2}, {0, 2});
+
+  m_trace = TracedCallback<int> ();
+  NS_TEST_EXPECT_MSG_EQ (m_trace.IsEmpty (), true, "TracedCallback not empty");
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::SinkZero, this));
+  m_by = 0;
+  m_victim = 0;
+  m_trace (1);
+  NS_TEST_EXPECT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected sink left in the TracedCallback");
+}
+
 /**
  * \ingroup tracedcallback-tests
  *  
@@ -149,6 +283,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new DisconnectTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite g_tracedCallbackTestSuite; //!< Static variable for test initialization
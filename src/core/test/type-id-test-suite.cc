@@ -337,6 +337,12 @@ DeprecatedAttributeTestCase::DoRun (void)
        << (ainfo.supportLevel == TypeId::DEPRECATED ? "deprecated" : "error")
        << endl;
 
+  // The permissive lookup, used by Config paths, does not abort
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("obsoleteAttribute", &ainfo, true), true,
+                         "permissive lookup of obsolete attribute");
+  NS_TEST_EXPECT_MSG_EQ (ainfo.supportLevel, TypeId::OBSOLETE,
+                         "permissive lookup of obsolete attribute");
+
 
   struct TypeId::TraceSourceInformation tinfo;
   Ptr<const TraceSourceAccessor> acc;
@@ -354,6 +360,100 @@ DeprecatedAttributeTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup typeid-tests
+ * 
+ * Class used to test lookup of Attributes and TraceSources
+ * registered by a parent TypeId.
+ */
+class DerivedAttribute : public DeprecatedAttribute
+{
+private:
+  int m_derived;        //!< An attribute registered by the derived TypeId
+
+public:
+  DerivedAttribute ()
+    : m_derived (0)
+  {
+  }
+  virtual ~DerivedAttribute ()
+  {}
+
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("DerivedAttribute")
+      .SetParent<DeprecatedAttribute> ()
+      .AddAttribute ("derivedAttribute",
+                     "the derived Attribute",
+                     IntegerValue (2),
+                     MakeIntegerAccessor (&DerivedAttribute::m_derived),
+                     MakeIntegerChecker<int> ())
+    ;
+    return tid;
+  }
+
+};
+
+
+/**
+ * \ingroup typeid-tests
+ * 
+ * Check lookup of Attributes and TraceSources by name
+ * through the parent chain.
+ */
+class InheritedLookupTestCase : public TestCase
+{
+public:
+  InheritedLookupTestCase ();
+  virtual ~InheritedLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+InheritedLookupTestCase::InheritedLookupTestCase ()
+  : TestCase ("Check lookup of inherited Attributes and TraceSources")
+{}
+
+InheritedLookupTestCase::~InheritedLookupTestCase ()
+{}
+
+void
+InheritedLookupTestCase::DoRun (void)
+{
+  TypeId parent = DeprecatedAttribute::GetTypeId ();
+  TypeId tid = DerivedAttribute::GetTypeId ();
+
+  struct TypeId::AttributeInformation ainfo;
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("derivedAttribute", &ainfo), true,
+                         "lookup own attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.name, "derivedAttribute", "wrong attribute found");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.help, "the derived Attribute", "wrong attribute found");
+
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("attribute", &ainfo), true,
+                         "lookup parent attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.help, "the Attribute", "wrong attribute found");
+
+  NS_TEST_ASSERT_MSG_EQ (parent.LookupAttributeByName ("derivedAttribute", &ainfo), false,
+                         "parent found derived attribute");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("noSuchAttribute", &ainfo), false,
+                         "found nonexistent attribute");
+
+  struct TypeId::TraceSourceInformation tinfo;
+  Ptr<const TraceSourceAccessor> acc;
+  acc = tid.LookupTraceSourceByName ("trace", &tinfo);
+  NS_TEST_ASSERT_MSG_NE (acc, 0, "lookup parent trace source");
+  NS_TEST_ASSERT_MSG_EQ (tinfo.help, "the TraceSource", "wrong trace source found");
+  acc = tid.LookupTraceSourceByName ("noSuchTrace", &tinfo);
+  NS_TEST_ASSERT_MSG_EQ (acc, 0, "found nonexistent trace source");
+}
+
+
 /**
  * \ingroup typeid-tests
  * 
@@ -474,6 +574,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new InheritedLookupTestCase, QUICK);
 }
 
 /// Static variable for test initialization.
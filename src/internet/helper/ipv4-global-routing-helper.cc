@@ -70,6 +70,12 @@ Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
   GlobalRouteManager::BuildGlobalRoutingDatabase ();
   GlobalRouteManager::InitializeRoutes ();
 }
+void
+Ipv4GlobalRoutingHelper::UpdateRoutingTables (Ipv4InterfaceContainer interfaces)
+{
+  std::vector<std::pair<Ptr<Ipv4>, uint32_t> > changed (interfaces.Begin (), interfaces.End ());
+  GlobalRouteManager::UpdateRoutes (changed);
+}
 
 
 } // namespace ns3
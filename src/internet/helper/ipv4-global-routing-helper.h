@@ -22,6 +22,7 @@
 
 #include "ns3/node-container.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-interface-container.h"
 
 namespace ns3 {
 
@@ -85,6 +86,27 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes after some interfaces went up or down, or
+   * had their metric changed.
+   *
+   * Only the routers on the links of the interfaces discover their link
+   * state again, and the shortest paths are only computed again for the
+   * routers whose shortest path tree may go through a changed link.  The
+   * other routers get their routes to the changed destinations updated in
+   * place, so that their routes are the same as after
+   * RecomputeRoutingTables(), though maybe in another order.  All the
+   * routes are computed again when the change is not local to the links
+   * of the interfaces: when the designated router of a broadcast link
+   * changes, a link starts or stops having routers on it, or a bridge is
+   * involved.
+   *
+   * The first call computes all the routes like RecomputeRoutingTables(),
+   * and keeps the state which the next calls need.
+   *
+   * \param interfaces the interfaces whose state changed
+   */
+  static void UpdateRoutingTables (Ipv4InterfaceContainer interfaces);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
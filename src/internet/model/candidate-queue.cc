@@ -51,7 +51,8 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::IsBefore);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
@@ -66,7 +67,8 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +96,10 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  vNew->m_candidateOrder = m_order++;
+  m_candidates.push_back (vNew);
+  Place (m_candidates.size () - 1, vNew);
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -111,7 +112,13 @@ CandidateQueue::Pop (void)
     }
 
   SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -164,11 +171,93 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::DecreaseKey (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+  NS_ASSERT (v->m_candidateIndex < m_candidates.size ()
+             && m_candidates[v->m_candidateIndex] == v);
+
+  // The sorted list this queue replaces moved the vertex after all the
+  // vertices which already were at its new distance.
+  v->m_candidateOrder = m_order++;
+  SiftUp (v->m_candidateIndex);
+}
+
+bool
+CandidateQueue::IsBefore (const SPFVertex* v1, const SPFVertex* v2)
+{
+  if (CompareSPFVertex (v1, v2))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (v2, v1))
+    {
+      return false;
+    }
+  return v1->m_candidateOrder < v2->m_candidateOrder;
+}
+
+void
+CandidateQueue::Place (uint32_t i, SPFVertex *v)
+{
+  m_candidates[i] = v;
+  v->m_candidateIndex = i;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!IsBefore (m_candidates[i], m_candidates[parent]))
+        {
+          break;
+        }
+      SPFVertex *v = m_candidates[i];
+      Place (i, m_candidates[parent]);
+      Place (parent, v);
+      i = parent;
+    }
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  uint32_t size = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t first = i;
+      uint32_t left = 2 * i + 1;
+      uint32_t right = left + 1;
+      if (left < size && IsBefore (m_candidates[left], m_candidates[first]))
+        {
+          first = left;
+        }
+      if (right < size && IsBefore (m_candidates[right], m_candidates[first]))
+        {
+          first = right;
+        }
+      if (first == i)
+        {
+          break;
+        }
+      SPFVertex *v = m_candidates[i];
+      Place (i, m_candidates[first]);
+      Place (first, v);
+      i = first;
+    }
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
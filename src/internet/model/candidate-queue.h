@@ -22,7 +22,7 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -45,8 +45,14 @@ class SPFVertex;
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
- * enhanced priority queue.
+ * requirement for a DecreaseKey () operation led us to implement this
+ * enhanced priority queue.  It is a binary heap; each vertex records its
+ * position in the heap, so that DecreaseKey () takes logarithmic time.
+ *
+ * Vertices at the same distance and of the same type are popped in the
+ * order they were pushed, or had their distance decreased, in.  This is
+ * the order of the sorted list the queue used to be, so that the routes
+ * are computed in the same order.
  */
 class CandidateQueue
 {
@@ -154,6 +160,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restore the priority order after the distance of a vertex of the
+ * queue has decreased.
+ *
+ * The vertex is moved towards the top of the queue, after the vertices
+ * which are at its new distance already.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance has decreased.
+ */
+  void DecreaseKey (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +202,38 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+/**
+ * \brief return true if v1 should be popped before v2
+ *
+ * \param v1 first operand
+ * \param v2 second operand
+ * \return True if v1 comes first in the order of CompareSPFVertex, or is
+ * tied with v2 and entered the queue first
+ */
+  static bool IsBefore (const SPFVertex* v1, const SPFVertex* v2);
+
+/**
+ * \brief Store a vertex at a heap position
+ * \param i the position
+ * \param v the vertex
+ */
+  void Place (uint32_t i, SPFVertex *v);
+
+/**
+ * \brief Move the vertex at a heap position towards the top
+ * \param i the position
+ */
+  void SiftUp (uint32_t i);
+
+/**
+ * \brief Move the vertex at a heap position towards the bottom
+ * \param i the position
+ */
+  void SiftDown (uint32_t i);
+
+  typedef std::vector<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  uint64_t m_order; //!< Counter giving the push order of the candidates
 
   /**
    * \brief Stream insertion operator.
@@ -26,11 +26,20 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <set>
+#include <iterator>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
@@ -43,6 +52,44 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \relates GlobalRouteManagerImpl
+ * \anchor GlobalValueGlobalRoutingThreads
+ * \brief The number of threads running the SPF calculations of the
+ * global routes.
+ */
+static GlobalValue g_spfThreads = GlobalValue ("GlobalRoutingThreads",
+                                               "The number of threads running the SPF calculations "
+                                               "of the global routes; 0 uses the number of "
+                                               "hardware threads",
+                                               UintegerValue (0),
+                                               MakeUintegerChecker<uint32_t> ());
+
+/**
+ * \brief The state of the SPF calculation rooted at one router.
+ *
+ * The calculation keeps the SPF status of the LSAs here rather than in the
+ * LSAs, and records its routes instead of installing them, so that the
+ * calculations rooted at different routers can run at the same time.
+ */
+struct GlobalRouteManagerImpl::SPFContext
+{
+  Ipv4Address rootId;  //!< The router ID of the root
+  SPFVertex* root;     //!< The root of the SPF tree, during the calculation
+  bool checkStub;      //!< Whether a stub root only gets a default route
+  std::vector<std::pair<uint32_t, Ipv4Address> > interfaces;  //!< The interface of each local address of the root
+  std::vector<GlobalRoutingLSA::SPFStatus> status;  //!< The SPF status of each LSA, by LSDB index
+  std::vector<SPFVertex*> candidates;  //!< The candidate vertex of each LSA, by LSDB index
+  std::vector<SPFRoute> routes;        //!< The routes found, in order
+  Ptr<Ipv4GlobalRouting> routing;      //!< Where to install the routes, or 0 if the root has no node
+  bool record;                         //!< Whether to fill the fields below for UpdateRoutes
+  bool stub;                           //!< Whether the root turned out to be a stub
+  std::vector<uint32_t> distance;      //!< \see SPFResult
+  std::vector<uint32_t> exits;         //!< \see SPFResult
+  std::vector<std::vector<SPFVertex::NodeExit_t> > exitSets;  //!< \see SPFResult
+  std::map<std::vector<SPFVertex::NodeExit_t>, uint32_t> exitSetIds;  //!< The index of each set in exitSets
+};
+
 /**
  * \brief Stream insertion operator.
  *
@@ -93,7 +140,9 @@ SPFVertex::SPFVertex () :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidateIndex (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -106,7 +155,9 @@ SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) :
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidateIndex (0),
+  m_candidateOrder (0)
 {
   NS_LOG_FUNCTION (this << lsa);
 
@@ -421,7 +472,9 @@ SPFVertex::ClearVertexProcessed (void)
 
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
+    m_lsas (),
     m_database (),
+    m_linkDataDatabase (),
     m_extdatabase ()
 {
   NS_LOG_FUNCTION (this);
@@ -430,11 +483,10 @@ GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
 GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (uint32_t i = 0; i < m_lsas.size (); i++)
     {
       NS_LOG_LOGIC ("free LSA");
-      GlobalRoutingLSA* temp = i->second;
+      GlobalRoutingLSA* temp = m_lsas[i];
       delete temp;
     }
   for (uint32_t j = 0; j < m_extdatabase.size (); j++)
@@ -444,17 +496,18 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
       delete temp;
     }
   NS_LOG_LOGIC ("clear map");
+  m_lsas.clear ();
   m_database.clear ();
+  m_linkDataDatabase.clear ();
 }
 
 void
 GlobalRouteManagerLSDB::Initialize ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (uint32_t i = 0; i < m_lsas.size (); i++)
     {
-      GlobalRoutingLSA* temp = i->second;
+      GlobalRoutingLSA* temp = m_lsas[i];
       temp->SetStatus (GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
     }
 }
@@ -466,10 +519,66 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   if (lsa->GetLSType () == GlobalRoutingLSA::ASExternalLSAs) 
     {
       m_extdatabase.push_back (lsa);
-    } 
-  else
+      return;
+    }
+  if (m_database.find (addr) != m_database.end ())
+    {
+      NS_LOG_WARN ("Ignoring a second LSA with link state ID " << addr);
+      delete lsa;
+      return;
+    }
+  uint32_t index = m_lsas.size ();
+  m_lsas.push_back (lsa);
+  m_database[addr] = index;
+  IndexLinkData (index);
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::Replace (uint32_t index, GlobalRoutingLSA* lsa)
+{
+  NS_LOG_FUNCTION (this << index << lsa);
+  GlobalRoutingLSA* old = m_lsas.at (index);
+  NS_ASSERT_MSG (old->GetLinkStateId () == lsa->GetLinkStateId (),
+                 "Replacing the LSA " << old->GetLinkStateId () << " by " << lsa->GetLinkStateId ());
+  m_lsas[index] = lsa;
+//
+// The records of other LSAs may now be the ones with the lowest link state
+// ID for some link data, so index them all again.
+//
+  m_linkDataDatabase.clear ();
+  for (uint32_t i = 0; i < m_lsas.size (); i++)
+    {
+      IndexLinkData (i);
+    }
+  return old;
+}
+
+void
+GlobalRouteManagerLSDB::IndexLinkData (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+//
+// If several LSAs have a TransitNetwork record with the same link data, the
+// one with the lowest link state ID is found, as it used to be when the
+// database was an ordered map.
+//
+  GlobalRoutingLSA* lsa = m_lsas[index];
+  for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+        {
+          continue;
+        }
+      LSDBMap_t::iterator i = m_linkDataDatabase.find (lr->GetLinkData ());
+      if (i == m_linkDataDatabase.end ())
+        {
+          m_linkDataDatabase[lr->GetLinkData ()] = index;
+        }
+      else if (lsa->GetLinkStateId () < m_lsas[i->second]->GetLinkStateId ())
+        {
+          i->second = index;
+        }
     }
 }
 
@@ -491,43 +600,62 @@ GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
-//
-// Look up an LSA by its address.
-//
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  int32_t index = GetLSAIndex (addr);
+  if (index < 0)
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return 0;
     }
-  return 0;
+  return m_lsas[index];
 }
 
 GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
-//
-// Look up an LSA by its address.
-//
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  int32_t index = GetLSAIndexByLinkData (addr);
+  if (index < 0)
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return 0;
     }
-  return 0;
+  return m_lsas[index];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lsas.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_lsas.at (index);
+}
+
+int32_t
+GlobalRouteManagerLSDB::GetLSAIndex (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i == m_database.end ())
+    {
+      return -1;
+    }
+  return i->second;
+}
+
+int32_t
+GlobalRouteManagerLSDB::GetLSAIndexByLinkData (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  LSDBMap_t::const_iterator i = m_linkDataDatabase.find (addr);
+  if (i == m_linkDataDatabase.end ())
+    {
+      return -1;
+    }
+  return i->second;
 }
 
 // ---------------------------------------------------------------------------
@@ -537,8 +665,8 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 // ---------------------------------------------------------------------------
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
-  :
-    m_spfroot (0)
+  : m_keepResults (false),
+    m_resultsValid (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -562,6 +690,8 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
       delete m_lsdb;
     }
   m_lsdb = lsdb;
+  m_resultsValid = false;
+  m_results.clear ();
 }
 
 void
@@ -597,6 +727,8 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  m_resultsValid = false;
+  m_results.clear ();
 }
 
 //
@@ -612,6 +744,7 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  m_resultsValid = false;
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -699,6 +832,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<Ptr<Node> > roots;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -723,156 +857,787 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (node);
+        }
+    }
+  std::vector<uint32_t> results;
+  m_results.clear ();
+  if (m_keepResults)
+    {
+      m_results.resize (roots.size ());
+      for (uint32_t i = 0; i < roots.size (); i++)
+        {
+          results.push_back (i);
         }
     }
+  CalculateRoutes (roots, results);
+  m_resultsValid = m_keepResults;
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+void
+GlobalRouteManagerImpl::CalculateRoutes (const std::vector<Ptr<Node> > &roots,
+                                         const std::vector<uint32_t> &results)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+//
+// The SPF calculations rooted at different routers are independent: they
+// only read the LSDB, and record their routes in their context instead of
+// installing them.  Run them on worker threads, a batch of roots at a time,
+// and then install the routes of the batch in the order of the node list,
+// so that the routing tables do not depend on the number of threads.
+//
+  uint32_t nThreads = GetNThreads ();
+  uint32_t batchSize = nThreads * SPF_BATCH_PER_THREAD;
+  NS_LOG_INFO ("Running " << roots.size () << " SPF calculations on " << nThreads << " threads");
+  for (uint32_t first = 0; first < roots.size (); first += batchSize)
+    {
+      uint32_t last = std::min<uint32_t> (first + batchSize, roots.size ());
+      std::vector<SPFContext> contexts (last - first);
+      for (uint32_t i = first; i < last; i++)
+        {
+          Ptr<GlobalRouter> rtr = roots[i]->GetObject<GlobalRouter> ();
+          InitializeContext (contexts[i - first], rtr->GetRouterId (), roots[i]);
+          contexts[i - first].record = !results.empty ();
+        }
+
+      std::atomic<uint32_t> next (0);
+      auto worker = [this, &contexts, &next] ()
+        {
+          for (uint32_t i = next++; i < contexts.size (); i = next++)
+            {
+              SPFCalculate (contexts[i]);
+            }
+        };
+      std::vector<std::thread> threads;
+      for (uint32_t t = 1; t < nThreads && t < contexts.size (); t++)
+        {
+          threads.push_back (std::thread (worker));
+        }
+      worker ();
+      for (std::vector<std::thread>::iterator t = threads.begin (); t != threads.end (); t++)
+        {
+          t->join ();
+        }
+
+      for (uint32_t i = 0; i < contexts.size (); i++)
+        {
+          SPFContext &context = contexts[i];
+          InstallRoutes (context);
+          if (context.record)
+            {
+              SPFResult &result = m_results[results[first + i]];
+              result.rootId = context.rootId;
+              result.node = roots[first + i];
+              result.stub = context.stub;
+              result.distance.swap (context.distance);
+              result.exits.swap (context.exits);
+              result.exitSets.swap (context.exitSets);
+            }
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::RecomputeAllRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_keepResults = true;
+  DeleteGlobalRoutes ();
+  BuildGlobalRoutingDatabase ();
+  InitializeRoutes ();
+}
+
 //
-// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
-// 16.1 (2) for further details.
+// A change of the state of an interface changes the LSAs of the routers on
+// its link only, and a handful of LSAs seldom changes the shortest path
+// trees of all the routers.  The SPF calculation rooted at a router needs
+// to run again only if
 //
-// We're passed a parameter <v> that is a vertex which is already in the SPF
-// tree.  A vertex represents a router node.  We also get a reference to the
-// SPF candidate queue, which is a priority queue containing the shortest paths
-// to the networks we know about.
+// - the LSA of the root, of one of its neighbours or of a router on one of
+//   its broadcast links changed, since the exits of the root come from
+//   them; or
+// - an edge of the graph which appeared or disappeared, or whose metric
+//   changed, may be on a shortest path: its tail is reachable and the
+//   distance of its tail plus its metric is not more than the distance of
+//   its head.
 //
-// We examine the links in v's LSA and update the list of candidates with any
-// vertices not already on the list.  If a lower-cost path is found to a
-// vertex already on the candidate list, store the new (lower) cost.
+// Otherwise the shortest path tree, with the distances and the exits of
+// all its vertices, stays the same.  Only the destinations advertised by the
+// changed LSAs may differ: a host address on a point-to-point link, a stub
+// network, the mask of a transit network.  The routes to them go through the
+// exits which the last calculation found for their vertex, so they are
+// updated in place.
 //
 void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+GlobalRouteManagerImpl::UpdateRoutes (const std::vector<std::pair<Ptr<Ipv4>, uint32_t> > &interfaces)
 {
-  NS_LOG_FUNCTION (this << v << &candidate);
+  NS_LOG_FUNCTION (this);
+  if (!m_resultsValid)
+    {
+      NS_LOG_INFO ("No SPF results to update; computing all the routes");
+      RecomputeAllRoutes ();
+      return;
+    }
+//
+// Find the routers attached to the links of the interfaces.  These are the
+// only ones whose LSAs may have changed.
+//
+  std::vector<Ptr<GlobalRouter> > routers;
+  std::set<uint32_t> seen;
+  for (std::vector<std::pair<Ptr<Ipv4>, uint32_t> >::const_iterator i = interfaces.begin ();
+       i != interfaces.end (); i++)
+    {
+      std::vector<Ptr<Node> > nodes;
+      nodes.push_back (i->first->GetObject<Node> ());
+      Ptr<Channel> channel = i->first->GetNetDevice (i->second)->GetChannel ();
+      for (uint32_t j = 0; channel && j < channel->GetNDevices (); j++)
+        {
+          nodes.push_back (channel->GetDevice (j)->GetNode ());
+        }
+      for (std::vector<Ptr<Node> >::const_iterator n = nodes.begin (); n != nodes.end (); n++)
+        {
+          if (!seen.insert ((*n)->GetId ()).second)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < (*n)->GetNDevices (); j++)
+            {
+              if ((*n)->GetDevice (j)->IsBridge ())
+                {
+                  NS_LOG_INFO ("Bridge on node " << (*n)->GetId () << "; computing all the routes");
+                  RecomputeAllRoutes ();
+                  return;
+                }
+            }
+          Ptr<GlobalRouter> rtr = (*n)->GetObject<GlobalRouter> ();
+          if (rtr)
+            {
+              routers.push_back (rtr);
+            }
+        }
+    }
 
-  SPFVertex* w = 0;
-  GlobalRoutingLSA* w_lsa = 0;
-  GlobalRoutingLinkRecord *l = 0;
-  uint32_t distance = 0;
-  uint32_t numRecordsInVertex = 0;
+  std::vector<uint32_t> changed;
+  std::vector<GlobalRoutingLSA*> lsas;
+  if (!DiscoverChangedLSAs (routers, changed, lsas))
+    {
+      NS_LOG_INFO ("The set of LSAs changed; computing all the routes");
+      RecomputeAllRoutes ();
+      return;
+    }
+  NS_LOG_INFO (changed.size () << " LSAs changed");
+  if (changed.empty ())
+    {
+      return;
+    }
 //
-// V points to a Router-LSA or Network-LSA
-// Loop over the links in router LSA or attached routers in Network LSA
+// The edges which may differ are those out of the changed LSAs, and those
+// out of the networks to which they link, whose attached routers are found
+// by the link data of their records.
 //
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  uint32_t nLSAs = m_lsdb->GetNumLSAs ();
+  std::vector<bool> isChanged (nLSAs, false);
+  std::vector<int32_t> touchedIndex (nLSAs, -1);
+  std::vector<uint32_t> touched;
+  for (uint32_t i = 0; i < changed.size (); i++)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+      isChanged[changed[i]] = true;
+      touchedIndex[changed[i]] = touched.size ();
+      touched.push_back (changed[i]);
     }
-  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+  for (uint32_t i = 0; i < changed.size (); i++)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+      GlobalRoutingLSA* versions[2] = { m_lsdb->GetLSAByIndex (changed[i]), lsas[i] };
+      for (uint32_t v = 0; v < 2; v++)
+        {
+          for (uint32_t j = 0; j < versions[v]->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = versions[v]->GetLinkRecord (j);
+              if (l->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  continue;
+                }
+              int32_t w = m_lsdb->GetLSAIndex (l->GetLinkId ());
+              if (touchedIndex[w] < 0)
+                {
+                  touchedIndex[w] = touched.size ();
+                  touched.push_back (w);
+                }
+            }
+        }
+    }
+  std::vector<std::vector<SPFEdge> > oldEdges (touched.size ());
+  std::vector<std::vector<SPFEdge> > newEdges (touched.size ());
+  std::vector<std::vector<SPFEdge> > diffs (touched.size ());
+  for (uint32_t t = 0; t < touched.size (); t++)
+    {
+      GetEdges (touched[t], oldEdges[t]);
+    }
+  std::vector<GlobalRoutingLSA*> oldLSAs;
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      oldLSAs.push_back (m_lsdb->Replace (changed[i], lsas[i]));
+    }
+  for (uint32_t t = 0; t < touched.size (); t++)
+    {
+      GetEdges (touched[t], newEdges[t]);
+      std::set_symmetric_difference (oldEdges[t].begin (), oldEdges[t].end (),
+                                     newEdges[t].begin (), newEdges[t].end (),
+                                     std::back_inserter (diffs[t]));
     }
 
-  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+  std::vector<Ptr<Node> > roots;
+  std::vector<uint32_t> results;
+  std::vector<SPFEdge> edges;
+  std::vector<SPFEdge> attached;
+  for (uint32_t r = 0; r < m_results.size (); r++)
     {
-// Get w_lsa:  In case of V is Router-LSA
-      if (v->GetVertexType () == SPFVertex::VertexRouter) 
-        {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
+      SPFResult &result = m_results[r];
+      int32_t rootIndex = m_lsdb->GetLSAIndex (result.rootId);
+      NS_ASSERT (rootIndex >= 0);
 //
-// (a) If this is a link to a stub network, examine the next link in V's LSA.
-// Links to stub networks will be considered in the second stage of the
-// shortest path calculation.
+// Look for changed LSAs near the root.  The root itself did not change if
+// we get past the first test, so its edges are still those of the last
+// calculation.
 //
-          l = v->GetLSA ()->GetLinkRecord (i);
-          NS_ASSERT (l != 0);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+      bool affected = isChanged[rootIndex];
+      GetEdges (rootIndex, edges);
+      for (uint32_t e = 0; !affected && e < edges.size (); e++)
+        {
+          uint32_t w = edges[e].first;
+          affected = isChanged[w];
+          if (affected || m_lsdb->GetLSAByIndex (w)->GetLSType () != GlobalRoutingLSA::NetworkLSA)
             {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
               continue;
             }
-//
-// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-// database. 
-//
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+          if (touchedIndex[w] >= 0)
             {
-//
-// Lookup the link state advertisement of the new link -- we call it <w> in
-// the link state database.
-//
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a P2P record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+              attached = oldEdges[touchedIndex[w]];
+              attached.insert (attached.end (), newEdges[touchedIndex[w]].begin (),
+                               newEdges[touchedIndex[w]].end ());
             }
-          else if (l->GetLinkType () == 
-                   GlobalRoutingLinkRecord::TransitNetwork)
+          else
             {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a Transit record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+              GetEdges (w, attached);
             }
-          else 
+          for (uint32_t a = 0; !affected && a < attached.size (); a++)
             {
-              NS_ASSERT_MSG (0, "illegal Link Type");
+              affected = isChanged[attached[a].first];
             }
         }
-// Get w_lsa:  In case of V is Network-LSA
-      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+//
+// Look for differing edges which may be on a shortest path.  The tree of a
+// stub root is only its default route, which depends on its neighbour only.
+//
+      for (uint32_t t = 0; !affected && !result.stub && t < touched.size (); t++)
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          uint64_t distance = result.distance[touched[t]];
+          if (distance == SPF_INFINITY)
             {
               continue;
             }
-          NS_LOG_LOGIC ("Found a Network LSA from " << 
-                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+          for (uint32_t e = 0; !affected && e < diffs[t].size (); e++)
+            {
+              affected = distance + diffs[t][e].second <= result.distance[diffs[t][e].first];
+            }
         }
 
-// Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
-//
-// (c) If vertex W is already on the shortest-path tree, examine the next
-// link in the LSA.
+      Ptr<Ipv4GlobalRouting> routing = result.node->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
 //
-// If the link is to a router that is already in the shortest path first tree
-// then we have it covered -- ignore it.
+// If the tree did not change, update the routes to the destinations of the
+// changed LSAs, through the exits found for them by the last calculation.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (!affected && !result.stub
+          && !PatchRoutes (routing, result, rootIndex, changed, oldLSAs, lsas))
+        {
+          NS_LOG_LOGIC ("The routes of " << result.rootId << " can not be patched in order");
+          affected = true;
+        }
+      if (affected)
+        {
+          NS_LOG_LOGIC ("Recomputing the routes of " << result.rootId);
+          while (routing->GetNRoutes () > 0)
+            {
+              routing->RemoveRoute (0);
+            }
+          roots.push_back (result.node);
+          results.push_back (r);
+        }
+    }
+  NS_LOG_INFO ("Recomputing the routes of " << roots.size () << " of " << m_results.size () << " routers");
+  CalculateRoutes (roots, results);
+
+  for (uint32_t i = 0; i < oldLSAs.size (); i++)
+    {
+      delete oldLSAs[i];
+    }
+}
+
+bool
+GlobalRouteManagerImpl::PatchRoutes (Ptr<Ipv4GlobalRouting> routing, const SPFResult& result, uint32_t rootIndex,
+                                     const std::vector<uint32_t>& changed,
+                                     const std::vector<GlobalRoutingLSA*>& oldLSAs,
+                                     const std::vector<GlobalRoutingLSA*>& lsas)
+{
+  NS_LOG_FUNCTION (routing << result.rootId << rootIndex);
+  for (uint32_t i = 0; i < changed.size (); i++)
+    {
+      uint32_t k = changed[i];
+      if (result.distance[k] == SPF_INFINITY || k == rootIndex)
         {
-          NS_LOG_LOGIC ("Skipping ->  LSA "<< 
-                        w_lsa->GetLinkStateId () << " already in SPF tree");
           continue;
         }
-//
-// (d) Calculate the link state cost D of the resulting path from the root to 
-// vertex W.  D is equal to the sum of the link state cost of the (already 
-// calculated) shortest path to vertex V and the advertised cost of the link
-// between vertices V and W.
-//
-      if (v->GetLSA ()->GetLSType () == GlobalRoutingLSA::RouterLSA)
+      const std::vector<SPFVertex::NodeExit_t> &exits = result.exitSets[result.exits[k]];
+      std::vector<SPFRoute> oldRoutes;
+      std::vector<SPFRoute> newRoutes;
+      GetLSARoutes (oldLSAs[i], exits, oldRoutes);
+      GetLSARoutes (lsas[i], exits, newRoutes);
+      std::sort (oldRoutes.begin (), oldRoutes.end ());
+      std::sort (newRoutes.begin (), newRoutes.end ());
+      std::vector<SPFRoute> removed;
+      std::vector<SPFRoute> added;
+      std::set_difference (oldRoutes.begin (), oldRoutes.end (), newRoutes.begin (), newRoutes.end (),
+                           std::back_inserter (removed));
+      std::set_difference (newRoutes.begin (), newRoutes.end (), oldRoutes.begin (), oldRoutes.end (),
+                           std::back_inserter (added));
+      if (!added.empty () && exits.size () > 1)
         {
-          NS_ASSERT (l != 0);
-          distance = v->GetDistanceFromRoot () + l->GetMetric ();
+          // Equal-cost routes, whose order decides which one is used
+          return false;
         }
-      else
+      for (std::vector<SPFRoute>::const_iterator j = removed.begin (); j != removed.end (); j++)
         {
-          distance = v->GetDistanceFromRoot ();
+          bool found;
+          if (j->type == SPFRoute::HOST)
+            {
+              found = routing->RemoveHostRouteTo (j->dest, j->nextHop, j->outIf);
+            }
+          else
+            {
+              found = routing->RemoveNetworkRouteTo (j->dest, j->mask, j->nextHop, j->outIf);
+            }
+          NS_ASSERT_MSG (found, "Route to " << j->dest << " not found on " << result.rootId);
         }
-
-      NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
-
-// Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      for (std::vector<SPFRoute>::const_iterator j = added.begin (); j != added.end (); j++)
         {
-// Calculate nexthop to w
-// We need to figure out how to actually get to the new router represented
+          bool overlaps;
+          if (j->type == SPFRoute::HOST)
+            {
+              overlaps = routing->HasHostRouteTo (j->dest);
+            }
+          else
+            {
+              overlaps = routing->HasOverlappingNetworkRoute (j->dest, j->mask);
+            }
+          if (overlaps)
+            {
+              return false;
+            }
+          InstallRoute (routing, *j);
+        }
+    }
+  return true;
+}
+
+bool
+GlobalRouteManagerImpl::DiscoverChangedLSAs (const std::vector<Ptr<GlobalRouter> > &routers,
+                                             std::vector<uint32_t> &changed,
+                                             std::vector<GlobalRoutingLSA*> &lsas)
+{
+  NS_LOG_FUNCTION (this << routers.size ());
+  typedef std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> CountMap_t;
+  typedef std::unordered_map<Ipv4Address, std::vector<GlobalRoutingLSA*>, Ipv4AddressHash> ExtMap_t;
+  CountMap_t counts;
+  ExtMap_t externals;
+  for (uint32_t i = 0; i < m_lsdb->GetNumLSAs (); i++)
+    {
+      counts[m_lsdb->GetLSAByIndex (i)->GetAdvertisingRouter ()]++;
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA* lsa = m_lsdb->GetExtLSA (i);
+      externals[lsa->GetAdvertisingRouter ()].push_back (lsa);
+    }
+
+  bool ok = true;
+  for (std::vector<Ptr<GlobalRouter> >::const_iterator r = routers.begin (); r != routers.end (); r++)
+    {
+      Ipv4Address id = (*r)->GetRouterId ();
+      uint32_t numLSAs = (*r)->DiscoverLSAs ();
+      uint32_t nOwn = 0;
+      uint32_t nExt = 0;
+      const std::vector<GlobalRoutingLSA*> &oldExternals = externals[id];
+      for (uint32_t j = 0; j < numLSAs; j++)
+        {
+          GlobalRoutingLSA* lsa = new GlobalRoutingLSA ();
+          (*r)->GetLSA (j, *lsa);
+          if (lsa->GetLSType () == GlobalRoutingLSA::ASExternalLSAs)
+            {
+              ok = ok && nExt < oldExternals.size () && IsSameLSA (oldExternals[nExt], lsa);
+              nExt++;
+              delete lsa;
+              continue;
+            }
+          nOwn++;
+          int32_t index = m_lsdb->GetLSAIndex (lsa->GetLinkStateId ());
+          ok = ok && index >= 0 && m_lsdb->GetLSAByIndex (index)->GetAdvertisingRouter () == id;
+          for (uint32_t k = 0; ok && k < lsa->GetNLinkRecords (); k++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (k);
+              ok = l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork
+                || m_lsdb->GetLSAIndex (l->GetLinkId ()) >= 0;
+            }
+          if (!ok || IsSameLSA (m_lsdb->GetLSAByIndex (index), lsa))
+            {
+              delete lsa;
+              continue;
+            }
+          changed.push_back (index);
+          lsas.push_back (lsa);
+        }
+      ok = ok && nOwn == counts[id] && nExt == oldExternals.size ();
+    }
+  if (!ok)
+    {
+      for (uint32_t i = 0; i < lsas.size (); i++)
+        {
+          delete lsas[i];
+        }
+      changed.clear ();
+      lsas.clear ();
+    }
+  return ok;
+}
+
+bool
+GlobalRouteManagerImpl::IsSameLSA (GlobalRoutingLSA* a, GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerImpl::GetEdges (uint32_t index, std::vector<SPFEdge>& edges) const
+{
+  NS_LOG_FUNCTION (this << index);
+//
+// These are the edges which SPFNext follows.
+//
+  edges.clear ();
+  GlobalRoutingLSA* lsa = m_lsdb->GetLSAByIndex (index);
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          int32_t w = m_lsdb->GetLSAIndex (l->GetLinkId ());
+          NS_ASSERT (w >= 0);
+          edges.push_back (SPFEdge (w, l->GetMetric ()));
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+        {
+          int32_t w = m_lsdb->GetLSAIndexByLinkData (lsa->GetAttachedRouter (i));
+          if (w >= 0)
+            {
+              edges.push_back (SPFEdge (w, 0));
+            }
+        }
+    }
+  std::sort (edges.begin (), edges.end ());
+}
+
+void
+GlobalRouteManagerImpl::GetLSARoutes (GlobalRoutingLSA* lsa, const std::vector<SPFVertex::NodeExit_t>& exits,
+                                      std::vector<SPFRoute>& routes)
+{
+  SPFRoute route;
+  for (std::vector<SPFVertex::NodeExit_t>::const_iterator exit = exits.begin (); exit != exits.end (); exit++)
+    {
+      if (exit->second < 0)
+        {
+          continue;
+        }
+      route.nextHop = exit->first;
+      route.outIf = exit->second;
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          // SPFIntraAddTransit
+          route.type = SPFRoute::NETWORK;
+          route.mask = lsa->GetNetworkLSANetworkMask ();
+          route.dest = lsa->GetLinkStateId ().CombineMask (route.mask);
+          routes.push_back (route);
+          continue;
+        }
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              // SPFIntraAddRouter
+              route.type = SPFRoute::HOST;
+              route.dest = l->GetLinkData ();
+              route.mask = Ipv4Mask::GetOnes ();
+              routes.push_back (route);
+            }
+          else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              // SPFIntraAddStub
+              route.type = SPFRoute::NETWORK;
+              route.mask = Ipv4Mask (l->GetLinkData ().Get ());
+              route.dest = l->GetLinkId ().CombineMask (route.mask);
+              routes.push_back (route);
+            }
+        }
+    }
+}
+
+uint32_t
+GlobalRouteManagerImpl::GetNThreads (void) const
+{
+  NS_LOG_FUNCTION (this);
+//
+// The log output of concurrent calculations would be interleaved.
+//
+  const char *components[] = { "GlobalRouteManagerImpl", "CandidateQueue", "GlobalRouter" };
+  LogComponent::ComponentList *list = LogComponent::GetComponentList ();
+  for (uint32_t i = 0; i < sizeof (components) / sizeof (components[0]); i++)
+    {
+      LogComponent::ComponentList::const_iterator component = list->find (components[i]);
+      if (component != list->end () && !component->second->IsNoneEnabled ())
+        {
+          return 1;
+        }
+    }
+  UintegerValue threads;
+  g_spfThreads.GetValue (threads);
+  if (threads.Get () == 0)
+    {
+      return std::max (1U, std::thread::hardware_concurrency ());
+    }
+  return threads.Get ();
+}
+
+void
+GlobalRouteManagerImpl::InitializeContext (SPFContext& context, Ipv4Address root, Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << root << node);
+  context.rootId = root;
+  context.root = 0;
+  context.checkStub = NodeList::GetNNodes () > 0;
+  context.interfaces.clear ();
+  context.routes.clear ();
+  context.routing = 0;
+  context.record = false;
+  context.stub = false;
+  if (node == 0)
+    {
+      return;
+    }
+//
+// Save the addresses of the interfaces of the root node, so that the
+// calculation need not access the node.
+//
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::InitializeContext (): "
+                 "GetObject for <Ipv4> interface failed");
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          context.interfaces.push_back (std::make_pair (i, ipv4->GetAddress (i, j).GetLocal ()));
+        }
+    }
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  context.routing = router->GetRoutingProtocol ();
+  NS_ASSERT (context.routing);
+}
+
+//
+// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
+// 16.1 (2) for further details.
+//
+// We're passed a parameter <v> that is a vertex which is already in the SPF
+// tree.  A vertex represents a router node.  We also get a reference to the
+// SPF candidate queue, which is a priority queue containing the shortest paths
+// to the networks we know about.
+//
+// We examine the links in v's LSA and update the list of candidates with any
+// vertices not already on the list.  If a lower-cost path is found to a
+// vertex already on the candidate list, store the new (lower) cost.
+//
+void
+GlobalRouteManagerImpl::SPFNext (SPFContext& context, SPFVertex* v, CandidateQueue& candidate)
+{
+  NS_LOG_FUNCTION (this << v << &candidate);
+
+  SPFVertex* w = 0;
+  GlobalRoutingLSA* w_lsa = 0;
+  int32_t w_index = -1;
+  GlobalRoutingLinkRecord *l = 0;
+  uint32_t distance = 0;
+  uint32_t numRecordsInVertex = 0;
+//
+// V points to a Router-LSA or Network-LSA
+// Loop over the links in router LSA or attached routers in Network LSA
+//
+  if (v->GetVertexType () == SPFVertex::VertexRouter)
+    {
+      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+    }
+  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+    {
+      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+    }
+
+  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+    {
+// Get w_lsa:  In case of V is Router-LSA
+      if (v->GetVertexType () == SPFVertex::VertexRouter) 
+        {
+          NS_LOG_LOGIC ("Examining link " << i << " of " << 
+                        v->GetVertexId () << "'s " <<
+                        v->GetLSA ()->GetNLinkRecords () << " link records");
+//
+// (a) If this is a link to a stub network, examine the next link in V's LSA.
+// Links to stub networks will be considered in the second stage of the
+// shortest path calculation.
+//
+          l = v->GetLSA ()->GetLinkRecord (i);
+          NS_ASSERT (l != 0);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
+              continue;
+            }
+//
+// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
+// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
+// database. 
+//
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+//
+// Lookup the link state advertisement of the new link -- we call it <w> in
+// the link state database.
+//
+              w_index = m_lsdb->GetLSAIndex (l->GetLinkId ());
+              NS_ASSERT (w_index >= 0);
+              w_lsa = m_lsdb->GetLSAByIndex (w_index);
+              NS_LOG_LOGIC ("Found a P2P record from " << 
+                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+            }
+          else if (l->GetLinkType () == 
+                   GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              w_index = m_lsdb->GetLSAIndex (l->GetLinkId ());
+              NS_ASSERT (w_index >= 0);
+              w_lsa = m_lsdb->GetLSAByIndex (w_index);
+              NS_LOG_LOGIC ("Found a Transit record from " << 
+                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+            }
+          else 
+            {
+              NS_ASSERT_MSG (0, "illegal Link Type");
+            }
+        }
+// Get w_lsa:  In case of V is Network-LSA
+      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+        {
+          w_index = m_lsdb->GetLSAIndexByLinkData 
+              (v->GetLSA ()->GetAttachedRouter (i));
+          if (w_index < 0)
+            {
+              continue;
+            }
+          w_lsa = m_lsdb->GetLSAByIndex (w_index);
+          NS_LOG_LOGIC ("Found a Network LSA from " << 
+                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+        }
+
+// Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
+//
+// (c) If vertex W is already on the shortest-path tree, examine the next
+// link in the LSA.
+//
+// If the link is to a router that is already in the shortest path first tree
+// then we have it covered -- ignore it.
+//
+      if (context.status[w_index] == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+        {
+          NS_LOG_LOGIC ("Skipping ->  LSA "<< 
+                        w_lsa->GetLinkStateId () << " already in SPF tree");
+          continue;
+        }
+//
+// (d) Calculate the link state cost D of the resulting path from the root to 
+// vertex W.  D is equal to the sum of the link state cost of the (already 
+// calculated) shortest path to vertex V and the advertised cost of the link
+// between vertices V and W.
+//
+      if (v->GetLSA ()->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          NS_ASSERT (l != 0);
+          distance = v->GetDistanceFromRoot () + l->GetMetric ();
+        }
+      else
+        {
+          distance = v->GetDistanceFromRoot ();
+        }
+
+      NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
+
+// Is there already vertex w in candidate list?
+      if (context.status[w_index] == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+        {
+// Calculate nexthop to w
+// We need to figure out how to actually get to the new router represented
 // by <w>.  This will (among other things) find the next hop address to send
 // packets destined for this network to, and also find the outbound interface
 // used to forward the packets.
 
 // prepare vertex w
           w = new SPFVertex (w_lsa);
-          if (SPFNexthopCalculation (v, w, l, distance))
+          if (SPFNexthopCalculation (context, v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              context.status[w_index] = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
+              context.candidates[w_index] = w;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -887,7 +1652,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (context.status[w_index] == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -895,7 +1660,8 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // distance metric.
 //
 // So, locate the vertex in the candidate queue and take a look at the 
-// distance.
+// distance.  The context remembers the candidate vertex of each LSA, so we
+// need not search the queue.
 
 /* (quagga-0.98.6) W is already on the candidate list; call it cw.
 * Compare the previously calculated cost (cw->distance)
@@ -903,7 +1669,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 * if we've found a shorter path.
 */
           SPFVertex* cw;
-          cw = candidate.Find (w_lsa->GetLinkStateId ());
+          cw = context.candidates[w_index];
           if (cw->GetDistanceFromRoot () < distance)
             {
 //
@@ -934,7 +1700,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
               w = new SPFVertex (w_lsa);
-              SPFNexthopCalculation (v, w, l, distance);
+              SPFNexthopCalculation (context, v, w, l, distance);
               cw->MergeRootExitDirections (w);
               cw->MergeParent (w);
 // SPFVertexAddParent (w) is necessary as the destructor of 
@@ -953,13 +1719,13 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // N.B. the nexthop_calculation is conditional, if it finds a valid nexthop
 // it will call spf_add_parents, which will flush the old parents
 //
-              if (SPFNexthopCalculation (v, cw, l, distance))
+              if (SPFNexthopCalculation (context, v, cw, l, distance))
                 {
 //
 // If we've changed the cost to get to the vertex represented by <w>, we 
-// must reorder the priority queue keyed to that cost.
+// must move it up the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.DecreaseKey (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -978,6 +1744,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 //
 int
 GlobalRouteManagerImpl::SPFNexthopCalculation (
+  SPFContext& context,
   SPFVertex* v, 
   SPFVertex* w,
   GlobalRoutingLinkRecord* l,
@@ -994,7 +1761,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 */
 
 //
-// The vertex m_spfroot is a distinguished vertex representing the node at
+// The vertex context.root is a distinguished vertex representing the node at
 // the root of the calculations.  That is, it is the node for which we are
 // calculating the routes.
 //
@@ -1016,7 +1783,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // The point-to-point link information is only useful in this calculation when
 // we are examining the root node. 
 //
-  if (v == m_spfroot)
+  if (v == context.root)
     {
 //
 // In this case <v> is the root node, which means it is the starting point
@@ -1061,7 +1828,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
 // from the perspective of <v> -- remember that <l> is the link "from"
 // <v> "to" <w>.
 //
-          uint32_t outIf = FindOutgoingInterfaceId (l->GetLinkData ());
+          uint32_t outIf = FindOutgoingInterfaceId (context, l->GetLinkData ());
 
           w->SetRootExitDirection (nextHop, outIf);
           w->SetDistanceFromRoot (distance);
@@ -1079,7 +1846,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
           GlobalRoutingLSA* w_lsa = w->GetLSA ();
           NS_ASSERT (w_lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA);
 // Find outgoing interface ID for this network
-          uint32_t outIf = FindOutgoingInterfaceId (w_lsa->GetLinkStateId (), 
+          uint32_t outIf = FindOutgoingInterfaceId (context, w_lsa->GetLinkStateId (), 
                                                     w_lsa->GetNetworkLSANetworkMask () );
 // Set the next hop to 0.0.0.0 meaning "not exist"
           Ipv4Address nextHop = Ipv4Address::GetZero ();
@@ -1096,7 +1863,7 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
   else if (v->GetVertexType () == SPFVertex::VertexNetwork) 
     {
 // See if any of v's parents are the root
-      if (v->GetParent () == m_spfroot)
+      if (v->GetParent () == context.root)
         {
 // 16.1.1 para 5. ...the parent vertex is a network that
 // directly connects the calculating router to the destination
@@ -1256,10 +2023,10 @@ GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 // to be run
 //
 bool
-GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
+GlobalRouteManagerImpl::CheckForStubNode (SPFContext& context)
 {
-  NS_LOG_FUNCTION (this << root);
-  GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (root);
+  NS_LOG_FUNCTION (this << context.rootId);
+  GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (context.rootId);
   Ipv4Address myRouterId = rlsa->GetLinkStateId ();
   int transits = 0;
   GlobalRoutingLinkRecord *transitLink = 0;
@@ -1282,7 +2049,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
       // This router is not connected to any router.  Probably, global
       // routing should not be called for this node, but we can just raise
       // a warning here and return true.
-      NS_LOG_WARN ("all nodes should have at least one transit link:" << root );
+      NS_LOG_WARN ("all nodes should have at least one transit link:" << context.rootId );
       return true;
     }
   if (transits == 1)
@@ -1319,15 +2086,11 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  int32_t outIf = FindOutgoingInterfaceId (context, transitLink->GetLinkData ());
+                  AddRoute (context, SPFRoute::NETWORK, Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"),
+                            lr->GetLinkData (), outIf);
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
-                                lr->GetLinkData () << " via interface " << 
-                                FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                                lr->GetLinkData () << " via interface " << outIf);
                   return true;
                 }
             }
@@ -1336,17 +2099,44 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
   return false;
 }
 
-// quagga ospf_spf_calculate
 void
 GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+//
+// Look for the node having the root as router ID; this is the node to which
+// we are going to write the routes.
+//
+  Ptr<Node> rootNode;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          rootNode = *i;
+          break;
+        }
+    }
+  SPFContext context;
+  InitializeContext (context, root, rootNode);
+  SPFCalculate (context);
+  InstallRoutes (context);
+}
+
+// quagga ospf_spf_calculate
+void
+GlobalRouteManagerImpl::SPFCalculate (SPFContext& context)
+{
+  NS_LOG_FUNCTION (this << context.rootId);
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the SPF state of the Link State Database.  It is kept in the
+// context rather than in the LSAs, which several calculations may share.
 //
-  m_lsdb->Initialize ();
+  context.status.assign (m_lsdb->GetNumLSAs (), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+  context.candidates.assign (m_lsdb->GetNumLSAs (), 0);
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1359,15 +2149,26 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // calculation.  Each router (and corresponding network) is a vertex in the
 // shortest path first (SPF) tree.
 //
-  v = new SPFVertex (m_lsdb->GetLSA (root));
+  int32_t rootIndex = m_lsdb->GetLSAIndex (context.rootId);
+  NS_ASSERT_MSG (rootIndex >= 0, "No LSA for the root " << context.rootId);
+  v = new SPFVertex (m_lsdb->GetLSAByIndex (rootIndex));
 // 
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
-  m_spfroot= v;
+  context.root = v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
-  NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
+  context.status[rootIndex] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
+  NS_LOG_LOGIC ("Starting SPFCalculate for node " << context.rootId);
+  if (context.record)
+    {
+      context.distance.assign (m_lsdb->GetNumLSAs (), SPF_INFINITY);
+      context.exits.assign (m_lsdb->GetNumLSAs (), 0);
+      context.exitSets.assign (1, std::vector<SPFVertex::NodeExit_t> ());
+      context.exitSetIds.clear ();
+      context.exitSetIds[context.exitSets[0]] = 0;
+      context.distance[rootIndex] = 0;
+    }
 
 //
 // Optimize SPF calculation, for ns-3.
@@ -1376,10 +2177,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (context.checkStub && CheckForStubNode (context))
     {
-      NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
-      delete m_spfroot;
+      NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << context.rootId);
+      context.stub = true;
+      delete context.root;
+      context.root = 0;
       return;
     }
 
@@ -1399,7 +2202,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // shortest path).  If the new vertices represent shorter paths, we use them
 // and update the path cost.
 //
-      SPFNext (v, candidate);
+      SPFNext (context, v, candidate);
 //
 // RFC2328 16.1. (3). 
 //
@@ -1427,7 +2230,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      int32_t index = m_lsdb->GetLSAIndex (v->GetVertexId ());
+      context.status[index] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
+      context.candidates[index] = 0;
+      if (context.record)
+        {
+          RecordVertex (context, index, v);
+        }
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1443,12 +2252,9 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
-// tree.
+// This is the method that actually adds the routes.  We are only actually
+// adding routes to the node at the root of the SPF tree; they are recorded
+// in the context and installed once the calculation is done.
 //
 // We're going to pop of a pointer to every vertex in the tree except the 
 // root in order of distance from the root.  For each of the vertices, we call
@@ -1466,11 +2272,11 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
       if (v->GetVertexType () == SPFVertex::VertexRouter)
         {
-          SPFIntraAddRouter (v);
+          SPFIntraAddRouter (context, v);
         }
       else if (v->GetVertexType () == SPFVertex::VertexNetwork)
         {
-          SPFIntraAddTransit (v);
+          SPFIntraAddTransit (context, v);
         }
       else
         {
@@ -1485,26 +2291,51 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
     }  // end for loop
 
 // Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
+  SPFProcessStubs (context, context.root);
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
     {
-      m_spfroot->ClearVertexProcessed ();
+      context.root->ClearVertexProcessed ();
       GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
       NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      ProcessASExternals (context, context.root, extlsa);
     }
 
 //
-// We're all done setting the routing information for the node at the root of
-// the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-// possibly do it again for the next router.
+// We're all done computing the routing information for the node at the root
+// of the SPF tree.  Delete all of the vertices and corresponding resources.
 //
-  delete m_spfroot;
-  m_spfroot = 0;
+  delete context.root;
+  context.root = 0;
+  std::vector<GlobalRoutingLSA::SPFStatus> ().swap (context.status);
+  std::vector<SPFVertex *> ().swap (context.candidates);
+  context.exitSetIds.clear ();
 }
 
 void
-GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa)
+GlobalRouteManagerImpl::RecordVertex (SPFContext& context, uint32_t index, SPFVertex* v)
+{
+  NS_LOG_FUNCTION (this << index << v);
+//
+// The vertices share a few distinct sets of exits, those of the neighbours
+// of the root and their combinations, so only keep each set once.
+//
+  std::vector<SPFVertex::NodeExit_t> exits;
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      exits.push_back (v->GetRootExitDirection (i));
+    }
+  std::pair<std::map<std::vector<SPFVertex::NodeExit_t>, uint32_t>::iterator, bool> found =
+    context.exitSetIds.insert (std::make_pair (exits, context.exitSets.size ()));
+  if (found.second)
+    {
+      context.exitSets.push_back (exits);
+    }
+  context.distance[index] = v->GetDistanceFromRoot ();
+  context.exits[index] = found.first->second;
+}
+
+void
+GlobalRouteManagerImpl::ProcessASExternals (SPFContext& context, SPFVertex* v, GlobalRoutingLSA* extlsa)
 {
   NS_LOG_FUNCTION (this << v << extlsa);
   NS_LOG_LOGIC ("Processing external for destination " << 
@@ -1518,7 +2349,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if ((rlsa->GetLinkStateId ()) == (extlsa->GetAdvertisingRouter ()))
         {
           NS_LOG_LOGIC ("Found advertising router to destination");
-          SPFAddASExternal (extlsa,v);
+          SPFAddASExternal (context, extlsa, v);
         }
     }
   for (uint32_t i = 0; i < v->GetNChildren (); i++)
@@ -1526,7 +2357,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
           NS_LOG_LOGIC ("Vertex's child " << i << " not yet processed, processing...");
-          ProcessASExternals (v->GetChild (i), extlsa);
+          ProcessASExternals (context, v->GetChild (i), extlsa);
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1538,15 +2369,15 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
 //
 
 void
-GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v)
+GlobalRouteManagerImpl::SPFAddASExternal (SPFContext& context, GlobalRoutingLSA *extlsa, SPFVertex *v)
 {
   NS_LOG_FUNCTION (this << extlsa << v);
 
-  NS_ASSERT_MSG (m_spfroot, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
+  NS_ASSERT_MSG (context.root, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
 // Two cases to consider: We are advertising the external ourselves
 // => No need to add anything
 // OR find best path to the advertising router
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == context.root->GetVertexId ())
     {
       NS_LOG_LOGIC ("External is on local host: " 
                     << v->GetVertexId () << "; returning");
@@ -1554,110 +2385,42 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
     }
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
-
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  NS_LOG_LOGIC ("Vertex ID = " << context.rootId);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+
+//
+// We're going to add a route to the external network through the router
+// represented by the vertex <v>, using the next hops and outbound interfaces
+// of the root which have been precalculated for <v>.
+//
+// walk through all next-hop-IPs and out-going-interfaces for reaching
+// the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
+          AddRoute (context, SPFRoute::EXTERNAL, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1665,7 +2428,7 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
 void
-GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
+GlobalRouteManagerImpl::SPFProcessStubs (SPFContext& context, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
   NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
@@ -1682,7 +2445,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
           if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
             {
               NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              SPFIntraAddStub (l, v);
+              SPFIntraAddStub (context, l, v);
               continue;
             }
         }
@@ -1691,7 +2454,7 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
     {
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
-          SPFProcessStubs (v->GetChild (i));
+          SPFProcessStubs (context, v->GetChild (i));
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1699,11 +2462,11 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
 
 // RFC2328 16.1. second stage. 
 void
-GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddStub (SPFContext& context, GlobalRoutingLinkRecord *l, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << l << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (context.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddStub (): Root pointer not set");
 
   // XXX simplifed logic for the moment.  There are two cases to consider:
@@ -1711,7 +2474,7 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   //    (already handled above)
   // 2) the stub network is on a remote router, so I should use the
   // same next hop that I use to get to vertex v
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  if (v->GetVertexId () == context.root->GetVertexId ())
     {
       NS_LOG_LOGIC ("Stub is on local host: " << v->GetVertexId () << "; returning");
       return;
@@ -1720,192 +2483,74 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+// to this router has a vertex ID which is the router ID of that node.
+//
+  NS_LOG_LOGIC ("Vertex ID = " << context.rootId);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// We're going to add a route to the stub network found in the link record
+// of the vertex <v>.  The vertex <v> (corresponding to the node that has
+// this stub network) has an m_nextHop address precalculated for us that is
+// the address to which the root node should send packets to be forwarded to
+// the network.  Similarly, the vertex <v> has an m_rootOif (outbound
+// interface index) to which the packets should be send for forwarding.
+//
+// walk through all next-hop-IPs and out-going-interfaces for reaching
+// the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          AddRoute (context, SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This does what GetInterfaceForPrefix() of the Ipv4 interface of the root
+// node does, on the addresses saved in the context.
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
 int32_t
-GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
+GlobalRouteManagerImpl::FindOutgoingInterfaceId (const SPFContext& context, Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
+// We have an IP address <a> and the addresses of the interfaces of the node
+// at the root of the SPF tree, in the order of the interfaces.  Look for the
+// first one in the same network as <a>.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  for (std::vector<std::pair<uint32_t, Ipv4Address> >::const_iterator i = context.interfaces.begin ();
+       i != context.interfaces.end (); i++)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
+      if (i->second.CombineMask (amask) == a.CombineMask (amask))
         {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+          return i->first;
         }
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find an interface for " << a <<
+                " on root " << context.rootId);
   return -1;
 }
 
@@ -1926,77 +2571,30 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // route.
 //
 void
-GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddRouter (SPFContext& context, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (context.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// to this router has a vertex ID which is the router ID of that node.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  NS_LOG_LOGIC ("Vertex ID = " << context.rootId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2005,18 +2603,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << context.rootId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2030,153 +2628,153 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+// walk through all available exit directions due to ECMP,
+// and add host route for each of the exit direction toward
+// the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              AddRoute (context, SPFRoute::HOST, lr->GetLinkData (), Ipv4Mask::GetOnes (),
+                        nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
+
 void
-GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddTransit (SPFContext& context, SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
+  NS_ASSERT_MSG (context.root, 
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-
-  NS_LOG_LOGIC ("Vertex ID = " << routerId);
+// to this router has a vertex ID which is the router ID of that node.
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+  NS_LOG_LOGIC ("Vertex ID = " << context.rootId);
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to.  The LSA describes the transit network, to which
+// we add a network route.
+//
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-      if (rtr == 0)
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          AddRoute (context, SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << context.rootId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
         }
-    } 
+    }
+}
+
+void
+GlobalRouteManagerImpl::AddRoute (SPFContext& context, SPFRoute::Type type,
+                                  Ipv4Address dest, Ipv4Mask mask,
+                                  Ipv4Address nextHop, uint32_t outIf)
+{
+  SPFRoute route;
+  route.type = type;
+  route.dest = dest;
+  route.mask = mask;
+  route.nextHop = nextHop;
+  route.outIf = outIf;
+  context.routes.push_back (route);
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (const SPFContext& context)
+{
+  NS_LOG_FUNCTION (this << context.rootId);
+  if (!context.routing)
+    {
+      NS_LOG_LOGIC ("No node has the router ID " << context.rootId);
+      return;
+    }
+  for (std::vector<SPFRoute>::const_iterator i = context.routes.begin ();
+       i != context.routes.end (); i++)
+    {
+      InstallRoute (context.routing, *i);
+    }
+}
+
+void
+GlobalRouteManagerImpl::InstallRoute (Ptr<Ipv4GlobalRouting> routing, const SPFRoute& route)
+{
+  switch (route.type)
+    {
+    case SPFRoute::HOST:
+      routing->AddHostRouteTo (route.dest, route.nextHop, route.outIf);
+      break;
+    case SPFRoute::NETWORK:
+      routing->AddNetworkRouteTo (route.dest, route.mask, route.nextHop, route.outIf);
+      break;
+    case SPFRoute::EXTERNAL:
+      routing->AddASExternalRouteTo (route.dest, route.mask, route.nextHop, route.outIf);
+      break;
+    }
+}
+
+bool
+GlobalRouteManagerImpl::SPFRoute::operator< (const SPFRoute &other) const
+{
+  if (type != other.type)
+    {
+      return type < other.type;
+    }
+  if (dest != other.dest)
+    {
+      return dest < other.dest;
+    }
+  if (mask.Get () != other.mask.Get ())
+    {
+      return mask.Get () < other.mask.Get ();
+    }
+  if (nextHop != other.nextHop)
+    {
+      return nextHop < other.nextHop;
+    }
+  return outIf < other.outIf;
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
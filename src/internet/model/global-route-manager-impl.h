@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -37,7 +38,9 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -538,6 +541,10 @@ private:
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
+  uint32_t m_candidateIndex; //!< Position in the heap of the CandidateQueue
+  uint64_t m_candidateOrder; //!< Order in which the vertex entered the CandidateQueue, among ties
+
+  friend class CandidateQueue;
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -641,6 +648,58 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Get the number of Link State Advertisements, other than the
+ * External ones.
+ *
+ * The LSAs are numbered densely in the order they were inserted in, so that
+ * the SPF computations can keep their state in vectors indexed by LSA.
+ *
+ * @returns the number of Link State Advertisements.
+ */
+  uint32_t GetNumLSAs () const;
+
+/**
+ * @brief Get a Link State Advertisement by its index.
+ *
+ * @param index the index of the LSA, less than GetNumLSAs ().
+ * @returns A pointer to the Link State Advertisement.
+ */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+
+/**
+ * @brief Look up the index of the Link State Advertisement associated with
+ * the given link state ID (address).
+ *
+ * @see GetLSA
+ * @param addr The IP address associated with the LSA.
+ * @returns The index of the LSA, or -1 if there is none.
+ */
+  int32_t GetLSAIndex (Ipv4Address addr) const;
+
+/**
+ * @brief Look up the index of the Link State Advertisement which has a
+ * TransitNetwork link record with the given link data.
+ *
+ * @see GetLSAByLinkData
+ * @param addr The IP address of the link data.
+ * @returns The index of the LSA, or -1 if there is none.
+ */
+  int32_t GetLSAIndexByLinkData (Ipv4Address addr) const;
+
+/**
+ * @brief Replace a Link State Advertisement by a new version of it, with
+ * the same link state ID.
+ *
+ * The LSA keeps its index, so that the state which the SPF computations
+ * keep by index remains valid.
+ *
+ * @param index the index of the LSA, less than GetNumLSAs ().
+ * @param lsa the new LSA, which the database takes ownership of.
+ * @returns the old LSA, which the caller must delete.
+ */
+  GlobalRoutingLSA* Replace (uint32_t index, GlobalRoutingLSA* lsa);
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
@@ -676,10 +735,19 @@ public:
 
 
 private:
-  typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
-  typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
+/**
+ * @brief Add the TransitNetwork link records of an LSA to the index by
+ * link data.
+ *
+ * @param index the index of the LSA.
+ */
+  void IndexLinkData (uint32_t index);
 
-  LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  typedef std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisement indices
+
+  std::vector<GlobalRoutingLSA*> m_lsas; //!< Link State Advertisements, by index
+  LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisement indices
+  LSDBMap_t m_linkDataDatabase; //!< database of TransitNetwork link data / Link State Advertisement indices
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -732,9 +800,33 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The computations rooted at different routers run on the number of threads
+ * given by the \ref GlobalValueGlobalRoutingThreads "GlobalRoutingThreads"
+ * global value; the routes are installed in the order of the node list
+ * whatever the number of threads.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after the state of some interfaces changed.
+ *
+ * Only the routers attached to the links of the given interfaces discover
+ * their LSAs again.  The SPF calculations are run again only for the roots
+ * whose shortest path tree may include a changed link; the other roots get
+ * the routes to the destinations advertised by the changed LSAs updated in
+ * place.  If an LSA appears or disappears (for instance when the designated
+ * router of a broadcast link changes) or a bridge is attached to one of the
+ * links, all the routes are computed again.
+ *
+ * The first call computes all the routes, and from then on the state of the
+ * SPF calculations which the later calls need is kept.
+ *
+ * @param interfaces the interfaces which went up or down, or whose metric
+ * changed, given by their Ipv4 and interface index
+ */
+  virtual void UpdateRoutes (const std::vector<std::pair<Ptr<Ipv4>, uint32_t> > &interfaces);
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @param lsdb the pre-built LSDB
@@ -767,8 +859,200 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
-  SPFVertex* m_spfroot; //!< the root node
+  /**
+   * \brief A route found by an SPF calculation, to be installed in the
+   * routing table of the root.
+   */
+  struct SPFRoute
+  {
+    /// The kind of route
+    enum Type
+    {
+      HOST,     //!< Installed with Ipv4GlobalRouting::AddHostRouteTo
+      NETWORK,  //!< Installed with Ipv4GlobalRouting::AddNetworkRouteTo
+      EXTERNAL  //!< Installed with Ipv4GlobalRouting::AddASExternalRouteTo
+    };
+    Type type;            //!< The kind of route
+    Ipv4Address dest;     //!< The destination
+    Ipv4Mask mask;        //!< The destination mask
+    Ipv4Address nextHop;  //!< The next hop
+    uint32_t outIf;       //!< The outgoing interface
+
+    /**
+     * \param other the route to compare with
+     * \returns true if this route sorts before \pname{other}
+     */
+    bool operator< (const SPFRoute &other) const;
+  };
+
+  struct SPFContext;
+
+  /**
+   * \brief What UpdateRoutes needs to know of the last SPF calculation
+   * rooted at a router.
+   */
+  struct SPFResult
+  {
+    Ipv4Address rootId;              //!< The router ID of the root
+    Ptr<Node> node;                  //!< The node of the root
+    bool stub;                       //!< Whether the root only got a default route
+    std::vector<uint32_t> distance;  //!< The distance of each LSA from the root, by LSDB index
+    std::vector<uint32_t> exits;     //!< The exits towards each LSA, by LSDB index, as an index in exitSets
+    std::vector<std::vector<SPFVertex::NodeExit_t> > exitSets;  //!< The distinct sets of exits of the root
+  };
+
+  /// An edge of the graph of the SPF calculations: the LSDB index of its head and its metric
+  typedef std::pair<uint32_t, uint32_t> SPFEdge;
+
+  /// Number of SPF calculations given to each thread at a time
+  static const uint32_t SPF_BATCH_PER_THREAD = 16;
+
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_keepResults;             //!< Whether InitializeRoutes keeps the results of its calculations
+  bool m_resultsValid;            //!< Whether m_results matches the LSDB and the routing tables
+  std::vector<SPFResult> m_results; //!< The results of the last calculations, by root
+
+  /**
+   * \brief Compute all the routes again and keep the results of the SPF
+   * calculations from now on.
+   */
+  void RecomputeAllRoutes (void);
+
+  /**
+   * \brief Run the SPF calculations rooted at some routers and install
+   * their routes.
+   *
+   * \param roots the nodes of the roots
+   * \param results where to save the result of the calculation of each
+   * root in m_results, or empty not to save them
+   */
+  void CalculateRoutes (const std::vector<Ptr<Node> > &roots, const std::vector<uint32_t> &results);
+
+  /**
+   * \brief Discover again the LSAs of some routers and compare them with
+   * those of the LSDB.
+   *
+   * \param routers the routers
+   * \param changed the LSDB indices of the LSAs which changed
+   * \param lsas the new versions of the LSAs which changed
+   * \returns false if the set of LSAs itself changed, in which case
+   * \pname{changed} and \pname{lsas} are left empty
+   */
+  bool DiscoverChangedLSAs (const std::vector<Ptr<GlobalRouter> > &routers,
+                            std::vector<uint32_t> &changed,
+                            std::vector<GlobalRoutingLSA*> &lsas);
+
+  /**
+   * \param a an LSA
+   * \param b another LSA
+   * \returns true if both LSAs advertise the same links
+   */
+  static bool IsSameLSA (GlobalRoutingLSA* a, GlobalRoutingLSA* b);
+
+  /**
+   * \brief Get the edges which SPFNext follows from an LSA.
+   *
+   * \param index the LSDB index of the LSA
+   * \param edges the edges, sorted
+   */
+  void GetEdges (uint32_t index, std::vector<SPFEdge>& edges) const;
+
+  /**
+   * \brief Get the routes to the destinations advertised by an LSA.
+   *
+   * These are the routes which SPFIntraAddRouter, SPFIntraAddTransit and
+   * SPFIntraAddStub add for the vertex of the LSA.
+   *
+   * \param lsa the LSA
+   * \param exits the exits of the root towards the vertex of the LSA
+   * \param routes the vector to which the routes are appended
+   */
+  static void GetLSARoutes (GlobalRoutingLSA* lsa, const std::vector<SPFVertex::NodeExit_t>& exits,
+                            std::vector<SPFRoute>& routes);
+
+  /**
+   * \brief Update in place the routes of a root whose shortest path tree
+   * did not change, to the destinations advertised by the changed LSAs.
+   *
+   * The routes added are appended to the routing table, while the SPF
+   * calculation would have inserted them after the routes to the vertices
+   * closer to the root.  Since the routing table picks the first route
+   * which matches, this is only done if no other route matches any of
+   * the destinations of an added route: neither the equal-cost routes to
+   * the same destination, nor routes to overlapping prefixes.
+   *
+   * \param routing the routing table of the root
+   * \param result the result of the last calculation rooted there
+   * \param rootIndex the LSDB index of the root
+   * \param changed the LSDB indices of the LSAs which changed
+   * \param oldLSAs the old versions of the LSAs which changed
+   * \param lsas the new versions of the LSAs which changed
+   * \returns false if the routes can not be updated in place, in which case
+   * they must be computed again
+   */
+  static bool PatchRoutes (Ptr<Ipv4GlobalRouting> routing, const SPFResult& result, uint32_t rootIndex,
+                           const std::vector<uint32_t>& changed,
+                           const std::vector<GlobalRoutingLSA*>& oldLSAs,
+                           const std::vector<GlobalRoutingLSA*>& lsas);
+
+  /**
+   * \brief Save the distance and the exits of a vertex added to the SPF tree.
+   *
+   * \param context the context of the calculation
+   * \param index the LSDB index of the vertex
+   * \param v the vertex
+   */
+  void RecordVertex (SPFContext& context, uint32_t index, SPFVertex* v);
+
+  /**
+   * \brief Get the number of threads running the SPF calculations.
+   *
+   * \returns the value of the GlobalRoutingThreads global value, or the
+   * number of hardware threads if it is 0, or 1 if the logging of the global
+   * routing is enabled
+   */
+  uint32_t GetNThreads (void) const;
+
+  /**
+   * \brief Prepare the context of an SPF calculation.
+   *
+   * This saves what the calculation needs to know about the root node, so
+   * that it does not access the node itself.
+   *
+   * \param context the context
+   * \param root the router ID of the root
+   * \param node the node of the root, or 0 if there is none
+   */
+  void InitializeContext (SPFContext& context, Ipv4Address root, Ptr<Node> node);
+
+  /**
+   * \brief Install the routes found by an SPF calculation in the routing
+   * table of the root.
+   *
+   * \param context the context of the calculation
+   */
+  void InstallRoutes (const SPFContext& context);
+
+  /**
+   * \brief Install a route in a routing table.
+   *
+   * \param routing the routing table
+   * \param route the route
+   */
+  static void InstallRoute (Ptr<Ipv4GlobalRouting> routing, const SPFRoute& route);
+
+  /**
+   * \brief Record a route to install in the routing table of the root.
+   *
+   * \param context the context of the calculation
+   * \param type the kind of route
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param nextHop the next hop
+   * \param outIf the outgoing interface
+   */
+  void AddRoute (SPFContext& context, SPFRoute::Type type, Ipv4Address dest, Ipv4Mask mask,
+                 Ipv4Address nextHop, uint32_t outIf);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -777,19 +1061,28 @@ private:
    * can safely be added to the next-hop router and SPF does not need
    * to be run
    *
-   * \param root the root node
+   * \param context the context of the calculation
    * \returns true if the node is a stub
    */
-  bool CheckForStubNode (Ipv4Address root);
+  bool CheckForStubNode (SPFContext& context);
 
   /**
    * \brief Calculate the shortest path first (SPF) tree
    *
-   * Equivalent to quagga ospf_spf_calculate
+   * Find the root node, run the calculation and install its routes.
    * \param root the root node
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Calculate the shortest path first (SPF) tree
+   *
+   * Equivalent to quagga ospf_spf_calculate
+   * \param context the context of the calculation, where the routes are
+   * recorded
+   */
+  void SPFCalculate (SPFContext& context);
+
   /**
    * \brief Process Stub nodes
    *
@@ -797,17 +1090,19 @@ private:
    * stub link records will exist for point-to-point interfaces and for
    * broadcast interfaces for which no neighboring router can be found
    *
+   * \param context the context of the calculation
    * \param v vertex to be processed
    */
-  void SPFProcessStubs (SPFVertex* v);
+  void SPFProcessStubs (SPFContext& context, SPFVertex* v);
 
   /**
    * \brief Process Autonomous Systems (AS) External LSA
    *
+   * \param context the context of the calculation
    * \param v vertex to be processed
    * \param extlsa external LSA
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void ProcessASExternals (SPFContext& context, SPFVertex* v, GlobalRoutingLSA* extlsa);
 
   /**
    * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -827,10 +1122,11 @@ private:
    * vertices not already on the list.  If a lower-cost path is found to a
    * vertex already on the candidate list, store the new (lower) cost.
    *
+   * \param context the context of the calculation
    * \param v the vertex
    * \param candidate the SPF candidate queue
    */
-  void SPFNext (SPFVertex* v, CandidateQueue& candidate);
+  void SPFNext (SPFContext& context, SPFVertex* v, CandidateQueue& candidate);
 
   /**
    * \brief Calculate nexthop from root through V (parent) to vertex W (destination)
@@ -839,13 +1135,14 @@ private:
    * This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
    * For now, this is greatly simplified from the quagga code
    *
+   * \param context the context of the calculation
    * \param v the parent
    * \param w the destination
    * \param l the link record
    * \param distance the target distance
    * \returns 1 on success
    */
-  int SPFNexthopCalculation (SPFVertex* v, SPFVertex* w, 
+  int SPFNexthopCalculation (SPFContext& context, SPFVertex* v, SPFVertex* w, 
                              GlobalRoutingLinkRecord* l, uint32_t distance);
 
   /**
@@ -905,47 +1202,52 @@ private:
    * a destination IP address, reachable from the root, to which we add a host
    * route.
    *
+   * \param context the context of the calculation
    * \param v the vertex
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (SPFContext& context, SPFVertex* v);
 
   /**
    * \brief Add a transit to the routing tables
    *
+   * \param context the context of the calculation
    * \param v the vertex
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (SPFContext& context, SPFVertex* v);
 
   /**
    * \brief Add a stub to the routing tables
    *
+   * \param context the context of the calculation
    * \param l the global routing link record
    * \param v the vertex
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (SPFContext& context, GlobalRoutingLinkRecord *l, SPFVertex* v);
 
   /**
    * \brief Add an external route to the routing tables
    *
+   * \param context the context of the calculation
    * \param extlsa the external LSA
    * \param v the vertex
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  void SPFAddASExternal (SPFContext& context, GlobalRoutingLSA *extlsa, SPFVertex *v);
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
+   * This does what GetInterfaceForPrefix() of the Ipv4 interface of the
+   * root node does, on the addresses saved in the context.
    * If no such interface is found, return -1 (note:  unit test framework
    * for routing assumes -1 to be a legal return value)
    *
+   * \param context the context of the calculation
    * \param a the target IP address
    * \param amask the target subnet mask
    * \return the outgoing interface number
    */
-  int32_t FindOutgoingInterfaceId (Ipv4Address a, 
+  int32_t FindOutgoingInterfaceId (const SPFContext& context, Ipv4Address a, 
                                    Ipv4Mask amask = Ipv4Mask ("255.255.255.255"));
 };
 
@@ -58,6 +58,14 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::UpdateRoutes (const std::vector<std::pair<Ptr<Ipv4>, uint32_t> > &interfaces)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  UpdateRoutes (interfaces);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
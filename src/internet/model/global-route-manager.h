@@ -22,8 +22,15 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "ns3/ptr.h"
+
 namespace ns3 {
 
+class Ipv4;
+
 /**
  * \ingroup globalrouting
  *
@@ -65,6 +72,14 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after the state of some interfaces changed,
+ * only recomputing the shortest paths which may go through their links.
+ *
+ * @param interfaces the interfaces, given by their Ipv4 and interface index
+ */
+  static void UpdateRoutes (const std::vector<std::pair<Ptr<Ipv4>, uint32_t> > &interfaces);
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
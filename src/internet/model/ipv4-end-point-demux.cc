@@ -17,17 +17,33 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
-
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+bool
+Ipv4EndPointDemux::Key::operator== (const Key &other) const
+{
+  return localAddress == other.localAddress && localPort == other.localPort
+         && peerAddress == other.peerAddress && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv4EndPointDemux::KeyHash::operator() (const Key &key) const
+{
+  uint64_t local = (static_cast<uint64_t> (key.localAddress.Get ()) << 16) | key.localPort;
+  uint64_t peer = (static_cast<uint64_t> (key.peerAddress.Get ()) << 16) | key.peerPort;
+  uint64_t hash = local * 0x9e3779b97f4a7c15ULL + peer;
+  return hash ^ (hash >> 29);
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
   : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
 {
@@ -37,9 +53,12 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
+  m_connected.clear ();
+  m_listeners.clear ();
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
@@ -49,20 +68,17 @@ bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       if ((*i)->GetLocalPort () == port &&
@@ -86,7 +102,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -102,7 +118,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -125,7 +141,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,13 +152,11 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Key key = { localAddress, peerAddress, localPort, peerPort };
+  std::pair<EndPointTable::iterator, EndPointTable::iterator> range = GetTable (key).equal_range (key);
+  for (EndPointTable::iterator i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      if (i->second->GetBoundNetDevice () == boundNetDevice || i->second->GetBoundNetDevice () == 0)
         {
           NS_LOG_WARN ("Duplicated endpoint.");
           return 0;
@@ -150,7 +164,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -161,15 +175,71 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (endPoint->m_demux != this)
+    {
+      return;
+    }
+  Unindex (endPoint);
+  m_endPoints.erase (endPoint->m_position);
+  endPoint->m_demux = 0;
+  delete endPoint;
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key = { endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+              endPoint->GetLocalPort (), endPoint->GetPeerPort () };
+  GetTable (key).insert (std::make_pair (key, endPoint));
+  if (m_localPorts[key.localPort]++ == 0)
+    {
+      SetEphemeralPortUsed (key.localPort, true);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key = { endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+              endPoint->GetLocalPort (), endPoint->GetPeerPort () };
+  EndPointTable &table = GetTable (key);
+  std::pair<EndPointTable::iterator, EndPointTable::iterator> range = table.equal_range (key);
+  for (EndPointTable::iterator i = range.first; i != range.second; i++)
     {
-      if (*i == endPoint)
+      if (i->second == endPoint)
         {
-          delete endPoint;
-          m_endPoints.erase (i);
+          table.erase (i);
           break;
         }
     }
+  PortMap::iterator port = m_localPorts.find (key.localPort);
+  NS_ASSERT (port != m_localPorts.end ());
+  if (--port->second == 0)
+    {
+      m_localPorts.erase (port);
+      SetEphemeralPortUsed (key.localPort, false);
+    }
+}
+
+Ipv4EndPointDemux::EndPointTable &
+Ipv4EndPointDemux::GetTable (const Key &key)
+{
+  if (key.peerAddress == Ipv4Address::GetAny () && key.peerPort == 0)
+    {
+      return m_listeners;
+    }
+  return m_connected;
 }
 
 /*
@@ -201,138 +271,84 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
                            Ptr<Ipv4Interface> incomingInterface)
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-  
-  EndPoints retval1; // Matches exact on local port, wildcards on others
-  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-  EndPoints retval3; // Matches all but local address
-  EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
 
-      if (!endP->IsRxEnabled ())
+  // The local addresses which match the destination address as wildcards:
+  // 1) Local endpoint bound to Any -> matches anything
+  // 2) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  std::vector<Ipv4Address> wildcards (1, Ipv4Address::GetAny ());
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+      if (addrNetpart != daddr && addrNetpart == daddr.CombineMask (addr.GetMask ())
+          && std::find (wildcards.begin (), wildcards.end (), addrNetpart) == wildcards.end ())
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
-          continue;
+          NS_LOG_LOGIC ("Looking for SubnetDirectedAny endpoints " << addrNetpart << "/" << addr.GetMask ().GetPrefixLength ());
+          wildcards.push_back (addrNetpart);
         }
+    }
 
-      if (endP->GetLocalPort () != dport) 
+  // Here we find the most exact match
+  EndPoints retval;
+  // Exact match on all 4 - this is the case of an open TCP connection, for example.
+  Find (daddr, dport, saddr, sport, incomingInterface, retval);
+  // All but local address - no idea what this case could be.
+  // The endpoints of all the wildcards match with the same precedence.
+  if (retval.empty ())
+    {
+      for (uint32_t i = 0; i < wildcards.size (); i++)
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
+          Find (wildcards[i], dport, saddr, sport, incomingInterface, retval);
         }
-      if (endP->GetBoundNetDevice ())
+    }
+  // Only local port and local address matches exactly - Not yet opened connection
+  if (retval.empty ())
+    {
+      Find (daddr, dport, Ipv4Address::GetAny (), 0, incomingInterface, retval);
+    }
+  // Only local port matches exactly - Endpoint open to "any" connection
+  if (retval.empty ())
+    {
+      for (uint32_t i = 0; i < wildcards.size (); i++)
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
-            {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
-              continue;
-            }
+          Find (wildcards[i], dport, Ipv4Address::GetAny (), 0, incomingInterface, retval);
         }
+    }
 
-      bool localAddressMatchesExact = false;
-      bool localAddressIsAny = false;
-      bool localAddressIsSubnetAny = false;
-
-      // We have 3 cases:
-      // 1) Exact local / destination address match
-      // 2) Local endpoint bound to Any -> matches anything
-      // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  return retval;  // might be empty if no matches
+}
 
-      if (endP->GetLocalAddress () == daddr)
-        {
-          // Case 1:
-          localAddressMatchesExact = true;
-        }
-      else if (endP->GetLocalAddress () == Ipv4Address::GetAny ())
+void
+Ipv4EndPointDemux::Find (Ipv4Address localAddress, uint16_t localPort,
+                         Ipv4Address peerAddress, uint16_t peerPort,
+                         Ptr<Ipv4Interface> incomingInterface, EndPoints &endPoints)
+{
+  NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
+  Key key = { localAddress, peerAddress, localPort, peerPort };
+  std::pair<EndPointTable::iterator, EndPointTable::iterator> range = GetTable (key).equal_range (key);
+  for (EndPointTable::iterator i = range.first; i != range.second; i++)
+    {
+      Ipv4EndPoint* endP = i->second;
+      if (!endP->IsRxEnabled ())
         {
-          // Case 2:
-          localAddressIsAny = true;
+          NS_LOG_LOGIC ("Skipping endpoint " << endP
+                        << " because endpoint can not receive packets");
+          continue;
         }
-      else
+      if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
         {
-          // Case 3:
-          for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-            {
-              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-
-              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
-              if (endP->GetLocalAddress () == addrNetpart)
-                {
-                  NS_LOG_LOGIC ("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress () << "/" << addr.GetMask ().GetPrefixLength ());
-
-                  Ipv4Address daddrNetPart = daddr.CombineMask (addr.GetMask ());
-                  if (addrNetpart == daddrNetPart)
-                    {
-                      localAddressIsSubnetAny = true;
-                    }
-                }
-            }
-
-          // if no match here, keep looking
-          if (!localAddressIsSubnetAny)
-            continue;
-        }
-
-      bool remotePortMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
-
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
-
-      bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
-
-      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval4.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-          NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-          NS_LOG_LOGIC ("Found an endpoint for case 2, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-          NS_LOG_LOGIC ("Found an endpoint for case 1, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval1.push_back (endP);
+          NS_LOG_LOGIC ("Skipping endpoint " << endP
+                                             << " because endpoint is bound to specific device and"
+                                             << endP->GetBoundNetDevice ()
+                                             << " does not match packet device " << incomingInterface->GetDevice ());
+          continue;
         }
+      NS_LOG_LOGIC ("Found an endpoint, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+      endPoints.push_back (endP);
     }
-
-  // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
-  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
-  return retval;  // might be empty if no matches
 }
 
 Ipv4EndPoint *
@@ -343,6 +359,19 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  Key key = { daddr, saddr, dport, sport };
+  EndPointTable &table = GetTable (key);
+  EndPointTable::iterator exact = table.find (key);
+  if (exact != table.end ())
+    {
+      /* this is an exact match. */
+      return exact->second;
+    }
+  if (!LookupPortLocal (dport))
+    {
+      return 0;
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
@@ -353,13 +382,6 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
         {
           continue;
         }
-      if ((*i)->GetLocalAddress () == daddr &&
-          (*i)->GetPeerPort () == sport &&
-          (*i)->GetPeerAddress () == saddr) 
-        {
-          /* this is an exact match. */
-          return *i;
-        }
       uint32_t tmp = 0;
       if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
@@ -377,28 +399,78 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
     }
   return generic;
 }
+
+void
+Ipv4EndPointDemux::SetEphemeralPortUsed (uint16_t port, bool used)
+{
+  if (m_ephemeralPorts.empty () || port < m_portFirst || port > m_portLast)
+    {
+      return;
+    }
+  uint32_t bit = port - m_portFirst;
+  if (used)
+    {
+      m_ephemeralPorts[bit / 64] |= static_cast<uint64_t> (1) << (bit % 64);
+    }
+  else
+    {
+      m_ephemeralPorts[bit / 64] &= ~(static_cast<uint64_t> (1) << (bit % 64));
+    }
+}
+
 uint16_t
-Ipv4EndPointDemux::AllocateEphemeralPort (void)
+Ipv4EndPointDemux::FindFreeEphemeralPort (uint32_t first, uint32_t last) const
 {
-  // Similar to counting up logic in netinet/in_pcb.c
-  NS_LOG_FUNCTION (this);
-  uint16_t port = m_ephemeral;
-  int count = m_portLast - m_portFirst;
-  do 
+  uint32_t port = first;
+  while (port <= last)
     {
-      if (count-- < 0)
+      uint32_t bit = port - m_portFirst;
+      uint64_t word = m_ephemeralPorts[bit / 64] >> (bit % 64);
+      if (word == ~static_cast<uint64_t> (0) >> (bit % 64))
         {
-          return 0;
+          // The rest of the word is in use
+          port += 64 - bit % 64;
+          continue;
         }
-      ++port;
-      if (port < m_portFirst || port > m_portLast)
+      if ((word & 1) == 0)
         {
-          port = m_portFirst;
+          return port;
         }
-    } while (LookupPortLocal (port));
+      port++;
+    }
+  return 0;
+}
+
+uint16_t
+Ipv4EndPointDemux::AllocateEphemeralPort (void)
+{
+  // Similar to counting up logic in netinet/in_pcb.c: the first free port
+  // after the last one allocated, wrapping around.
+  NS_LOG_FUNCTION (this);
+  if (m_ephemeralPorts.empty ())
+    {
+      m_ephemeralPorts.assign ((m_portLast - m_portFirst) / 64 + 1, 0);
+      for (PortMap::const_iterator i = m_localPorts.begin (); i != m_localPorts.end (); i++)
+        {
+          SetEphemeralPortUsed (i->first, true);
+        }
+    }
+  uint32_t start = m_ephemeral + 1;
+  if (start < m_portFirst || start > m_portLast)
+    {
+      start = m_portFirst;
+    }
+  uint16_t port = FindFreeEphemeralPort (start, m_portLast);
+  if (port == 0)
+    {
+      port = FindFreeEphemeralPort (m_portFirst, start - 1);
+    }
+  if (port == 0)
+    {
+      return 0;
+    }
   m_ephemeral = port;
   return port;
 }
 
 } // namespace ns3
-
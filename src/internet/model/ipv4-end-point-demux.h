@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,13 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are also indexed by their four-tuple in hash tables, one
+ * for the endpoints with a peer and one for the listeners, whose peer is a
+ * wildcard, so that Lookup() costs a few probes whatever the number of
+ * connections.  The endpoints tell their demux when their four-tuple
+ * changes.  A bitmap of the ephemeral ports in use lets
+ * AllocateEphemeralPort() find a free port without looking up each port.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +175,95 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple of an endpoint, as a key of the endpoint tables.
+   */
+  struct Key
+  {
+    Ipv4Address localAddress; //!< The local address
+    Ipv4Address peerAddress;  //!< The peer address
+    uint16_t localPort;       //!< The local port
+    uint16_t peerPort;        //!< The peer port
+
+    /**
+     * \param other the key to compare with
+     * \returns true if both keys are equal
+     */
+    bool operator== (const Key &other) const;
+  };
+
+  /**
+   * \brief Hash function of the keys of the endpoint tables.
+   */
+  struct KeyHash
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    std::size_t operator() (const Key &key) const;
+  };
+
+  /// Endpoints by four-tuple
+  typedef std::unordered_multimap<Key, Ipv4EndPoint *, KeyHash> EndPointTable;
+  /// Number of endpoints by local port
+  typedef std::unordered_map<uint16_t, uint32_t> PortMap;
+
+  /**
+   * \brief Add an endpoint to the list and the tables.
+   * \param endPoint the endpoint
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the tables, under its current four-tuple.
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the tables, before its four-tuple changes.
+   * \param endPoint the endpoint
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Find the endpoints with a four-tuple which can receive a packet.
+   * \param localAddress the local address
+   * \param localPort the local port
+   * \param peerAddress the peer address
+   * \param peerPort the peer port
+   * \param incomingInterface the interface which received the packet
+   * \param endPoints the list to which the endpoints are appended
+   */
+  void Find (Ipv4Address localAddress, uint16_t localPort,
+             Ipv4Address peerAddress, uint16_t peerPort,
+             Ptr<Ipv4Interface> incomingInterface, EndPoints &endPoints);
+
+  /**
+   * \brief Get the table of the endpoints with a four-tuple.
+   * \param key the four-tuple
+   * \returns the listener table if the peer is a wildcard, the table of
+   * the endpoints with a peer otherwise
+   */
+  EndPointTable &GetTable (const Key &key);
+
+  /**
+   * \brief Mark a port of the ephemeral range as used or free.
+   * \param port the port
+   * \param used whether the port is used
+   */
+  void SetEphemeralPortUsed (uint16_t port, bool used);
+
+  /**
+   * \brief Find a free port in a part of the ephemeral range.
+   * \param first the first port to consider
+   * \param last the last port to consider
+   * \returns the first free port from first to last, or 0
+   */
+  uint16_t FindFreeEphemeralPort (uint32_t first, uint32_t last) const;
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +290,27 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points with a peer, by four-tuple.
+   */
+  EndPointTable m_connected;
+
+  /**
+   * \brief The end points without a peer, by local address and port.
+   */
+  EndPointTable m_listeners;
+
+  /**
+   * \brief The number of end points of each local port in use.
+   */
+  PortMap m_localPorts;
+
+  /**
+   * \brief A bit for each port of the ephemeral range, set if the port is
+   * used; empty until the first ephemeral port allocation.
+   */
+  std::vector<uint64_t> m_ephemeralPorts;
 };
 
 } // namespace ns3
@@ -59,7 +59,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +81,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteIndex, --m_hostRoutes.end ());
 }
 
 void 
@@ -90,6 +92,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteIndex, --m_hostRoutes.end ());
 }
 
 void 
@@ -105,6 +108,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteIndex, --m_networkRoutes.end ());
 }
 
 void 
@@ -118,6 +122,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteIndex, --m_networkRoutes.end ());
 }
 
 void 
@@ -133,8 +138,98 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalRouteIndex, --m_ASexternalRoutes.end ());
 }
 
+void
+Ipv4GlobalRouting::IndexRoute (RouteIndex &index, RouteI route)
+{
+  uint8_t network[4];
+  uint8_t mask[4];
+  (*route)->GetDestNetwork ().Serialize (network);
+  Ipv4Address ((*route)->GetDestNetworkMask ().Get ()).Serialize (mask);
+  index.Insert (network, RouteIndex::GetPrefixLength (mask), route);
+  m_generation++;
+}
+
+void
+Ipv4GlobalRouting::UnindexRoute (RouteIndex &index, RouteI route)
+{
+  uint8_t network[4];
+  uint8_t mask[4];
+  (*route)->GetDestNetwork ().Serialize (network);
+  Ipv4Address ((*route)->GetDestNetworkMask ().Get ()).Serialize (mask);
+  [[maybe_unused]] bool found = index.Remove (network, RouteIndex::GetPrefixLength (mask), route);
+  NS_ASSERT (found);
+  m_generation++;
+}
+
+bool
+Ipv4GlobalRouting::RemoveMatchingRoute (std::list<Ipv4RoutingTableEntry *> &routes, RouteIndex &index,
+                                        Ipv4Address network, Ipv4Mask networkMask,
+                                        Ipv4Address nextHop, uint32_t interface)
+{
+  uint8_t networkBytes[4];
+  network.Serialize (networkBytes);
+  std::vector<RouteI> candidates;
+  index.Lookup (networkBytes, candidates);
+  for (std::vector<RouteI>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      Ipv4RoutingTableEntry *route = **i;
+      if (route->GetDestNetwork () == network
+          && route->GetDestNetworkMask () == networkMask
+          && route->GetGateway () == nextHop
+          && route->GetInterface () == interface)
+        {
+          UnindexRoute (index, *i);
+          delete route;
+          routes.erase (*i);
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+Ipv4GlobalRouting::RemoveHostRouteTo (Ipv4Address dest,
+                                      Ipv4Address nextHop,
+                                      uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << dest << nextHop << interface);
+  return RemoveMatchingRoute (m_hostRoutes, m_hostRouteIndex,
+                              dest, Ipv4Mask::GetOnes (), nextHop, interface);
+}
+
+bool
+Ipv4GlobalRouting::RemoveNetworkRouteTo (Ipv4Address network,
+                                         Ipv4Mask networkMask,
+                                         Ipv4Address nextHop,
+                                         uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << network << networkMask << nextHop << interface);
+  return RemoveMatchingRoute (m_networkRoutes, m_networkRouteIndex,
+                              network, networkMask, nextHop, interface);
+}
+
+bool
+Ipv4GlobalRouting::HasHostRouteTo (Ipv4Address dest) const
+{
+  NS_LOG_FUNCTION (this << dest);
+  uint8_t destBytes[4];
+  dest.Serialize (destBytes);
+  return m_hostRouteIndex.HasOverlap (destBytes, 32);
+}
+
+bool
+Ipv4GlobalRouting::HasOverlappingNetworkRoute (Ipv4Address network, Ipv4Mask networkMask) const
+{
+  NS_LOG_FUNCTION (this << network << networkMask);
+  uint8_t networkBytes[4];
+  uint8_t maskBytes[4];
+  network.Serialize (networkBytes);
+  Ipv4Address (networkMask.Get ()).Serialize (maskBytes);
+  return m_networkRouteIndex.HasOverlap (networkBytes, RouteIndex::GetPrefixLength (maskBytes));
+}
 
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
@@ -145,71 +240,80 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   // store all available routes that bring packets to their destination
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
+  // the routes whose prefix matches dest, in table order
+  std::vector<RouteI> candidates;
+  uint8_t destBytes[4];
+  dest.Serialize (destBytes);
 
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
+  m_hostRouteIndex.Lookup (destBytes, candidates);
+  for (std::vector<RouteI>::const_iterator i = candidates.begin (); 
+       i != candidates.end (); 
        i++) 
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == dest)
+      NS_ASSERT ((**i)->IsHost ());
+      if ((**i)->GetDest () == dest)
         {
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice ((**i)->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (**i);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << **i); 
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
+      candidates.clear ();
+      m_networkRouteIndex.Lookup (destBytes, candidates);
+      for (std::vector<RouteI>::const_iterator j = candidates.begin (); 
+           j != candidates.end (); 
            j++) 
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
+          Ipv4Mask mask = (**j)->GetDestNetworkMask ();
+          Ipv4Address entry = (**j)->GetDestNetwork ();
           if (mask.IsMatch (dest, entry)) 
             {
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice ((**j)->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              allRoutes.push_back (**j);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << **j);
             }
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
+      candidates.clear ();
+      m_ASexternalRouteIndex.Lookup (destBytes, candidates);
+      for (std::vector<RouteI>::const_iterator k = candidates.begin ();
+           k != candidates.end ();
            k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
+          Ipv4Mask mask = (**k)->GetDestNetworkMask ();
+          Ipv4Address entry = (**k)->GetDestNetwork ();
           if (mask.IsMatch (dest, entry))
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
+              NS_LOG_LOGIC ("Found external route" << **k);
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice ((**k)->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              allRoutes.push_back (**k);
               break;
             }
         }
@@ -319,6 +423,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              UnindexRoute (m_hostRouteIndex, i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +441,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexRoute (m_networkRouteIndex, j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +458,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexRoute (m_ASexternalRouteIndex, k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +499,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteIndex.Clear ();
+  m_networkRouteIndex.Clear ();
+  m_ASexternalRouteIndex.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -542,11 +652,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_generation++;
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes (std::vector<std::pair<Ptr<Ipv4>, uint32_t> > (1, std::make_pair (m_ipv4, i)));
     }
 }
 
@@ -554,11 +663,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_generation++;
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes (std::vector<std::pair<Ptr<Ipv4>, uint32_t> > (1, std::make_pair (m_ipv4, i)));
     }
 }
 
@@ -566,6 +674,7 @@ void
 Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  m_generation++;
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
       GlobalRouteManager::DeleteGlobalRoutes ();
@@ -578,6 +687,7 @@ void
 Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  m_generation++;
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
       GlobalRouteManager::DeleteGlobalRoutes ();
@@ -586,6 +696,12 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
     }
 }
 
+uint64_t
+Ipv4GlobalRouting::GetRouteGeneration (void) const
+{
+  return m_randomEcmpRouting ? 0 : m_generation;
+}
+
 void 
 Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
 {
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -99,6 +100,15 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  /**
+   * \brief Get the generation of the routes given by RouteOutput
+   *
+   * The routes are not cached when RandomEcmpRouting is set, since each
+   * packet may then take another route.
+   *
+   * \return the generation of the routes, or 0
+   */
+  virtual uint64_t GetRouteGeneration (void) const;
 
   /**
    * \brief Add a host route to the global routing table.
@@ -218,6 +228,58 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove a host route from the global routing table.
+   *
+   * If several routes match, the first one is removed.
+   *
+   * \param dest The Ipv4Address destination of the route.
+   * \param nextHop The Ipv4Address of the next hop of the route.
+   * \param interface The network interface index of the route.
+   * \returns true if a matching route was found and removed
+   */
+  bool RemoveHostRouteTo (Ipv4Address dest,
+                          Ipv4Address nextHop,
+                          uint32_t interface);
+
+  /**
+   * \brief Remove a network route from the global routing table.
+   *
+   * If several routes match, the first one is removed.
+   *
+   * \param network The Ipv4Address network of the route.
+   * \param networkMask The Ipv4Mask of the network.
+   * \param nextHop The next hop of the route.
+   * \param interface The network interface index of the route.
+   * \returns true if a matching route was found and removed
+   */
+  bool RemoveNetworkRouteTo (Ipv4Address network,
+                             Ipv4Mask networkMask,
+                             Ipv4Address nextHop,
+                             uint32_t interface);
+
+  /**
+   * \brief Check for a host route to a destination.
+   *
+   * \param dest The Ipv4Address destination.
+   * \returns true if the table has a host route to \pname{dest}
+   */
+  bool HasHostRouteTo (Ipv4Address dest) const;
+
+  /**
+   * \brief Check for network routes which match some of the addresses of
+   * a network.
+   *
+   * These are the routes whose order with respect to a route to the
+   * network decides which one is used.
+   *
+   * \param network The Ipv4Address network.
+   * \param networkMask The Ipv4Mask of the network.
+   * \returns true if the table has a network route to a prefix which
+   * contains the network or is contained in it
+   */
+  bool HasOverlappingNetworkRoute (Ipv4Address network, Ipv4Mask networkMask) const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -260,6 +322,38 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// position of a route in one of the containers above, which have the same type
+  typedef std::list<Ipv4RoutingTableEntry *>::iterator RouteI;
+  /// index of a container of Ipv4RoutingTableEntry by destination prefix; it
+  /// refers to the routes by position, so that they are removed without a search
+  typedef PrefixTrie<RouteI, 32> RouteIndex;
+
+  /**
+   * \brief Add a route to an index, and change the generation of the routes.
+   * \param index the index of the container of the route
+   * \param route the position of the route in its container
+   */
+  void IndexRoute (RouteIndex &index, RouteI route);
+  /**
+   * \brief Remove a route from an index, and change the generation of the routes.
+   * \param index the index of the container of the route
+   * \param route the position of the route in its container
+   */
+  void UnindexRoute (RouteIndex &index, RouteI route);
+  /**
+   * \brief Remove the first route of a container with the given fields.
+   * \param routes the container
+   * \param index the index of the container
+   * \param network the destination network of the route
+   * \param networkMask the destination mask of the route
+   * \param nextHop the next hop of the route
+   * \param interface the interface of the route
+   * \returns true if a matching route was found and removed
+   */
+  bool RemoveMatchingRoute (std::list<Ipv4RoutingTableEntry *> &routes, RouteIndex &index,
+                            Ipv4Address network, Ipv4Mask networkMask,
+                            Ipv4Address nextHop, uint32_t interface);
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -272,7 +366,12 @@ private:
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  RouteIndex m_hostRouteIndex;         //!< Index of m_hostRoutes
+  RouteIndex m_networkRouteIndex;      //!< Index of m_networkRoutes
+  RouteIndex m_ASexternalRouteIndex;   //!< Index of m_ASexternalRoutes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
+  uint64_t m_generation; //!< Changed with the table and the interfaces, see GetRouteGeneration
 };
 
 } // Namespace ns3
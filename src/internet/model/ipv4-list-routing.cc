@@ -43,7 +43,8 @@ Ipv4ListRouting::GetTypeId (void)
 
 
 Ipv4ListRouting::Ipv4ListRouting () 
-  : m_ipv4 (0)
+  : m_ipv4 (0),
+    m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -255,12 +256,31 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  m_generation++;
   if (m_ipv4 != 0)
     {
       routingProtocol->SetIpv4 (m_ipv4);
     }
 }
 
+uint64_t
+Ipv4ListRouting::GetRouteGeneration (void) const
+{
+  // The generations only increase, and so does their sum
+  uint64_t generation = m_generation;
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      uint64_t protocolGeneration = (*i).second->GetRouteGeneration ();
+      if (protocolGeneration == 0)
+        {
+          return 0;
+        }
+      generation += protocolGeneration;
+    }
+  return generation;
+}
+
 uint32_t 
 Ipv4ListRouting::GetNRoutingProtocols (void) const
 {
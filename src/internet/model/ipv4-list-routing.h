@@ -90,6 +90,14 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  /**
+   * \brief Get the generation of the routes given by RouteOutput
+   *
+   * The routes may be cached only if those of all the protocols may be.
+   *
+   * \return the sum of the generations of the protocols, or 0
+   */
+  virtual uint64_t GetRouteGeneration (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -113,6 +121,7 @@ private:
    */
   static bool Compare (const Ipv4RoutingProtocolEntry& a, const Ipv4RoutingProtocolEntry& b);
   Ptr<Ipv4> m_ipv4; //!< Ipv4 this protocol is associated with.
+  uint64_t m_generation; //!< Changed when a protocol is added
 
 
 };
@@ -0,0 +1,78 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-route-cache.h"
+#include "ipv4-route.h"
+#include "ipv4-header.h"
+#include "ipv4-routing-protocol.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteCache");
+
+Ipv4RouteCache::Ipv4RouteCache ()
+  : m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<Ipv4Route>
+Ipv4RouteCache::RouteOutput (Ptr<Ipv4RoutingProtocol> routing, Ptr<Packet> p,
+                             const Ipv4Header &header, Ptr<NetDevice> oif,
+                             Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << routing << p << header << oif);
+  uint64_t generation = routing->GetRouteGeneration ();
+  if (m_route != 0 && generation != 0 && generation == m_generation
+      && routing == m_routing && oif == m_oif
+      && header.GetSource () == m_source && header.GetDestination () == m_destination)
+    {
+      NS_LOG_LOGIC ("Cached route " << m_route);
+      sockerr = Socket::ERROR_NOTERROR;
+      return m_route;
+    }
+
+  Ptr<Ipv4Route> route = routing->RouteOutput (p, header, oif, sockerr);
+  if (route != 0 && generation != 0)
+    {
+      m_routing = routing;
+      m_generation = generation;
+      m_source = header.GetSource ();
+      m_destination = header.GetDestination ();
+      m_oif = oif;
+      m_route = route;
+    }
+  else
+    {
+      Flush ();
+    }
+  return route;
+}
+
+void
+Ipv4RouteCache::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routing = 0;
+  m_generation = 0;
+  m_oif = 0;
+  m_route = 0;
+}
+
+} // namespace ns3
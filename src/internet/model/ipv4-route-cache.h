@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_CACHE_H
+#define IPV4_ROUTE_CACHE_H
+
+#include "ns3/ptr.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/socket.h"
+
+namespace ns3 {
+
+class Ipv4Route;
+class Ipv4Header;
+class Ipv4RoutingProtocol;
+class NetDevice;
+class Packet;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief The route of a flow, kept by its socket (similar to the
+ * destination cache of a Linux struct sock)
+ *
+ * A connected socket sends all its packets to the same destination, so
+ * that it may keep the route given by the routing protocol instead of
+ * asking it for every packet. The route is asked again when the
+ * addresses or the output device change, and when the routing protocol
+ * reports a new generation of routes (see
+ * Ipv4RoutingProtocol::GetRouteGeneration); nothing is kept if the
+ * routing protocol does not allow it.
+ */
+class Ipv4RouteCache
+{
+public:
+  Ipv4RouteCache ();
+
+  /**
+   * \brief Get the route of a packet, from the cache or from the routing protocol
+   *
+   * \param routing the routing protocol
+   * \param p the packet to route, may be null
+   * \param header the IPv4 header, with the source and destination addresses
+   * \param oif the output device, or 0
+   * \param sockerr output parameter; socket errno
+   * \return the route, or 0 if there is none
+   */
+  Ptr<Ipv4Route> RouteOutput (Ptr<Ipv4RoutingProtocol> routing, Ptr<Packet> p,
+                              const Ipv4Header &header, Ptr<NetDevice> oif,
+                              Socket::SocketErrno &sockerr);
+
+  /**
+   * \brief Forget the cached route
+   */
+  void Flush (void);
+
+private:
+  Ptr<Ipv4RoutingProtocol> m_routing; //!< The routing protocol which gave m_route
+  uint64_t m_generation;              //!< The generation of m_route
+  Ipv4Address m_source;               //!< The source address of the flow
+  Ipv4Address m_destination;          //!< The destination address of the flow
+  Ptr<NetDevice> m_oif;               //!< The output device asked by the flow
+  Ptr<Ipv4Route> m_route;             //!< The cached route, or 0
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_CACHE_H */
@@ -171,6 +171,20 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Get the generation of the routes given by RouteOutput
+   *
+   * A protocol whose RouteOutput gives the same route for the same
+   * destination and output device, whatever the packet, may let the
+   * senders cache its routes (see Ipv4RouteCache): it returns a counter
+   * which changes whenever its table, or the interfaces it depends on,
+   * change, so that the cached routes are looked up again.
+   *
+   * \return the generation of the routes, or 0 if they must not be cached,
+   * which is the default
+   */
+  virtual uint64_t GetRouteGeneration (void) const;
+
 };
 
 } // namespace ns3
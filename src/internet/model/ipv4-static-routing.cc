@@ -54,7 +54,8 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_ipv4 (0),
+    m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -75,8 +76,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
 
   if (!LookupRoute (route, metric))
     {
-      Ipv4RoutingTableEntry *routePtr = new Ipv4RoutingTableEntry (route);
-      m_networkRoutes.push_back (make_pair (routePtr, metric));
+      InsertRoute (new Ipv4RoutingTableEntry (route), metric);
     }
 }
 
@@ -93,9 +93,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                                              interface);
   if (!LookupRoute (route, metric))
     {
-      Ipv4RoutingTableEntry *routePtr = new Ipv4RoutingTableEntry (route);
-
-      m_networkRoutes.push_back (make_pair (routePtr, metric));
+      InsertRoute (new Ipv4RoutingTableEntry (route), metric);
     }
 }
 
@@ -153,7 +151,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         outputInterface);
-  m_networkRoutes.push_back (make_pair (route,0));
+  InsertRoute (route, 0);
 }
 
 uint32_t 
@@ -229,10 +227,43 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+void
+Ipv4StaticRouting::InsertRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  uint8_t network[4];
+  uint8_t mask[4];
+  route->GetDestNetwork ().Serialize (network);
+  Ipv4Address (route->GetDestNetworkMask ().Get ()).Serialize (mask);
+  m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkRouteIndex.Insert (network, NetworkRouteIndex::GetPrefixLength (mask), m_networkRoutes.back ());
+  m_generation++;
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseRoute (NetworkRoutesI it)
+{
+  uint8_t network[4];
+  uint8_t mask[4];
+  it->first->GetDestNetwork ().Serialize (network);
+  Ipv4Address (it->first->GetDestNetworkMask ().Get ()).Serialize (mask);
+  [[maybe_unused]] bool found = m_networkRouteIndex.Remove (network, NetworkRouteIndex::GetPrefixLength (mask), *it);
+  NS_ASSERT (found);
+  delete it->first;
+  m_generation++;
+  return m_networkRoutes.erase (it);
+}
+
 bool
 Ipv4StaticRouting::LookupRoute (const Ipv4RoutingTableEntry &route, uint32_t metric)
 {
-  for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+  // A route matches its own destination, so the index has all its
+  // duplicates.
+  std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > candidates;
+  uint8_t dest[4];
+  route.GetDest ().Serialize (dest);
+  m_networkRouteIndex.Lookup (dest, candidates);
+  for (std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::const_iterator j = candidates.begin ();
+       j != candidates.end (); j++)
     {
       Ipv4RoutingTableEntry* rtentry = j->first;
 
@@ -269,8 +300,13 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
+  // the routes whose prefix matches dest, in table order
+  std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > candidates;
+  uint8_t destBytes[4];
+  dest.Serialize (destBytes);
+  m_networkRouteIndex.Lookup (destBytes, candidates);
+  for (std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::const_iterator i = candidates.begin (); 
+       i != candidates.end (); 
        i++) 
     {
       Ipv4RoutingTableEntry *j=i->first;
@@ -476,8 +512,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete j->first;
-          m_networkRoutes.erase (j);
+          EraseRoute (j);
           return;
         }
       tmp++;
@@ -604,6 +639,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteIndex.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -618,6 +654,7 @@ void
 Ipv4StaticRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_generation++;
   // If interface address and network mask have been set, add a route
   // to the network of the interface (like e.g. ifconfig does on a
   // Linux box)
@@ -637,13 +674,13 @@ void
 Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_generation++;
   // Remove all static routes that are going through this interface
   for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); )
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseRoute (it);
         }
       else
         {
@@ -656,6 +693,7 @@ void
 Ipv4StaticRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  m_generation++;
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -674,6 +712,7 @@ void
 Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  m_generation++;
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -689,8 +728,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseRoute (it);
         }
       else
         {
@@ -699,6 +737,12 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
     }
 }
 
+uint64_t
+Ipv4StaticRouting::GetRouteGeneration (void) const
+{
+  return m_generation;
+}
+
 void 
 Ipv4StaticRouting::SetIpv4 (Ptr<Ipv4> ipv4)
 {
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -86,6 +87,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual uint64_t GetRouteGeneration (void) const;
 
 /**
  * \brief Add a network route to the static routing table.
@@ -367,6 +369,9 @@ private:
   /// Iterator for container for the network routes
   typedef std::list<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
 
+  /// Index of the network routes by destination prefix
+  typedef PrefixTrie<std::pair <Ipv4RoutingTableEntry *, uint32_t>, 32> NetworkRouteIndex;
+
   /// Container for the multicast routes
   typedef std::list<Ipv4MulticastRoutingTableEntry *> MulticastRoutes;
 
@@ -384,6 +389,20 @@ private:
    */
   bool LookupRoute (const Ipv4RoutingTableEntry &route, uint32_t metric);
 
+  /**
+   * \brief Add a route to the forwarding table.
+   * \param route route
+   * \param metric metric of route
+   */
+  void InsertRoute (Ipv4RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a route from the forwarding table and delete it.
+   * \param it the route
+   * \return the route following it
+   */
+  NetworkRoutesI EraseRoute (NetworkRoutesI it);
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -407,6 +426,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the index of m_networkRoutes, for LookupStatic.
+   */
+  NetworkRouteIndex m_networkRouteIndex;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -416,6 +440,14 @@ private:
    * \brief Ipv4 reference.
    */
   Ptr<Ipv4> m_ipv4;
+
+  /**
+   * \brief the generation of the routes, see GetRouteGeneration.
+   *
+   * Changed with the table, and with the interfaces, since the source
+   * addresses of the routes depend on them.
+   */
+  uint64_t m_generation;
 };
 
 } // Namespace ns3
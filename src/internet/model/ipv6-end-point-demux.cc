@@ -26,6 +26,21 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 
+bool Ipv6EndPointDemux::Key::operator== (const Key &other) const
+{
+  return localAddress == other.localAddress && localPort == other.localPort
+         && peerAddress == other.peerAddress && peerPort == other.peerPort;
+}
+
+std::size_t Ipv6EndPointDemux::KeyHash::operator() (const Key &key) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t hash = addressHash (key.localAddress) * 0x9e3779b97f4a7c15ULL
+    + addressHash (key.peerAddress);
+  hash = (hash ^ ((static_cast<uint64_t> (key.localPort) << 16) | key.peerPort)) * 0x9e3779b97f4a7c15ULL;
+  return hash ^ (hash >> 29);
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
@@ -37,9 +52,12 @@ Ipv6EndPointDemux::Ipv6EndPointDemux ()
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
+  m_connected.clear ();
+  m_listeners.clear ();
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
@@ -48,19 +66,16 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
+  if (!LookupPortLocal (port))
+    {
+      return false;
+    }
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == port &&
@@ -83,7 +98,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -98,7 +113,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -119,7 +134,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -129,13 +144,11 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Key key = { localAddress, peerAddress, localPort, peerPort };
+  std::pair<EndPointTable::iterator, EndPointTable::iterator> range = GetTable (key).equal_range (key);
+  for (EndPointTable::iterator i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      if (i->second->GetBoundNetDevice () == boundNetDevice || i->second->GetBoundNetDevice () == 0)
         {
           NS_LOG_WARN ("Duplicated endpoint.");
           return 0;
@@ -143,7 +156,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -152,16 +165,68 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << endPoint);
+  if (endPoint->m_demux != this)
+    {
+      return;
+    }
+  Unindex (endPoint);
+  m_endPoints.erase (endPoint->m_position);
+  endPoint->m_demux = 0;
+  delete endPoint;
+}
+
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key = { endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+              endPoint->GetLocalPort (), endPoint->GetPeerPort () };
+  GetTable (key).insert (std::make_pair (key, endPoint));
+  if (m_localPorts[key.localPort]++ == 0)
+    {
+      SetEphemeralPortUsed (key.localPort, true);
+    }
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key = { endPoint->GetLocalAddress (), endPoint->GetPeerAddress (),
+              endPoint->GetLocalPort (), endPoint->GetPeerPort () };
+  EndPointTable &table = GetTable (key);
+  std::pair<EndPointTable::iterator, EndPointTable::iterator> range = table.equal_range (key);
+  for (EndPointTable::iterator i = range.first; i != range.second; i++)
     {
-      if (*i == endPoint)
+      if (i->second == endPoint)
         {
-          delete endPoint;
-          m_endPoints.erase (i);
+          table.erase (i);
           break;
         }
     }
+  PortMap::iterator port = m_localPorts.find (key.localPort);
+  NS_ASSERT (port != m_localPorts.end ());
+  if (--port->second == 0)
+    {
+      m_localPorts.erase (port);
+      SetEphemeralPortUsed (key.localPort, false);
+    }
+}
+
+Ipv6EndPointDemux::EndPointTable &Ipv6EndPointDemux::GetTable (const Key &key)
+{
+  if (key.peerAddress == Ipv6Address::GetAny () && key.peerPort == 0)
+    {
+      return m_listeners;
+    }
+  return m_connected;
 }
 
 /*
@@ -175,37 +240,48 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
 
-  EndPoints retval1; /* Matches exact on local port, wildcards on others */
-  EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
-  EndPoints retval3; /* Matches all but local address */
-  EndPoints retval4; /* Exact match on all 4 */
-
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  // Here we find the most exact match
+  EndPoints retval;
+  /* Exact match on all 4 */
+  Find (daddr, dport, saddr, sport, incomingInterface, retval);
+  /* Matches all but local address */
+  if (retval.empty ())
+    {
+      Find (Ipv6Address::GetAny (), dport, saddr, sport, incomingInterface, retval);
+    }
+  /* Matches exact on local port/adder, wildcards on others */
+  if (retval.empty ())
+    {
+      Find (daddr, dport, Ipv6Address::GetAny (), 0, incomingInterface, retval);
+    }
+  /* Matches exact on local port, wildcards on others */
+  if (retval.empty ())
     {
-      Ipv6EndPoint* endP = *i;
+      Find (Ipv6Address::GetAny (), dport, Ipv6Address::GetAny (), 0, incomingInterface, retval);
+    }
 
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
+  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  return retval;  // might be empty if no matches
+}
 
+void Ipv6EndPointDemux::Find (Ipv6Address localAddress, uint16_t localPort,
+                              Ipv6Address peerAddress, uint16_t peerPort,
+                              Ptr<Ipv6Interface> incomingInterface, EndPoints &endPoints)
+{
+  NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
+  Key key = { localAddress, peerAddress, localPort, peerPort };
+  std::pair<EndPointTable::iterator, EndPointTable::iterator> range = GetTable (key).equal_range (key);
+  for (EndPointTable::iterator i = range.first; i != range.second; i++)
+    {
+      Ipv6EndPoint* endP = i->second;
       if (!endP->IsRxEnabled ())
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
+          NS_LOG_LOGIC ("Skipping endpoint " << endP
                         << " because endpoint can not receive packets");
           continue;
         }
-
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-
       if (endP->GetBoundNetDevice ())
         {
           if (!incomingInterface)
@@ -214,82 +290,34 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
             }
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
             {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
+              NS_LOG_LOGIC ("Skipping endpoint " << endP
                                                  << " because endpoint is bound to specific device and"
                                                  << endP->GetBoundNetDevice ()
                                                  << " does not match packet device " << incomingInterface->GetDevice ());
               continue;
             }
         }
-
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
-
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
-
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
-        }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-          continue;
-        }
-
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
-        }
+      endPoints.push_back (endP);
     }
-
-  // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
-  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
-  return retval;  // might be empty if no matches
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  NS_LOG_FUNCTION (this << dst << dport << src << sport);
+
+  Key key = { dst, src, dport, sport };
+  EndPointTable &table = GetTable (key);
+  EndPointTable::iterator exact = table.find (key);
+  if (exact != table.end ())
+    {
+      /* this is an exact match. */
+      return exact->second;
+    }
+  if (!LookupPortLocal (dport))
+    {
+      return 0;
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
@@ -302,13 +330,6 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
           continue;
         }
 
-      if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
-          && (*i)->GetPeerAddress () == src)
-        {
-          /* this is an exact match. */
-          return *i;
-        }
-
       if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
@@ -328,24 +349,70 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
   return generic;
 }
 
-uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
+void Ipv6EndPointDemux::SetEphemeralPortUsed (uint16_t port, bool used)
 {
-  NS_LOG_FUNCTION (this);
-  uint16_t port = m_ephemeral;
-  int count = m_portLast - m_portFirst;
-  do
+  if (m_ephemeralPorts.empty () || port < m_portFirst || port > m_portLast)
+    {
+      return;
+    }
+  uint32_t bit = port - m_portFirst;
+  if (used)
+    {
+      m_ephemeralPorts[bit / 64] |= static_cast<uint64_t> (1) << (bit % 64);
+    }
+  else
     {
-      if (count-- < 0)
+      m_ephemeralPorts[bit / 64] &= ~(static_cast<uint64_t> (1) << (bit % 64));
+    }
+}
+
+uint16_t Ipv6EndPointDemux::FindFreeEphemeralPort (uint32_t first, uint32_t last) const
+{
+  uint32_t port = first;
+  while (port <= last)
+    {
+      uint32_t bit = port - m_portFirst;
+      uint64_t word = m_ephemeralPorts[bit / 64] >> (bit % 64);
+      if (word == ~static_cast<uint64_t> (0) >> (bit % 64))
         {
-          return 0;
+          // The rest of the word is in use
+          port += 64 - bit % 64;
+          continue;
         }
-      ++port;
-      if (port < m_portFirst || port > m_portLast)
+      if ((word & 1) == 0)
+        {
+          return port;
+        }
+      port++;
+    }
+  return 0;
+}
+
+uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_ephemeralPorts.empty ())
+    {
+      m_ephemeralPorts.assign ((m_portLast - m_portFirst) / 64 + 1, 0);
+      for (PortMap::const_iterator i = m_localPorts.begin (); i != m_localPorts.end (); i++)
         {
-          port = m_portFirst;
+          SetEphemeralPortUsed (i->first, true);
         }
     }
-  while (LookupPortLocal (port));
+  uint32_t start = m_ephemeral + 1;
+  if (start < m_portFirst || start > m_portLast)
+    {
+      start = m_portFirst;
+    }
+  uint16_t port = FindFreeEphemeralPort (start, m_portLast);
+  if (port == 0)
+    {
+      port = FindFreeEphemeralPort (m_portFirst, start - 1);
+    }
+  if (port == 0)
+    {
+      return 0;
+    }
   m_ephemeral = port;
   return port;
 }
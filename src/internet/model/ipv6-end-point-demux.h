@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,10 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * As in Ipv4EndPointDemux, the end points are indexed by their four-tuple
+ * in a table of connected end points and a table of listeners, and the
+ * ephemeral ports in use are kept in a bitmap.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +159,96 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of an end point, as a key of the end point tables.
+   */
+  struct Key
+  {
+    Ipv6Address localAddress; //!< The local address
+    Ipv6Address peerAddress;  //!< The peer address
+    uint16_t localPort;       //!< The local port
+    uint16_t peerPort;        //!< The peer port
+
+    /**
+     * \param other the key to compare with
+     * \returns true if both keys are equal
+     */
+    bool operator== (const Key &other) const;
+  };
+
+  /**
+   * \brief Hash function of the keys of the end point tables.
+   */
+  struct KeyHash
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    std::size_t operator() (const Key &key) const;
+  };
+
+  /// End points by four-tuple
+  typedef std::unordered_multimap<Key, Ipv6EndPoint *, KeyHash> EndPointTable;
+  /// Number of end points by local port
+  typedef std::unordered_map<uint16_t, uint32_t> PortMap;
+
+  /**
+   * \brief Add an end point to the list and the tables.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the tables, under its current four-tuple.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the tables, before its four-tuple changes.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Find the end points with a four-tuple which can receive a packet.
+   * \param localAddress the local address
+   * \param localPort the local port
+   * \param peerAddress the peer address
+   * \param peerPort the peer port
+   * \param incomingInterface the interface which received the packet, if any
+   * \param endPoints the list to which the end points are appended
+   */
+  void Find (Ipv6Address localAddress, uint16_t localPort,
+             Ipv6Address peerAddress, uint16_t peerPort,
+             Ptr<Ipv6Interface> incomingInterface, EndPoints &endPoints);
+
+  /**
+   * \brief Get the table of the end points with a four-tuple.
+   * \param key the four-tuple
+   * \return the listener table if the peer is a wildcard, the table of
+   * the end points with a peer otherwise
+   */
+  EndPointTable &GetTable (const Key &key);
+
+  /**
+   * \brief Mark a port of the ephemeral range as used or free.
+   * \param port the port
+   * \param used whether the port is used
+   */
+  void SetEphemeralPortUsed (uint16_t port, bool used);
+
+  /**
+   * \brief Find a free port in a part of the ephemeral range.
+   * \param first the first port to consider
+   * \param last the last port to consider
+   * \return the first free port from first to last, or 0
+   */
+  uint16_t FindFreeEphemeralPort (uint32_t first, uint32_t last) const;
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +274,27 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points with a peer, by four-tuple.
+   */
+  EndPointTable m_connected;
+
+  /**
+   * \brief The end points without a peer, by local address and port.
+   */
+  EndPointTable m_listeners;
+
+  /**
+   * \brief The number of end points of each local port in use.
+   */
+  PortMap m_localPorts;
+
+  /**
+   * \brief A bit for each port of the ephemeral range, set if the port is
+   * used; empty until the first ephemeral port allocation.
+   */
+  std::vector<uint64_t> m_ephemeralPorts;
 };
 
 } /* namespace ns3 */
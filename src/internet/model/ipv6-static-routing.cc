@@ -161,8 +161,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
 
   if (!LookupRoute (route, metric))
     {
-      Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry (route);
-      m_networkRoutes.push_back (std::make_pair (routePtr, metric));
+      InsertRoute (new Ipv6RoutingTableEntry (route), metric);
     }
 }
 
@@ -177,8 +176,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
   if (!LookupRoute (route, metric))
     {
-      Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry (route);
-      m_networkRoutes.push_back (std::make_pair (routePtr, metric));
+      InsertRoute (new Ipv6RoutingTableEntry (route), metric);
     }
 }
 
@@ -189,8 +187,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   Ipv6RoutingTableEntry route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
   if (!LookupRoute (route, metric))
     {
-      Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry (route);
-      m_networkRoutes.push_back (std::make_pair (routePtr, metric));
+      InsertRoute (new Ipv6RoutingTableEntry (route), metric);
     }
 }
 
@@ -215,7 +212,7 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Address network = Ipv6Address ("ff00::"); /* RFC 3513 */
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
-  m_networkRoutes.push_back (std::make_pair (route, 0));
+  InsertRoute (route, 0);
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -302,7 +299,14 @@ bool Ipv6StaticRouting::HasNetworkDest (Ipv6Address network, uint32_t interfaceI
 
 bool Ipv6StaticRouting::LookupRoute (const Ipv6RoutingTableEntry &route, uint32_t metric)
 {
-  for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+  // A route matches its own destination, so the index has all its
+  // duplicates.
+  std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> > candidates;
+  uint8_t dest[16];
+  route.GetDest ().GetBytes (dest);
+  m_networkRouteIndex.Lookup (dest, candidates);
+  for (std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::const_iterator j = candidates.begin ();
+       j != candidates.end (); j++)
     {
       Ipv6RoutingTableEntry* rtentry = j->first;
 
@@ -319,6 +323,28 @@ bool Ipv6StaticRouting::LookupRoute (const Ipv6RoutingTableEntry &route, uint32_
   return false;
 }
 
+void Ipv6StaticRouting::InsertRoute (Ipv6RoutingTableEntry *route, uint32_t metric)
+{
+  uint8_t network[16];
+  uint8_t prefix[16];
+  route->GetDestNetwork ().GetBytes (network);
+  route->GetDestNetworkPrefix ().GetBytes (prefix);
+  m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkRouteIndex.Insert (network, NetworkRouteIndex::GetPrefixLength (prefix), m_networkRoutes.back ());
+}
+
+Ipv6StaticRouting::NetworkRoutesI Ipv6StaticRouting::EraseRoute (NetworkRoutesI it)
+{
+  uint8_t network[16];
+  uint8_t prefix[16];
+  it->first->GetDestNetwork ().GetBytes (network);
+  it->first->GetDestNetworkPrefix ().GetBytes (prefix);
+  [[maybe_unused]] bool found = m_networkRouteIndex.Remove (network, NetworkRouteIndex::GetPrefixLength (prefix), *it);
+  NS_ASSERT (found);
+  delete it->first;
+  return m_networkRoutes.erase (it);
+}
+
 Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice> interface)
 {
   NS_LOG_FUNCTION (this << dst << interface);
@@ -338,7 +364,12 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  // the routes whose prefix matches dst, in table order
+  std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> > candidates;
+  uint8_t dstBytes[16];
+  dst.GetBytes (dstBytes);
+  m_networkRouteIndex.Lookup (dstBytes, candidates);
+  for (std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::const_iterator it = candidates.begin (); it != candidates.end (); it++)
     {
       Ipv6RoutingTableEntry* j = it->first;
       uint32_t metric = it->second;
@@ -418,6 +449,7 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_networkRouteIndex.Clear ();
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -566,8 +598,7 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          EraseRoute (it);
           return;
         }
       tmp++;
@@ -585,8 +616,7 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
       if (network == rtentry->GetDest () && rtentry->GetInterface () == ifIndex
           && rtentry->GetPrefixToUse () == prefixToUse)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          EraseRoute (it);
           return;
         }
     }
@@ -715,8 +745,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseRoute (it);
         }
       else
         {
@@ -752,8 +781,7 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkPrefix () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseRoute (it);
         }
       else
         {
@@ -800,8 +828,7 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
 
           if (dst == entry && prefix == mask && rtentry->GetInterface () == interface)
             {
-              delete j->first;
-              j = m_networkRoutes.erase (j);
+              j = EraseRoute (j);
             }
           else
             {
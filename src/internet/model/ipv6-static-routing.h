@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -255,6 +256,9 @@ private:
   /// Iterator for container for the network routes
   typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
 
+  /// Index of the network routes by destination prefix
+  typedef PrefixTrie<std::pair <Ipv6RoutingTableEntry *, uint32_t>, 128> NetworkRouteIndex;
+
   /// Container for the multicast routes
   typedef std::list<Ipv6MulticastRoutingTableEntry *> MulticastRoutes;
 
@@ -272,6 +276,20 @@ private:
    */
   bool LookupRoute (const Ipv6RoutingTableEntry &route, uint32_t metric);
 
+  /**
+   * \brief Add a route to the forwarding table.
+   * \param route route
+   * \param metric metric of route
+   */
+  void InsertRoute (Ipv6RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a route from the forwarding table and delete it.
+   * \param it the route
+   * \return the route following it
+   */
+  NetworkRoutesI EraseRoute (NetworkRoutesI it);
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -294,6 +312,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the index of m_networkRoutes, for LookupStatic.
+   */
+  NetworkRouteIndex m_networkRouteIndex;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -0,0 +1,409 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A path-compressed binary trie of address prefixes.
+ *
+ * The trie maps prefixes of up to \pname{BITS} bits, given as bytes in
+ * network order, to lists of values; several values may share a prefix.
+ * Lookup() finds the values of all the prefixes of an address by walking
+ * a single branch, so that the routing protocols need not scan their
+ * whole table for every packet.
+ *
+ * Lookup() reports the values in the order they were inserted in, so
+ * that the routing protocols keep the tie-breaking rules of their
+ * linear scans.
+ *
+ * \tparam T the type of the values, compared with operator==
+ * \tparam BITS the length of the addresses, 32 or 128
+ */
+template <typename T, uint32_t BITS>
+class PrefixTrie
+{
+public:
+  PrefixTrie ();
+  ~PrefixTrie ();
+
+  /**
+   * \param prefix the prefix bytes; the bits after \pname{length} are ignored
+   * \param length the prefix length, in bits
+   * \param value the value to add to the prefix
+   */
+  void Insert (const uint8_t *prefix, uint32_t length, const T &value);
+  /**
+   * \param prefix the prefix bytes; the bits after \pname{length} are ignored
+   * \param length the prefix length, in bits
+   * \param value the value to remove from the prefix
+   * \returns true if the value was found
+   */
+  bool Remove (const uint8_t *prefix, uint32_t length, const T &value);
+  /**
+   * Remove all the values.
+   */
+  void Clear (void);
+  /**
+   * \param address the address bytes
+   * \param values the vector to which the values of all the prefixes of
+   * \pname{address} are appended, in the order they were inserted in
+   */
+  void Lookup (const uint8_t *address, std::vector<T> &values) const;
+  /**
+   * \param prefix the prefix bytes; the bits after \pname{length} are ignored
+   * \param length the prefix length, in bits
+   * \returns true if the trie has values for a prefix which contains
+   * \pname{prefix}, or which \pname{prefix} contains
+   */
+  bool HasOverlap (const uint8_t *prefix, uint32_t length) const;
+
+  /**
+   * Routes are indexed under the contiguous part of their mask, so that
+   * they are found for all the addresses they match even if the mask has
+   * holes.
+   *
+   * \param mask the mask bytes
+   * \returns the number of leading one bits of \pname{mask}
+   */
+  static uint32_t GetPrefixLength (const uint8_t *mask);
+
+private:
+  /// A value, with its insertion order
+  struct Item
+  {
+    uint64_t order;  //!< Insertion counter
+    T value;         //!< The value
+  };
+  /// A node of the trie: a prefix, its values and two subtries
+  struct Node
+  {
+    uint8_t key[BITS / 8];    //!< The prefix
+    uint32_t length;          //!< The prefix length
+    Node *child[2];           //!< The subtries for the next bit 0 and 1
+    std::vector<Item> items;  //!< The values of the prefix, in insertion order
+  };
+
+  /// Disabled copy constructor
+  PrefixTrie (const PrefixTrie &);
+  /// Disabled assignment
+  PrefixTrie &operator = (const PrefixTrie &);
+
+  /**
+   * \param key the bytes
+   * \param i the bit index
+   * \returns the bit \pname{i} of \pname{key}, from the most significant
+   */
+  static uint32_t GetBit (const uint8_t *key, uint32_t i);
+  /**
+   * \param a the first bytes
+   * \param b the second bytes
+   * \param max the maximum length to compare
+   * \returns the number of leading bits, at most \pname{max}, which
+   * \pname{a} and \pname{b} have in common
+   */
+  static uint32_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max);
+  /**
+   * \param prefix the prefix bytes
+   * \param length the prefix length
+   * \returns a node without values nor children
+   */
+  static Node *NewNode (const uint8_t *prefix, uint32_t length);
+  /**
+   * \param node the root of the subtrie to delete
+   */
+  static void Delete (Node *node);
+
+  Node *m_root;       //!< The root, or 0 if the trie is empty
+  uint64_t m_order;   //!< Insertion counter
+};
+
+} // namespace ns3
+
+namespace ns3 {
+
+template <typename T, uint32_t BITS>
+PrefixTrie<T, BITS>::PrefixTrie ()
+  : m_root (0),
+    m_order (0)
+{
+}
+
+template <typename T, uint32_t BITS>
+PrefixTrie<T, BITS>::~PrefixTrie ()
+{
+  Delete (m_root);
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::GetBit (const uint8_t *key, uint32_t i)
+{
+  return (key[i / 8] >> (7 - i % 8)) & 1;
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max)
+{
+  for (uint32_t byte = 0; byte * 8 < max; byte++)
+    {
+      uint8_t diff = a[byte] ^ b[byte];
+      if (diff != 0)
+        {
+          uint32_t length = byte * 8;
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              length++;
+            }
+          return std::min (length, max);
+        }
+    }
+  return max;
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::GetPrefixLength (const uint8_t *mask)
+{
+  uint32_t length = 0;
+  while (length < BITS && GetBit (mask, length) == 1)
+    {
+      length++;
+    }
+  return length;
+}
+
+template <typename T, uint32_t BITS>
+typename PrefixTrie<T, BITS>::Node *
+PrefixTrie<T, BITS>::NewNode (const uint8_t *prefix, uint32_t length)
+{
+  Node *node = new Node;
+  std::memset (node->key, 0, sizeof (node->key));
+  std::memcpy (node->key, prefix, (length + 7) / 8);
+  if (length % 8 != 0)
+    {
+      node->key[length / 8] &= 0xff << (8 - length % 8);
+    }
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::Delete (Node *node)
+{
+  if (node != 0)
+    {
+      Delete (node->child[0]);
+      Delete (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::Insert (const uint8_t *prefix, uint32_t length, const T &value)
+{
+  Item item = {m_order++, value};
+  Node **link = &m_root;
+  for (;;)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = NewNode (prefix, length);
+          node->items.push_back (item);
+          *link = node;
+          return;
+        }
+      uint32_t common = GetCommonLength (node->key, prefix, std::min (node->length, length));
+      if (common < node->length)
+        {
+          // The prefix diverges from this node, or is shorter: insert the
+          // common part of both above the node.
+          Node *split = NewNode (prefix, common);
+          split->child[GetBit (node->key, common)] = node;
+          *link = split;
+          node = split;
+        }
+      if (node->length == length)
+        {
+          node->items.push_back (item);
+          return;
+        }
+      link = &node->child[GetBit (prefix, node->length)];
+    }
+}
+
+template <typename T, uint32_t BITS>
+bool
+PrefixTrie<T, BITS>::Remove (const uint8_t *prefix, uint32_t length, const T &value)
+{
+  Node **path[BITS + 1];
+  uint32_t depth = 0;
+  Node **link = &m_root;
+  for (;;)
+    {
+      Node *node = *link;
+      if (node == 0 || node->length > length
+          || GetCommonLength (node->key, prefix, node->length) < node->length)
+        {
+          return false;
+        }
+      if (node->length == length)
+        {
+          break;
+        }
+      path[depth++] = link;
+      link = &node->child[GetBit (prefix, node->length)];
+    }
+
+  std::vector<Item> &items = (*link)->items;
+  typename std::vector<Item>::iterator i = items.begin ();
+  while (i != items.end () && !(i->value == value))
+    {
+      i++;
+    }
+  if (i == items.end ())
+    {
+      return false;
+    }
+  items.erase (i);
+
+  // Remove the nodes which have become useless: those without values and
+  // with at most one child.
+  for (;;)
+    {
+      Node *node = *link;
+      if (!node->items.empty () || (node->child[0] != 0 && node->child[1] != 0))
+        {
+          break;
+        }
+      *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+      delete node;
+      if (*link != 0 || depth == 0)
+        {
+          break;
+        }
+      link = path[--depth];
+    }
+  return true;
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::Clear (void)
+{
+  Delete (m_root);
+  m_root = 0;
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::Lookup (const uint8_t *address, std::vector<T> &values) const
+{
+  const Node *matches[BITS + 1];
+  uint32_t nMatches = 0;
+  const Node *node = m_root;
+  while (node != 0 && GetCommonLength (node->key, address, node->length) == node->length)
+    {
+      if (!node->items.empty ())
+        {
+          matches[nMatches++] = node;
+        }
+      if (node->length == BITS)
+        {
+          break;
+        }
+      node = node->child[GetBit (address, node->length)];
+    }
+
+  if (nMatches == 1)
+    {
+      for (typename std::vector<Item>::const_iterator i = matches[0]->items.begin ();
+           i != matches[0]->items.end (); i++)
+        {
+          values.push_back (i->value);
+        }
+      return;
+    }
+
+  // Merge the values of the matching prefixes by insertion order; there
+  // are seldom more than a few of them.
+  std::size_t next[BITS + 1] = {};
+  for (;;)
+    {
+      uint32_t best = nMatches;
+      for (uint32_t m = 0; m < nMatches; m++)
+        {
+          if (next[m] < matches[m]->items.size ()
+              && (best == nMatches
+                  || matches[m]->items[next[m]].order < matches[best]->items[next[best]].order))
+            {
+              best = m;
+            }
+        }
+      if (best == nMatches)
+        {
+          return;
+        }
+      values.push_back (matches[best]->items[next[best]++].value);
+    }
+}
+
+template <typename T, uint32_t BITS>
+bool
+PrefixTrie<T, BITS>::HasOverlap (const uint8_t *prefix, uint32_t length) const
+{
+  const Node *node = m_root;
+  while (node != 0)
+    {
+      uint32_t shortest = std::min (node->length, length);
+      if (GetCommonLength (node->key, prefix, shortest) < shortest)
+        {
+          return false;
+        }
+      if (node->length >= length)
+        {
+          // Every node has values or two subtries, so there are values
+          // under this one.
+          return true;
+        }
+      if (!node->items.empty ())
+        {
+          return true;
+        }
+      node = node->child[GetBit (prefix, node->length)];
+    }
+  return false;
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -23,11 +23,13 @@
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
 #include "ns3/object-vector.h"
+#include "ns3/pointer.h"
 
 #include "ns3/packet.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
+#include "ns3/ipv4-route-cache.h"
 #include "ns3/ipv6-route.h"
 
 #include "tcp-l4-protocol.h"
@@ -41,6 +43,7 @@
 #include "ipv6-routing-protocol.h"
 #include "tcp-socket-factory-impl.h"
 #include "tcp-socket-base.h"
+#include "tcp-pacing-scheduler.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-cubic.h"
 #include "tcp-recovery-ops.h"
@@ -92,12 +95,17 @@ TcpL4Protocol::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
                    MakeObjectVectorChecker<TcpSocketBase> ())
+    .AddAttribute ("PacingScheduler", "The scheduler of the paced sockets of this node.",
+                   PointerValue (),
+                   MakePointerAccessor (&TcpL4Protocol::m_pacingScheduler),
+                   MakePointerChecker<TcpPacingScheduler> ())
   ;
   return tid;
 }
 
 TcpL4Protocol::TcpL4Protocol ()
-  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ())
+  : m_endPoints (new Ipv4EndPointDemux ()), m_endPoints6 (new Ipv6EndPointDemux ()),
+    m_pacingScheduler (CreateObject<TcpPacingScheduler> ())
 {
   NS_LOG_FUNCTION (this);
 }
@@ -175,6 +183,12 @@ TcpL4Protocol::DoDispose (void)
       m_endPoints6 = 0;
     }
 
+  if (m_pacingScheduler != 0)
+    {
+      m_pacingScheduler->Dispose ();
+      m_pacingScheduler = 0;
+    }
+
   m_node = 0;
   m_downTarget.Nullify ();
   m_downTarget6.Nullify ();
@@ -555,9 +569,9 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
 void
 TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              const Ipv4Address &saddr, const Ipv4Address &daddr,
-                             Ptr<NetDevice> oif) const
+                             Ptr<NetDevice> oif, Ipv4RouteCache *routeCache) const
 {
-  NS_LOG_FUNCTION (this << packet << saddr << daddr << oif);
+  NS_LOG_FUNCTION (this << packet << saddr << daddr << oif << routeCache);
   NS_LOG_LOGIC ("TcpL4Protocol " << this
                                  << " sending seq " << outgoing.GetSequenceNumber ()
                                  << " ack " << outgoing.GetAckNumber ()
@@ -586,14 +600,18 @@ TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
       header.SetProtocol (PROT_NUMBER);
       Socket::SocketErrno errno_;
       Ptr<Ipv4Route> route;
-      if (ipv4->GetRoutingProtocol () != 0)
+      if (ipv4->GetRoutingProtocol () == 0)
         {
-          route = ipv4->GetRoutingProtocol ()->RouteOutput (packet, header, oif, errno_);
+          NS_LOG_ERROR ("No IPV4 Routing Protocol");
+          route = 0;
+        }
+      else if (routeCache != 0)
+        {
+          route = routeCache->RouteOutput (ipv4->GetRoutingProtocol (), packet, header, oif, errno_);
         }
       else
         {
-          NS_LOG_ERROR ("No IPV4 Routing Protocol");
-          route = 0;
+          route = ipv4->GetRoutingProtocol ()->RouteOutput (packet, header, oif, errno_);
         }
       m_downTarget (packet, saddr, daddr, PROT_NUMBER, route);
     }
@@ -660,15 +678,15 @@ TcpL4Protocol::SendPacketV6 (Ptr<Packet> packet, const TcpHeader &outgoing,
 void
 TcpL4Protocol::SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
                            const Address &saddr, const Address &daddr,
-                           Ptr<NetDevice> oif) const
+                           Ptr<NetDevice> oif, Ipv4RouteCache *routeCache) const
 {
-  NS_LOG_FUNCTION (this << pkt << outgoing << saddr << daddr << oif);
+  NS_LOG_FUNCTION (this << pkt << outgoing << saddr << daddr << oif << routeCache);
   if (Ipv4Address::IsMatchingType (saddr))
     {
       NS_ASSERT (Ipv4Address::IsMatchingType (daddr));
 
       SendPacketV4 (pkt, outgoing, Ipv4Address::ConvertFrom (saddr),
-                    Ipv4Address::ConvertFrom (daddr), oif);
+                    Ipv4Address::ConvertFrom (daddr), oif, routeCache);
 
       return;
     }
@@ -686,7 +704,7 @@ TcpL4Protocol::SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
       InetSocketAddress s = InetSocketAddress::ConvertFrom (saddr);
       InetSocketAddress d = InetSocketAddress::ConvertFrom (daddr);
 
-      SendPacketV4 (pkt, outgoing, s.GetIpv4 (), d.GetIpv4 (), oif);
+      SendPacketV4 (pkt, outgoing, s.GetIpv4 (), d.GetIpv4 (), oif, routeCache);
 
       return;
     }
@@ -742,6 +760,12 @@ TcpL4Protocol::RemoveSocket (Ptr<TcpSocketBase> socket)
   return false;
 }
 
+Ptr<TcpPacingScheduler>
+TcpL4Protocol::GetPacingScheduler (void) const
+{
+  return m_pacingScheduler;
+}
+
 void
 TcpL4Protocol::SetDownTarget (IpL4Protocol::DownTargetCallback callback)
 {
@@ -41,6 +41,8 @@ class TcpSocketBase;
 class Ipv4EndPoint;
 class Ipv6EndPoint;
 class NetDevice;
+class TcpPacingScheduler;
+class Ipv4RouteCache;
 
 
 /**
@@ -217,10 +219,11 @@ public:
    * \param saddr The source Ipv4Address
    * \param daddr The destination Ipv4Address
    * \param oif The output interface bound. Defaults to null (unspecified).
+   * \param routeCache The route cache of the flow over IPv4, or null
    */
   void SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
                    const Address &saddr, const Address &daddr,
-                   Ptr<NetDevice> oif = 0) const;
+                   Ptr<NetDevice> oif = 0, Ipv4RouteCache *routeCache = 0) const;
 
   /**
    * \brief Make a socket fully operational
@@ -239,6 +242,12 @@ public:
    */
   bool RemoveSocket (Ptr<TcpSocketBase> socket);
 
+  /**
+   * \brief Get the scheduler of the paced sockets of this node
+   * \return the pacing scheduler
+   */
+  Ptr<TcpPacingScheduler> GetPacingScheduler (void) const;
+
   /**
    * \brief Remove an IPv4 Endpoint.
    * \param endPoint the end point to remove
@@ -327,6 +336,7 @@ private:
   std::vector<Ptr<TcpSocketBase> > m_sockets;      //!< list of sockets
   IpL4Protocol::DownTargetCallback m_downTarget;   //!< Callback to send packets over IPv4
   IpL4Protocol::DownTargetCallback6 m_downTarget6; //!< Callback to send packets over IPv6
+  Ptr<TcpPacingScheduler> m_pacingScheduler;       //!< Scheduler of the paced sockets
 
   /**
    * \brief Send a packet via TCP (IPv4)
@@ -336,10 +346,11 @@ private:
    * \param saddr The source Ipv4Address
    * \param daddr The destination Ipv4Address
    * \param oif The output interface bound. Defaults to null (unspecified).
+   * \param routeCache The route cache of the flow, or null
    */
   void SendPacketV4 (Ptr<Packet> pkt, const TcpHeader &outgoing,
                      const Ipv4Address &saddr, const Ipv4Address &daddr,
-                     Ptr<NetDevice> oif = 0) const;
+                     Ptr<NetDevice> oif = 0, Ipv4RouteCache *routeCache = 0) const;
 
   /**
    * \brief Send a packet via TCP (IPv6)
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-pacing-scheduler.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpPacingScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpPacingScheduler);
+
+TypeId
+TcpPacingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpPacingScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpPacingScheduler> ()
+    .AddAttribute ("Granularity",
+                   "Width of the time slots in which the paced flows are released "
+                   "together; zero releases each flow at its exact departure time.",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&TcpPacingScheduler::m_granularity),
+                   MakeTimeChecker (Seconds (0)))
+  ;
+  return tid;
+}
+
+TcpPacingScheduler::TcpPacingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpPacingScheduler::~TcpPacingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpPacingScheduler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  m_slots.clear ();
+  m_pending.clear ();
+  Object::DoDispose ();
+}
+
+uint64_t
+TcpPacingScheduler::Schedule (Time departure, Callback<void> release)
+{
+  NS_LOG_FUNCTION (this << departure);
+
+  Time slot = std::max (departure, Simulator::Now ());
+  int64_t granularity = m_granularity.GetTimeStep ();
+  if (granularity > 1)
+    {
+      slot = TimeStep ((slot.GetTimeStep () + granularity - 1) / granularity * granularity);
+    }
+
+  uint64_t id = m_nextId++;
+  m_slots[slot].push_back (id);
+  m_pending[id] = release;
+  NS_LOG_DEBUG ("Flow " << id << " departs at " << departure << " in slot " << slot);
+
+  if (!m_releasing)
+    {
+      ScheduleNext ();
+    }
+  return id;
+}
+
+void
+TcpPacingScheduler::Cancel (uint64_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  // The flow is left in its slot, and skipped when the slot is released
+  m_pending.erase (id);
+}
+
+uint32_t
+TcpPacingScheduler::GetNPending (void) const
+{
+  return m_pending.size ();
+}
+
+void
+TcpPacingScheduler::Release (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_slots.empty () && m_slots.begin ()->first == Simulator::Now ());
+
+  // The released flows may schedule their next departure in this very
+  // slot; they go in a new bucket, released by a later event.
+  std::vector<uint64_t> flows;
+  flows.swap (m_slots.begin ()->second);
+  m_slots.erase (m_slots.begin ());
+
+  m_releasing = true;
+  for (std::vector<uint64_t>::const_iterator it = flows.begin (); it != flows.end (); ++it)
+    {
+      std::unordered_map<uint64_t, Callback<void> >::iterator flow = m_pending.find (*it);
+      if (flow == m_pending.end ())
+        {
+          continue;
+        }
+      Callback<void> release = flow->second;
+      m_pending.erase (flow);
+      release ();
+    }
+  m_releasing = false;
+
+  ScheduleNext ();
+}
+
+void
+TcpPacingScheduler::ScheduleNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_slots.empty ())
+    {
+      m_event.Cancel ();
+      return;
+    }
+  Time first = m_slots.begin ()->first;
+  if (m_event.IsRunning () && m_eventTime == first)
+    {
+      return;
+    }
+  m_event.Cancel ();
+  m_event = Simulator::Schedule (first - Simulator::Now (), &TcpPacingScheduler::Release, this);
+  m_eventTime = first;
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_PACING_SCHEDULER_H
+#define TCP_PACING_SCHEDULER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+
+#include <map>
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Per-node scheduler of the paced TCP flows
+ *
+ * Instead of running a timer each, the paced sockets of a node hand their
+ * earliest departure time to this scheduler, as Linux TCP does with the
+ * fq queue discipline. The departure times are rounded up to time slots
+ * of the Granularity attribute, and the flows of a slot are kept in a
+ * bucket; a single simulator event, at the first non-empty slot, releases
+ * the whole bucket in the order the flows were scheduled in.
+ *
+ * The default granularity of 10 us is the timer slack of the Linux fq
+ * queue discipline: a flow leaves at most that late, and a released
+ * socket sends at once the segments whose departure time has passed, so
+ * that the slots do not lower its pacing rate.  A granularity of zero
+ * makes each slot a single time step, and the flows leave exactly at
+ * their departure time.
+ */
+class TcpPacingScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpPacingScheduler ();
+  virtual ~TcpPacingScheduler ();
+
+  /**
+   * \brief Schedule the release of a flow
+   *
+   * \param departure the earliest departure time of the flow
+   * \param release the callback to invoke at the departure
+   * \return an identifier to cancel the release with, never 0
+   */
+  uint64_t Schedule (Time departure, Callback<void> release);
+
+  /**
+   * \brief Cancel the release of a flow
+   *
+   * \param id the identifier returned by Schedule; releases which already
+   * happened, or were already cancelled, are ignored
+   */
+  void Cancel (uint64_t id);
+
+  /**
+   * \return the number of flows waiting for their departure
+   */
+  uint32_t GetNPending (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Release the flows of the first slot, which is due
+   */
+  void Release (void);
+
+  /**
+   * \brief Schedule the event of the first non-empty slot, if it is not
+   *        the one already scheduled
+   */
+  void ScheduleNext (void);
+
+  Time m_granularity;      //!< Width of the time slots
+  uint64_t m_nextId {1};   //!< Identifier of the next scheduled flow
+  bool m_releasing {false}; //!< True while the flows of a slot are released
+
+  /// Flows to release, by slot time, in the order they were scheduled
+  std::map<Time, std::vector<uint64_t> > m_slots;
+  /// Release callbacks of the flows which were neither released nor cancelled
+  std::unordered_map<uint64_t, Callback<void> > m_pending;
+
+  EventId m_event;         //!< Release event of the first slot
+  Time m_eventTime;        //!< Time of m_event
+};
+
+} // namespace ns3
+
+#endif /* TCP_PACING_SCHEDULER_H */
@@ -51,7 +51,8 @@ TcpRxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpRxBuffer::TcpRxBuffer (uint32_t n)
-  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0)
+  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0),
+    m_headSeq (n)
 {
 }
 
@@ -113,9 +114,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size () && m_nextRxSeq > m_data.begin ()->first)
+  else if (!m_inOrder.empty ())
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return m_headSeq + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -149,14 +150,21 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  if (!m_inOrder.empty () || !m_data.empty ())
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 firstSeq = m_inOrder.empty () ? m_data.begin ()->first : m_headSeq;
+      SequenceNumber32 maxSeq = firstSeq + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. The in-order data ends before
+  // m_nextRxSeq, and the stored segments do not overlap each other, so only
+  // the segments from the last one starting at or before headSeq matter.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -185,38 +193,42 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       NS_LOG_LOGIC ("Nothing to buffer");
       return false; // Nothing to buffer anyway
     }
-  else
+  else if (headSeq != tcph.GetSequenceNumber () || tailSeq != headSeq + SequenceNumber32 (pktSize))
     {
       uint32_t start = static_cast<uint32_t> (headSeq - tcph.GetSequenceNumber ());
       uint32_t length = static_cast<uint32_t> (tailSeq - headSeq);
       p = p->CreateFragment (start, length);
       NS_ASSERT (length == p->GetSize ());
     }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
 
+  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
+  m_size += p->GetSize ();      // Occupancy
   if (headSeq > m_nextRxSeq)
     {
+      // Insert packet into buffer
+      NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
+      m_data[headSeq] = p;
       // Generate a new SACK block
       UpdateSackList (headSeq, tailSeq);
     }
-
-  NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
-  // Update variables
-  m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  else
     {
-      if (i->first < m_nextRxSeq)
+      // Append the packet, and the out-of-order segments it made contiguous,
+      // to the in-order data
+      if (m_inOrder.empty ())
         {
-          continue;
+          m_headSeq = headSeq;
         }
-      else if (i->first > m_nextRxSeq)
+      m_inOrder.push_back (p);
+      m_nextRxSeq = tailSeq;
+      m_availBytes += p->GetSize ();
+      for (i = m_data.begin (); i != m_data.end () && i->first == m_nextRxSeq; )
         {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+          m_inOrder.push_back (i->second);
+          m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+          m_availBytes += i->second->GetSize ();
+          m_data.erase (i++);
+        }
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -368,32 +380,40 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return nullptr;  // No contiguous block to return
-  NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
+  NS_ASSERT (!m_inOrder.empty ()); // At least we have something to extract
+  // The packet that contains all the data to return: the first in-order
+  // packet, to which the next ones are appended if needed
+  Ptr<Packet> outPkt;
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      Ptr<Packet> head = m_inOrder.front ();
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = head->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
-          m_size -= pktSize;
-          m_availBytes -= pktSize;
-          extractSize -= pktSize;
+          m_inOrder.pop_front ();
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
-          m_size -= extractSize;
-          m_availBytes -= extractSize;
-          extractSize = 0;
+          m_inOrder.front () = head->CreateFragment (extractSize, pktSize - extractSize);
+          head = head->CreateFragment (0, extractSize);
+          pktSize = extractSize;
+        }
+      if (outPkt == nullptr)
+        {
+          // The received packets are shared with the buffer; the tags of
+          // the lower layers are not returned to the application
+          outPkt = head->Copy ();
+          outPkt->RemoveAllPacketTags ();
+        }
+      else
+        {
+          outPkt->AddAtEnd (head);
         }
+      m_headSeq += pktSize;
+      m_size -= pktSize;
+      m_availBytes -= pktSize;
+      extractSize -= pktSize;
     }
   if (outPkt->GetSize () == 0)
     {
@@ -401,7 +421,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       return nullptr;
     }
   NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
-                             << ", num pkts in buffer=" << m_data.size ());
+                             << ", num pkts in buffer=" << m_inOrder.size () + m_data.size ());
   return outPkt;
 }
 
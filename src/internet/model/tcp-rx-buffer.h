@@ -22,6 +22,7 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -53,6 +54,12 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The in-order data, up to NextRxSequence, is kept apart from the
+ * out-of-order segments, as a queue of packets which Extract consumes from
+ * the head; the out-of-order segments are indexed by sequence number, so
+ * that Add only visits the segments which the new one overlaps, and moves
+ * them to the queue once the hole before them is filled.
+ *
  * SACK list
  * ---------
  *
@@ -217,7 +224,7 @@ private:
 
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
-  /// container for data stored in the buffer
+  /// container for the out-of-order data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
@@ -225,7 +232,9 @@ private:
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  SequenceNumber32 m_headSeq;                //!< Seqnum of the first byte in m_inOrder
+  std::deque<Ptr<Packet> > m_inOrder;        //!< Contiguous data, from m_headSeq up to RCV.NXT
+  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Out-of-order data, beyond RCV.NXT
 };
 
 } //namespace ns3
@@ -45,6 +45,7 @@
 #include "ns3/object.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
+#include "tcp-pacing-scheduler.h"
 #include "ipv4-end-point.h"
 #include "ipv6-end-point.h"
 #include "ipv6-l3-protocol.h"
@@ -259,7 +260,6 @@ TcpSocketBase::TcpSocketBase (void)
   m_tcb->m_rxBuffer = CreateObject<TcpRxBuffer> ();
 
   m_tcb->m_pacingRate = m_tcb->m_maxPacingRate;
-  m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
 
   m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
 
@@ -353,7 +353,6 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
-    m_pacingTimer (Timer::CANCEL_ON_DESTROY),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
     m_ecnCESeq (sock.m_ecnCESeq),
     m_ecnCWRSeq (sock.m_ecnCWRSeq)
@@ -379,7 +378,6 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   m_tcb->m_rxBuffer = CopyObject (sock.m_tcb->m_rxBuffer);
 
   m_tcb->m_pacingRate = m_tcb->m_maxPacingRate;
-  m_pacingTimer.SetFunction (&TcpSocketBase::NotifyPacingPerformed, this);
 
   if (sock.m_congestionControl)
     {
@@ -2770,7 +2768,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
   if (m_endPoint != nullptr)
     {
       m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), m_boundnetdevice);
+                         m_endPoint->GetPeerAddress (), m_boundnetdevice, &m_routeCache);
     }
   else
     {
@@ -3055,15 +3053,28 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   if (IsPacingEnabled ())
     {
       NS_LOG_INFO ("Pacing is enabled");
-      if (m_pacingTimer.IsExpired ())
+      if (m_pacingId == 0)
         {
           NS_LOG_DEBUG ("Current Pacing Rate " << m_tcb->m_pacingRate);
-          NS_LOG_DEBUG ("Timer is in expired state, activate it " << m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
-          m_pacingTimer.Schedule (m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
+          // The pacing scheduler may release the flow up to a slot after its
+          // departure time: count from that time rather than from now, as
+          // Linux does with earliest departure times, so that the next
+          // segments leave at once while their departure time has passed.
+          Time departure = m_pacingReleased ? m_pacingDeparture : Simulator::Now ();
+          departure += m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz);
+          NS_LOG_DEBUG ("No departure time set, the next segment departs at " << departure);
+          if (departure > Simulator::Now ())
+            {
+              SetEarliestDeparture (departure);
+            }
+          else
+            {
+              m_pacingDeparture = departure;
+            }
         }
       else
         {
-          NS_LOG_INFO ("Timer is already in running state");
+          NS_LOG_INFO ("Departure time already set");
         }
     }
   else
@@ -3134,7 +3145,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   if (m_endPoint)
     {
       m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), m_boundnetdevice);
+                         m_endPoint->GetPeerAddress (), m_boundnetdevice, &m_routeCache);
       NS_LOG_DEBUG ("Send segment of size " << sz << " with remaining data " <<
                     remainingData << " via TcpL4Protocol to " <<  m_endPoint->GetPeerAddress () <<
                     ". Header " << header);
@@ -3220,12 +3231,12 @@ TcpSocketBase::SendPendingData (bool withAck)
       if (IsPacingEnabled ())
         {
           NS_LOG_INFO ("Pacing is enabled");
-          if (m_pacingTimer.IsRunning ())
+          if (m_pacingId != 0)
             {
-              NS_LOG_INFO ("Skipping Packet due to pacing" << m_pacingTimer.GetDelayLeft ());
+              NS_LOG_INFO ("Skipping Packet due to pacing until " << m_pacingDeparture);
               break;
             }
-          NS_LOG_INFO ("Timer is not running");
+          NS_LOG_INFO ("No departure time set");
         }
 
       if (m_tcb->m_congState == TcpSocketState::CA_OPEN
@@ -3312,16 +3323,11 @@ TcpSocketBase::SendPendingData (bool withAck)
                         " size " << sz);
           m_tcb->m_nextTxSequence += sz;
           ++nPacketsSent;
-          if (IsPacingEnabled ())
+          if (IsPacingEnabled () && m_pacingId != 0)
             {
-              NS_LOG_INFO ("Pacing is enabled");
-              if (m_pacingTimer.IsExpired ())
-                {
-                  NS_LOG_DEBUG ("Current Pacing Rate " << m_tcb->m_pacingRate);
-                  NS_LOG_DEBUG ("Timer is in expired state, activate it " << m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
-                  m_pacingTimer.Schedule (m_tcb->m_pacingRate.Get ().CalculateBytesTxTime (sz));
-                  break;
-                }
+              // SendDataPacket set the departure time of the next segment
+              NS_LOG_INFO ("Hold the next segment until " << m_pacingDeparture);
+              break;
             }
         }
 
@@ -3732,7 +3738,7 @@ TcpSocketBase::ReTxTimeout ()
   m_tcb->m_cWnd = m_tcb->m_segmentSize;
   m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
-  m_pacingTimer.Cancel ();
+  CancelPacing ();
 
   NS_LOG_DEBUG ("RTO. Reset cwnd to " <<  m_tcb->m_cWnd << ", ssthresh to " <<
                 m_tcb->m_ssThresh << ", restart from seqnum " <<
@@ -3829,7 +3835,7 @@ TcpSocketBase::PersistTimeout ()
   if (m_endPoint != nullptr)
     {
       m_tcp->SendPacket (p, tcpHeader, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), m_boundnetdevice);
+                         m_endPoint->GetPeerAddress (), m_boundnetdevice, &m_routeCache);
     }
   else
     {
@@ -3887,7 +3893,7 @@ TcpSocketBase::CancelAllTimers ()
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
-  m_pacingTimer.Cancel ();
+  CancelPacing ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -4447,8 +4453,39 @@ void
 TcpSocketBase::NotifyPacingPerformed (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_pacingId == 0)
+    {
+      // Released after CancelPacing lost track of the scheduler
+      return;
+    }
+  m_pacingId = 0;
   NS_LOG_INFO ("Performing Pacing");
+  m_pacingReleased = true;
   SendPendingData (m_connected);
+  m_pacingReleased = false;
+}
+
+void
+TcpSocketBase::SetEarliestDeparture (Time departure)
+{
+  NS_LOG_FUNCTION (this << departure);
+  NS_ASSERT (m_tcp != nullptr);
+  CancelPacing ();
+  m_pacingDeparture = departure;
+  m_pacingId = m_tcp->GetPacingScheduler ()->Schedule (departure,
+                                                        MakeCallback (&TcpSocketBase::NotifyPacingPerformed,
+                                                                      Ptr<TcpSocketBase> (this)));
+}
+
+void
+TcpSocketBase::CancelPacing (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_pacingId != 0 && m_tcp != nullptr && m_tcp->GetPacingScheduler () != nullptr)
+    {
+      m_tcp->GetPacingScheduler ()->Cancel (m_pacingId);
+    }
+  m_pacingId = 0;
 }
 
 bool
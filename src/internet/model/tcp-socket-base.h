@@ -28,6 +28,7 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/timer.h"
+#include "ns3/ipv4-route-cache.h"
 #include "ns3/sequence-number.h"
 #include "ns3/data-rate.h"
 #include "ns3/node.h"
@@ -1210,6 +1211,21 @@ protected:
    */
   void NotifyPacingPerformed (void);
 
+  /**
+   * \brief Hold the transmissions until a departure time
+   *
+   * The pacing scheduler of the node calls NotifyPacingPerformed at the
+   * departure time, or a little later if it releases the flows in slots.
+   *
+   * \param departure the earliest departure time of the next segment
+   */
+  void SetEarliestDeparture (Time departure);
+
+  /**
+   * \brief Allow the next segment to leave immediately
+   */
+  void CancelPacing (void);
+
   /**
    * \brief Return true if packets in the current window should be paced
    * \return true if pacing is currently enabled
@@ -1340,8 +1356,12 @@ protected:
   TracedCallback<Ptr<const Packet>, const TcpHeader&,
                  Ptr<const TcpSocketBase> > m_rxTrace; //!< Trace of received packets
 
-  // Pacing related variable
-  Timer m_pacingTimer {Timer::CANCEL_ON_DESTROY}; //!< Pacing Event
+  Ipv4RouteCache m_routeCache; //!< Route of the flow over IPv4
+
+  // Pacing related variables
+  uint64_t m_pacingId {0};  //!< Release pending in the pacing scheduler, or 0
+  Time m_pacingDeparture;   //!< Earliest departure time of the next paced segment
+  bool m_pacingReleased {false}; //!< The pacing scheduler released the flow
 
   // Parameters related to Explicit Congestion Notification
   TracedValue<SequenceNumber32> m_ecnEchoSeq {0};      //!< Sequence number of the last received ECN Echo
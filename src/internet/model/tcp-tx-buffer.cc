@@ -58,7 +58,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostScan (n), m_lostHigh (n), m_nextSegHint (n)
 {
   m_rWndCallback = MakeNullCallback<uint32_t> ();
 }
@@ -173,7 +174,8 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+  ResetScoreboardHints ();
 }
 
 bool
@@ -310,13 +312,13 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
+  auto it = m_sentList.begin () + FindSentIndex (seq);
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  if (it != m_sentList.end ())
     {
       if ((*it)->m_startSeq == seq)
         {
@@ -339,7 +341,6 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
             {
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
         }
     }
 
@@ -354,21 +355,21 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   return item;
 }
 
-std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
+std::pair <TcpTxItem *, SequenceNumber32>
 TcpTxBuffer::FindHighestSacked () const
 {
   NS_LOG_FUNCTION (this);
 
   SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
 
-  auto ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  std::pair <TcpTxItem *, SequenceNumber32> ret = std::make_pair (nullptr, SequenceNumber32 (0));
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
-      const TcpTxItem *item = *it;
+      TcpTxItem *item = *it;
       if (item->m_sacked)
         {
-          ret = std::make_pair (it, beginOfCurrentPacket);
+          ret = std::make_pair (item, beginOfCurrentPacket);
         }
       beginOfCurrentPacket += item->m_packet->GetSize ();
     }
@@ -376,6 +377,37 @@ TcpTxBuffer::FindHighestSacked () const
   return ret;
 }
 
+std::size_t
+TcpTxBuffer::FindSentIndex (const SequenceNumber32 &seq) const
+{
+  // The sent items are contiguous and sorted by sequence number
+  PacketList::const_iterator it = std::upper_bound (m_sentList.begin (), m_sentList.end (), seq,
+                                                    [] (const SequenceNumber32 &s, const TcpTxItem *item)
+                                                    {
+                                                      return s < item->m_startSeq;
+                                                    });
+  if (it != m_sentList.begin ())
+    {
+      const TcpTxItem *previous = *(it - 1);
+      if (seq < previous->m_startSeq + previous->m_packet->GetSize ())
+        {
+          --it;
+        }
+    }
+  return it - m_sentList.begin ();
+}
+
+void
+TcpTxBuffer::ResetScoreboardHints ()
+{
+  NS_LOG_FUNCTION (this);
+  m_lostScan = m_firstByteSeq;
+  m_nextSegHint = m_firstByteSeq;
+  if (m_lostHigh < m_firstByteSeq)
+    {
+      m_lostHigh = m_firstByteSeq;
+    }
+}
 
 void
 TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
@@ -437,11 +469,22 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+  if (&list == &m_sentList)
+    {
+      // Start from the item which contains seq, instead of walking the
+      // items before it
+      it += FindSentIndex (seq);
+      if (it != list.end ())
+        {
+          beginOfCurrentPacket = (*it)->m_startSeq;
+        }
+    }
+
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (&list != &m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -604,6 +647,7 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
         {
           TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
           self->m_retrans -= t1->m_packet->GetSize ();
+          self->m_nextSegHint = m_firstByteSeq;
           t1->m_retrans = false;
         }
       else
@@ -611,6 +655,7 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
           NS_ASSERT (t2->m_retrans);
           TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
           self->m_retrans -= t2->m_packet->GetSize ();
+          self->m_nextSegHint = m_firstByteSeq;
           t2->m_retrans = false;
         }
     }
@@ -651,15 +696,17 @@ bool
 TcpTxBuffer::IsRetransmittedDataAcked (const SequenceNumber32& ack) const
 {
   NS_LOG_FUNCTION (this);
-  for (const auto &it : m_sentList)
-     {
-       TcpTxItem *item = it;
-       Ptr<Packet> p = item->m_packet;
-       if (item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans)
-         {
-           return true;
-         }
-     }
+  // Only the item which ends at ack can match
+  std::size_t index = FindSentIndex (ack - 1);
+  if (index < m_sentList.size ())
+    {
+      TcpTxItem *item = m_sentList[index];
+      Ptr<Packet> p = item->m_packet;
+      if (item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans)
+        {
+          return true;
+        }
+    }
   return false;
 }
 
@@ -769,7 +816,19 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
 
   if (m_highestSack.second <= m_firstByteSeq)
     {
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+    }
+  if (m_lostScan < m_firstByteSeq)
+    {
+      m_lostScan = m_firstByteSeq;
+    }
+  if (m_lostHigh < m_firstByteSeq)
+    {
+      m_lostHigh = m_firstByteSeq;
+    }
+  if (m_nextSegHint < m_firstByteSeq)
+    {
+      m_nextSegHint = m_firstByteSeq;
     }
 
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
@@ -791,15 +850,21 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return bytesSacked;
         }
 
+      // The items before the one which contains the start of the block
+      // cannot be covered by it
+      PacketList::iterator item_it = m_sentList.begin () + FindSentIndex ((*option_it).first);
+      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq + m_sentSize;
+      if (item_it != m_sentList.end ())
+        {
+          beginOfCurrentPacket = (*item_it)->m_startSeq;
+        }
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
@@ -831,10 +896,10 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
                   bytesSacked += (*item_it)->m_packet->GetSize ();
 
-                  if (m_highestSack.first == m_sentList.end()
+                  if (m_highestSack.first == nullptr
                       || m_highestSack.second <= beginOfCurrentPacket + pktSize)
                     {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
+                      m_highestSack = std::make_pair (*item_it, beginOfCurrentPacket);
                     }
 
                   NS_LOG_INFO ("Received block " << *option_it <<
@@ -864,7 +929,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   if (bytesSacked > 0)
     {
-      NS_ASSERT_MSG (m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
+      NS_ASSERT_MSG (m_highestSack.first != nullptr, "Buffer status: " << *this);
       UpdateLostCount ();
     }
 
@@ -880,47 +945,55 @@ void
 TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
-  uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
+  if (m_highestSack.first == nullptr)
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
+                   ", no sacked item");
+      return;
     }
-
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  NS_LOG_INFO ("Status before the update: " << *this <<
+               ", will start from item " << *m_highestSack.first);
+
+  // Walk down from the highest sacked item to the dupAckThresh-th sacked
+  // item; all the items below it are lost, unless sacked. The head is never
+  // counted. The items before m_lostScan have already been marked, so the
+  // walk can stop there.
+  std::size_t threshold = FindSentIndex (m_highestSack.first->m_startSeq);
+  NS_ASSERT (threshold < m_sentList.size () && m_sentList[threshold] == m_highestSack.first);
+  uint32_t sacked = 0;
+  for (;;)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
+      if (threshold == 0 || m_sentList[threshold]->m_startSeq < m_lostScan)
+        {
+          NS_LOG_INFO ("No new lost item, status: " << *this);
+          return;
+        }
+      if (m_sentList[threshold]->m_sacked)
         {
           sacked++;
         }
-
       if (sacked >= m_dupAckThresh)
         {
-          if (!item->m_sacked && !item->m_lost)
-            {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
-            }
+          break;
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      --threshold;
     }
 
-  if (sacked >= m_dupAckThresh)
+  for (std::size_t i = FindSentIndex (m_lostScan); i < threshold; ++i)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
+      TcpTxItem *item = m_sentList[i];
+      if (!item->m_sacked && !item->m_lost)
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
         }
     }
+  m_lostScan = m_sentList[threshold]->m_startSeq;
+  if (m_lostHigh < m_lostScan)
+    {
+      m_lostHigh = m_lostScan;
+    }
+
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
 }
@@ -930,17 +1003,20 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Start from the item which contains seq
+  PacketList::const_iterator it = m_sentList.begin () + FindSentIndex (seq);
+  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq + m_sentSize;
+  if (it != m_sentList.end ())
+    {
+      beginOfCurrentPacket = (*it)->m_startSeq;
+    }
+
+  for (; it != m_sentList.end (); ++it)
     {
       // Search for the right iterator before calling IsLost()
       if (beginOfCurrentPacket >= seq)
@@ -982,19 +1058,39 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
   TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  bool isHintFound = false;
+
+  // The items before m_nextSegHint are retransmitted or sacked, and those
+  // from m_lostHigh on are not lost: after the first candidate for rule (3),
+  // the walk can stop at m_lostHigh.
+  std::size_t i = FindSentIndex (m_nextSegHint);
+  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq + m_sentSize;
+  if (i < m_sentList.size ())
+    {
+      beginOfCurrentPkt = m_sentList[i]->m_startSeq;
+    }
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (; i < m_sentList.size (); ++i)
     {
-      item = *it;
+      item = m_sentList[i];
+
+      if (isHintFound && beginOfCurrentPkt >= m_lostHigh
+          && (!isRecovery || seqPerRule3.GetValue () != 0))
+        {
+          break;
+        }
 
       // Condition 1.a , 1.b , and 1.c
       if (item->m_retrans == false && item->m_sacked == false)
         {
+          if (!isHintFound)
+            {
+              isHintFound = true;
+              m_nextSegHint = beginOfCurrentPkt;
+            }
           if (item->m_lost)
             {
               NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
@@ -1013,6 +1109,10 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
       // Nothing found, iterate
       beginOfCurrentPkt += item->m_packet->GetSize ();
     }
+  if (!isHintFound)
+    {
+      m_nextSegHint = m_firstByteSeq + m_sentSize;
+    }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
    *     exists available unsent data and the receiver's advertised
@@ -1206,7 +1306,7 @@ TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_ite
 
       beginOfCurrentPacket += current->GetSize ();
     }
-  if (it == m_highestSack.first)
+  if (m_highestSack.first == nullptr)
     {
       NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead " << m_highestSack.second);
     }
@@ -1224,7 +1324,8 @@ TcpTxBuffer::ResetRenoSack ()
       (*it)->m_sacked = false;
     }
 
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+  ResetScoreboardHints ();
 }
 
 void
@@ -1253,7 +1354,9 @@ TcpTxBuffer::ResetSentList ()
   m_lostOut = 0;
   m_retrans = 0;
   m_sackedOut = 0;
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
+  m_lostHigh = m_firstByteSeq;
+  ResetScoreboardHints ();
 }
 
 void
@@ -1270,7 +1373,22 @@ TcpTxBuffer::ResetLastSegmentSent ()
         {
           m_retrans -= item->m_packet->GetSize ();
         }
+      if (m_highestSack.first == item)
+        {
+          m_highestSack = FindHighestSacked ();
+        }
       m_appList.insert (m_appList.begin (), item);
+
+      // The item may come back with other flags
+      SequenceNumber32 sentEnd = m_firstByteSeq + m_sentSize;
+      if (m_lostScan > sentEnd)
+        {
+          m_lostScan = sentEnd;
+        }
+      if (m_nextSegHint > sentEnd)
+        {
+          m_nextSegHint = sentEnd;
+        }
     }
   ConsistencyCheck ();
 }
@@ -1285,7 +1403,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
     {
       m_sackedOut = 0;
       m_lostOut = m_sentSize;
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_highestSack = std::make_pair (nullptr, SequenceNumber32 (0));
     }
   else
     {
@@ -1317,6 +1435,11 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       (*it)->m_retrans = false;
     }
 
+  // Every item is now lost or sacked, and none is retransmitted
+  ResetScoreboardHints ();
+  m_lostScan = m_firstByteSeq + m_sentSize;
+  m_lostHigh = m_lostScan;
+
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   ConsistencyCheck ();
@@ -1349,6 +1472,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      m_nextSegHint = m_firstByteSeq;
     }
   ConsistencyCheck ();
 }
@@ -1378,6 +1502,13 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      m_nextSegHint = m_firstByteSeq;
+      SequenceNumber32 headEnd = m_firstByteSeq + m_sentList.front ()->m_packet->GetSize ();
+      if (m_lostHigh < headEnd)
+        {
+          m_lostHigh = headEnd;
+        }
     }
   ConsistencyCheck ();
 }
@@ -1412,7 +1543,7 @@ TcpTxBuffer::AddRenoSack (void)
     {
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
-      m_highestSack = std::make_pair (it, (*it)->m_startSeq);
+      m_highestSack = std::make_pair (*it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
   else
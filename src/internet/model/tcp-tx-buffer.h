@@ -28,6 +28,8 @@
 #include "ns3/tcp-option-sack.h"
 #include "ns3/tcp-tx-item.h"
 
+#include <deque>
+
 namespace ns3 {
 class Packet;
 
@@ -55,6 +57,13 @@ class Packet;
  * are not transmitted yet as segments. To discover how the chunks are managed
  * and retrieved from these lists, check CopyFromSequence documentation.
  *
+ * Both lists are double-ended queues of items, used as rings: segments are
+ * sent from the front of the AppList to the back of the SentList, and
+ * acknowledged from the front of the SentList. The items of the SentList
+ * are contiguous and sorted by their starting sequence number, so that the
+ * segment which holds a sequence number is found by a binary search instead
+ * of a walk from SND.UNA.
+ *
  * The head of the data is represented by m_firstByteSeq, and it is returned by
  * HeadSequence(). The last byte is returned by TailSequence(). In this class,
  * we also store the size (in bytes) of the packets inside the SentList in the
@@ -73,6 +82,15 @@ class Packet;
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * The flags of the items form the scoreboard; instead of walking it on
+ * every ACK, the buffer keeps three watermarks over it. All the items
+ * before m_lostScan are lost or sacked, so that UpdateLostCount only marks
+ * the items past the previous update. All the items before m_nextSegHint
+ * are retransmitted or sacked, and no item at or after m_lostHigh is lost,
+ * so that NextSeg only looks at the part of the scoreboard where it may
+ * find a segment to retransmit. The operations which clear the flags
+ * bring the watermarks back to SND.UNA.
+ *
  * Item properties
  * ---------------
  *
@@ -410,7 +428,7 @@ public:
 private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
-  typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::deque<TcpTxItem*> PacketList; //!< container for data stored in the buffer
 
   /**
    * \brief Update the lost count
@@ -427,12 +445,31 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. It walks down from the highest sacked item
+   * until it finds the "Dupack thresh"-th sacked one, and marks the items
+   * below it up to m_lostScan, which have been marked by the previous updates.
    *
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Find an item of the sent list by sequence number
+   *
+   * \param seq the sequence number
+   * \return the index of the sent item which contains seq, or of the first
+   * item after seq if none contains it (the size of the list if seq is after
+   * all the sent items)
+   */
+  std::size_t FindSentIndex (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Bring the scoreboard watermarks back to SND.UNA
+   *
+   * Called by the operations which clear the lost, sacked or retransmitted
+   * flags of the sent items.
+   */
+  void ResetScoreboardHints ();
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -595,9 +632,9 @@ private:
 
   /**
    * \brief Find the highest SACK byte
-   * \return a pair with the highest byte and an iterator inside m_sentList
+   * \return a pair with the highest sacked item of m_sentList and its sequence
    */
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
+  std::pair <TcpTxItem *, SequenceNumber32>
   FindHighestSacked () const;
 
   PacketList m_appList;  //!< Buffer for application data
@@ -608,7 +645,11 @@ private:
   Callback<uint32_t> m_rWndCallback; //!< Callback to obtain RCV.WND value
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  std::pair <TcpTxItem *, SequenceNumber32> m_highestSack {nullptr, SequenceNumber32 (0)}; //!< Highest SACK item (or nullptr) and its sequence
+
+  SequenceNumber32 m_lostScan;             //!< All the sent items before it are lost or sacked
+  SequenceNumber32 m_lostHigh;             //!< No sent item at or after it is lost
+  mutable SequenceNumber32 m_nextSegHint;  //!< All the sent items before it are retransmitted or sacked
 
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
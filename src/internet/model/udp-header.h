@@ -185,6 +185,15 @@ private:
   bool m_goodChecksum;        //!< Flag to indicate that checksum is correct
 };
 
+/**
+ * \brief UdpHeader is always 8 bytes long.
+ */
+template <>
+struct FixedSizeHeader<UdpHeader>
+{
+  static const uint32_t SIZE = 8; //!< The serialized size
+};
+
 } // namespace ns3
 
 #endif /* UDP_HEADER */
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/simple-net-device.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux Test: lookups and ephemeral ports
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the lookups and port allocations of Ipv4EndPointDemux")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<Ipv4Interface> iface = CreateObject<Ipv4Interface> ();
+  iface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+  Ipv4Address local ("10.0.0.1");
+  Ipv4EndPoint *any = demux.Allocate (0, 80);
+  Ipv4EndPoint *listener = demux.Allocate (0, local, 80);
+  Ipv4EndPoint *connected = demux.Allocate (0, local, 80, Ipv4Address ("10.0.0.2"), 1000);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "Connected end point not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, Ipv4Address ("10.0.0.2"), 1000), 0, "Duplicated end point allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80), 0, "Duplicated listener allocated");
+
+  Ipv4EndPointDemux::EndPoints found = demux.Lookup (local, 80, Ipv4Address ("10.0.0.2"), 1000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No exact match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connected, "Wrong exact match");
+  found = demux.Lookup (local, 80, Ipv4Address ("10.0.0.3"), 1000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No listener match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "Wrong listener match");
+  found = demux.Lookup (Ipv4Address ("10.0.0.255"), 80, Ipv4Address ("10.0.0.3"), 1000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), any, "Wrong wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, Ipv4Address ("10.0.0.2"), 1000), connected, "Wrong simple lookup");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 81, Ipv4Address ("10.0.0.2"), 1000), 0, "Simple lookup on an unused port");
+
+  // The end points are found under their new four-tuple
+  listener->SetPeer (Ipv4Address ("10.0.0.4"), 2000);
+  found = demux.Lookup (local, 80, Ipv4Address ("10.0.0.4"), 2000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "End point not found after SetPeer");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "Wrong end point after SetPeer");
+  found = demux.Lookup (local, 80, Ipv4Address ("10.0.0.3"), 1000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), any, "End point found under its old four-tuple");
+
+  demux.DeAllocate (connected);
+  found = demux.Lookup (local, 80, Ipv4Address ("10.0.0.2"), 1000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), any, "Deallocated end point found");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 2, "Wrong number of end points");
+
+  // Ephemeral ports count up from the last one, skipping the ports in use
+  NS_TEST_ASSERT_MSG_NE (demux.Allocate (0, local, 49155), 0, "Listener not allocated");
+  for (uint16_t port = 49153; port < 49159; port++)
+    {
+      if (port == 49155)
+        {
+          continue;
+        }
+      Ipv4EndPoint *endPoint = demux.Allocate ();
+      NS_TEST_ASSERT_MSG_NE (endPoint, 0, "Ephemeral port not allocated");
+      NS_TEST_EXPECT_MSG_EQ (endPoint->GetLocalPort (), port, "Wrong ephemeral port");
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (49157), true, "Ephemeral port not in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (49159), false, "Free port in use");
+
+  // The end points bound to Any and to the subnet match a subnet-directed
+  // broadcast with the same precedence: the one bound to another device
+  // is skipped, whichever wildcard it is bound to.
+  Ptr<NetDevice> device = CreateObject<SimpleNetDevice> ();
+  Ptr<NetDevice> otherDevice = CreateObject<SimpleNetDevice> ();
+  iface->SetDevice (device);
+  Ipv4EndPoint *anyOther = demux.Allocate (0, 90);
+  anyOther->BindToNetDevice (otherDevice);
+  Ipv4EndPoint *subnet = demux.Allocate (0, Ipv4Address ("10.0.0.0"), 90);
+  found = demux.Lookup (Ipv4Address ("10.0.0.255"), 90, Ipv4Address ("10.0.0.3"), 1000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No subnet match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), subnet, "Wrong subnet match");
+  anyOther->BindToNetDevice (device);
+  subnet->BindToNetDevice (otherDevice);
+  found = demux.Lookup (Ipv4Address ("10.0.0.255"), 90, Ipv4Address ("10.0.0.3"), 1000, iface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), anyOther, "Wrong wildcard match");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux Test: lookups and ephemeral ports
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the lookups and port allocations of Ipv6EndPointDemux")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ipv6Address local ("2001:db8::1");
+  Ipv6Address peer ("2001:db8::2");
+  Ipv6EndPoint *any = demux.Allocate (0, 80);
+  Ipv6EndPoint *connected = demux.Allocate (0, local, 80, peer, 1000);
+  NS_TEST_ASSERT_MSG_NE (connected, 0, "Connected end point not allocated");
+
+  Ipv6EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No exact match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connected, "Wrong exact match");
+  found = demux.Lookup (local, 80, peer, 1001, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), any, "Wrong wildcard match");
+
+  // The end points are found under their new four-tuple
+  connected->SetLocalPort (81);
+  found = demux.Lookup (local, 81, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "End point not found after SetLocalPort");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connected, "Wrong end point after SetLocalPort");
+  found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "No wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), any, "End point found under its old four-tuple");
+
+  demux.DeAllocate (connected);
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, 81, peer, 1000, 0).size (), 0, "Deallocated end point found");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (81), false, "Port of a deallocated end point in use");
+
+  // Ephemeral ports count up from the last one, skipping the ports in use
+  NS_TEST_ASSERT_MSG_NE (demux.Allocate (0, local, 49154), 0, "Listener not allocated");
+  Ipv6EndPoint *first = demux.Allocate ();
+  Ipv6EndPoint *second = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (second, 0, "Ephemeral port not allocated");
+  NS_TEST_EXPECT_MSG_EQ (first->GetLocalPort (), 49153, "Wrong ephemeral port");
+  NS_TEST_EXPECT_MSG_EQ (second->GetLocalPort (), 49155, "Port in use allocated");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demultiplexer TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
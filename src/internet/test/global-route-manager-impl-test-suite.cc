@@ -65,13 +65,36 @@ GlobalRouteManagerImplTestCase::DoRun (void)
       candidate.Push (v);
     }
 
+  uint32_t lastDistance = 0;
   for (int i = 0; i < 100; ++i)
     {
       SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ ((v->GetDistanceFromRoot () >= lastDistance), true,
+                             "Vertices not popped in order of distance");
+      lastDistance = v->GetDistanceFromRoot ();
       delete v;
       v = 0;
     }
 
+  // Vertices at the same distance are popped in the order they were
+  // pushed, or had their distance decreased, in.
+  SPFVertex *vertices[4];
+  for (int i = 0; i < 4; ++i)
+    {
+      vertices[i] = new SPFVertex;
+      vertices[i]->SetDistanceFromRoot (i < 2 ? 10 : 20);
+      candidate.Push (vertices[i]);
+    }
+  vertices[3]->SetDistanceFromRoot (10);
+  candidate.DecreaseKey (vertices[3]);
+  SPFVertex *order[4] = { vertices[0], vertices[1], vertices[3], vertices[2] };
+  for (int i = 0; i < 4; ++i)
+    {
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_EXPECT_MSG_EQ (v, order[i], "Bad order of the vertex popped at " << i);
+      delete v;
+    }
+
   // Build fake link state database; four routers (0-3), 3 point-to-point
   // links
   //
@@ -14,6 +14,8 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
@@ -41,7 +43,10 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -1244,6 +1249,194 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental update test
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  /**
+   * \param lan whether to run on the topology with broadcast links
+   */
+  Ipv4GlobalRoutingUpdateTestCase (bool lan);
+
+private:
+  virtual void DoRun (void);
+  bool m_lan; //!< Whether to run on the topology with broadcast links
+  /**
+   * \param nodes the nodes
+   * \returns the global routes of each node, sorted
+   */
+  static std::vector<std::vector<std::string> > GetRoutes (NodeContainer nodes);
+  /**
+   * \param nodes the nodes
+   * \returns the route which each node uses towards each address of the
+   * nodes, which depends on the order of the routes which match it
+   */
+  static std::vector<std::vector<std::string> > GetForwarding (NodeContainer nodes);
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase (bool lan)
+  : TestCase (std::string ("Incremental updates of the global routes match a full recomputation, ")
+              + (lan ? "broadcast links" : "point-to-point links")),
+    m_lan (lan)
+{
+}
+
+std::vector<std::vector<std::string> >
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::vector<std::vector<std::string> > routes;
+  for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); n++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = (*n)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::string> table;
+      for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+        {
+          std::ostringstream route;
+          route << *routing->GetRoute (i);
+          table.push_back (route.str ());
+        }
+      std::sort (table.begin (), table.end ());
+      routes.push_back (table);
+    }
+  return routes;
+}
+
+std::vector<std::vector<std::string> >
+Ipv4GlobalRoutingUpdateTestCase::GetForwarding (NodeContainer nodes)
+{
+  std::vector<Ipv4Address> destinations;
+  for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); n++)
+    {
+      Ptr<Ipv4> ipv4 = (*n)->GetObject<Ipv4> ();
+      for (uint32_t i = 1; i < ipv4->GetNInterfaces (); i++)
+        {
+          destinations.push_back (ipv4->GetAddress (i, 0).GetLocal ());
+        }
+    }
+  std::vector<std::vector<std::string> > forwarding;
+  for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); n++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = (*n)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::string> table;
+      for (std::vector<Ipv4Address>::const_iterator d = destinations.begin (); d != destinations.end (); d++)
+        {
+          Ipv4Header header;
+          header.SetDestination (*d);
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+          std::ostringstream oss;
+          oss << *d << " ";
+          if (route)
+            {
+              oss << route->GetGateway () << " " << route->GetOutputDevice ()->GetIfIndex ();
+            }
+          table.push_back (oss.str ());
+        }
+      forwarding.push_back (table);
+    }
+  return forwarding;
+}
+
+// Without broadcast links, a 3x3 grid of routers n0-n8 on point-to-point
+// links, and a stub router n9 attached to n4.  With broadcast links, a tree
+// of LANs and point-to-point links, since SPFNexthopCalculation does not
+// handle equal cost paths through a LAN which is not adjacent to the root:
+//
+//  n0 -- n1 ==LAN== n2, n3;  n3 -- n4 ==LAN== n5, n6;  n6 -- n7;  n2 -- n8
+//
+// Random interfaces go down and up or get another metric, the routes are
+// updated with UpdateRoutingTables, and every few changes compared with
+// those which RecomputeRoutingTables finds.
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (m_lan ? 9 : 10);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2p;
+  p2p.SetNetDevicePointToPointMode (true);
+  SimpleNetDeviceHelper lan;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.255.252");
+  uint32_t gridLinks[][2] = { {0, 1}, {1, 2}, {3, 4}, {4, 5}, {6, 7}, {7, 8},
+                              {0, 3}, {3, 6}, {1, 4}, {4, 7}, {2, 5}, {5, 8}, {4, 9} };
+  uint32_t treeLinks[][2] = { {0, 1}, {3, 4}, {6, 7}, {2, 8} };
+  uint32_t nLinks = m_lan ? sizeof (treeLinks) / sizeof (treeLinks[0]) : sizeof (gridLinks) / sizeof (gridLinks[0]);
+  for (uint32_t i = 0; i < nLinks; i++)
+    {
+      uint32_t *link = m_lan ? treeLinks[i] : gridLinks[i];
+      address.Assign (p2p.Install (NodeContainer (nodes.Get (link[0]), nodes.Get (link[1]))));
+      address.NewNetwork ();
+    }
+  if (m_lan)
+    {
+      address.SetBase ("10.2.1.0", "255.255.255.0");
+      address.Assign (lan.Install (NodeContainer (nodes.Get (1), nodes.Get (2), nodes.Get (3))));
+      address.SetBase ("10.2.2.0", "255.255.255.0");
+      address.Assign (lan.Install (NodeContainer (nodes.Get (4), nodes.Get (5), nodes.Get (6))));
+    }
+
+  std::vector<std::pair<Ptr<Ipv4>, uint32_t> > interfaces;
+  for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); n++)
+    {
+      Ptr<Ipv4> ipv4 = (*n)->GetObject<Ipv4> ();
+      for (uint32_t i = 1; i < ipv4->GetNInterfaces (); i++)
+        {
+          ipv4->SetMetric (i, 1 + (*n)->GetId () % 3);
+          interfaces.push_back (std::make_pair (ipv4, i));
+        }
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  for (uint32_t step = 1; step <= 60; step++)
+    {
+      std::pair<Ptr<Ipv4>, uint32_t> changed = interfaces[random->GetInteger (0, interfaces.size () - 1)];
+      Ptr<Ipv4> ipv4 = changed.first;
+      if (random->GetInteger (0, 2) == 0)
+        {
+          ipv4->SetMetric (changed.second, random->GetInteger (1, 4));
+        }
+      else if (ipv4->IsUp (changed.second))
+        {
+          ipv4->SetDown (changed.second);
+        }
+      else
+        {
+          ipv4->SetUp (changed.second);
+        }
+      Ipv4InterfaceContainer container;
+      container.Add (ipv4, changed.second);
+      Ipv4GlobalRoutingHelper::UpdateRoutingTables (container);
+
+      if (step % 3 == 0)
+        {
+          std::vector<std::vector<std::string> > updated = GetRoutes (nodes);
+          std::vector<std::vector<std::string> > updatedForwarding = GetForwarding (nodes);
+          Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+          std::vector<std::vector<std::string> > recomputed = GetRoutes (nodes);
+          std::vector<std::vector<std::string> > recomputedForwarding = GetForwarding (nodes);
+          for (uint32_t n = 0; n < nodes.GetN (); n++)
+            {
+              NS_TEST_EXPECT_MSG_EQ ((updated[n] == recomputed[n]), true,
+                                     "Routes of node " << n << " differ after step " << step);
+              NS_TEST_EXPECT_MSG_EQ ((updatedForwarding[n] == recomputedForwarding[n]), true,
+                                     "Forwarding of node " << n << " differs after step " << step);
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1460,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (false), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (true), TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
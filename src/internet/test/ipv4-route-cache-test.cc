@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-route-cache.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteCache Test: routes kept until the routing changes
+ */
+class Ipv4RouteCacheTestCase : public TestCase
+{
+public:
+  Ipv4RouteCacheTestCase ();
+  virtual void DoRun (void);
+};
+
+Ipv4RouteCacheTestCase::Ipv4RouteCacheTestCase ()
+  : TestCase ("Check that Ipv4RouteCache keeps the routes of a flow until the routing changes")
+{
+}
+
+void
+Ipv4RouteCacheTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  NodeContainer peers (2);
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer devices = simpleHelper.Install (NodeContainer (node, peers.Get (0)));
+  devices.Add (simpleHelper.Install (NodeContainer (node, peers.Get (1))));
+
+  InternetStackHelper internet;
+  internet.Install (node);
+  internet.Install (peers);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.0");
+  address.Assign (NetDeviceContainer (devices.Get (0), devices.Get (1)));
+  address.SetBase ("10.0.1.0", "255.255.255.0");
+  address.Assign (NetDeviceContainer (devices.Get (2), devices.Get (3)));
+
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ptr<Ipv4RoutingProtocol> routing = ipv4->GetRoutingProtocol ();
+  NS_TEST_ASSERT_MSG_NE (routing->GetRouteGeneration (), 0, "Static and global routes not cacheable");
+
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.0.0.1"));
+  header.SetDestination (Ipv4Address ("10.0.0.2"));
+  Socket::SocketErrno sockerr;
+  Ipv4RouteCache cache;
+  Ptr<Ipv4Route> route = cache.RouteOutput (routing, 0, header, 0, sockerr);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), devices.Get (0), "Wrong route");
+  NS_TEST_EXPECT_MSG_EQ (cache.RouteOutput (routing, 0, header, 0, sockerr), route, "Route not cached");
+  NS_TEST_EXPECT_MSG_EQ (sockerr, Socket::ERROR_NOTERROR, "Error with a cached route");
+  NS_TEST_EXPECT_MSG_NE (cache.RouteOutput (routing, 0, header, devices.Get (2), sockerr), route,
+                         "Route cached for another output device");
+
+  // A new route is found once the table changes
+  route = cache.RouteOutput (routing, 0, header, 0, sockerr);
+  Ipv4StaticRoutingHelper staticHelper;
+  staticHelper.GetStaticRouting (ipv4)->AddHostRouteTo (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.1.2"), 2);
+  Ptr<Ipv4Route> newRoute = cache.RouteOutput (routing, 0, header, 0, sockerr);
+  NS_TEST_ASSERT_MSG_NE (newRoute, 0, "No route");
+  NS_TEST_EXPECT_MSG_EQ (newRoute->GetOutputDevice (), devices.Get (2), "Cached route used after a table change");
+
+  // and once an interface goes down
+  ipv4->SetDown (2);
+  newRoute = cache.RouteOutput (routing, 0, header, 0, sockerr);
+  NS_TEST_ASSERT_MSG_NE (newRoute, 0, "No route");
+  NS_TEST_EXPECT_MSG_EQ (newRoute->GetOutputDevice (), devices.Get (0), "Cached route used after an interface change");
+
+  // Routes randomly spread over ECMP are not cached
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (routing);
+  NS_TEST_ASSERT_MSG_NE (list, 0, "No list routing");
+  for (uint32_t i = 0; i < list->GetNRoutingProtocols (); i++)
+    {
+      int16_t priority;
+      Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+      if (global != 0)
+        {
+          global->SetAttribute ("RandomEcmpRouting", BooleanValue (true));
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (routing->GetRouteGeneration (), 0, "Random ECMP routes cacheable");
+  route = cache.RouteOutput (routing, 0, header, 0, sockerr);
+  NS_TEST_EXPECT_MSG_NE (cache.RouteOutput (routing, 0, header, 0, sockerr), route, "Random ECMP route cached");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteCache TestSuite
+ */
+class Ipv4RouteCacheTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteCacheTestSuite ();
+};
+
+Ipv4RouteCacheTestSuite::Ipv4RouteCacheTestSuite ()
+  : TestSuite ("ipv4-route-cache", UNIT)
+{
+  AddTestCase (new Ipv4RouteCacheTestCase (), TestCase::QUICK);
+}
+
+static Ipv4RouteCacheTestSuite g_ipv4RouteCacheTestSuite; //!< Static variable for test initialization
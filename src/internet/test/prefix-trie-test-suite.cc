@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-address.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie Test: fixed cases
+ */
+class PrefixTrieTestCase : public TestCase
+{
+public:
+  PrefixTrieTestCase ();
+  virtual void DoRun (void);
+};
+
+PrefixTrieTestCase::PrefixTrieTestCase ()
+  : TestCase ("Check the lookups of PrefixTrie on a few prefixes")
+{
+}
+
+void
+PrefixTrieTestCase::DoRun (void)
+{
+  PrefixTrie<int, 32> trie;
+  uint8_t prefix[4];
+  uint8_t address[4];
+  std::vector<int> values;
+
+  Ipv4Address ("10.1.0.0").Serialize (prefix);
+  trie.Insert (prefix, 16, 1);
+  Ipv4Address ("0.0.0.0").Serialize (prefix);
+  trie.Insert (prefix, 0, 2);
+  Ipv4Address ("10.1.2.0").Serialize (prefix);
+  trie.Insert (prefix, 24, 3);
+  Ipv4Address ("10.1.0.0").Serialize (prefix);
+  trie.Insert (prefix, 16, 4);
+  Ipv4Address ("10.1.3.0").Serialize (prefix);
+  trie.Insert (prefix, 24, 5);
+
+  Ipv4Address ("10.1.2.7").Serialize (address);
+  trie.Lookup (address, values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 4, "Wrong number of matching prefixes");
+  NS_TEST_EXPECT_MSG_EQ (values[0], 1, "Values not in insertion order");
+  NS_TEST_EXPECT_MSG_EQ (values[1], 2, "Values not in insertion order");
+  NS_TEST_EXPECT_MSG_EQ (values[2], 3, "Values not in insertion order");
+  NS_TEST_EXPECT_MSG_EQ (values[3], 4, "Values not in insertion order");
+
+  values.clear ();
+  Ipv4Address ("192.168.0.1").Serialize (address);
+  trie.Lookup (address, values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 1, "Only the default prefix matches");
+  NS_TEST_EXPECT_MSG_EQ (values[0], 2, "Only the default prefix matches");
+
+  Ipv4Address ("10.1.0.0").Serialize (prefix);
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (prefix, 16, 1), true, "Value not removed");
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (prefix, 16, 1), false, "Value removed twice");
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (prefix, 24, 4), false, "Value removed from the wrong prefix");
+  Ipv4Address ("0.0.0.0").Serialize (prefix);
+  NS_TEST_EXPECT_MSG_EQ (trie.Remove (prefix, 0, 2), true, "Value not removed");
+
+  Ipv4Address ("10.1.3.0").Serialize (prefix);
+  NS_TEST_EXPECT_MSG_EQ (trie.HasOverlap (prefix, 8), true, "Contained prefixes not found");
+  NS_TEST_EXPECT_MSG_EQ (trie.HasOverlap (prefix, 30), true, "Containing prefixes not found");
+  Ipv4Address ("10.2.0.0").Serialize (prefix);
+  NS_TEST_EXPECT_MSG_EQ (trie.HasOverlap (prefix, 16), false, "Disjoint prefix overlaps");
+
+  values.clear ();
+  Ipv4Address ("10.1.3.200").Serialize (address);
+  trie.Lookup (address, values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 2, "Wrong number of matching prefixes");
+  NS_TEST_EXPECT_MSG_EQ (values[0], 4, "Values not in insertion order");
+  NS_TEST_EXPECT_MSG_EQ (values[1], 5, "Values not in insertion order");
+
+  uint8_t mask[4];
+  Ipv4Address ("255.255.240.0").Serialize (mask);
+  NS_TEST_EXPECT_MSG_EQ ((PrefixTrie<int, 32>::GetPrefixLength (mask)), 20, "Bad prefix length");
+  Ipv4Address ("255.0.255.0").Serialize (mask);
+  NS_TEST_EXPECT_MSG_EQ ((PrefixTrie<int, 32>::GetPrefixLength (mask)), 8, "Bad prefix length of a mask with holes");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie Test: comparison with a linear scan
+ */
+class PrefixTrieRandomTestCase : public TestCase
+{
+public:
+  PrefixTrieRandomTestCase ();
+  virtual void DoRun (void);
+};
+
+PrefixTrieRandomTestCase::PrefixTrieRandomTestCase ()
+  : TestCase ("Check PrefixTrie against a linear scan of random prefixes")
+{
+}
+
+void
+PrefixTrieRandomTestCase::DoRun (void)
+{
+  /// A prefix in the linear table
+  struct Entry
+  {
+    uint8_t prefix[16];  //!< The prefix
+    uint32_t length;     //!< The prefix length
+    uint32_t value;      //!< The value
+  };
+  std::vector<Entry> table;
+  PrefixTrie<uint32_t, 128> trie;
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  // Addresses from a few bytes only, so that the prefixes overlap
+  for (uint32_t round = 0; round < 2000; round++)
+    {
+      uint8_t address[16];
+      for (uint32_t i = 0; i < 16; i++)
+        {
+          address[i] = random->GetInteger (0, 3) << 6;
+        }
+      uint32_t op = random->GetInteger (0, 2);
+      if (op == 0 || table.empty ())
+        {
+          Entry entry;
+          std::memcpy (entry.prefix, address, 16);
+          entry.length = random->GetInteger (0, 128);
+          entry.value = round;
+          table.push_back (entry);
+          trie.Insert (entry.prefix, entry.length, entry.value);
+        }
+      else if (op == 1)
+        {
+          uint32_t index = random->GetInteger (0, table.size () - 1);
+          bool removed = trie.Remove (table[index].prefix, table[index].length, table[index].value);
+          NS_TEST_ASSERT_MSG_EQ (removed, true, "Value not found");
+          table.erase (table.begin () + index);
+        }
+
+      std::vector<uint32_t> expected;
+      for (std::vector<Entry>::const_iterator i = table.begin (); i != table.end (); i++)
+        {
+          uint32_t bit = 0;
+          while (bit < i->length
+                 && ((i->prefix[bit / 8] ^ address[bit / 8]) & (0x80 >> (bit % 8))) == 0)
+            {
+              bit++;
+            }
+          if (bit == i->length)
+            {
+              expected.push_back (i->value);
+            }
+        }
+      std::vector<uint32_t> values;
+      trie.Lookup (address, values);
+      NS_TEST_ASSERT_MSG_EQ ((values == expected), true, "Lookup differs from the linear scan in round " << round);
+
+      // The same address as a prefix of random length
+      uint32_t length = random->GetInteger (0, 128);
+      bool overlap = false;
+      for (std::vector<Entry>::const_iterator i = table.begin (); !overlap && i != table.end (); i++)
+        {
+          uint32_t shortest = std::min (i->length, length);
+          uint32_t bit = 0;
+          while (bit < shortest
+                 && ((i->prefix[bit / 8] ^ address[bit / 8]) & (0x80 >> (bit % 8))) == 0)
+            {
+              bit++;
+            }
+          overlap = bit == shortest;
+        }
+      NS_TEST_ASSERT_MSG_EQ (trie.HasOverlap (address, length), overlap,
+                             "Overlap differs from the linear scan in round " << round);
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ();
+};
+
+PrefixTrieTestSuite::PrefixTrieTestSuite ()
+  : TestSuite ("prefix-trie", UNIT)
+{
+  AddTestCase (new PrefixTrieTestCase (), TestCase::QUICK);
+  AddTestCase (new PrefixTrieRandomTestCase (), TestCase::QUICK);
+}
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
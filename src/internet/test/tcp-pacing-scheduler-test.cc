@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/tcp-pacing-scheduler.h"
+
+#include <vector>
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpPacingScheduler Test: release times and order of the flows
+ */
+class TcpPacingSchedulerTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param granularity the width of the time slots
+   */
+  TcpPacingSchedulerTestCase (Time granularity);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the release of a flow
+   * \param flow the flow
+   */
+  void Released (uint32_t flow);
+
+  /**
+   * \brief Release a flow, and schedule it again at the current time
+   * \param flow the flow
+   */
+  void ReleasedAndRescheduled (uint32_t flow);
+
+  /**
+   * \param departure the departure time of the flow
+   * \return the time at which the flow is expected to be released
+   */
+  Time GetSlot (Time departure) const;
+
+  Time m_granularity;                    //!< The width of the time slots
+  Ptr<TcpPacingScheduler> m_scheduler;   //!< The scheduler under test
+  std::vector<uint32_t> m_flows;         //!< The released flows, in order
+  std::vector<Time> m_times;             //!< The release times of m_flows
+};
+
+TcpPacingSchedulerTestCase::TcpPacingSchedulerTestCase (Time granularity)
+  : TestCase ("Check the releases of TcpPacingScheduler with slots of " + std::to_string (granularity.GetNanoSeconds ()) + " ns"),
+    m_granularity (granularity)
+{
+}
+
+Time
+TcpPacingSchedulerTestCase::GetSlot (Time departure) const
+{
+  if (m_granularity.IsZero ())
+    {
+      return departure;
+    }
+  int64_t slots = (departure.GetTimeStep () + m_granularity.GetTimeStep () - 1) / m_granularity.GetTimeStep ();
+  return TimeStep (slots * m_granularity.GetTimeStep ());
+}
+
+void
+TcpPacingSchedulerTestCase::Released (uint32_t flow)
+{
+  m_flows.push_back (flow);
+  m_times.push_back (Simulator::Now ());
+}
+
+void
+TcpPacingSchedulerTestCase::ReleasedAndRescheduled (uint32_t flow)
+{
+  Released (flow);
+  if (flow == 5)
+    {
+      m_scheduler->Schedule (Simulator::Now (),
+                             MakeCallback (&TcpPacingSchedulerTestCase::ReleasedAndRescheduled, this).Bind (6u));
+    }
+}
+
+void
+TcpPacingSchedulerTestCase::DoRun (void)
+{
+  m_scheduler = CreateObject<TcpPacingScheduler> ();
+  m_scheduler->SetAttribute ("Granularity", TimeValue (m_granularity));
+
+  Time departures[] = {MicroSeconds (3), MicroSeconds (12), MicroSeconds (7),
+                       MicroSeconds (3), MicroSeconds (15), MicroSeconds (9)};
+  uint64_t ids[6];
+  for (uint32_t flow = 0; flow < 6; flow++)
+    {
+      ids[flow] = m_scheduler->Schedule (departures[flow],
+                                         MakeCallback (&TcpPacingSchedulerTestCase::ReleasedAndRescheduled,
+                                                       this).Bind (flow));
+      NS_TEST_ASSERT_MSG_NE (ids[flow], 0, "Invalid identifier");
+    }
+  m_scheduler->Cancel (ids[4]);
+  m_scheduler->Cancel (ids[4]);
+  NS_TEST_EXPECT_MSG_EQ (m_scheduler->GetNPending (), 5, "Cancelled flow still pending");
+
+  Simulator::Run ();
+
+  // The flows leave in the order of their slots, and of their scheduling
+  // within a slot
+  std::vector<uint32_t> expected;
+  std::vector<Time> expectedTimes;
+  for (uint32_t flow = 0; flow < 6; flow++)
+    {
+      if (flow == 4)
+        {
+          continue;
+        }
+      std::vector<uint32_t>::iterator it = expected.begin ();
+      while (it != expected.end () && GetSlot (departures[*it]) <= GetSlot (departures[flow]))
+        {
+          it++;
+        }
+      expectedTimes.insert (expectedTimes.begin () + (it - expected.begin ()), GetSlot (departures[flow]));
+      expected.insert (it, flow);
+    }
+  // The flow scheduled by flow 5 at its own release leaves right after it
+  std::vector<uint32_t>::iterator five = std::find (expected.begin (), expected.end (), 5u);
+  expectedTimes.insert (expectedTimes.begin () + (five - expected.begin ()) + 1, GetSlot (departures[5]));
+  expected.insert (five + 1, 6);
+
+  NS_TEST_ASSERT_MSG_EQ (m_flows.size (), expected.size (), "Wrong number of releases");
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_flows[i], expected[i], "Wrong release order at " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], expectedTimes[i], "Wrong release time of flow " << m_flows[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_scheduler->GetNPending (), 0, "Flows left in the scheduler");
+
+  m_scheduler->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpPacingScheduler TestSuite
+ */
+class TcpPacingSchedulerTestSuite : public TestSuite
+{
+public:
+  TcpPacingSchedulerTestSuite ()
+    : TestSuite ("tcp-pacing-scheduler", UNIT)
+  {
+    AddTestCase (new TcpPacingSchedulerTestCase (Seconds (0)), TestCase::QUICK);
+    AddTestCase (new TcpPacingSchedulerTestCase (MicroSeconds (10)), TestCase::QUICK);
+  }
+};
+
+static TcpPacingSchedulerTestSuite g_tcpPacingSchedulerTestSuite; //!< Static variable for test initialization
@@ -197,6 +197,9 @@ TcpPacingTest::ConfigureEnvironment ()
   SetMTU (1500);
   SetTransmitStart (Seconds (0));
   SetPropagationDelay (MilliSeconds (50));
+
+  // Check the exact pacing intervals, without the slots of the scheduler
+  Config::SetDefault ("ns3::TcpPacingScheduler::Granularity", TimeValue (Seconds (0)));
 }
 
 void TcpPacingTest::ConfigureProperties ()
@@ -21,6 +21,8 @@
 
 #include "ns3/tcp-rx-buffer.h"
 
+#include <vector>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("TcpRxBufferTestSuite");
@@ -44,6 +46,10 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+  /**
+   * \brief Test the reassembly of overlapping out-of-order segments.
+   */
+  void TestReassembly ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +61,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReassembly ();
 }
 
 void
@@ -338,6 +345,67 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReassembly ()
+{
+  // Segments of 150 bytes every 100 bytes, so that each one overlaps its
+  // neighbours; the bytes are their sequence number modulo 251
+  const uint32_t segments = 600;
+  const uint32_t dataSize = 100 * segments + 50;
+  std::vector<uint8_t> data (dataSize);
+  for (uint32_t j = 0; j < dataSize; ++j)
+    {
+      data[j] = (j + 1) % 251;
+    }
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (dataSize);
+
+  // One segment in three, from the last one, which leaves holes
+  for (uint32_t k = segments; k-- > 0; )
+    {
+      if (k % 3 == 2)
+        {
+          h.SetSequenceNumber (SequenceNumber32 (1 + 100 * k));
+          rxBuf.Add (Create<Packet> (&data[100 * k], 150), h);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 0, "Out-of-order data available");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 150 * segments / 3, "Wrong buffer occupancy");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 4, "Wrong number of SACK blocks");
+
+  // Then the others in order, which fill the holes
+  for (uint32_t k = 0; k < segments; ++k)
+    {
+      if (k % 3 != 2)
+        {
+          h.SetSequenceNumber (SequenceNumber32 (1 + 100 * k));
+          rxBuf.Add (Create<Packet> (&data[100 * k], 150), h);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1 + dataSize),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), dataSize, "Wrong available data");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), dataSize, "Wrong buffer occupancy");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list not cleared");
+
+  // Extract the data in chunks which do not match the segments
+  std::vector<uint8_t> received (dataSize);
+  uint32_t offset = 0;
+  while (Ptr<Packet> p = rxBuf.Extract (150))
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + p->GetSize (), dataSize, "Too much data extracted");
+      p->CopyData (&received[offset], p->GetSize ());
+      offset += p->GetSize ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (offset, dataSize, "Not all the data extracted");
+  NS_TEST_ASSERT_MSG_EQ ((received == data), true, "Data not reassembled in order");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Buffer not empty");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
@@ -53,6 +53,8 @@ private:
   /** \brief Test the logic of merging items in GetTransmittedSegment()
    * which is triggered by CopyFromSequence()*/
   void TestMergeItemsWhenGetTransmittedSegment ();
+  /** \brief Test the scoreboard of a large window with sparse SACK blocks */
+  void TestLargeWindow ();
   /**
    * \brief Callback to provide a value of receiver window
    * \returns the receiver window size
@@ -101,6 +103,14 @@ TcpTxBufferTestCase::DoRun ()
   Simulator::Schedule (Seconds (0.0),
                          &TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment, this);
 
+  /*
+   * Case for a large window:
+   *  -> every other segment is sacked, one SACK block per ACK
+   *  -> the lost count, NextSeg and the bytes in flight follow the sacks
+   */
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
+
   Simulator::Run ();
   Simulator::Destroy ();
 }
@@ -153,6 +163,65 @@ TcpTxBufferTestCase::TestIsLost ()
 
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&TcpTxBufferTestCase::GetRWnd, this));
+  SequenceNumber32 head (1);
+  txBuf->SetHeadSequence (head);
+  txBuf->SetMaxBufferSize (4000000);
+  txBuf->SetSegmentSize (1000);
+  txBuf->SetDupAckThresh (3);
+  const uint32_t segments = 2000;
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (segments * 1000)), true, "Data not added");
+  SequenceNumber32 ret;
+  SequenceNumber32 retHigh;
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, false), true, "No new data");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (1000 * i), "Different NextSeq than expected");
+      txBuf->CopyFromSequence (1000, ret);
+    }
+
+  // Sack the odd segments one by one; when the k-th is sacked, the even
+  // segments below the (k-2)-th are lost, and each is retransmitted in turn.
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  for (uint32_t k = 1; k <= segments / 2; ++k)
+    {
+      SequenceNumber32 begin = head + (1000 * (2 * k - 1));
+      sack->ClearSackList ();
+      sack->AddSackBlock (TcpOptionSack::SackBlock (begin, begin + 1000));
+      NS_TEST_ASSERT_MSG_EQ (txBuf->Update (sack->GetSackList ()), 1000, "Segment not sacked");
+
+      uint32_t lost = k >= 3 ? k - 2 : 0;
+      NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), lost * 1000, "Wrong lost count after " << k << " sacks");
+      if (lost > 0)
+        {
+          SequenceNumber32 expected = head + (1000 * 2 * (lost - 1));
+          NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (expected), true, "Segment not lost");
+          NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true, "No lost segment");
+          NS_TEST_ASSERT_MSG_EQ (ret, expected, "Wrong segment to retransmit after " << k << " sacks");
+          txBuf->CopyFromSequence (1000, ret);
+          NS_TEST_ASSERT_MSG_EQ (txBuf->IsRetransmittedDataAcked (ret + 1000), true, "Segment not retransmitted");
+        }
+      NS_TEST_ASSERT_MSG_EQ (txBuf->GetRetransmitsCount (), lost * 1000, "Wrong retransmitted count");
+      NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), k * 1000, "Wrong sacked count");
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), segments / 2 * 1000, "Wrong bytes in flight");
+
+  // Only the last even segments, above the third highest sack, are left
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, true), true, "No segment for rule 3");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (1000 * (segments - 4)), "Wrong segment for rule 3");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&ret, &retHigh, false), false, "Segment returned out of recovery");
+
+  txBuf->DiscardUpTo (head + (segments * 1000));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Data inside the buffer");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost () + txBuf->GetSacked () + txBuf->GetRetransmitsCount (), 0,
+                         "Scoreboard not empty");
+}
+
 uint32_t
 TcpTxBufferTestCase::GetRWnd (void) const
 {
@@ -28,6 +28,9 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/compressed-file-writer.h"
+#include "ns3/global-value.h"
+#include "ns3/enum.h"
 
 #include "trace-helper.h"
 
@@ -35,6 +38,31 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TraceHelper");
 
+/**
+ * \relates PcapHelper
+ * \anchor GlobalValueTraceCompression
+ * \brief A global switch to compress the trace files named after a device
+ * or an interface.
+ */
+static GlobalValue g_traceCompression = GlobalValue ("TraceCompression",
+                                                     "Compression of the pcap and ascii trace files named after "
+                                                     "a device or an interface, which get the matching extension",
+                                                     EnumValue (CompressedFileWriter::NONE),
+                                                     MakeEnumChecker (CompressedFileWriter::NONE, "None",
+                                                                      CompressedFileWriter::GZIP, "Gzip",
+                                                                      CompressedFileWriter::ZSTD, "Zstd"));
+
+/**
+ * \returns the file name extension selected by the TraceCompression global value
+ */
+static std::string
+GetCompressionExtension (void)
+{
+  EnumValue compression;
+  g_traceCompression.GetValue (compression);
+  return CompressedFileWriter::GetExtension (static_cast<CompressedFileWriter::Format> (compression.Get ()));
+}
+
 PcapHelper::PcapHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -116,7 +144,7 @@ PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bo
       oss << device->GetIfIndex ();
     }
 
-  oss << ".pcap";
+  oss << ".pcap" << GetCompressionExtension ();
 
   return oss.str ();
 }
@@ -154,7 +182,7 @@ PcapHelper::GetFilenameFromInterfacePair (std::string prefix, Ptr<Object> object
       oss << "n" << node->GetId ();
     }
 
-  oss << "-i" << interface << ".pcap";
+  oss << "-i" << interface << ".pcap" << GetCompressionExtension ();
 
   return oss.str ();
 }
@@ -248,7 +276,7 @@ AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> devi
       oss << device->GetIfIndex ();
     }
 
-  oss << ".tr";
+  oss << ".tr" << GetCompressionExtension ();
 
   return oss.str ();
 }
@@ -290,7 +318,7 @@ AsciiTraceHelper::GetFilenameFromInterfacePair (
       oss << "n" << node->GetId ();
     }
 
-  oss << "-i" << interface << ".tr";
+  oss << "-i" << interface << ".tr" << GetCompressionExtension ();
 
   return oss.str ();
 }
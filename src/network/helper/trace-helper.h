@@ -33,6 +33,15 @@ namespace ns3 {
  *
  * Handling pcap files is a common operation for ns-3 devices.  It is useful to
  * provide a common base class for dealing with these ops.
+ *
+ * The files are created with the default attribute values of
+ * PcapFileWrapper, so setting ns3::PcapFileWrapper::AsyncWrite selects
+ * background writing for all the pcap traces of a simulation.
+ *
+ * Files whose name ends in ".gz" or ".zst" are compressed.  The
+ * \ref GlobalValueTraceCompression "TraceCompression" global value adds
+ * such an extension to the file names built by GetFilenameFromDevice()
+ * and GetFilenameFromInterfacePair().
  */
 
 class PcapHelper
@@ -157,6 +166,9 @@ PcapHelper::HookDefaultSink (Ptr<T> object, std::string tracename, Ptr<PcapFileW
  *
  * Handling ascii trace files is a common operation for ns-3 devices.  It is 
  * useful to provide a common base class for dealing with these ops.
+ *
+ * Files whose name ends in ".gz" or ".zst" are compressed, as with
+ * PcapHelper.
  */
 
 class AsciiTraceHelper
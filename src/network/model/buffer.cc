@@ -52,46 +52,16 @@ NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+/**
+ * \ingroup packet
+ * \returns the pool of Buffer::Data, which is never destroyed so that
+ * buffers can be released from static destructors
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+static PacketDataPool &
+GetPool (void)
 {
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
+  static PacketDataPool *pool = new PacketDataPool ();
+  return *pool;
 }
 
 void
@@ -99,49 +69,31 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  GetPool ().Deallocate (reinterpret_cast<uint8_t *> (data),
+                         data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
+  if (dataSize == 0)
     {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
+      dataSize = 1;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
+  uint32_t capacity;
+  uint8_t *b = GetPool ().Allocate (dataSize - 1 + sizeof (struct Buffer::Data), &capacity);
+  struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
+  data->m_size = capacity + 1 - sizeof (struct Buffer::Data);
+  data->m_count = 1;
   return data;
 }
+
+PacketDataPool::Statistics
+Buffer::GetPoolStatistics (void)
+{
+  return GetPool ().GetStatistics ();
+}
 #else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
@@ -157,6 +109,13 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+PacketDataPool::Statistics
+Buffer::GetPoolStatistics (void)
+{
+  PacketDataPool::Statistics statistics = {0, 0, 0, 0};
+  return statistics;
+}
 #endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
@@ -244,7 +203,10 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  // Ask for the headroom which the headers of the last buffers needed, so
+  // that AddAtStart does not reallocate the buffer of each new packet.
+  // The zero area is virtual and needs no memory.
+  m_data = Buffer::Create (g_recommendedStart);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -401,6 +363,48 @@ Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
 
+  if (m_data == o.m_data
+      && m_end - (m_zeroAreaEnd - m_zeroAreaStart) == o.m_start)
+    {
+      /**
+       * This is an optimization which kicks in when we
+       * append a slice of our own data which starts where
+       * our data ends, as when fragments created from the
+       * same buffer are put back together: the bytes are
+       * already in place, so no copy is needed as long as
+       * the result has at most one zero area.
+       */
+      uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+      bool joined = true;
+      if (zeroSize == 0)
+        {
+          m_end += o.GetSize ();
+        }
+      else if (m_zeroAreaStart == m_zeroAreaEnd)
+        {
+          // our offsets are those of the data, like the ones of o
+          m_zeroAreaStart = o.m_zeroAreaStart;
+          m_zeroAreaEnd = o.m_zeroAreaEnd;
+          m_end = o.m_end;
+        }
+      else if (m_zeroAreaEnd == m_end && o.m_zeroAreaStart == o.m_start)
+        {
+          // the two zero areas are adjacent
+          m_zeroAreaEnd += zeroSize;
+          m_end += o.GetSize ();
+        }
+      else
+        {
+          joined = false;
+        }
+      if (joined)
+        {
+          m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+          NS_ASSERT (CheckInternalState ());
+          return;
+        }
+    }
+
   if (m_data->m_count == 1 &&
       (m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
       m_end == m_data->m_dirtyEnd &&
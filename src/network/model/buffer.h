@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "packet-data-pool.h"
 
 #define BUFFER_FREE_LIST 1
 
@@ -527,6 +528,10 @@ private:
    * Add bytes at the end of the Buffer.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
+   *
+   * If the two buffers are adjacent fragments of the same
+   * buffer, as created by CreateFragment, no data is copied:
+   * this buffer is extended over the bytes of the other one.
    */
   void AddAtEnd (const Buffer &o);
   /**
@@ -642,6 +647,12 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \returns the usage statistics of the pool from which the storage
+   * of the buffers is allocated
+   */
+  static PacketDataPool::Statistics GetPoolStatistics (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -789,19 +800,6 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
-
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
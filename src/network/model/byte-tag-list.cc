@@ -18,13 +18,12 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "packet-data-pool.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
 #include <limits>
 
-#define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
 namespace ns3 {
@@ -45,32 +44,18 @@ struct ByteTagListData {
   uint8_t data[4]; //!< data
 };
 
-#ifdef USE_FREE_LIST
 /**
- * \ingroup packet
- *
- * \brief Container class for struct ByteTagListData
+ * \returns the pool of the ByteTagListData structures
  *
- * Internal use only.
+ * The pool is never destroyed, so that packets freed by static
+ * destructors can still release their tags.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
+static PacketDataPool &
+GetPool (void)
 {
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
+  static PacketDataPool *pool = new PacketDataPool ();
+  return *pool;
 }
-#endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
   : buf (buf_)
@@ -159,6 +144,10 @@ ByteTagList::ByteTagList (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
 }
 ByteTagList &
 ByteTagList::operator = (const ByteTagList &o)
@@ -178,6 +167,10 @@ ByteTagList::operator = (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
   return *this;
 }
 ByteTagList::~ByteTagList ()
@@ -194,21 +187,22 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   NS_LOG_FUNCTION (this << tid << bufferSize << start << end);
   uint32_t spaceNeeded = m_used + bufferSize + 4 + 4 + 4 + 4;
   NS_ASSERT (m_used <= spaceNeeded);
-  if (m_data == 0)
+  if (m_data == 0 && spaceNeeded > INLINE_SIZE)
     {
       m_data = Allocate (spaceNeeded);
-      m_used = 0;
+      std::memcpy (&m_data->data, m_inline, m_used);
     } 
-  else if (m_data->size < spaceNeeded ||
-           (m_data->count != 1 && m_data->dirty != m_used))
+  else if (m_data != 0
+           && (m_data->size < spaceNeeded
+               || (m_data->count != 1 && m_data->dirty != m_used)))
     {
       struct ByteTagListData *newData = Allocate (spaceNeeded);
       std::memcpy (&newData->data, &m_data->data, m_used);
       Deallocate (m_data);
       m_data = newData;
     }
-  TagBuffer tag = TagBuffer (&m_data->data[m_used], 
-                             &m_data->data[spaceNeeded]);
+  uint8_t *buffer = GetBuffer ();
+  TagBuffer tag = TagBuffer (&buffer[m_used], &buffer[spaceNeeded]);
   tag.WriteU32 (tid.GetUid ());
   tag.WriteU32 (bufferSize);
   tag.WriteU32 (start - m_adjustment);
@@ -222,7 +216,10 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_maxEnd = end - m_adjustment;
     }
   m_used = spaceNeeded;
-  m_data->dirty = m_used;
+  if (m_data != 0)
+    {
+      m_data->dirty = m_used;
+    }
   return tag;
 }
 
@@ -230,6 +227,13 @@ void
 ByteTagList::Add (const ByteTagList &o)
 {
   NS_LOG_FUNCTION (this << &o);
+  if (&o == this)
+    {
+      // the buffer may move while the tags are added
+      ByteTagList copy = o;
+      Add (copy);
+      return;
+    }
   ByteTagList::Iterator i = o.BeginAll ();
   while (i.HasNext ())
     {
@@ -264,14 +268,18 @@ ByteTagList::Iterator
 ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
 {
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
+  uint8_t *buffer = GetBuffer ();
+  return Iterator (buffer, &buffer[m_used], offsetStart, offsetEnd, m_adjustment);
+}
+
+uint8_t *
+ByteTagList::GetBuffer (void) const
+{
   if (m_data == 0)
     {
-      return Iterator (0, 0, offsetStart, offsetEnd, 0);
-    }
-  else
-    {
-      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
+      return const_cast<uint8_t *> (reinterpret_cast<const uint8_t *> (m_inline));
     }
+  return m_data->data;
 }
 
 void 
@@ -339,69 +347,15 @@ ByteTagList::AddAtStart (int32_t prependOffset)
   *this = list;
 }
 
-#ifdef USE_FREE_LIST
-
-struct ByteTagListData *
-ByteTagList::Allocate (uint32_t size)
-{
-  NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
-    {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
-      if (data->size >= size)
-        {
-          data->count = 1;
-          data->dirty = 0;
-          return data;
-        }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
-    }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
-  data->count = 1;
-  data->size = size;
-  data->dirty = 0;
-  return data;
-}
-
-void 
-ByteTagList::Deallocate (struct ByteTagListData *data)
-{
-  NS_LOG_FUNCTION (this << data);
-  if (data == 0)
-    {
-      return;
-    }
-  g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
-    {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
-        {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
-        }
-      else
-        {
-          g_freeList.push_back (data);
-        }
-    }
-}
-
-#else /* USE_FREE_LIST */
-
 struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
+  uint32_t capacity;
+  uint8_t *buffer = GetPool ().Allocate (size + sizeof (struct ByteTagListData) - 4, &capacity);
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
-  data->size = size;
+  data->size = capacity + 4 - sizeof (struct ByteTagListData);
   data->dirty = 0;
   return data;
 }
@@ -417,13 +371,10 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
+      GetPool ().Deallocate ((uint8_t *)data, data->size + sizeof (struct ByteTagListData) - 4);
     }
 }
 
-#endif /* USE_FREE_LIST */
-
 uint32_t
 ByteTagList::GetSerializedSize (void) const
 {
@@ -45,6 +45,10 @@ struct ByteTagListData;
  *     as 4 32bit integers (TypeId, tag data size, start, end) followed 
  *     by the tag data as generated by Tag::Serialize.
  *
+ *   - The first INLINE_SIZE bytes of tags are stored within the
+ *     ByteTagList, so that packets with a few small byte tags do not
+ *     allocate.  Larger lists move to a struct ByteTagListData.
+ *
  *   - The struct ByteTagListData structure which contains the tag byte buffer
  *     is shared and, thus, reference-counted. This data structure is unshared
  *     as-needed to emulate COW semantics.
@@ -275,11 +279,20 @@ private:
    */
   void Deallocate (struct ByteTagListData *data);
 
+  /**
+   * \returns the tag byte buffer, inline or in the ByteTagListData
+   */
+  uint8_t *GetBuffer (void) const;
+
+  /// Size of the tags stored within the list, in bytes
+  static const uint32_t INLINE_SIZE = 48;
+
   int32_t m_minStart; //!< minimal start offset
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
   uint32_t m_used; //!< the number of used bytes in the buffer
-  struct ByteTagListData *m_data; //!< the ByteTagListData structure
+  struct ByteTagListData *m_data; //!< the ByteTagListData structure, or 0 if the tags are inline
+  uint32_t m_inline[INLINE_SIZE / 4]; //!< the inline tag byte buffer, word aligned
 };
 
 void
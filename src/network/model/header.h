@@ -113,6 +113,36 @@ public:
  */
 std::ostream & operator << (std::ostream &os, const Header &header);
 
+/**
+ * \ingroup packet
+ *
+ * \brief The serialized size of the headers which always have the same size.
+ *
+ * Packet::AddHeader, Packet::RemoveHeader and Packet::PeekHeader take
+ * the size of the header from this trait rather than from
+ * Header::GetSerializedSize, and call Serialize and Deserialize without
+ * virtual dispatch, when it is specialized for the static type of the
+ * header:
+ *
+ * \code
+ *   template <>
+ *   struct FixedSizeHeader<UdpHeader>
+ *   {
+ *     static const uint32_t SIZE = 8;
+ *   };
+ * \endcode
+ *
+ * The specialization must only be provided for headers which have no
+ * subclasses, and whose GetSerializedSize always returns SIZE.
+ *
+ * \tparam T \explicit The header type.
+ */
+template <typename T>
+struct FixedSizeHeader
+{
+  static const uint32_t SIZE = 0; //!< The serialized size, or 0 if it varies
+};
+
 } // namespace ns3
 
 #endif /* HEADER_H */
@@ -19,6 +19,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/packet-burst.h"
 #include "net-device.h"
 
 namespace ns3 {
@@ -41,4 +42,16 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+  bool result = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      result &= Send (*i, dest, protocolNumber);
+    }
+  return result;
+}
+
 } // namespace ns3
@@ -33,6 +33,7 @@
 namespace ns3 {
 
 class Node;
+class PacketBurst;
 class Channel;
 
 /**
@@ -246,6 +247,20 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param burst packets sent from above down to Network Device
+   * \param dest mac address of the destination (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        these packets.
+   *
+   *  Called from higher layer to send a train of packets into Network
+   *  Device to the specified destination Address.  Devices which can
+   *  transmit the packets back-to-back in a single channel event override
+   *  this method; by default each packet is given to Send in turn.
+   *
+   * \return whether all the packets were accepted
+   */
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   /**
    * \param packet packet sent from above down to Network Device
    * \param source source mac address (so called "MAC spoofing")
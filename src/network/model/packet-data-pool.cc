@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "packet-data-pool.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketDataPool");
+
+/**
+ * \relates PacketDataPool
+ * \anchor GlobalValuePacketPoolMaxFreeBlocks
+ * \brief The maximum number of blocks kept in each free list of the
+ * packet data pools, per thread.
+ */
+static GlobalValue g_maxFreeBlocks = GlobalValue ("PacketPoolMaxFreeBlocks",
+                                                  "The maximum number of free blocks of each size "
+                                                  "kept by the packet data pools in each thread",
+                                                  UintegerValue (1000),
+                                                  MakeUintegerChecker<uint32_t> ());
+
+namespace {
+
+/// Number of size classes, from MIN_BLOCK_SIZE to MAX_BLOCK_SIZE
+const uint32_t N_SIZE_CLASSES = 11;
+
+/**
+ * The pool caches of the calling thread.  This is trivially destructible,
+ * so that it can still be read while the thread exits.
+ */
+struct ThreadState
+{
+  void *caches[8];  //!< The cache of each pool, indexed by pool id, up to MAX_POOLS
+  bool exiting;     //!< The caches have been released
+};
+
+/// The pool caches of the calling thread
+thread_local ThreadState t_state;
+
+/**
+ * Update a counter which only the calling thread writes.
+ * \param counter the counter
+ * \param delta the value to add
+ */
+void
+Add (std::atomic<uint64_t> &counter, int64_t delta)
+{
+  counter.store (counter.load (std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+} // unnamed namespace
+
+/** The free lists of a pool for a thread. */
+struct PacketDataPool::ThreadCache
+{
+  PacketDataPool *pool;                              //!< The pool
+  uint32_t maxFree;                                  //!< Maximum length of each free list
+  std::vector<uint8_t *> freeList[N_SIZE_CLASSES];   //!< The free blocks of each size class
+  std::atomic<uint64_t> allocations;                 //!< \see Statistics
+  std::atomic<uint64_t> hits;                        //!< \see Statistics
+  std::atomic<uint64_t> freeBlocks;                  //!< \see Statistics
+  std::atomic<uint64_t> maxFreeBlocks;               //!< \see Statistics
+};
+
+std::atomic<uint32_t> PacketDataPool::g_pools (0);
+
+PacketDataPool::ThreadCacheGuard::~ThreadCacheGuard ()
+{
+  t_state.exiting = true;
+  for (uint32_t i = 0; i < MAX_POOLS; ++i)
+    {
+      ThreadCache *cache = static_cast<ThreadCache *> (t_state.caches[i]);
+      if (cache != 0)
+        {
+          t_state.caches[i] = 0;
+          cache->pool->Retire (cache);
+        }
+    }
+}
+
+PacketDataPool::PacketDataPool ()
+  : m_id (g_pools++)
+{
+  NS_LOG_FUNCTION (this);
+  static_assert (std::extent<decltype (ThreadState::caches)>::value == MAX_POOLS,
+                 "ThreadState must have a cache for each pool");
+  NS_ABORT_MSG_UNLESS (m_id < MAX_POOLS, "Too many packet data pools");
+  m_retired.allocations = 0;
+  m_retired.hits = 0;
+  m_retired.freeBlocks = 0;
+  m_retired.maxFreeBlocks = 0;
+}
+
+PacketDataPool::ThreadCache *
+PacketDataPool::GetThreadCache (void)
+{
+  ThreadCache *cache = static_cast<ThreadCache *> (t_state.caches[m_id]);
+  if (cache != 0 || t_state.exiting)
+    {
+      return cache;
+    }
+  static thread_local ThreadCacheGuard guard;
+  NS_LOG_FUNCTION (this);
+  UintegerValue maxFree;
+  g_maxFreeBlocks.GetValue (maxFree);
+  cache = new ThreadCache ();
+  cache->pool = this;
+  cache->maxFree = maxFree.Get ();
+  cache->allocations = 0;
+  cache->hits = 0;
+  cache->freeBlocks = 0;
+  cache->maxFreeBlocks = 0;
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_caches.push_back (cache);
+  }
+  t_state.caches[m_id] = cache;
+  return cache;
+}
+
+void
+PacketDataPool::Retire (ThreadCache *cache)
+{
+  NS_LOG_FUNCTION (this << cache);
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_caches.erase (std::find (m_caches.begin (), m_caches.end (), cache));
+    m_retired.allocations += cache->allocations;
+    m_retired.hits += cache->hits;
+    m_retired.maxFreeBlocks = std::max<uint64_t> (m_retired.maxFreeBlocks, cache->maxFreeBlocks);
+  }
+  for (uint32_t i = 0; i < N_SIZE_CLASSES; ++i)
+    {
+      for (std::vector<uint8_t *>::const_iterator j = cache->freeList[i].begin ();
+           j != cache->freeList[i].end (); ++j)
+        {
+          delete [] *j;
+        }
+    }
+  delete cache;
+}
+
+uint8_t *
+PacketDataPool::Allocate (uint32_t size, uint32_t *capacity)
+{
+  if (size > MAX_BLOCK_SIZE)
+    {
+      *capacity = size;
+      return new uint8_t [size];
+    }
+  uint32_t sizeClass = 0;
+  uint32_t blockSize = MIN_BLOCK_SIZE;
+  while (blockSize < size)
+    {
+      blockSize <<= 1;
+      sizeClass++;
+    }
+  *capacity = blockSize;
+  ThreadCache *cache = GetThreadCache ();
+  if (cache == 0)
+    {
+      return new uint8_t [blockSize];
+    }
+  Add (cache->allocations, 1);
+  std::vector<uint8_t *> &freeList = cache->freeList[sizeClass];
+  if (freeList.empty ())
+    {
+      return new uint8_t [blockSize];
+    }
+  uint8_t *block = freeList.back ();
+  freeList.pop_back ();
+  Add (cache->hits, 1);
+  Add (cache->freeBlocks, -1);
+  return block;
+}
+
+void
+PacketDataPool::Deallocate (uint8_t *block, uint32_t capacity)
+{
+  if (capacity > MAX_BLOCK_SIZE)
+    {
+      delete [] block;
+      return;
+    }
+  uint32_t sizeClass = 0;
+  uint32_t blockSize = MIN_BLOCK_SIZE;
+  while (blockSize < capacity)
+    {
+      blockSize <<= 1;
+      sizeClass++;
+    }
+  NS_ASSERT_MSG (blockSize == capacity, "Block of " << capacity << " bytes does not come from the pool");
+  ThreadCache *cache = GetThreadCache ();
+  if (cache == 0 || cache->freeList[sizeClass].size () >= cache->maxFree)
+    {
+      delete [] block;
+      return;
+    }
+  cache->freeList[sizeClass].push_back (block);
+  Add (cache->freeBlocks, 1);
+  uint64_t freeBlocks = cache->freeBlocks.load (std::memory_order_relaxed);
+  if (freeBlocks > cache->maxFreeBlocks.load (std::memory_order_relaxed))
+    {
+      cache->maxFreeBlocks.store (freeBlocks, std::memory_order_relaxed);
+    }
+}
+
+PacketDataPool::Statistics
+PacketDataPool::GetStatistics (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::unique_lock<std::mutex> lock (m_mutex);
+  Statistics statistics = m_retired;
+  for (std::vector<ThreadCache *>::const_iterator i = m_caches.begin (); i != m_caches.end (); ++i)
+    {
+      statistics.allocations += (*i)->allocations;
+      statistics.hits += (*i)->hits;
+      statistics.freeBlocks += (*i)->freeBlocks;
+      statistics.maxFreeBlocks = std::max<uint64_t> (statistics.maxFreeBlocks, (*i)->maxFreeBlocks);
+    }
+  return statistics;
+}
+
+} // namespace ns3
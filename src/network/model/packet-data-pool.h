@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_DATA_POOL_H
+#define PACKET_DATA_POOL_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief A pool of memory blocks for the storage of packets.
+ *
+ * Buffer::Data and PacketMetadata::Data are allocated and freed for
+ * every packet.  This pool keeps the freed blocks in free lists, one per
+ * size class (powers of two from MIN_BLOCK_SIZE to MAX_BLOCK_SIZE
+ * bytes), so that most allocations do not reach the system allocator.
+ * Larger blocks are not pooled.
+ *
+ * Each thread has its own free lists, so that the pool needs no
+ * locking; a block may be freed by another thread than the one which
+ * allocated it.  The number of blocks kept in each free list is capped
+ * by the \ref GlobalValuePacketPoolMaxFreeBlocks
+ * "PacketPoolMaxFreeBlocks" global value, which is read when a thread
+ * first uses the pool.  The blocks of a thread are released when it
+ * exits.
+ */
+class PacketDataPool
+{
+public:
+  /** Pool usage statistics, summed over all the threads. */
+  struct Statistics
+  {
+    uint64_t allocations; //!< Number of blocks allocated
+    uint64_t hits;        //!< Number of blocks taken from a free list
+    uint64_t freeBlocks;  //!< Number of blocks currently in the free lists
+    uint64_t maxFreeBlocks; //!< High watermark of freeBlocks, per thread
+  };
+
+  static const uint32_t MIN_BLOCK_SIZE = 64;    //!< Smallest size class
+  static const uint32_t MAX_BLOCK_SIZE = 65536; //!< Largest size class
+
+  PacketDataPool ();
+
+  /**
+   * \param size the minimum size of the block
+   * \param capacity the actual size of the block, at least \pname{size}
+   * \returns a block of \pname{capacity} bytes
+   */
+  uint8_t *Allocate (uint32_t size, uint32_t *capacity);
+  /**
+   * \param block a block returned by Allocate
+   * \param capacity the capacity of the block returned by Allocate
+   */
+  void Deallocate (uint8_t *block, uint32_t capacity);
+
+  /**
+   * \returns the usage statistics of this pool
+   */
+  Statistics GetStatistics (void) const;
+
+private:
+  struct ThreadCache;
+  /// Releases the caches of a thread when it exits.
+  struct ThreadCacheGuard
+  {
+    ~ThreadCacheGuard ();
+  };
+
+  /**
+   * \returns the cache of this pool for the calling thread, or 0 if the
+   * thread is exiting
+   */
+  ThreadCache *GetThreadCache (void);
+  /**
+   * Add the statistics of a cache to the totals of this pool and free it.
+   * \param cache the cache of a thread which exits
+   */
+  void Retire (ThreadCache *cache);
+
+  static const uint32_t MAX_POOLS = 8;    //!< Maximum number of pools
+  static std::atomic<uint32_t> g_pools;   //!< Number of pools created
+
+  uint32_t m_id;                          //!< Index of the thread caches of this pool
+  mutable std::mutex m_mutex;             //!< Protects the members below
+  std::vector<ThreadCache *> m_caches;    //!< Caches of the running threads
+  Statistics m_retired;                   //!< Statistics of the exited threads
+};
+
+} // namespace ns3
+
+#endif /* PACKET_DATA_POOL_H */
@@ -36,16 +36,17 @@ bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
-PacketMetadata::DataFreeList::~DataFreeList ()
+/**
+ * \ingroup packet
+ * \returns the pool of PacketMetadata::Data, which is never destroyed so
+ * that metadata can be released from static destructors
+ */
+static PacketDataPool &
+GetPool (void)
 {
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
+  static PacketDataPool *pool = new PacketDataPool ();
+  return *pool;
 }
 
 void 
@@ -575,20 +576,6 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
-    {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
-      PacketMetadata::Deallocate (data);
-    }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
   return PacketMetadata::Allocate (m_maxSize);
 }
 
@@ -596,22 +583,9 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
+  NS_LOG_LOGIC ("recycle size="<<data->m_size);
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
-    {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
-    }
+  PacketMetadata::Deallocate (data);
 }
 
 struct PacketMetadata::Data *
@@ -624,9 +598,10 @@ PacketMetadata::Allocate (uint32_t n)
       n = PACKET_METADATA_DATA_M_DATA_SIZE;
     }
   size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
+  uint32_t capacity;
+  uint8_t *buf = GetPool ().Allocate (size, &capacity);
   struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
-  data->m_size = n;
+  data->m_size = capacity - sizeof (struct Data) + PACKET_METADATA_DATA_M_DATA_SIZE;
   data->m_count = 1;
   data->m_dirtyEnd = 0;
   return data;
@@ -636,7 +611,13 @@ PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
   uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  GetPool ().Deallocate (buf, data->m_size + sizeof (struct Data) - PACKET_METADATA_DATA_M_DATA_SIZE);
+}
+
+PacketDataPool::Statistics
+PacketMetadata::GetPoolStatistics (void)
+{
+  return GetPool ().GetStatistics ();
 }
 
 
@@ -655,6 +636,12 @@ PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
+  if (!m_enable)
+    {
+      // skip the TypeId lookup
+      m_metadataSkipped = true;
+      return;
+    }
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   DoAddHeader (uid, size);
   NS_ASSERT (IsStateOk ());
@@ -682,7 +669,6 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 void 
 PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
 {
-  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
@@ -690,6 +676,7 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -161,6 +161,12 @@ private:
    */
   static void EnableChecking (void);
 
+  /**
+   * \returns the usage statistics of the pool from which the storage
+   * of the metadata is allocated
+   */
+  static PacketDataPool::Statistics GetPoolStatistics (void);
+
   /**
    * \brief Constructor
    * \param uid packet uid
@@ -494,16 +500,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
 
@@ -661,7 +657,6 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -20,284 +20,194 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a flat list of Packet tags, stored inline for the first few tags.
 */
 
 #include "packet-tag-list.h"
+#include "packet-data-pool.h"
 #include "tag-buffer.h"
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <algorithm>
 #include <cstring>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
-PacketTagList::TagData *
-PacketTagList::CreateTagData (size_t dataSize)
+/**
+ * \returns the pool of the heap blocks of PacketTagList
+ *
+ * The pool is never destroyed, so that packets freed by static
+ * destructors can still release their tags.
+ */
+static PacketDataPool &
+GetPool (void)
 {
-  NS_ASSERT_MSG (dataSize
-                 < std::numeric_limits<decltype(TagData::size)>::max (),
-                 "Requested TagData size " << dataSize
-                 << " exceeds maximum "
-                 << std::numeric_limits<decltype(TagData::size)>::max () );
-
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
-
-  TagData * tag = new (p) TagData;
-  tag->size = dataSize;
-  return tag;
+  static PacketDataPool *pool = new PacketDataPool ();
+  return *pool;
 }
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
+PacketTagList::Spill *
+PacketTagList::Allocate (uint32_t size)
 {
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
+  uint32_t capacity;
+  uint8_t *block = GetPool ().Allocate (size + sizeof (Spill) - 4, &capacity);
+  Spill *spill = reinterpret_cast<Spill *> (block);
+  spill->count = 1;
+  spill->size = capacity - sizeof (Spill) + 4;
+  return spill;
+}
 
-  // trivial case when list is empty
-  if (m_next == 0)
+void
+PacketTagList::Deallocate (Spill *spill)
+{
+  if (spill == 0)
     {
-      return false;
+      return;
     }
-
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
-
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+  spill->count--;
+  if (spill->count == 0)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
-        {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
-        }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
-
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
-    {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      GetPool ().Deallocate (reinterpret_cast<uint8_t *> (spill), spill->size + sizeof (Spill) - 4);
     }
+}
 
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
-
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
-    {
-      if (it->tid == tid)
-        {
-          break;
-        }
-    }
-  if (it == 0)
+uint8_t *
+PacketTagList::Reserve (uint32_t size)
+{
+  if (m_spill == 0 && size <= INLINE_SIZE)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      return reinterpret_cast<uint8_t *> (m_inline);
     }
-
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+  if (m_spill == 0 || m_spill->count > 1 || m_spill->size < size)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = CreateTagData (cur->size);
-      copy->tid = cur->tid;
-      copy->count = 1;
-      copy->size = cur->size;
-      memcpy (copy->data, cur->data, copy->size);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      NS_LOG_LOGIC ("copy " << m_used << " bytes to a block of " << size);
+      Spill *spill = Allocate (std::max (size, 2 * INLINE_SIZE));
+      std::memcpy (spill->data, GetData (), m_used);
+      Deallocate (m_spill);
+      m_spill = spill;
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
-}
-
-bool
-PacketTagList::Remove (Tag & tag)
-{
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  return m_spill->data;
 }
 
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
+uint32_t
+PacketTagList::Find (uint32_t tid) const
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
-    {
-      // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
-    }
-  else
+  const uint8_t *data = GetData ();
+  uint32_t offset = 0;
+  while (offset < m_used)
     {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
+      const TagData *cur = reinterpret_cast<const TagData *> (data + offset);
+      if (cur->tid == tid)
         {
-          // there's a next, so make it a merge
-          cur->next->count++;
+          break;
         }
+      offset += GetEntrySize (cur->size);
     }
-  return found;
+  return offset;
 }
 
 bool
-PacketTagList::Replace (Tag & tag)
+PacketTagList::Remove (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  uint32_t tid = tag.GetInstanceTypeId ().GetUid ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
-      Add (tag);
+      return false;
     }
-  return found;
+  const TagData *cur = reinterpret_cast<const TagData *> (GetData () + offset);
+  const uint8_t *tagData = reinterpret_cast<const uint8_t *> (cur + 1);
+  tag.Deserialize (TagBuffer (const_cast<uint8_t *> (tagData),
+                              const_cast<uint8_t *> (tagData) + cur->size));
+  uint32_t entrySize = GetEntrySize (cur->size);
+  uint8_t *data = Reserve (m_used);
+  std::memmove (data + offset, data + offset + entrySize, m_used - offset - entrySize);
+  m_used -= entrySize;
+  return true;
 }
 
-// COWWriter implementing Replace
 bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
+PacketTagList::Replace (Tag & tag)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
+  uint32_t tid = tag.GetInstanceTypeId ().GetUid ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
+      Add (tag);
+      return false;
     }
-  else
+  uint32_t size = tag.GetSerializedSize ();
+  const TagData *cur = reinterpret_cast<const TagData *> (GetData () + offset);
+  uint32_t entrySize = GetEntrySize (cur->size);
+  uint8_t *data = Reserve (m_used);
+  if (entrySize == GetEntrySize (size))
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = CreateTagData (tag.GetSerializedSize ());
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data, copy->data + copy->size));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
+      // rewrite in place
+      TagData *entry = reinterpret_cast<TagData *> (data + offset);
+      entry->size = size;
+      uint8_t *tagData = reinterpret_cast<uint8_t *> (entry + 1);
+      tag.Serialize (TagBuffer (tagData, tagData + size));
+      return true;
     }
-  return found;
+  std::memmove (data + offset, data + offset + entrySize, m_used - offset - entrySize);
+  m_used -= entrySize;
+  Add (tag);
+  return true;
 }
 
 void
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  uint32_t tid = tag.GetInstanceTypeId ().GetUid ();
+  NS_LOG_FUNCTION (this << tid);
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
-    {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
-                     "Error: cannot add the same kind of tag twice.");
-    }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
-  tag.Serialize (TagBuffer (head->data, head->data + head->size));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  NS_ASSERT_MSG (Find (tid) == m_used, "Error: cannot add the same kind of tag twice.");
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  uint32_t size = tag.GetSerializedSize ();
+  uint32_t entrySize = GetEntrySize (size);
+  uint8_t *data = self->Reserve (m_used + entrySize);
+  // The most recent tag goes first
+  std::memmove (data + entrySize, data, m_used);
+  TagData *head = reinterpret_cast<TagData *> (data);
+  head->tid = tid;
+  head->size = size;
+  uint8_t *tagData = reinterpret_cast<uint8_t *> (head + 1);
+  tag.Serialize (TagBuffer (tagData, tagData + size));
+  self->m_used += entrySize;
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
-  TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  uint32_t tid = tag.GetInstanceTypeId ().GetUid ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
-      if (cur->tid == tid)
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  const TagData *cur = reinterpret_cast<const TagData *> (GetData () + offset);
+  uint8_t *tagData = const_cast<uint8_t *> (reinterpret_cast<const uint8_t *> (cur + 1));
+  tag.Deserialize (TagBuffer (tagData, tagData + cur->size));
+  return true;
 }
 
 const struct PacketTagList::TagData *
 PacketTagList::Head (void) const
 {
-  return m_next;
+  return reinterpret_cast<const TagData *> (GetData ());
+}
+
+const struct PacketTagList::TagData *
+PacketTagList::End (void) const
+{
+  return reinterpret_cast<const TagData *> (GetData () + m_used);
 }
 
 uint32_t
@@ -309,7 +219,7 @@ PacketTagList::GetSerializedSize (void) const
 
   size = 4; // numberOfTags
 
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  for (const TagData *cur = Head (); cur != End (); cur = Next (cur))
     {
       size += 4; // TagData -> size
 
@@ -346,7 +256,7 @@ PacketTagList::Serialize (uint32_t* buffer, uint32_t maxSize) const
       return 0;
     }
 
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  for (const TagData *cur = Head (); cur != End (); cur = Next (cur))
     {
       if (size + 4 <= maxSize)
         {
@@ -358,13 +268,15 @@ PacketTagList::Serialize (uint32_t* buffer, uint32_t maxSize) const
           return 0;
         }
 
-      NS_LOG_INFO("Serializing tag id " << cur->tid);
+      TypeId tagTid;
+      tagTid.SetUid (cur->tid);
+      NS_LOG_INFO("Serializing tag id " << tagTid);
 
       // ensure size is multiple of 4 bytes for 4 byte boundaries
       uint32_t hashSize = (sizeof (TypeId::hash_t)+3) & (~3);
       if (size + hashSize <= maxSize)
         {
-          TypeId::hash_t tid = cur->tid.GetHash ();
+          TypeId::hash_t tid = tagTid.GetHash ();
           memcpy (p, &tid, sizeof (TypeId::hash_t));
           p += hashSize / 4;
           size += hashSize;
@@ -378,7 +290,7 @@ PacketTagList::Serialize (uint32_t* buffer, uint32_t maxSize) const
       uint32_t tagWordSize = (cur->size+3) & (~3);
       if (size + tagWordSize <= maxSize)
         {
-          memcpy (p, cur->data, cur->size);
+          memcpy (p, cur + 1, cur->size);
           size += tagWordSize;
           p += tagWordSize / 4;
         }
@@ -407,7 +319,7 @@ PacketTagList::Deserialize (const uint32_t* buffer, uint32_t size)
 
   NS_LOG_INFO("Deserializing number of tags " << numberOfTags);
 
-  struct TagData * prevTag = 0;
+  RemoveAll ();
   for (uint32_t i = 0; i < numberOfTags; ++i)
     {
       NS_ASSERT (sizeCheck >= 4);
@@ -425,30 +337,20 @@ PacketTagList::Deserialize (const uint32_t* buffer, uint32_t size)
 
       NS_LOG_INFO ("Deserializing tag of type " << tid);
 
-      struct TagData * newTag = CreateTagData (tagSize);
-      newTag->count = 1;
-      newTag->next = 0;
-      newTag->tid = tid;
+      // Append, to keep the serialized order
+      uint32_t entrySize = GetEntrySize (tagSize);
+      TagData * newTag = reinterpret_cast<TagData *> (Reserve (m_used + entrySize) + m_used);
+      newTag->tid = tid.GetUid ();
+      newTag->size = tagSize;
 
       NS_ASSERT (sizeCheck >= tagSize);
-      memcpy (newTag->data, p, tagSize);
+      memcpy (newTag + 1, p, tagSize);
+      m_used += entrySize;
 
       // ensure 4 byte boundary
       uint32_t tagWordSize = (tagSize+3) & (~3);
       p += tagWordSize / 4;
       sizeCheck -= tagWordSize;
-
-      // Set link list pointers.
-      if (i==0)
-        {
-          m_next = newTag;
-        }
-      else
-        {
-          prevTag->next = newTag;
-        }
-
-      prevTag = newTag;
     }
 
   NS_ASSERT (sizeCheck == 0);
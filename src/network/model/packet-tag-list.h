@@ -22,11 +22,12 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a flat list of Packet tags, stored inline for the first few tags.
 */
 
 #include <stdint.h>
 #include <ostream>
+#include <cstring>
 #include "ns3/type-id.h"
 
 namespace ns3 {
@@ -43,108 +44,42 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * Tags are stored in serialized form, one after the other, in a single
+ * byte array, most recent tag first.  Each tag is a TagData header
+ * followed by the serialized tag, padded to a multiple of 4 bytes:
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
+ * \verbatim
+     +-----+------+---------+-----+------+---------+----
+     | tid | size | data... | tid | size | data... | ...
+     +-----+------+---------+-----+------+---------+----
+   \endverbatim
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
+ * The array lives inside the PacketTagList for the first INLINE_SIZE
+ * bytes, which holds the few small tags most packets carry
+ * (FlowIdTag, SocketPriorityTag, Ipv4PacketInfoTag...), so that adding,
+ * copying and removing them does not allocate.  Larger lists spill to a
+ * heap block, which is shared by the copies of the list and copied
+ * when one of them is modified (copy-on-write).
  *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
- *
- * \par <b> Copy-on-write </b> is implemented as follows:
- *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
- *   - Copy constructor (PacketTagList(const PacketTagList & o))
- *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
- *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ * Tags are identified by the uid of their TypeId, which is obtained once
+ * per operation.
  */
 class PacketTagList 
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
-   *
-   * See PacketTagList for a discussion of the data structure.
+   * Header of a tag in the list, followed by its serialized data.
    *
    * \internal
    * Unfortunately this has to be public, because
    * PacketTagIterator::Item::GetTag() needs the data and size values.
    * The Item nested class can't be forward declared, so friending isn't
    * possible.
-   *
-   * We use placement new so we can allocate enough room for the Tag
-   * type which will be serialized into data.  See Object::Aggregates
-   * for a similar construction.
    */
   struct TagData
   {
-    struct TagData * next;      /**< Pointer to next in list */
-    uint32_t count;             /**< Number of incoming links */
-    TypeId tid;                 /**< Type of the tag serialized into #data */
-    uint32_t size;              /**< Size of the \c data buffer */
-    uint8_t data[1];            /**< Serialization buffer */
+    uint32_t tid;               /**< Uid of the TypeId of the tag */
+    uint32_t size;              /**< Size of the serialized tag which follows */
   };  /* struct TagData */
 
   /**
@@ -156,8 +91,7 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This copies the inline tags, or shares the heap block of \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -166,19 +100,16 @@ public:
    * \param [in] o The PacketTagList to copy.
    * \returns the copied object
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This copies the inline tags, or shares the heap block of \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
-   *
-   * #RemoveAll's the tags up to the first merge.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag to the head of the list.
    *
    * \param [in] tag The tag to add
    */
@@ -210,13 +141,22 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to the first tag of the list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns pointer past the last tag of the list
+   */
+  const struct PacketTagList::TagData *End (void) const;
+  /**
+   * \param [in] data A tag of a list.
+   * \returns pointer to the tag which follows \pname{data}
+   */
+  static inline const struct PacketTagList::TagData *Next (const struct PacketTagList::TagData *data);
   /**
    * Returns number of bytes required for packet serialization.
    *
@@ -244,68 +184,57 @@ public:
 
 private:
   /**
-   * Allocate and construct a TagData struct, sizing the data area
-   * large enough to serialize dataSize bytes from a Tag.
-   *
-   * \param [in] dataSize The serialized size of the Tag.
-   * \returns The newly constructed TagData object.
+   * Heap storage of the lists which do not fit in the inline area,
+   * shared by the copies of a list.
    */
-  static
-  TagData * CreateTagData (size_t dataSize);
-  
+  struct Spill
+  {
+    uint32_t count;             /**< Number of lists using this block */
+    uint32_t size;              /**< Size of the \c data buffer */
+    uint8_t data[4];            /**< The tags */
+  };
+
+  /// Size of the tags stored within the list, in bytes
+  static const uint32_t INLINE_SIZE = 64;
+
   /**
-   * Typedef of method function pointer for copy-on-write operations
-   *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * \param [in] size The serialized size of a tag.
+   * \returns The size taken by the tag in the list.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  static inline uint32_t GetEntrySize (uint32_t size);
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * \param [in] tid The uid of the TypeId of a tag.
+   * \returns The offset of the tag in the list, or #m_used if not found.
+   */
+  uint32_t Find (uint32_t tid) const;
+  /**
+   * Make the storage of this list unshared and large enough.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] size The number of bytes needed.
+   * \returns The storage of the list.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  uint8_t *Reserve (uint32_t size);
   /**
-   * Copy-on-write implementing Remove.
+   * Allocate a heap block.
    *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * \param [in] size The minimum size of the data area.
+   * \returns The newly allocated block, with a count of one.
    */
-  bool RemoveWriter  (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  static Spill *Allocate (uint32_t size);
   /**
-   * Copy-on-write implementing Replace
+   * Release a heap block, freeing it if it is no longer used.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] spill The block.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
-
+  static void Deallocate (Spill *spill);
   /**
-   * Pointer to first \ref TagData on the list
+   * \returns The storage of the list.
    */
-  struct TagData *m_next;
+  inline const uint8_t *GetData (void) const;
+
+  uint32_t m_used;                       //!< Number of bytes used by the tags
+  Spill *m_spill;                        //!< Heap storage, or 0 if the tags are inline
+  uint32_t m_inline[INLINE_SIZE / 4];    //!< Inline storage, word aligned
 };
 
 } // namespace ns3
@@ -317,16 +246,22 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_used (0),
+    m_spill (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_used (o.m_used),
+    m_spill (o.m_spill)
 {
-  if (m_next != 0)
+  if (m_spill != 0)
+    {
+      m_spill->count++;
+    }
+  else
     {
-      m_next->count++;
+      std::memcpy (m_inline, o.m_inline, m_used);
     }
 }
 
@@ -334,48 +269,54 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o)
     {
       return *this;
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (o.m_spill != 0)
     {
-      m_next->count++;
+      o.m_spill->count++;
+    }
+  Deallocate (m_spill);
+  m_used = o.m_used;
+  m_spill = o.m_spill;
+  if (m_spill == 0)
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
     }
   return *this;
 }
 
 PacketTagList::~PacketTagList ()
 {
-  RemoveAll ();
+  Deallocate (m_spill);
 }
 
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
-    {
-      cur->count--;
-      if (cur->count > 0) 
-        {
-          break;
-        }
-      if (prev != 0) 
-        {
-          prev->~TagData ();
-          std::free (prev);
-        }
-      prev = cur;
-    }
-  if (prev != 0) 
-    {
-      prev->~TagData ();
-      std::free (prev);
-    }
-  m_next = 0;
+  Deallocate (m_spill);
+  m_spill = 0;
+  m_used = 0;
+}
+
+const struct PacketTagList::TagData *
+PacketTagList::Next (const struct PacketTagList::TagData *data)
+{
+  return reinterpret_cast<const TagData *>
+    (reinterpret_cast<const uint8_t *> (data) + GetEntrySize (data->size));
+}
+
+uint32_t
+PacketTagList::GetEntrySize (uint32_t size)
+{
+  return sizeof (TagData) + ((size + 3) & (~3));
+}
+
+const uint8_t *
+PacketTagList::GetData (void) const
+{
+  return m_spill != 0 ? m_spill->data : reinterpret_cast<const uint8_t *> (m_inline);
 }
 
 } // namespace ns3
@@ -81,21 +81,23 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head,
+                                      const struct PacketTagList::TagData *end)
+  : m_current (head),
+    m_end (end)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != m_end;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
   const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
+  m_current = PacketTagList::Next (m_current);
   return PacketTagIterator::Item (prev);
 }
 
@@ -106,14 +108,16 @@ PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  TypeId tid;
+  tid.SetUid (m_data->tid);
+  return tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data + m_data->size));
+  NS_ASSERT (tag.GetInstanceTypeId () == GetTypeId ());
+  uint8_t *data = (uint8_t*)(m_data + 1);
+  tag.Deserialize (TagBuffer (data, data + m_data->size));
 }
 
 
@@ -1013,7 +1017,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList.Head (), m_packetTagList.End ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -174,9 +174,12 @@ private:
   /**
    * Constructor
    * \param head head of the items
+   * \param end end of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const struct PacketTagList::TagData *head,
+                     const struct PacketTagList::TagData *end);
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  const struct PacketTagList::TagData *m_end;      //!< end of the set of tags in a packet
 };
 
 /**
@@ -313,6 +316,19 @@ public:
    * \param header a reference to the header to add to this packet.
    */
   void AddHeader (const Header & header);
+  /**
+   * \brief Add header to this packet.
+   *
+   * Headers for which FixedSizeHeader is specialized are added
+   * without calling Header::GetSerializedSize and with a direct call
+   * to their Serialize method; the others go through
+   * AddHeader (const Header &).
+   *
+   * \tparam T \deduced The header type.
+   * \param header a reference to the header to add to this packet.
+   */
+  template <typename T>
+  void AddHeader (const T & header);
   /**
    * \brief Deserialize and remove the header from the internal buffer.
    *
@@ -323,6 +339,19 @@ public:
    * \returns the number of bytes removed from the packet.
    */
   uint32_t RemoveHeader (Header &header);
+  /**
+   * \brief Deserialize and remove the header from the internal buffer.
+   *
+   * Headers for which FixedSizeHeader is specialized are removed with
+   * a direct call to their Deserialize method; the others go through
+   * RemoveHeader (Header &).
+   *
+   * \tparam T \deduced The header type.
+   * \param header a reference to the header to remove from the internal buffer.
+   * \returns the number of bytes removed from the packet.
+   */
+  template <typename T>
+  uint32_t RemoveHeader (T &header);
   /**
    * \brief Deserialize and remove the header from the internal buffer.
    *
@@ -344,6 +373,19 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header) const;
+  /**
+   * \brief Deserialize but does _not_ remove the header from the internal buffer.
+   *
+   * Headers for which FixedSizeHeader is specialized are read with
+   * a direct call to their Deserialize method; the others go through
+   * PeekHeader (Header &).
+   *
+   * \tparam T \deduced The header type.
+   * \param header a reference to the header to read from the internal buffer.
+   * \returns the number of bytes read from the packet.
+   */
+  template <typename T>
+  uint32_t PeekHeader (T &header) const;
   /**
    * \brief Deserialize but does _not_ remove the header from the internal buffer.
    * s
@@ -858,6 +900,62 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+template <typename T>
+void
+Packet::AddHeader (const T &header)
+{
+  const uint32_t size = FixedSizeHeader<T>::SIZE;
+  if constexpr (size == 0)
+    {
+      AddHeader (static_cast<const Header &> (header));
+    }
+  else
+    {
+      NS_ASSERT_MSG (header.GetInstanceTypeId () == T::GetTypeId ()
+                     && header.GetSerializedSize () == size,
+                     "FixedSizeHeader does not match " << header.GetInstanceTypeId ());
+      m_buffer.AddAtStart (size);
+      m_byteTagList.Adjust (size);
+      m_byteTagList.AddAtStart (size);
+      header.T::Serialize (m_buffer.Begin ());
+      m_metadata.AddHeader (header, size);
+    }
+}
+
+template <typename T>
+uint32_t
+Packet::RemoveHeader (T &header)
+{
+  if constexpr (FixedSizeHeader<T>::SIZE == 0)
+    {
+      return RemoveHeader (static_cast<Header &> (header));
+    }
+  else
+    {
+      NS_ASSERT_MSG (header.GetInstanceTypeId () == T::GetTypeId (),
+                     "FixedSizeHeader does not match " << header.GetInstanceTypeId ());
+      uint32_t deserialized = header.T::Deserialize (m_buffer.Begin ());
+      m_buffer.RemoveAtStart (deserialized);
+      m_byteTagList.Adjust (-deserialized);
+      m_metadata.RemoveHeader (header, deserialized);
+      return deserialized;
+    }
+}
+
+template <typename T>
+uint32_t
+Packet::PeekHeader (T &header) const
+{
+  if constexpr (FixedSizeHeader<T>::SIZE == 0)
+    {
+      return PeekHeader (static_cast<Header &> (header));
+    }
+  else
+    {
+      return header.T::Deserialize (m_buffer.Begin ());
+    }
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
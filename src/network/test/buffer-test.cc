@@ -22,6 +22,7 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -387,6 +388,88 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer fragment join unit tests.
+ */
+class BufferFragmentJoinTest : public TestCase {
+private:
+  /**
+   * Split a buffer in three fragments and join them back.
+   * \param buffer The buffer to split
+   * \param first The offset of the second fragment
+   * \param second The offset of the third fragment
+   */
+  void CheckJoin (Buffer buffer, uint32_t first, uint32_t second);
+public:
+  virtual void DoRun (void);
+  BufferFragmentJoinTest ();
+};
+
+BufferFragmentJoinTest::BufferFragmentJoinTest ()
+  : TestCase ("Buffer fragment join") {
+}
+
+void
+BufferFragmentJoinTest::CheckJoin (Buffer buffer, uint32_t first, uint32_t second)
+{
+  uint32_t size = buffer.GetSize ();
+  std::vector<uint8_t> expected (size);
+  buffer.CopyData (expected.data (), size);
+
+  Buffer joined = buffer.CreateFragment (0, first);
+  joined.AddAtEnd (buffer.CreateFragment (first, second - first));
+  joined.AddAtEnd (buffer.CreateFragment (second, size - second));
+
+  std::vector<uint8_t> got (size);
+  NS_TEST_ASSERT_MSG_EQ (joined.GetSize (), size, "Bad joined size for " << first << ", " << second);
+  joined.CopyData (got.data (), size);
+  NS_TEST_EXPECT_MSG_EQ ((got == expected), true, "Bad joined data for " << first << ", " << second);
+}
+
+void
+BufferFragmentJoinTest::DoRun (void)
+{
+  // Without zero area, the fragments are joined in place
+  Buffer buffer;
+  buffer.AddAtStart (100);
+  Buffer::Iterator i = buffer.Begin ();
+  for (uint32_t j = 0; j < 100; j++)
+    {
+      i.WriteU8 (j);
+    }
+  Buffer joined = buffer.CreateFragment (0, 30);
+  joined.AddAtEnd (buffer.CreateFragment (30, 40));
+  joined.AddAtEnd (buffer.CreateFragment (70, 30));
+  NS_TEST_EXPECT_MSG_EQ (joined.PeekData (), buffer.PeekData (), "Fragments were copied");
+  CheckJoin (buffer, 30, 70);
+
+  // Fragments which are not adjacent are copied
+  joined = buffer.CreateFragment (0, 30);
+  joined.AddAtEnd (buffer.CreateFragment (40, 10));
+  NS_TEST_ASSERT_MSG_EQ (joined.GetSize (), 40, "Bad joined size");
+  NS_TEST_EXPECT_MSG_EQ (joined.PeekData ()[30], 40, "Bad joined data");
+
+  // With a zero area, split in all the possible places
+  buffer = Buffer (10);
+  buffer.AddAtStart (4);
+  i = buffer.Begin ();
+  i.WriteU32 (0xdeadbeef);
+  buffer.AddAtEnd (4);
+  i = buffer.End ();
+  i.Prev (4);
+  i.WriteU32 (0xcafedeca);
+  for (uint32_t first = 0; first <= buffer.GetSize (); first++)
+    {
+      for (uint32_t second = first; second <= buffer.GetSize (); second++)
+        {
+          CheckJoin (buffer, first, second);
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -403,6 +486,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferFragmentJoinTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet-data-pool.h"
+#include "ns3/packet.h"
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketDataPool unit tests.
+ */
+class PacketDataPoolTest : public TestCase
+{
+public:
+  PacketDataPoolTest ();
+private:
+  virtual void DoRun (void);
+};
+
+PacketDataPoolTest::PacketDataPoolTest ()
+  : TestCase ("Check the size classes, reuse and caps of PacketDataPool")
+{
+}
+
+void
+PacketDataPoolTest::DoRun (void)
+{
+  // Pools are never destroyed, so that the caches of the threads
+  // can be released when the threads exit.
+  static PacketDataPool *pool = new PacketDataPool ();
+  uint32_t capacity;
+
+  uint8_t *a = pool->Allocate (100, &capacity);
+  NS_TEST_ASSERT_MSG_EQ (capacity, 128, "100 bytes come from the 128 bytes class");
+  pool->Deallocate (a, capacity);
+  uint8_t *b = pool->Allocate (128, &capacity);
+  NS_TEST_EXPECT_MSG_EQ ((a == b), true, "The free block is reused");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetStatistics ().allocations, 2, "Bad allocation count");
+  NS_TEST_EXPECT_MSG_EQ (pool->GetStatistics ().hits, 1, "Bad hit count");
+  pool->Deallocate (b, capacity);
+  NS_TEST_EXPECT_MSG_EQ (pool->GetStatistics ().freeBlocks, 1, "Bad free block count");
+
+  uint8_t *large = pool->Allocate (100000, &capacity);
+  NS_TEST_EXPECT_MSG_EQ (capacity, 100000, "Large blocks are allocated to size");
+  pool->Deallocate (large, capacity);
+  NS_TEST_EXPECT_MSG_EQ (pool->GetStatistics ().freeBlocks, 1, "Large blocks are not pooled");
+
+  // A thread started after the cap is set keeps at most that many
+  // blocks, and releases them when it exits.
+  Config::SetGlobal ("PacketPoolMaxFreeBlocks", UintegerValue (2));
+  std::thread thread ([] ()
+    {
+      std::vector<uint8_t *> blocks;
+      uint32_t capacity;
+      for (uint32_t i = 0; i < 5; ++i)
+        {
+          blocks.push_back (pool->Allocate (64, &capacity));
+        }
+      for (uint32_t i = 0; i < 5; ++i)
+        {
+          pool->Deallocate (blocks[i], capacity);
+        }
+    });
+  thread.join ();
+  Config::SetGlobal ("PacketPoolMaxFreeBlocks", UintegerValue (1000));
+  PacketDataPool::Statistics statistics = pool->GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (statistics.allocations, 7, "Exited threads are accounted for");
+  NS_TEST_EXPECT_MSG_EQ (statistics.maxFreeBlocks, 2, "The cap was not applied");
+  NS_TEST_EXPECT_MSG_EQ (statistics.freeBlocks, 1, "Exited threads release their blocks");
+
+  // Blocks may be freed by another thread than the one which allocated them
+  std::vector<uint8_t *> blocks;
+  std::thread producer ([&blocks] ()
+    {
+      uint32_t capacity;
+      for (uint32_t i = 0; i < 1000; ++i)
+        {
+          blocks.push_back (pool->Allocate (64 + i, &capacity));
+        }
+    });
+  producer.join ();
+  std::thread consumer ([&blocks] ()
+    {
+      for (uint32_t i = 0; i < 1000; ++i)
+        {
+          uint32_t capacity;
+          uint8_t *block = pool->Allocate (64 + i, &capacity);
+          pool->Deallocate (blocks[i], capacity);
+          pool->Deallocate (block, capacity);
+        }
+    });
+  consumer.join ();
+  NS_TEST_EXPECT_MSG_EQ (pool->GetStatistics ().allocations, 2007, "Bad allocation count");
+
+  // Packets get their storage from the pools of Buffer and PacketMetadata
+  uint64_t allocations = Buffer::GetPoolStatistics ().allocations;
+  Ptr<Packet> packet = Create<Packet> (1000);
+  NS_TEST_EXPECT_MSG_GT (Buffer::GetPoolStatistics ().allocations, allocations, "Buffer does not use its pool");
+  allocations = PacketMetadata::GetPoolStatistics ().allocations;
+  packet = Create<Packet> (1000);
+  NS_TEST_EXPECT_MSG_GT (PacketMetadata::GetPoolStatistics ().allocations, allocations, "PacketMetadata does not use its pool");
+
+  // New buffers get the headroom which the headers of the previous ones
+  // needed, even when it exceeds the smallest size class
+  {
+    Buffer buffer (1000);
+    buffer.AddAtStart (200);
+  }
+  Buffer buffer (1000);
+  allocations = Buffer::GetPoolStatistics ().allocations;
+  buffer.AddAtStart (200);
+  NS_TEST_EXPECT_MSG_EQ (Buffer::GetPoolStatistics ().allocations, allocations, "Headers reallocated the buffer");
+
+  // The zero-filled payload of a new buffer takes no memory: the buffer
+  // reuses the block which an empty buffer freed, even when the payload
+  // is larger than the largest size class.  A new thread starts with
+  // empty free lists.
+  uint64_t hits[2];
+  std::thread sizes ([&hits] ()
+    {
+      {
+        Buffer empty;
+      }
+      uint64_t before = Buffer::GetPoolStatistics ().hits;
+      {
+        Buffer small (1000);
+      }
+      hits[0] = Buffer::GetPoolStatistics ().hits - before;
+      {
+        Buffer large (PacketDataPool::MAX_BLOCK_SIZE * 2);
+      }
+      hits[1] = Buffer::GetPoolStatistics ().hits - before - hits[0];
+    });
+  sizes.join ();
+  NS_TEST_EXPECT_MSG_EQ (hits[0], 1, "The payload took memory");
+  NS_TEST_EXPECT_MSG_EQ (hits[1], 1, "The payload took memory outside of the pool");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PacketDataPool TestSuite
+ */
+class PacketDataPoolTestSuite : public TestSuite
+{
+public:
+  PacketDataPoolTestSuite ();
+};
+
+PacketDataPoolTestSuite::PacketDataPoolTestSuite ()
+  : TestSuite ("packet-data-pool", UNIT)
+{
+  AddTestCase (new PacketDataPoolTest, TestCase::QUICK);
+}
+
+static PacketDataPoolTestSuite g_packetDataPoolTestSuite; //!< Static variable for test initialization
@@ -310,6 +310,22 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
 
 }
 
+namespace ns3 {
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief HistoryHeader<4> goes through the FixedSizeHeader path of Packet
+ */
+template <>
+struct FixedSizeHeader<HistoryHeader<4> >
+{
+  static const uint32_t SIZE = 4; //!< The serialized size
+};
+
+} // namespace ns3
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -892,6 +908,24 @@ PacketMetadataTest::DoRun (void)
   REM_HEADER (p3, 2);
   CHECK_HISTORY (p3, 1, 11);
 
+  // Fixed-size headers record the same history
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 4);
+  ADD_HEADER (p, 2);
+  CHECK_HISTORY (p, 4,
+                 2, 4, 1, 10);
+  REM_HEADER (p, 2);
+  REM_HEADER (p, 4);
+  CHECK_HISTORY (p, 2,
+                 1, 10);
+  p1 = p->Copy ();
+  ADD_HEADER (p1, 4);
+  CHECK_HISTORY (p, 2,
+                 1, 10);
+  CHECK_HISTORY (p1, 3,
+                 4, 1, 10);
+
   uint8_t *buf = new uint8_t[p3->GetSize ()];
   p3->CopyData (buf, p3->GetSize ());
   std::string msg = std::string (reinterpret_cast<const char *>(buf),
@@ -21,10 +21,19 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <chrono>
+#include <thread>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/packet.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/core-config.h"
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace ns3;
 
@@ -77,6 +86,27 @@ CheckFileLength (std::string filename, uint64_t sizeExpected)
   return sizeActual == sizeExpected;
 }
 
+#if HAVE_ZLIB
+static std::string
+ReadGzipFile (std::string filename)
+{
+  std::string contents;
+  gzFile file = gzopen (filename.c_str (), "rb");
+  if (file == 0)
+    {
+      return contents;
+    }
+  char buffer[4096];
+  int read;
+  while ((read = gzread (file, buffer, sizeof (buffer))) > 0)
+    {
+      contents.append (buffer, read);
+    }
+  gzclose (file);
+  return contents;
+}
+#endif
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1144,6 +1174,204 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that a file written from a background
+ * thread is identical to one written synchronously.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Write the same records to a file.
+   * \param filename the file name
+   * \param snapLen the snap length
+   * \param bufferSize the size of the buffers of the background writer,
+   * or 0 to write synchronously
+   */
+  void WriteFile (std::string filename, uint32_t snapLen, uint32_t bufferSize);
+  /**
+   * Write the records of one step to a file.
+   * \param f the file
+   * \param i the step
+   */
+  static void WriteRecords (PcapFile &f, uint32_t i);
+  /**
+   * Read a whole file.
+   * \param filename the file name
+   * \returns the contents of the file
+   */
+  static std::string ReadFile (std::string filename);
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFile::EnableAsyncWrite writes the same file")
+{
+}
+
+void
+AsyncWriteTestCase::WriteFile (std::string filename, uint32_t snapLen, uint32_t bufferSize)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, snapLen);
+  if (bufferSize != 0)
+    {
+      f.EnableAsyncWrite (bufferSize);
+    }
+
+  for (uint32_t i = 0; i < 500; ++i)
+    {
+      WriteRecords (f, i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+  f.Close ();
+}
+
+void
+AsyncWriteTestCase::WriteRecords (PcapFile &f, uint32_t i)
+{
+  uint8_t data[1500];
+  for (uint32_t j = 0; j < sizeof (data); ++j)
+    {
+      data[j] = static_cast<uint8_t> (j * 7);
+    }
+  uint32_t size = (i * 37) % sizeof (data);
+  f.Write (i, i * 3, data, size);
+  f.Write (i, i * 3 + 1, Create<Packet> (data, size));
+}
+
+std::string
+AsyncWriteTestCase::ReadFile (std::string filename)
+{
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  std::ostringstream contents;
+  contents << file.rdbuf ();
+  return contents.str ();
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  uint32_t snapLens[] = {PcapFile::SNAPLEN_DEFAULT, 64};
+  for (uint32_t snapLen : snapLens)
+    {
+      std::string sync = CreateTempDirFilename ("sync.pcap");
+      WriteFile (sync, snapLen, 0);
+      std::string expected = ReadFile (sync);
+
+      // Buffers smaller than a record, than a few records and than the file
+      uint32_t bufferSizes[] = {1, 4096, 1 << 20};
+      for (uint32_t bufferSize : bufferSizes)
+        {
+          std::string async = CreateTempDirFilename ("async.pcap");
+          WriteFile (async, snapLen, bufferSize);
+          NS_TEST_EXPECT_MSG_EQ ((ReadFile (async) == expected), true,
+                                 "Files differ with snaplen " << snapLen << ", buffer size " << bufferSize);
+        }
+
+#if HAVE_ZLIB
+      // Compressed files are always written from the background thread
+      std::string compressed = CreateTempDirFilename ("compressed.pcap.gz");
+      WriteFile (compressed, snapLen, 0);
+      NS_TEST_EXPECT_MSG_EQ ((ReadGzipFile (compressed) == expected), true,
+                             "Decompressed file differs with snaplen " << snapLen);
+#endif
+    }
+
+  // Files written at the same time share the writer thread
+  std::string sync = CreateTempDirFilename ("sync.pcap");
+  WriteFile (sync, PcapFile::SNAPLEN_DEFAULT, 0);
+  std::string expected = ReadFile (sync);
+  const uint32_t n = 8;
+  PcapFile files[n];
+  std::string filenames[n];
+  for (uint32_t k = 0; k < n; ++k)
+    {
+      filenames[k] = CreateTempDirFilename ("shared-" + std::to_string (k) + ".pcap");
+      files[k].Open (filenames[k], std::ios::out);
+      files[k].Init (1);
+      files[k].EnableAsyncWrite (4096);
+    }
+  for (uint32_t i = 0; i < 500; ++i)
+    {
+      for (uint32_t k = 0; k < n; ++k)
+        {
+          WriteRecords (files[k], i);
+        }
+    }
+  for (uint32_t k = 0; k < n; ++k)
+    {
+      NS_TEST_EXPECT_MSG_EQ (files[k].Fail (), false, "Write must not fail");
+      files[k].Close ();
+      NS_TEST_EXPECT_MSG_EQ ((ReadFile (filenames[k]) == expected), true,
+                             "File " << k << " differs when written with the others");
+    }
+}
+
+#if HAVE_ZLIB
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that an ascii trace written to a ".gz"
+ * file decompresses to the text written.
+ */
+class CompressedAsciiTestCase : public TestCase
+{
+public:
+  CompressedAsciiTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CompressedAsciiTestCase::CompressedAsciiTestCase ()
+  : TestCase ("Check that OutputStreamWrapper compresses .gz files")
+{
+}
+
+void
+CompressedAsciiTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("trace.tr.gz");
+  std::ostringstream expected;
+  {
+    Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (filename, std::ios::out);
+    // More than the buffer of the stream, ending each line with std::endl
+    // as the trace sinks do
+    for (uint32_t i = 0; i < 100000; ++i)
+      {
+        *stream->GetStream () << "+ " << i * 0.001 << " /NodeList/" << i % 7 << "/DeviceList/0" << std::endl;
+        expected << "+ " << i * 0.001 << " /NodeList/" << i % 7 << "/DeviceList/0" << std::endl;
+      }
+    // A line written a while after the last flush of the compressor gets
+    // the file decompressed up to it, without waiting for the end
+    std::this_thread::sleep_for (std::chrono::milliseconds (1100));
+    *stream->GetStream () << "r 0" << std::endl;
+    expected << "r 0" << std::endl;
+    bool flushed = false;
+    for (uint32_t i = 0; i < 100 && !flushed; ++i)
+      {
+        std::this_thread::sleep_for (std::chrono::milliseconds (50));
+        flushed = ReadGzipFile (filename) == expected.str ();
+      }
+    NS_TEST_EXPECT_MSG_EQ (flushed, true, "Trace was not flushed after a while");
+    NS_TEST_EXPECT_MSG_EQ (stream->GetStream ()->good (), true, "Write must not fail");
+  }
+  NS_TEST_EXPECT_MSG_EQ ((ReadGzipFile (filename) == expected.str ()), true,
+                         "Decompressed trace differs from the text written");
+}
+#endif
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1395,10 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
+#if HAVE_ZLIB
+  AddTestCase (new CompressedAsciiTestCase, TestCase::QUICK);
+#endif
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
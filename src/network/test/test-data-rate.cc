@@ -265,6 +265,76 @@ DataRateTestCase2::DoRun ()
   MultiplicationDoubleTest("6Gb/s", 1.0/7.0, "857142857.14b/s");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test the integer transmission time against the int64x64 computation
+ *
+ */
+class DataRateTestCase3 : public DataRateTestCase
+{
+public:
+  DataRateTestCase3 ();
+
+  /**
+   * Checks that the transmission time of a given number of bits matches
+   * Seconds (nBits) divided by the bit rate
+   * \param dr the DataRate
+   * \param nBits number of bits
+   */
+  void SingleTest (const DataRate &dr, uint32_t nBits);
+
+private:
+  virtual void DoRun (void);
+};
+
+DataRateTestCase3::DataRateTestCase3 ()
+    : DataRateTestCase ("Test integer transmission time against int64x64")
+{
+}
+
+void
+DataRateTestCase3::SingleTest (const DataRate &dr, uint32_t nBits)
+{
+  Time correctTime = Seconds (nBits) / dr.GetBitRate ();
+  CheckTimesEqual (dr.CalculateBitsTxTime (nBits), correctTime,
+                   "CalculateBitsTxTime returned incorrect value");
+  if ((nBits % 8) == 0)
+    {
+      CheckTimesEqual (dr.CalculateBytesTxTime (nBits / 8), correctTime,
+                       "CalculateBytesTxTime returned incorrect value");
+    }
+}
+
+void
+DataRateTestCase3::DoRun ()
+{
+  if (Time::GetResolution () != Time::FS)
+    {
+      Time::SetResolution (Time::FS);
+    }
+  const char *rates[] = {"1kb/s", "3Mb/s", "7kb/s", "33333b/s", "12345678b/s",
+                         "10Gb/s", "3Gb/s", "999999999999b/s"};
+  for (const char *rate : rates)
+    {
+      DataRate dr (rate);
+      for (uint32_t nBits = 0; nBits <= 12000; nBits += 8)
+        {
+          SingleTest (dr, nBits);
+          SingleTest (dr, nBits + 1);
+        }
+    }
+
+  // The cached steps per byte must follow changes of the rate
+  DataRate dr ("1Gb/s");
+  SingleTest (dr, 12000);
+  dr *= static_cast<uint64_t> (3);
+  SingleTest (dr, 12000);
+  dr -= DataRate ("1Gb/s");
+  SingleTest (dr, 12000);
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -281,6 +351,7 @@ DataRateTestSuite::DataRateTestSuite () : TestSuite ("data-rate", UNIT)
 {
   AddTestCase (new DataRateTestCase1 (), TestCase::QUICK);
   AddTestCase (new DataRateTestCase2 (), TestCase::QUICK);
+  AddTestCase (new DataRateTestCase3 (), TestCase::QUICK);
 }
 
 static DataRateTestSuite sDataRateTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,313 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "async-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncFileWriter");
+
+/**
+ * The writer thread shared by all the writers of the process.
+ *
+ * The buffers of all the writers are written in the order they were
+ * handed over, so that each stream is written in order.  The thread is
+ * never stopped: it waits for work until the process exits.
+ */
+class AsyncFileWriter::Worker
+{
+public:
+  /**
+   * \returns The writer thread of this process, started on first use.
+   */
+  static Worker * Get (void);
+
+  std::mutex m_mutex;  //!< Protects the queue and the buffers of all the writers.
+  std::condition_variable m_workCondition;  //!< Signals the writer thread.
+  std::condition_variable m_doneCondition;  //!< Signals the producers.
+  /** The buffers waiting to be written, and their writer. */
+  std::deque<std::pair<AsyncFileWriter *, Chunk *> > m_queue;
+
+private:
+  Worker ();
+  /** Body of the writer thread. */
+  void Run (void);
+};
+
+AsyncFileWriter::Worker *
+AsyncFileWriter::Worker::Get (void)
+{
+  // A child process does not inherit the thread of its parent: it starts
+  // its own.  Workers are never destroyed, so that they outlive the
+  // writers closed by static destructors.
+  static std::mutex mutex;
+  static Worker *worker = 0;
+  static pid_t pid = 0;
+  std::lock_guard<std::mutex> lock (mutex);
+  if (worker == 0 || pid != getpid ())
+    {
+      worker = new Worker ();
+      pid = getpid ();
+    }
+  return worker;
+}
+
+AsyncFileWriter::Worker::Worker ()
+{
+  NS_LOG_FUNCTION (this);
+  std::thread (&Worker::Run, this).detach ();
+}
+
+void
+AsyncFileWriter::Worker::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::unique_lock<std::mutex> lock (m_mutex);
+  for (;;)
+    {
+      m_workCondition.wait (lock, [this] { return !m_queue.empty (); });
+      AsyncFileWriter *writer = m_queue.front ().first;
+      Chunk *chunk = m_queue.front ().second;
+      m_queue.pop_front ();
+      lock.unlock ();
+
+      if (chunk->used > 0)
+        {
+          writer->DoWrite (writer->m_os, chunk->data.data (), chunk->used);
+        }
+      if (chunk->flush)
+        {
+          writer->DoFlush (writer->m_os);
+        }
+      if (writer->m_os->fail ())
+        {
+          writer->m_fail = true;
+        }
+
+      lock.lock ();
+      writer->m_free.push_back (chunk);
+      writer->m_pending--;
+      m_doneCondition.notify_all ();
+    }
+}
+
+AsyncFileWriter::FlushBuf::FlushBuf (AsyncFileWriter *writer)
+  : m_writer (writer)
+{
+}
+
+int
+AsyncFileWriter::FlushBuf::sync (void)
+{
+  m_writer->Flush ();
+  return m_writer->Fail () ? -1 : 0;
+}
+
+AsyncFileWriter::AsyncFileWriter (std::ostream *os, uint32_t bufferSize, uint32_t buffers)
+  : m_os (os),
+    m_bufferSize (bufferSize),
+    m_buffers (buffers),
+    m_current (0),
+    m_pending (0),
+    m_closed (false),
+    m_fail (false),
+    m_worker (Worker::Get ()),
+    m_flushBuf (this),
+    m_flushStream (&m_flushBuf)
+{
+  NS_LOG_FUNCTION (this << os << bufferSize << buffers);
+  NS_ASSERT (buffers >= 2);
+}
+
+AsyncFileWriter::~AsyncFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+uint8_t *
+AsyncFileWriter::Reserve (uint32_t size)
+{
+  if (m_current == 0 || m_current->used + size > m_current->data.size ())
+    {
+      Submit ();
+      if (size > m_current->data.size ())
+        {
+          m_current->data.resize (size);
+        }
+    }
+  return &m_current->data[m_current->used];
+}
+
+void
+AsyncFileWriter::Commit (uint32_t size)
+{
+  NS_ASSERT (m_current->used + size <= m_current->data.size ());
+  m_current->used += size;
+}
+
+void
+AsyncFileWriter::Write (const void *data, uint32_t size)
+{
+  std::memcpy (Reserve (size), data, size);
+  Commit (size);
+}
+
+void
+AsyncFileWriter::Submit (bool flush)
+{
+  NS_LOG_FUNCTION (this << flush);
+  NS_ASSERT (!m_closed);
+  std::unique_lock<std::mutex> lock (m_worker->m_mutex);
+  if (m_current != 0 && (m_current->used > 0 || flush))
+    {
+      m_current->flush = flush;
+      m_worker->m_queue.push_back (std::make_pair (this, m_current));
+      m_current = 0;
+      m_pending++;
+      m_worker->m_workCondition.notify_one ();
+    }
+  if (m_current == 0)
+    {
+      if (m_free.empty () && m_chunks.size () < m_buffers)
+        {
+          m_chunks.push_back (Chunk ());
+          m_chunks.back ().data.resize (m_bufferSize);
+          m_free.push_back (&m_chunks.back ());
+        }
+      m_worker->m_doneCondition.wait (lock, [this] { return !m_free.empty (); });
+      m_current = m_free.front ();
+      m_free.pop_front ();
+      m_current->used = 0;
+    }
+}
+
+void
+AsyncFileWriter::Drain (void)
+{
+  NS_LOG_FUNCTION (this);
+  {
+    std::unique_lock<std::mutex> lock (m_worker->m_mutex);
+    m_worker->m_doneCondition.wait (lock, [this] { return m_pending == 0; });
+  }
+  // The stream is ours until the next Submit: write the last buffer
+  // rather than handing it over and waiting again.
+  if (m_current != 0 && m_current->used > 0)
+    {
+      DoWrite (m_os, m_current->data.data (), m_current->used);
+      m_current->used = 0;
+    }
+}
+
+void
+AsyncFileWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return;
+    }
+  Drain ();
+  DoFlush (m_os);
+  if (m_os->fail ())
+    {
+      m_fail = true;
+    }
+}
+
+void
+AsyncFileWriter::FlushAsync (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return;
+    }
+  if (m_current == 0)
+    {
+      Submit ();
+    }
+  Submit (true);
+}
+
+void
+AsyncFileWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return;
+    }
+  Drain ();
+  DoClose (m_os);
+  if (m_os->fail ())
+    {
+      m_fail = true;
+    }
+  m_closed = true;
+  m_current = 0;
+  m_free.clear ();
+  m_chunks.clear ();
+}
+
+bool
+AsyncFileWriter::Fail (void) const
+{
+  return m_fail;
+}
+
+void
+AsyncFileWriter::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_os->clear ();
+  m_fail = false;
+}
+
+std::ostream *
+AsyncFileWriter::GetFlushStream (void)
+{
+  return &m_flushStream;
+}
+
+void
+AsyncFileWriter::DoWrite (std::ostream *os, const uint8_t *data, uint32_t size)
+{
+  os->write (reinterpret_cast<const char *> (data), size);
+}
+
+void
+AsyncFileWriter::DoFlush (std::ostream *os)
+{
+  os->flush ();
+}
+
+void
+AsyncFileWriter::DoClose (std::ostream *os)
+{
+  DoFlush (os);
+}
+
+} // namespace ns3
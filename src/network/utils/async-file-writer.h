@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <atomic>
+#include <deque>
+#include <list>
+#include <ostream>
+#include <stdint.h>
+#include <streambuf>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Write to an output stream from a background thread.
+ *
+ * Data is appended to the current buffer by the thread producing it,
+ * without any locking.  When that buffer is full, it is handed over to
+ * the writer thread, which writes it to the stream in one call, and the
+ * producer carries on with another buffer.  The producer only blocks
+ * when all the buffers are waiting to be written, that is when the
+ * stream cannot keep up.
+ *
+ * A single writer thread, started on first use, serves all the writers
+ * of the process, in the order their buffers are handed over.  Buffers
+ * are only allocated when the previous ones are still being written, so
+ * that a writer whose stream keeps up holds one or two of them.
+ *
+ * Records can be serialized in place with Reserve() and Commit(), or
+ * copied with Write().  A record is never split across two buffers.
+ *
+ * The stream must not be used by anybody else until Flush() or Close()
+ * returns; register GetFlushStream() with FatalImpl::RegisterStream()
+ * instead of it.  Subclasses may transform the data by overriding
+ * DoWrite(), DoFlush() and DoClose(), which are never called
+ * concurrently; they must call Close() in their destructor.
+ */
+class AsyncFileWriter
+{
+public:
+  /**
+   * Create a writer.
+   *
+   * \param os The stream to write to.
+   * \param bufferSize The size of each buffer.
+   * \param buffers The maximum number of buffers, at least 2.
+   */
+  AsyncFileWriter (std::ostream *os, uint32_t bufferSize, uint32_t buffers = 4);
+  /** Write all the pending data. */
+  virtual ~AsyncFileWriter ();
+
+  /**
+   * Get room for a record in the current buffer.
+   *
+   * \param size The size of the record.
+   * \returns Where to serialize the record.  It remains valid until the
+   * next call to any other method.
+   */
+  uint8_t * Reserve (uint32_t size);
+  /**
+   * Append the record serialized at the address returned by Reserve().
+   *
+   * \param size The size of the record, at most the size reserved.
+   */
+  void Commit (uint32_t size);
+  /**
+   * Append a record.
+   *
+   * \param data The record.
+   * \param size The size of the record.
+   */
+  void Write (const void *data, uint32_t size);
+
+  /** Write all the pending data and flush the stream. */
+  void Flush (void);
+  /**
+   * Hand the pending data over to the writer thread, which flushes the
+   * stream once it has written it.  Unlike Flush(), this does not wait.
+   */
+  void FlushAsync (void);
+  /** Write all the pending data, flush the stream and release the buffers. */
+  void Close (void);
+
+  /**
+   * \returns true if writing to the stream failed.
+   */
+  bool Fail (void) const;
+  /** Write all the pending data and clear the state of the stream. */
+  void Clear (void);
+
+  /**
+   * \returns A stream whose flush () calls Flush (), to be flushed on
+   * fatal errors in place of the stream written to.
+   */
+  std::ostream * GetFlushStream (void);
+
+protected:
+  /**
+   * Write data to the stream.  This is called on the writer thread, or
+   * on the producer thread once the writer thread is done with the stream.
+   *
+   * \param os The stream.
+   * \param data The data.
+   * \param size The size of the data.
+   */
+  virtual void DoWrite (std::ostream *os, const uint8_t *data, uint32_t size);
+  /**
+   * Flush the stream.  This is called on the writer thread, or on the
+   * producer thread once the writer thread is done with the stream.
+   *
+   * \param os The stream.
+   */
+  virtual void DoFlush (std::ostream *os);
+  /**
+   * Flush the stream for the last time.  This is called once the writer
+   * thread is done with the stream.  By default, this calls DoFlush().
+   *
+   * \param os The stream.
+   */
+  virtual void DoClose (std::ostream *os);
+
+private:
+  class Worker;
+
+  /** A buffer and the size of the data it holds. */
+  struct Chunk
+  {
+    std::vector<uint8_t> data;  //!< The buffer.
+    uint32_t used;              //!< The size of the data.
+    bool flush;                 //!< Flush the stream after writing the data.
+  };
+
+  /** A stream buffer whose synchronization calls Flush(). */
+  class FlushBuf : public std::streambuf
+  {
+  public:
+    /**
+     * Constructor
+     * \param writer The writer to flush.
+     */
+    FlushBuf (AsyncFileWriter *writer);
+  protected:
+    virtual int sync (void);
+  private:
+    AsyncFileWriter *m_writer;  //!< The writer to flush.
+  };
+
+  /**
+   * Hand the current buffer over to the writer thread, if it holds any
+   * data or a flush is requested, and make another buffer current.
+   *
+   * \param flush Whether the writer thread must flush the stream after
+   * writing the buffer.
+   */
+  void Submit (bool flush = false);
+  /**
+   * Wait until the writer thread is done with the stream, and write the
+   * current buffer from this thread.
+   */
+  void Drain (void);
+
+  std::ostream *m_os;               //!< The stream.
+  uint32_t m_bufferSize;            //!< The size of each buffer.
+  uint32_t m_buffers;               //!< The maximum number of buffers.
+  std::list<Chunk> m_chunks;        //!< The buffers allocated so far.
+  Chunk *m_current;                 //!< The buffer being filled.
+  std::deque<Chunk *> m_free;       //!< Buffers ready to be filled.
+  uint32_t m_pending;               //!< Buffers handed over and not written yet.
+  bool m_closed;                    //!< Close() was called.
+  std::atomic<bool> m_fail;         //!< Writing to the stream failed.
+  Worker *m_worker;                 //!< The writer thread.
+  FlushBuf m_flushBuf;              //!< The buffer of m_flushStream.
+  std::ostream m_flushStream;       //!< The stream returned by GetFlushStream().
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_WRITER_H */
@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+#include "compressed-file-writer.h"
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressedFileWriter");
+
+/** The state of the compressor of the chosen format. */
+struct CompressedFileWriter::Codec
+{
+#if HAVE_ZLIB
+  z_stream zlib;     //!< The gzip compressor.
+#endif
+#if HAVE_ZSTD
+  ZSTD_CCtx *zstd;   //!< The zstd compressor.
+#endif
+};
+
+CompressedFileWriter::CompressedFileWriter (std::ostream *os, Format format, uint32_t bufferSize)
+  : AsyncFileWriter (os, bufferSize),
+    m_format (format),
+    m_codec (new Codec)
+{
+  NS_LOG_FUNCTION (this << os << format << bufferSize);
+  NS_ABORT_MSG_UNLESS (format != NONE && IsSupported (format),
+                       "CompressedFileWriter: ns-3 was built without support for "
+                       << (format == GZIP ? "gzip" : "zstd") << " compression");
+  switch (m_format)
+    {
+#if HAVE_ZLIB
+    case GZIP:
+      {
+        m_codec->zlib.zalloc = Z_NULL;
+        m_codec->zlib.zfree = Z_NULL;
+        m_codec->zlib.opaque = Z_NULL;
+        // 16 more window bits asks for a gzip header and trailer.
+        int ret = deflateInit2 (&m_codec->zlib, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        NS_ABORT_MSG_UNLESS (ret == Z_OK, "CompressedFileWriter: deflateInit2 failed");
+        m_output.resize (deflateBound (&m_codec->zlib, bufferSize));
+        break;
+      }
+#endif
+#if HAVE_ZSTD
+    case ZSTD:
+      m_codec->zstd = ZSTD_createCCtx ();
+      NS_ABORT_MSG_UNLESS (m_codec->zstd != 0, "CompressedFileWriter: ZSTD_createCCtx failed");
+      m_output.resize (ZSTD_CStreamOutSize ());
+      break;
+#endif
+    default:
+      NS_ASSERT (false);
+    }
+}
+
+CompressedFileWriter::~CompressedFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  switch (m_format)
+    {
+#if HAVE_ZLIB
+    case GZIP:
+      deflateEnd (&m_codec->zlib);
+      break;
+#endif
+#if HAVE_ZSTD
+    case ZSTD:
+      ZSTD_freeCCtx (m_codec->zstd);
+      break;
+#endif
+    default:
+      break;
+    }
+  delete m_codec;
+}
+
+bool
+CompressedFileWriter::IsSupported (Format format)
+{
+  switch (format)
+    {
+    case NONE:
+      return true;
+    case GZIP:
+      return HAVE_ZLIB;
+    case ZSTD:
+      return HAVE_ZSTD;
+    }
+  return false;
+}
+
+CompressedFileWriter::Format
+CompressedFileWriter::GetFormat (std::string filename)
+{
+  const Format formats[] = {GZIP, ZSTD};
+  for (Format format : formats)
+    {
+      std::string extension = GetExtension (format);
+      if (filename.size () > extension.size ()
+          && filename.compare (filename.size () - extension.size (), extension.size (), extension) == 0)
+        {
+          return format;
+        }
+    }
+  return NONE;
+}
+
+std::string
+CompressedFileWriter::GetExtension (Format format)
+{
+  switch (format)
+    {
+    case GZIP:
+      return ".gz";
+    case ZSTD:
+      return ".zst";
+    default:
+      return "";
+    }
+}
+
+void
+CompressedFileWriter::DoWrite (std::ostream *os, const uint8_t *data, uint32_t size)
+{
+  Compress (os, data, size, CONTINUE);
+}
+
+void
+CompressedFileWriter::DoFlush (std::ostream *os)
+{
+  Compress (os, 0, 0, FLUSH);
+  os->flush ();
+}
+
+void
+CompressedFileWriter::DoClose (std::ostream *os)
+{
+  Compress (os, 0, 0, FINISH);
+  os->flush ();
+}
+
+void
+CompressedFileWriter::Compress (std::ostream *os, const uint8_t *data, uint32_t size, Mode mode)
+{
+  switch (m_format)
+    {
+#if HAVE_ZLIB
+    case GZIP:
+      {
+        const int flush[] = {Z_NO_FLUSH, Z_SYNC_FLUSH, Z_FINISH};
+        z_stream *zlib = &m_codec->zlib;
+        zlib->next_in = const_cast<Bytef *> (data);
+        zlib->avail_in = size;
+        // deflate has written out everything it could once it leaves
+        // some room in the output buffer.
+        do
+          {
+            zlib->next_out = m_output.data ();
+            zlib->avail_out = m_output.size ();
+            if (deflate (zlib, flush[mode]) == Z_STREAM_ERROR)
+              {
+                os->setstate (std::ios::badbit);
+                return;
+              }
+            os->write (reinterpret_cast<const char *> (m_output.data ()),
+                       m_output.size () - zlib->avail_out);
+          }
+        while (zlib->avail_out == 0);
+        break;
+      }
+#endif
+#if HAVE_ZSTD
+    case ZSTD:
+      {
+        const ZSTD_EndDirective directive[] = {ZSTD_e_continue, ZSTD_e_flush, ZSTD_e_end};
+        ZSTD_inBuffer input = {data, size, 0};
+        for (;;)
+          {
+            ZSTD_outBuffer output = {m_output.data (), m_output.size (), 0};
+            std::size_t remaining = ZSTD_compressStream2 (m_codec->zstd, &output, &input, directive[mode]);
+            if (ZSTD_isError (remaining))
+              {
+                os->setstate (std::ios::badbit);
+                return;
+              }
+            os->write (reinterpret_cast<const char *> (m_output.data ()), output.pos);
+            if (mode == CONTINUE ? input.pos == input.size : remaining == 0)
+              {
+                break;
+              }
+          }
+        break;
+      }
+#endif
+    default:
+      NS_ASSERT (false);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPRESSED_FILE_WRITER_H
+#define COMPRESSED_FILE_WRITER_H
+
+#include <string>
+#include <vector>
+#include "async-file-writer.h"
+
+namespace ns3 {
+
+/**
+ * \brief Compress the data written to an output stream on a background
+ * thread.
+ *
+ * The stream holds a single gzip member or zstd frame, which can be read
+ * back by the standard tools, for example with
+ * \verbatim
+ *   zcat trace.pcap.gz | tcpdump -r -
+ *   zstdcat trace.tr.zst | less
+ * \endverbatim
+ *
+ * gzip compression requires zlib and zstd compression requires libzstd
+ * when ns-3 is configured; IsSupported() tells which are available.
+ * Gzip favors speed (level 1) and zstd uses its default level, so that
+ * the writer thread keeps up with the simulation.  Flush() ends the
+ * current compressed block, so that the stream decompresses up to there.
+ */
+class CompressedFileWriter : public AsyncFileWriter
+{
+public:
+  /** The compression formats. */
+  enum Format
+  {
+    NONE,  //!< No compression.
+    GZIP,  //!< gzip, with zlib.
+    ZSTD   //!< Zstandard, with libzstd.
+  };
+
+  /**
+   * Start compressing to a stream.
+   *
+   * \param os The stream to write to.
+   * \param format The compression format, which must be supported.
+   * \param bufferSize The size of each buffer.
+   */
+  CompressedFileWriter (std::ostream *os, Format format, uint32_t bufferSize = 1 << 16);
+  /** Write all the pending data and end the compressed stream. */
+  virtual ~CompressedFileWriter ();
+
+  /**
+   * \param format The compression format.
+   * \returns true if ns-3 was built with the library for \pname{format}.
+   */
+  static bool IsSupported (Format format);
+  /**
+   * \param filename The name of a file.
+   * \returns The compression format matching the extension of
+   * \pname{filename}: GZIP for ".gz", ZSTD for ".zst", NONE otherwise.
+   */
+  static Format GetFormat (std::string filename);
+  /**
+   * \param format The compression format.
+   * \returns The file name extension of \pname{format}, or an empty string for NONE.
+   */
+  static std::string GetExtension (Format format);
+
+protected:
+  virtual void DoWrite (std::ostream *os, const uint8_t *data, uint32_t size);
+  virtual void DoFlush (std::ostream *os);
+  virtual void DoClose (std::ostream *os);
+
+private:
+  /** How much of the compressed data to write out. */
+  enum Mode
+  {
+    CONTINUE,  //!< Whatever the compressor wants to.
+    FLUSH,     //!< All of it, so that the stream can be decompressed so far.
+    FINISH     //!< All of it and the end of the stream.
+  };
+
+  /**
+   * Compress data and write the output to the stream.
+   *
+   * \param os The stream.
+   * \param data The data.
+   * \param size The size of the data.
+   * \param mode How much of the compressed data to write out.
+   */
+  void Compress (std::ostream *os, const uint8_t *data, uint32_t size, Mode mode);
+
+  struct Codec;
+  Format m_format;                //!< The compression format.
+  Codec *m_codec;                 //!< The compressor state.
+  std::vector<uint8_t> m_output;  //!< The compressed data.
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSED_FILE_WRITER_H */
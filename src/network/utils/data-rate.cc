@@ -23,6 +23,8 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 
+#include <limits>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("DataRate");
@@ -185,13 +187,19 @@ DataRate::DoParse (const std::string s, uint64_t *v)
 }
 
 DataRate::DataRate ()
-  : m_bps (0)
+  : m_bps (0),
+    m_txTimeResolution (Time::LAST),
+    m_stepsPerSecond (0),
+    m_stepsPerByte (0)
 {
   NS_LOG_FUNCTION (this);
 }
 
 DataRate::DataRate(uint64_t bps)
-  : m_bps (bps)
+  : m_bps (bps),
+    m_txTimeResolution (Time::LAST),
+    m_stepsPerSecond (0),
+    m_stepsPerByte (0)
 {
   NS_LOG_FUNCTION (this << bps);
 }
@@ -204,6 +212,7 @@ DataRate DataRate::operator + (DataRate rhs)
 DataRate& DataRate::operator += (DataRate rhs)
 {
   m_bps += rhs.m_bps;
+  m_txTimeResolution = Time::LAST;
   return *this;
 }
 
@@ -217,6 +226,7 @@ DataRate& DataRate::operator -= (DataRate rhs)
 {
   NS_ASSERT_MSG(m_bps >= rhs.m_bps, "Data Rate cannot be negative.");
   m_bps -= rhs.m_bps;
+  m_txTimeResolution = Time::LAST;
   return *this;
 }
 
@@ -228,6 +238,7 @@ DataRate DataRate::operator * (double rhs)
 DataRate& DataRate::operator *= (double rhs)
 {
   m_bps *= rhs;
+  m_txTimeResolution = Time::LAST;
   return *this;
 }
 
@@ -239,6 +250,7 @@ DataRate DataRate::operator * (uint64_t rhs)
 DataRate& DataRate::operator *= (uint64_t rhs)
 {
   m_bps *= rhs;
+  m_txTimeResolution = Time::LAST;
   return *this;
 }
 
@@ -272,15 +284,65 @@ bool DataRate::operator != (const DataRate& rhs) const
   return m_bps!=rhs.m_bps;
 }
 
+void
+DataRate::UpdateTxTimeCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_txTimeResolution = Time::GetResolution ();
+  m_stepsPerSecond = 0;
+  m_stepsPerByte = 0;
+  if (m_bps == 0 || m_txTimeResolution < Time::S)
+    {
+      return;
+    }
+  m_stepsPerSecond = Time::FromInteger (1, Time::S).GetTimeStep ();
+  if ((m_stepsPerSecond * 8) % m_bps == 0)
+    {
+      m_stepsPerByte = (m_stepsPerSecond * 8) / m_bps;
+    }
+}
+
+bool
+DataRate::CalculateTxTimeSteps (uint64_t bits, uint64_t *steps) const
+{
+  if (m_txTimeResolution != Time::GetResolution ())
+    {
+      UpdateTxTimeCache ();
+    }
+  if (m_stepsPerByte != 0 && bits % 8 == 0
+      && bits / 8 <= std::numeric_limits<uint64_t>::max () / m_stepsPerByte)
+    {
+      *steps = (bits / 8) * m_stepsPerByte;
+      return true;
+    }
+  if (m_stepsPerSecond != 0
+      && bits <= std::numeric_limits<uint64_t>::max () / m_stepsPerSecond)
+    {
+      *steps = (bits * m_stepsPerSecond) / m_bps;
+      return true;
+    }
+  return false;
+}
+
 Time DataRate::CalculateBytesTxTime (uint32_t bytes) const
 {
   NS_LOG_FUNCTION (this << bytes);
+  uint64_t steps;
+  if (CalculateTxTimeSteps (static_cast<uint64_t> (bytes) * 8, &steps))
+    {
+      return TimeStep (steps);
+    }
   return Seconds (bytes * 8) / m_bps;
 }
 
 Time DataRate::CalculateBitsTxTime (uint32_t bits) const
 {
   NS_LOG_FUNCTION (this << bits);
+  uint64_t steps;
+  if (CalculateTxTimeSteps (bits, &steps))
+    {
+      return TimeStep (steps);
+    }
   return Seconds (bits) / m_bps;
 }
 
@@ -291,6 +353,9 @@ uint64_t DataRate::GetBitRate () const
 }
 
 DataRate::DataRate (std::string rate)
+  : m_txTimeResolution (Time::LAST),
+    m_stepsPerSecond (0),
+    m_stepsPerByte (0)
 {
   NS_LOG_FUNCTION (this << rate);
   bool ok = DoParse (rate, &m_bps);
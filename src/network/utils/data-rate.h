@@ -271,10 +271,35 @@ private:
    */
   static bool DoParse (const std::string s, uint64_t *v);
 
+  /**
+   * \brief Compute the transmission time of some bits in Time steps
+   *
+   * Uses plain 64-bit integer arithmetic on the cached number of Time
+   * steps per second, and gives the same result as dividing
+   * Seconds (bits) by the bit rate.
+   *
+   * \param [in] bits The number of bits
+   * \param [out] steps The transmission time, in Time steps
+   * \return true if the fast path could be used
+   */
+  bool CalculateTxTimeSteps (uint64_t bits, uint64_t *steps) const;
+  /** \brief Recompute the transmission time cache for the current Time resolution */
+  void UpdateTxTimeCache (void) const;
+
   // Uses DoParse
   friend std::istream &operator >> (std::istream &is, DataRate &rate);
   
   uint64_t m_bps; //!< data rate [bps]
+
+  /**
+   * Time resolution m_stepsPerSecond and m_stepsPerByte were computed
+   * for, or Time::LAST if they must be recomputed.  DataRate attribute
+   * defaults are built before the simulation script can change the
+   * resolution, so the cache cannot be filled at construction.
+   */
+  mutable enum Time::Unit m_txTimeResolution;
+  mutable uint64_t m_stepsPerSecond; //!< Time steps per second, 0 if not integral
+  mutable uint64_t m_stepsPerByte;   //!< Time steps per byte, 0 if not integral
 };
 
 /**
@@ -17,24 +17,210 @@
  */
 
 #include "output-stream-wrapper.h"
+#include "compressed-file-writer.h"
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
+#include <chrono>
 #include <fstream>
+#include <streambuf>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
 
+namespace {
+
+/**
+ * \ingroup network
+ * A stream buffer whose put area is the current buffer of a
+ * CompressedFileWriter, so that the characters are written into it
+ * directly.
+ *
+ * Synchronizing the stream, as std::endl does for every trace line,
+ * only appends the pending characters to the buffer.  At most once per
+ * FLUSH_INTERVAL, it also asks the writer thread to flush the compressor
+ * once it has compressed them, so that the file decompresses up to
+ * there; Flush() does so at once.  The end of the compressed stream is
+ * written when the buffer is destroyed.
+ */
+class CompressedStreamBuf : public std::streambuf
+{
+public:
+  /**
+   * Constructor
+   * \param file the file to write to
+   * \param format the compression format
+   */
+  CompressedStreamBuf (std::ostream *file, CompressedFileWriter::Format format)
+    : m_writer (file, format),
+      m_lastFlush (std::chrono::steady_clock::now ())
+  {
+    Reserve (BUFFER_SIZE);
+  }
+  ~CompressedStreamBuf ()
+  {
+    m_writer.Commit (pptr () - pbase ());
+    m_writer.Close ();
+  }
+  /**
+   * Compress all the characters written so far and flush the compressor.
+   * \returns 0 on success, -1 on failure
+   */
+  int Flush (void)
+  {
+    m_writer.Commit (pptr () - pbase ());
+    m_writer.Flush ();
+    Reserve (BUFFER_SIZE);
+    return m_writer.Fail () ? -1 : 0;
+  }
+
+protected:
+  virtual int_type overflow (int_type c)
+  {
+    m_writer.Commit (pptr () - pbase ());
+    Reserve (BUFFER_SIZE);
+    if (!traits_type::eq_int_type (c, traits_type::eof ()))
+      {
+        *pptr () = traits_type::to_char_type (c);
+        pbump (1);
+      }
+    return m_writer.Fail () ? traits_type::eof () : traits_type::not_eof (c);
+  }
+  virtual int sync (void)
+  {
+    uint32_t remainder = epptr () - pptr ();
+    m_writer.Commit (pptr () - pbase ());
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+    if (now - m_lastFlush >= FLUSH_INTERVAL)
+      {
+        m_writer.FlushAsync ();
+        m_lastFlush = now;
+        Reserve (BUFFER_SIZE);
+      }
+    else
+      {
+        // Carry on in the rest of the current buffer
+        Reserve (remainder);
+      }
+    return m_writer.Fail () ? -1 : 0;
+  }
+
+private:
+  /**
+   * Make the buffer of the writer the put area.
+   * \param size the size of the put area
+   */
+  void Reserve (uint32_t size)
+  {
+    char *buffer = reinterpret_cast<char *> (m_writer.Reserve (size));
+    setp (buffer, buffer + size);
+  }
+
+  static const uint32_t BUFFER_SIZE = 1 << 16; //!< Size of the put area
+  /** Longest time between two flushes of the compressor by sync() */
+  static constexpr std::chrono::seconds FLUSH_INTERVAL = std::chrono::seconds (1);
+  CompressedFileWriter m_writer;               //!< The compressing writer
+  /** When sync() last flushed the compressor */
+  std::chrono::steady_clock::time_point m_lastFlush;
+};
+
+/**
+ * \ingroup network
+ * A stream buffer whose synchronization flushes a CompressedStreamBuf
+ * completely, to be flushed on fatal errors.
+ */
+class CompressedFlushBuf : public std::streambuf
+{
+public:
+  /**
+   * Constructor
+   * \param buffer the buffer to flush
+   */
+  CompressedFlushBuf (CompressedStreamBuf *buffer)
+    : m_buffer (buffer)
+  {
+  }
+
+protected:
+  virtual int sync (void)
+  {
+    return m_buffer->Flush ();
+  }
+
+private:
+  CompressedStreamBuf *m_buffer;  //!< The buffer to flush
+};
+
+/**
+ * \ingroup network
+ * An output file stream which compresses what is written to it.
+ */
+class CompressedFileStream : public std::ostream
+{
+public:
+  /**
+   * Constructor
+   * \param filename file name
+   * \param filemode std::ios::openmode flags
+   * \param format the compression format
+   */
+  CompressedFileStream (std::string filename, std::ios::openmode filemode,
+                        CompressedFileWriter::Format format)
+    : std::ostream (0),
+      m_file (filename.c_str (), filemode | std::ios::binary),
+      m_buffer (&m_file, format),
+      m_flushBuffer (&m_buffer),
+      m_flushStream (&m_flushBuffer)
+  {
+    rdbuf (&m_buffer);
+    // Flushing this stream may leave data in the compressor, so flush
+    // the whole buffer on fatal errors instead.
+    FatalImpl::RegisterStream (&m_flushStream);
+  }
+  ~CompressedFileStream ()
+  {
+    FatalImpl::UnregisterStream (&m_flushStream);
+  }
+  /**
+   * \returns true if the file could be opened
+   */
+  bool IsOpen (void) const
+  {
+    return m_file.is_open ();
+  }
+
+private:
+  std::ofstream m_file;              //!< The compressed file
+  CompressedStreamBuf m_buffer;      //!< The compressing stream buffer
+  CompressedFlushBuf m_flushBuffer;  //!< The buffer of m_flushStream
+  std::ostream m_flushStream;        //!< The stream flushed on fatal errors
+};
+
+} // unnamed namespace
+
 OutputStreamWrapper::OutputStreamWrapper (std::string filename, std::ios::openmode filemode)
   : m_destroyable (true)
 {
   NS_LOG_FUNCTION (this << filename << filemode);
-  std::ofstream* os = new std::ofstream ();
-  os->open (filename.c_str (), filemode);
-  m_ostream = os;
-  FatalImpl::RegisterStream (m_ostream);
-  NS_ABORT_MSG_UNLESS (os->is_open (), "AsciiTraceHelper::CreateFileStream():  " <<
+  bool isOpen;
+  CompressedFileWriter::Format format = CompressedFileWriter::GetFormat (filename);
+  if (format == CompressedFileWriter::NONE)
+    {
+      std::ofstream* os = new std::ofstream ();
+      os->open (filename.c_str (), filemode);
+      isOpen = os->is_open ();
+      m_ostream = os;
+      FatalImpl::RegisterStream (m_ostream);
+    }
+  else
+    {
+      // The compressed stream registers the stream to flush on fatal errors
+      CompressedFileStream *os = new CompressedFileStream (filename, filemode, format);
+      isOpen = os->IsOpen ();
+      m_ostream = os;
+    }
+  NS_ABORT_MSG_UNLESS (isOpen, "AsciiTraceHelper::CreateFileStream():  " <<
                        "Unable to Open " << filename << " for mode " << filemode);
 }
 
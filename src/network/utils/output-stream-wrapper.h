@@ -72,6 +72,13 @@ class OutputStreamWrapper : public SimpleRefCount<OutputStreamWrapper>
 public:
   /**
    * Constructor
+   *
+   * A file whose name ends in ".gz" or ".zst" is compressed, from a
+   * background thread (see CompressedFileWriter).  Flushing the stream, as
+   * std::endl does, makes what was written so far decompressible at most
+   * once per second, and the file is complete once this wrapper is
+   * destroyed; on fatal errors, everything written so far is flushed.
+   *
    * \param filename file name
    * \param filemode std::ios::openmode flags
    */
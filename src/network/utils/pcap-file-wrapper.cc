@@ -46,6 +46,18 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("AsyncWrite",
+                   "Whether packets are written to the file by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asyncWrite),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncBufferSize",
+                   "Size in bytes of each of the buffers handed over to the "
+                   "background writer thread when AsyncWrite is enabled.  "
+                   "Buffers are allocated as needed, at most four per file.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_asyncBufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -113,6 +125,10 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  if (m_asyncWrite && !m_file.Fail ())
+    {
+      m_file.EnableAsyncWrite (m_asyncBufferSize);
+    }
 }
 
 void
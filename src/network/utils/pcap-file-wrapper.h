@@ -35,6 +35,16 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * When the AsyncWrite attribute is set, the file is written by a
+ * background thread (see PcapFile::EnableAsyncWrite), which takes the
+ * file I/O off the simulation thread.  Since the helpers create their
+ * files with PcapHelper::CreateFile, this can be enabled for all the
+ * traces of a simulation with
+ *
+ * \code
+ *   Config::SetDefault ("ns3::PcapFileWrapper::AsyncWrite", BooleanValue (true));
+ * \endcode
  */
 class PcapFileWrapper : public Object
 {
@@ -224,6 +234,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_asyncWrite; //!< Write from a background thread
+  uint32_t m_asyncBufferSize; //!< Size of the buffers of the background writer
 };
 
 } // namespace ns3
@@ -27,6 +27,7 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "compressed-file-writer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -50,7 +51,8 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writer (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file);
@@ -59,8 +61,8 @@ PcapFile::PcapFile ()
 PcapFile::~PcapFile ()
 {
   NS_LOG_FUNCTION (this);
-  FatalImpl::UnregisterStream (&m_file);
   Close ();
+  FatalImpl::UnregisterStream (&m_file);
 }
 
 
@@ -68,18 +70,32 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer)
+    {
+      // The writer thread owns the stream state
+      return m_writer->Fail ();
+    }
   return m_file.fail ();
 }
 bool
 PcapFile::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer)
+    {
+      return false;
+    }
   return m_file.eof ();
 }
 void
 PcapFile::Clear (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer)
+    {
+      m_writer->Clear ();
+      return;
+    }
   m_file.clear ();
 }
 
@@ -88,6 +104,14 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer)
+    {
+      FatalImpl::UnregisterStream (m_writer->GetFlushStream ());
+      m_writer->Close ();
+      delete m_writer;
+      m_writer = 0;
+      FatalImpl::RegisterStream (&m_file);
+    }
   m_file.close ();
 }
 
@@ -202,12 +226,6 @@ void
 PcapFile::WriteFileHeader (void)
 {
   NS_LOG_FUNCTION (this);
-  //
-  // If we're initializing the file, we need to write the pcap file header
-  // at the start of the file.
-  //
-  m_file.seekp (0, std::ios::beg);
-
   //
   // We have the ability to write out the pcap file header in a foreign endian
   // format, so we need a temp place to swap on the way out.
@@ -234,13 +252,27 @@ PcapFile::WriteFileHeader (void)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-  m_file.write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-  m_file.write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-  m_file.write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
-  m_file.write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-  m_file.write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-  m_file.write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
+  uint8_t buffer[24];
+  std::memcpy (buffer, &headerOut->m_magicNumber, 4);
+  std::memcpy (buffer + 4, &headerOut->m_versionMajor, 2);
+  std::memcpy (buffer + 6, &headerOut->m_versionMinor, 2);
+  std::memcpy (buffer + 8, &headerOut->m_zone, 4);
+  std::memcpy (buffer + 12, &headerOut->m_sigFigs, 4);
+  std::memcpy (buffer + 16, &headerOut->m_snapLen, 4);
+  std::memcpy (buffer + 20, &headerOut->m_type, 4);
+
+  if (m_writer)
+    {
+      // Compressed files are written in sequence from the start
+      m_writer->Write (buffer, sizeof (buffer));
+      return;
+    }
+  //
+  // If we're initializing the file, we need to write the pcap file header
+  // at the start of the file.
+  //
+  m_file.seekp (0, std::ios::beg);
+  m_file.write ((const char *)buffer, sizeof (buffer));
 }
 
 void
@@ -327,6 +359,7 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   NS_LOG_FUNCTION (this << filename << mode);
   NS_ASSERT ((mode & std::ios::app) == 0);
   NS_ASSERT (!m_file.fail ());
+  NS_ASSERT (m_writer == 0);
   //
   // All pcap files are binary files, so we just do this automatically.
   //
@@ -334,11 +367,22 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
 
   m_filename=filename;
   m_file.open (filename.c_str (), mode);
+  CompressedFileWriter::Format format = CompressedFileWriter::GetFormat (filename);
   if (mode & std::ios::in)
     {
+      if (format != CompressedFileWriter::NONE)
+        {
+          NS_LOG_LOGIC ("Cannot read compressed file " << filename);
+          m_file.setstate (std::ios::failbit);
+          return;
+        }
       // will set the fail bit if file header is invalid.
       ReadAndVerifyFileHeader ();
     }
+  else if (format != CompressedFileWriter::NONE && !m_file.fail ())
+    {
+      StartWriter (new CompressedFileWriter (&m_file, format));
+    }
 }
 
 void
@@ -399,24 +443,75 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   WriteFileHeader ();
 }
 
-uint32_t
-PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+void
+PcapFile::EnableAsyncWrite (uint32_t bufferSize)
 {
-  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
+  NS_LOG_FUNCTION (this << bufferSize);
+  if (m_writer)
+    {
+      // Already compressing from the writer thread
+      return;
+    }
   NS_ASSERT (m_file.good ());
+  StartWriter (new AsyncFileWriter (&m_file, bufferSize));
+}
 
+void
+PcapFile::StartWriter (AsyncFileWriter *writer)
+{
+  NS_LOG_FUNCTION (this << writer);
+  m_writer = writer;
+  // The file belongs to the writer thread now: on fatal errors, flush
+  // the writer, which writes the pending records out, instead.
+  FatalImpl::UnregisterStream (&m_file);
+  FatalImpl::RegisterStream (m_writer->GetFlushStream ());
+}
+
+uint32_t
+PcapFile::MakePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, PcapRecordHeader *header)
+{
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
-  PcapRecordHeader header;
-  header.m_tsSec = tsSec;
-  header.m_tsUsec = tsUsec;
-  header.m_inclLen = inclLen;
-  header.m_origLen = totalLen;
+  header->m_tsSec = tsSec;
+  header->m_tsUsec = tsUsec;
+  header->m_inclLen = inclLen;
+  header->m_origLen = totalLen;
 
   if (m_swapMode)
     {
-      Swap (&header, &header);
+      Swap (header, header);
     }
+  return inclLen;
+}
+
+uint8_t *
+PcapFile::ReservePacketRecord (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t &inclLen)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
+
+  PcapRecordHeader header;
+  inclLen = MakePacketHeader (tsSec, tsUsec, totalLen, &header);
+
+  //
+  // The record header is 16 bytes on disk whatever the padding of the
+  // struct, so serialize the fields one after the other.
+  //
+  uint8_t *record = m_writer->Reserve (16 + inclLen);
+  std::memcpy (record, &header.m_tsSec, 4);
+  std::memcpy (record + 4, &header.m_tsUsec, 4);
+  std::memcpy (record + 8, &header.m_inclLen, 4);
+  std::memcpy (record + 12, &header.m_origLen, 4);
+  return record + 16;
+}
+
+uint32_t
+PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
+  NS_ASSERT (m_file.good ());
+
+  PcapRecordHeader header;
+  uint32_t inclLen = MakePacketHeader (tsSec, tsUsec, totalLen, &header);
 
   //
   // Watch out for memory alignment differences between machines, so write
@@ -434,6 +529,14 @@ void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
+  if (m_writer)
+    {
+      uint32_t inclLen;
+      uint8_t *record = ReservePacketRecord (tsSec, tsUsec, totalLen, inclLen);
+      std::memcpy (record, data, inclLen);
+      m_writer->Commit (16 + inclLen);
+      return;
+    }
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
   m_file.write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
@@ -443,6 +546,14 @@ void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
+  if (m_writer)
+    {
+      uint32_t inclLen;
+      uint8_t *record = ReservePacketRecord (tsSec, tsUsec, p->GetSize (), inclLen);
+      p->CopyData (record, inclLen);
+      m_writer->Commit (16 + inclLen);
+      return;
+    }
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
@@ -454,6 +565,22 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &header << p);
   uint32_t headerSize = header.GetSerializedSize ();
   uint32_t totalSize = headerSize + p->GetSize ();
+  if (m_writer)
+    {
+      uint32_t inclLen;
+      uint8_t *record = ReservePacketRecord (tsSec, tsUsec, totalSize, inclLen);
+      uint32_t toCopy = std::min (headerSize, inclLen);
+      if (toCopy > 0)
+        {
+          Buffer headerBuffer;
+          headerBuffer.AddAtStart (headerSize);
+          header.Serialize (headerBuffer.Begin ());
+          headerBuffer.CopyData (record, toCopy);
+        }
+      p->CopyData (record + toCopy, inclLen - toCopy);
+      m_writer->Commit (16 + inclLen);
+      return;
+    }
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
 
   Buffer headerBuffer;
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class AsyncFileWriter;
 
 
 /**
@@ -74,6 +75,10 @@ public:
    * selected as a binary file (fstream::binary is automatically ored with the mode
    * field).
    *
+   * A file whose name ends in ".gz" or ".zst" is written compressed, from a
+   * background thread (see CompressedFileWriter); such a file cannot be
+   * opened for reading.
+   *
    * \param filename String containing the name of the file.
    *
    * \param mode the access mode for the file.
@@ -120,6 +125,22 @@ public:
              bool swapMode = false,
              bool nanosecMode = false);
 
+  /**
+   * \brief Write the packets from a background thread.
+   *
+   * Once this is called, the Write methods serialize each record, truncated
+   * to the snap length, into an in-memory buffer, and a writer thread
+   * writes the buffers to the file as they fill up.  Packet data beyond
+   * the snap length is never copied.  The file must have been opened for
+   * writing only and initialized with Init().  Records are written to the
+   * file in order; they are all on disk when Close() returns.  This does
+   * nothing for compressed files, which are always written this way.
+   *
+   * \param bufferSize The size of each of the buffers handed over to the
+   * writer thread.
+   */
+  void EnableAsyncWrite (uint32_t bufferSize);
+
   /**
    * \brief Write next packet to file
    * 
@@ -358,6 +379,33 @@ private:
    * \returns the length of the packet to write in the Pcap file
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
+  /**
+   * \brief Reserve room for a record in the asynchronous writer and
+   * serialize its Pcap packet header there
+   *
+   * \param tsSec Time stamp (seconds part)
+   * \param tsUsec Time stamp (microseconds part)
+   * \param totalLen total packet length
+   * \param inclLen [out] the length of the packet to write in the Pcap file
+   * \returns where to copy the packet data
+   */
+  uint8_t * ReservePacketRecord (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t &inclLen);
+  /**
+   * \brief Fill a Pcap packet header
+   *
+   * \param tsSec Time stamp (seconds part)
+   * \param tsUsec Time stamp (microseconds part)
+   * \param totalLen total packet length
+   * \param header [out] the header, in file byte order
+   * \returns the length of the packet to write in the Pcap file
+   */
+  uint32_t MakePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, PcapRecordHeader *header);
+  /**
+   * \brief Hand the file over to a background writer
+   *
+   * \param writer the writer, which this object deletes on Close()
+   */
+  void StartWriter (AsyncFileWriter *writer);
 
   /**
    * \brief Read and verify a Pcap file header
@@ -369,6 +417,7 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  AsyncFileWriter *m_writer;    //!< background writer, or 0 when writing synchronously
 };
 
 } // namespace ns3
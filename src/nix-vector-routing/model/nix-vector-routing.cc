@@ -25,9 +25,14 @@
 
 #include <queue>
 #include <iomanip>
+#include <atomic>
+#include <thread>
 
 #include "ns3/log.h"
 #include "ns3/abort.h"
+#include "ns3/enum.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
 #include "ns3/names.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/loopback-net-device.h"
@@ -41,6 +46,18 @@ NS_LOG_COMPONENT_DEFINE ("NixVectorRouting");
 NS_OBJECT_TEMPLATE_CLASS_DEFINE (NixVectorRouting, Ipv4RoutingProtocol);
 NS_OBJECT_TEMPLATE_CLASS_DEFINE (NixVectorRouting, Ipv6RoutingProtocol);
 
+/**
+ * \relates NixVectorRouting
+ * \anchor GlobalValueNixVectorRoutingThreads
+ * \brief The number of threads building the BFS trees of all the nodes.
+ */
+static GlobalValue g_bfsThreads = GlobalValue ("NixVectorRoutingThreads",
+                                               "The number of threads building the BFS trees "
+                                               "of all the nodes for AllPairsBfsTrees; 0 uses "
+                                               "the number of hardware threads",
+                                               UintegerValue (0),
+                                               MakeUintegerChecker<uint32_t> ());
+
 template <typename T>
 bool NixVectorRouting<T>::g_isCacheDirty = false;
 
@@ -54,6 +71,30 @@ typename NixVectorRouting<T>::IpAddressToNodeMap NixVectorRouting<T>::g_ipAddres
 template <typename T>
 typename NixVectorRouting<T>::NetDeviceToIpInterfaceMap NixVectorRouting<T>::g_netdeviceToIpInterfaceMap;
 
+template <typename T>
+std::vector<uint32_t> NixVectorRouting<T>::g_nixNeighborsOffset;
+
+template <typename T>
+std::vector<uint32_t> NixVectorRouting<T>::g_nixNeighbors;
+
+template <typename T>
+std::vector<uint32_t> NixVectorRouting<T>::g_nixInLinksOffset;
+
+template <typename T>
+std::vector<typename NixVectorRouting<T>::NixInLink> NixVectorRouting<T>::g_nixInLinks;
+
+template <typename T>
+std::tuple<std::vector<uint8_t>, std::vector<uint16_t>, std::vector<uint32_t> > NixVectorRouting<T>::g_bfsTrees;
+
+template <typename T>
+uint32_t NixVectorRouting<T>::g_bfsTreeIndexSize = 0;
+
+template <typename T>
+std::vector<uint32_t> NixVectorRouting<T>::g_bfsTreeSlot;
+
+template <typename T>
+uint32_t NixVectorRouting<T>::g_nBfsTrees = 0;
+
 template <typename T>
 TypeId 
 NixVectorRouting<T>::GetTypeId (void)
@@ -64,13 +105,25 @@ NixVectorRouting<T>::GetTypeId (void)
     .SetParent<T> ()
     .SetGroupName ("NixVectorRouting")
     .template AddConstructor<NixVectorRouting<T> > ()
+    .AddAttribute ("RouteComputation",
+                   "How the nix-vectors which are not in the cache are computed: "
+                   "with a BFS from the source, or from BFS trees towards the "
+                   "destinations shared by all the nodes, either built on demand "
+                   "or all at once when the routing protocol is initialized and "
+                   "after each topology change.",
+                   EnumValue (NixVectorRouting<T>::PER_SOURCE_BFS),
+                   MakeEnumAccessor (&NixVectorRouting<T>::m_routeComputation),
+                   MakeEnumChecker (NixVectorRouting<T>::PER_SOURCE_BFS, "PerSourceBfs",
+                                    NixVectorRouting<T>::SHARED_BFS_TREES, "SharedBfsTrees",
+                                    NixVectorRouting<T>::ALL_PAIRS_BFS_TREES, "AllPairsBfsTrees"))
   ;
   return tid;
 }
 
 template <typename T>
 NixVectorRouting<T>::NixVectorRouting ()
-  : m_totalNeighbors (0)
+  : m_totalNeighbors (0),
+    m_routeComputation (PER_SOURCE_BFS)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -114,6 +167,12 @@ NixVectorRouting<T>::DoInitialize ()
       m_ip->SetForwarding (i, true);
     }
 
+  if (m_routeComputation == ALL_PAIRS_BFS_TREES)
+    {
+      CheckCacheStateAndFlush ();
+      BuildAllBfsTrees ();
+    }
+
   T::DoInitialize ();
 }
 
@@ -162,6 +221,25 @@ NixVectorRouting<T>::FlushGlobalNixRoutingCache (void) const
   // IP address to node mapping is potentially invalid so clear it.
   // Will be repopulated in lazy evaluation when mapping is needed.
   g_ipAddressToNodeMap.clear ();
+
+  // Same for the graph of the nodes and the BFS trees.
+  g_nixNeighborsOffset.clear ();
+  g_nixNeighbors.clear ();
+  g_nixInLinksOffset.clear ();
+  g_nixInLinks.clear ();
+  ClearBfsTrees ();
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::ClearBfsTrees (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::get<0> (g_bfsTrees).clear ();
+  std::get<1> (g_bfsTrees).clear ();
+  std::get<2> (g_bfsTrees).clear ();
+  g_bfsTreeSlot.assign (g_nixNeighborsOffset.empty () ? 0 : g_nixNeighborsOffset.size () - 1, NO_BFS_TREE);
+  g_nBfsTrees = 0;
 }
 
 template <typename T>
@@ -209,6 +287,18 @@ NixVectorRouting<T>::GetNixVector (Ptr<Node> source, IpAddress dest, Ptr<NetDevi
     }
   else
     {
+      // the BFS trees do not account for
+      // the output interface
+      if (!oif && m_routeComputation != PER_SOURCE_BFS)
+        {
+          if (BuildNixVectorFromTree (source->GetId (), destNode->GetId (), nixVector))
+            {
+              return nixVector;
+            }
+          NS_LOG_ERROR ("No routing path exists");
+          return 0;
+        }
+
       // otherwise proceed as normal 
       // and build the nix vector
       std::vector< Ptr<Node> > parentVector;
@@ -1231,6 +1321,321 @@ NixVectorRouting<T>::BFS (uint32_t numberOfNodes, Ptr<Node> source,
   return false;
 }
 
+template <typename T>
+void
+NixVectorRouting<T>::BuildNixGraph (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // Populate the lookup tables of the addresses and interfaces
+  if (g_ipAddressToNodeMap.empty ())
+    {
+      BuildIpAddressToNodeMap ();
+    }
+
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
+  g_nixNeighborsOffset.assign (1, 0);
+  g_nixNeighbors.clear ();
+
+  // links followed by BFS, as (to, from, nix index at from)
+  std::vector<std::pair<uint32_t, NixInLink> > links;
+  std::vector<uint32_t> linksTo (numberOfNodes + 1, 0);
+
+  for (uint32_t nodeId = 0; nodeId < numberOfNodes; nodeId++)
+    {
+      Ptr<Node> node = NodeList::GetNode (nodeId);
+      Ptr<IpL3Protocol> ip = node->GetObject<IpL3Protocol> ();
+      uint32_t firstNeighbor = g_nixNeighbors.size ();
+      // the nix index of a neighbor is the last one BuildNixVector finds
+      std::unordered_map<uint32_t, uint32_t> nixIndex;
+      std::vector<uint32_t> bfsNeighbors;
+
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+          // the neighbors, as BuildNixVector and
+          // FindNetDeviceForNixIndex number them
+          if (!localNetDevice->IsBridge ())
+            {
+              for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+                {
+                  uint32_t remoteId = (*iter)->GetNode ()->GetId ();
+                  nixIndex[remoteId] = g_nixNeighbors.size () - firstNeighbor;
+                  g_nixNeighbors.push_back (remoteId);
+                }
+            }
+
+          // the neighbors BFS may go to, with the same
+          // checks as BFS
+          if (ip)
+            {
+              int32_t interfaceIndex = ip->GetInterfaceForDevice (localNetDevice);
+              if (interfaceIndex == -1 || !(ip->IsUp (interfaceIndex)))
+                {
+                  continue;
+                }
+            }
+          if (!(localNetDevice->IsLinkUp ()))
+            {
+              continue;
+            }
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+            {
+              bfsNeighbors.push_back ((*iter)->GetNode ()->GetId ());
+            }
+        }
+      g_nixNeighborsOffset.push_back (g_nixNeighbors.size ());
+
+      for (std::vector<uint32_t>::const_iterator it = bfsNeighbors.begin (); it != bfsNeighbors.end (); it++)
+        {
+          std::unordered_map<uint32_t, uint32_t>::const_iterator index = nixIndex.find (*it);
+          if (index == nixIndex.end ())
+            {
+              NS_LOG_LOGIC ("Node " << *it << " has no nix index at node " << nodeId);
+              continue;
+            }
+          links.push_back (std::make_pair (*it, NixInLink (nodeId, index->second)));
+          linksTo[*it + 1]++;
+        }
+    }
+
+  // Sort the links by the node they go to, keeping
+  // the order of the nodes they come from
+  for (uint32_t nodeId = 0; nodeId < numberOfNodes; nodeId++)
+    {
+      linksTo[nodeId + 1] += linksTo[nodeId];
+    }
+  g_nixInLinksOffset = linksTo;
+  g_nixInLinks.resize (links.size ());
+  for (typename std::vector<std::pair<uint32_t, NixInLink> >::const_iterator it = links.begin (); it != links.end (); it++)
+    {
+      g_nixInLinks[linksTo[it->first]++] = it->second;
+    }
+
+  // The narrowest nix index type which holds the largest neighbor
+  // count, whose largest value is left for the unreachable nodes
+  uint32_t maxNeighbors = 0;
+  for (uint32_t nodeId = 0; nodeId < numberOfNodes; nodeId++)
+    {
+      maxNeighbors = std::max (maxNeighbors, g_nixNeighborsOffset[nodeId + 1] - g_nixNeighborsOffset[nodeId]);
+    }
+  if (maxNeighbors <= std::numeric_limits<uint8_t>::max ())
+    {
+      g_bfsTreeIndexSize = sizeof (uint8_t);
+    }
+  else if (maxNeighbors <= std::numeric_limits<uint16_t>::max ())
+    {
+      g_bfsTreeIndexSize = sizeof (uint16_t);
+    }
+  else
+    {
+      g_bfsTreeIndexSize = sizeof (uint32_t);
+    }
+  ClearBfsTrees ();
+
+  NS_LOG_LOGIC ("Nix graph of " << numberOfNodes << " nodes, " << g_nixNeighbors.size ()
+                << " neighbors and " << g_nixInLinks.size () << " links, "
+                << g_bfsTreeIndexSize << "-byte nix indexes");
+}
+
+template <typename T>
+template <typename I>
+void
+NixVectorRouting<T>::BuildBfsTree (uint32_t dest, I *tree, std::vector<uint32_t> &greyNodeList)
+{
+  // The tree tells which nodes were discovered, but for dest
+  const I none = std::numeric_limits<I>::max ();
+  greyNodeList.clear ();
+  greyNodeList.push_back (dest);
+  for (uint32_t head = 0; head < greyNodeList.size (); head++)
+    {
+      uint32_t currNode = greyNodeList[head];
+      for (uint32_t i = g_nixInLinksOffset[currNode]; i < g_nixInLinksOffset[currNode + 1]; i++)
+        {
+          const NixInLink & link = g_nixInLinks[i];
+          if (tree[link.first] == none && link.first != dest)
+            {
+              tree[link.first] = static_cast<I> (link.second);
+              greyNodeList.push_back (link.first);
+            }
+        }
+    }
+}
+
+template <typename T>
+template <typename I>
+const I *
+NixVectorRouting<T>::GetBfsTree (uint32_t dest)
+{
+  NS_LOG_FUNCTION (dest);
+
+  std::vector<I> & trees = std::get<std::vector<I> > (g_bfsTrees);
+  std::size_t numberOfNodes = g_nixNeighborsOffset.size () - 1;
+  if (g_bfsTreeSlot[dest] == NO_BFS_TREE)
+    {
+      g_bfsTreeSlot[dest] = g_nBfsTrees++;
+      trees.resize (g_nBfsTrees * numberOfNodes, std::numeric_limits<I>::max ());
+      std::vector<uint32_t> greyNodeList;
+      greyNodeList.reserve (numberOfNodes);
+      BuildBfsTree (dest, &trees[g_bfsTreeSlot[dest] * numberOfNodes], greyNodeList);
+      NS_LOG_LOGIC ("BFS tree towards Node " << dest << " reaches " << greyNodeList.size () << " nodes");
+    }
+  return &trees[g_bfsTreeSlot[dest] * numberOfNodes];
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::BuildAllBfsTrees (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
+  if (g_nixNeighborsOffset.size () <= numberOfNodes)
+    {
+      // Not built yet, or nodes were added since
+      BuildNixGraph ();
+    }
+  if (g_nBfsTrees == numberOfNodes)
+    {
+      return;
+    }
+  switch (g_bfsTreeIndexSize)
+    {
+    case sizeof (uint8_t):
+      BuildAllBfsTrees (std::get<std::vector<uint8_t> > (g_bfsTrees));
+      break;
+    case sizeof (uint16_t):
+      BuildAllBfsTrees (std::get<std::vector<uint16_t> > (g_bfsTrees));
+      break;
+    default:
+      BuildAllBfsTrees (std::get<std::vector<uint32_t> > (g_bfsTrees));
+      break;
+    }
+}
+
+template <typename T>
+template <typename I>
+void
+NixVectorRouting<T>::BuildAllBfsTrees (std::vector<I> &trees)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // The trees are independent: they only read the graph.  Build them
+  // on worker threads, each into its own part of the preallocated
+  // storage, so that they do not depend on the number of threads.
+  uint32_t numberOfNodes = g_nixNeighborsOffset.size () - 1;
+  trees.assign (static_cast<std::size_t> (numberOfNodes) * numberOfNodes, std::numeric_limits<I>::max ());
+  for (uint32_t dest = 0; dest < numberOfNodes; dest++)
+    {
+      g_bfsTreeSlot[dest] = dest;
+    }
+  g_nBfsTrees = numberOfNodes;
+
+  uint32_t nThreads = GetNBfsThreads ();
+  NS_LOG_INFO ("Building " << numberOfNodes << " BFS trees on " << nThreads << " threads");
+  std::atomic<uint32_t> next (0);
+  auto worker = [&trees, &next, numberOfNodes] ()
+    {
+      std::vector<uint32_t> greyNodeList;
+      greyNodeList.reserve (numberOfNodes);
+      for (uint32_t dest = next++; dest < numberOfNodes; dest = next++)
+        {
+          BuildBfsTree (dest, &trees[static_cast<std::size_t> (dest) * numberOfNodes], greyNodeList);
+        }
+    };
+  std::vector<std::thread> threads;
+  for (uint32_t t = 1; t < nThreads && t < numberOfNodes; t++)
+    {
+      threads.push_back (std::thread (worker));
+    }
+  worker ();
+  for (std::vector<std::thread>::iterator t = threads.begin (); t != threads.end (); t++)
+    {
+      t->join ();
+    }
+}
+
+template <typename T>
+uint32_t
+NixVectorRouting<T>::GetNBfsThreads (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  UintegerValue threads;
+  g_bfsThreads.GetValue (threads);
+  if (threads.Get () == 0)
+    {
+      return std::max (1U, std::thread::hardware_concurrency ());
+    }
+  return threads.Get ();
+}
+
+template <typename T>
+template <typename I>
+bool
+NixVectorRouting<T>::FollowBfsTree (const I *tree, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector)
+{
+  // The neighbor index of the first hop is the last one
+  // added, so gather the hops before adding them
+  std::vector<std::pair<uint32_t, uint32_t> > hops;
+  uint32_t currNode = source;
+  while (currNode != dest)
+    {
+      I nixIndex = tree[currNode];
+      if (nixIndex == std::numeric_limits<I>::max ())
+        {
+          return false;
+        }
+      uint32_t firstNeighbor = g_nixNeighborsOffset[currNode];
+      uint32_t totalNeighbors = g_nixNeighborsOffset[currNode + 1] - firstNeighbor;
+      hops.push_back (std::make_pair (nixIndex, nixVector->BitCount (totalNeighbors)));
+      currNode = g_nixNeighbors[firstNeighbor + nixIndex];
+    }
+
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_reverse_iterator it = hops.rbegin (); it != hops.rend (); it++)
+    {
+      NS_LOG_LOGIC ("Adding Nix: " << it->first << " with " << it->second << " bits");
+      nixVector->AddNeighborIndex (it->first, it->second);
+    }
+  return true;
+}
+
+template <typename T>
+bool
+NixVectorRouting<T>::BuildNixVectorFromTree (uint32_t source, uint32_t dest, Ptr<NixVector> nixVector) const
+{
+  NS_LOG_FUNCTION (this << source << dest << nixVector);
+
+  if (m_routeComputation == ALL_PAIRS_BFS_TREES)
+    {
+      BuildAllBfsTrees ();
+    }
+  else if (g_nixNeighborsOffset.size () <= NodeList::GetNNodes ())
+    {
+      // Not built yet, or nodes were added since
+      BuildNixGraph ();
+    }
+  NS_ASSERT (source < g_bfsTreeSlot.size () && dest < g_bfsTreeSlot.size ());
+
+  switch (g_bfsTreeIndexSize)
+    {
+    case sizeof (uint8_t):
+      return FollowBfsTree (GetBfsTree<uint8_t> (dest), source, dest, nixVector);
+    case sizeof (uint16_t):
+      return FollowBfsTree (GetBfsTree<uint16_t> (dest), source, dest, nixVector);
+    default:
+      return FollowBfsTree (GetBfsTree<uint32_t> (dest), source, dest, nixVector);
+    }
+}
+
 template <typename T>
 void
 NixVectorRouting<T>::PrintRoutingPath (Ptr<Node> source, IpAddress dest,
@@ -44,6 +44,9 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
+#include <limits>
+#include <tuple>
 
 namespace ns3 {
 
@@ -102,6 +105,17 @@ public:
    * @see Object::GetObject ()
    */
   static TypeId GetTypeId (void);
+
+  /**
+   * How the nix-vectors of the destinations which are not in the
+   * cache are computed
+   */
+  enum RouteComputation_e {
+    PER_SOURCE_BFS,      //!< A BFS from the source to each destination
+    SHARED_BFS_TREES,    //!< A BFS tree per destination, built on demand and shared by all the sources
+    ALL_PAIRS_BFS_TREES, //!< The BFS trees of all the destinations, built at once
+  };
+
   /**
    * @brief Set the Node pointer of the node for which this
    * routing protocol is to be placed
@@ -260,6 +274,81 @@ private:
             std::vector< Ptr<Node> > & parentVector,
             Ptr<NetDevice> oif) const;
 
+  /**
+   * Build the neighbors of all the nodes, in nix-index order, and the
+   * links BFS may follow towards each node, as compact arrays of node ids
+   */
+  void BuildNixGraph (void) const;
+
+  /**
+   * Drop the BFS trees, keeping the graph
+   */
+  static void ClearBfsTrees (void);
+
+  /**
+   * Build the BFS tree towards a destination, following the links
+   * backwards: the first link found towards a node is its next hop
+   * \tparam I the nix index type of the trees
+   * \param [in] dest Destination Node index
+   * \param [out] tree the nix index of the next hop of each node towards
+   *        dest, or the largest value of I if dest is not reachable from
+   *        the node; it must hold that value for all the nodes on entry
+   * \param [in,out] greyNodeList space for the nodes to visit
+   */
+  template <typename I>
+  static void BuildBfsTree (uint32_t dest, I *tree, std::vector<uint32_t> &greyNodeList);
+
+  /**
+   * Returns the BFS tree towards a destination, building it if it is
+   * not in the shared cache
+   * \tparam I the nix index type of the trees
+   * \param dest Destination Node index
+   * \returns the tree, as filled by BuildBfsTree
+   */
+  template <typename I>
+  static const I * GetBfsTree (uint32_t dest);
+
+  /**
+   * Build the BFS trees towards all the nodes, unless they are all in
+   * the shared cache already
+   */
+  void BuildAllBfsTrees (void) const;
+
+  /**
+   * Build the BFS trees towards all the nodes on worker threads
+   * \tparam I the nix index type of the trees
+   * \param trees the storage of the trees of that type
+   */
+  template <typename I>
+  static void BuildAllBfsTrees (std::vector<I> &trees);
+
+  /**
+   * \returns the number of threads building the BFS trees of all the nodes
+   */
+  static uint32_t GetNBfsThreads (void);
+
+  /**
+   * Follows a BFS tree from the source and builds the nixvector of the path
+   * \tparam I the nix index type of the trees
+   * \param [in] tree the BFS tree of dest
+   * \param [in] source Source Node index
+   * \param [in] dest Destination Node index
+   * \param [out] nixVector the NixVector to be used for routing
+   * \returns true on success, false if dest is not reachable.
+   */
+  template <typename I>
+  static bool FollowBfsTree (const I *tree, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
+
+  /**
+   * Follows the BFS tree of the destination from the source and builds
+   * the nixvector of the path
+   * \param [in] source Source Node index
+   * \param [in] dest Destination Node index
+   * \param [out] nixVector the NixVector to be used for routing
+   * \returns true on success, false if dest is not reachable.
+   */
+  bool BuildNixVectorFromTree (uint32_t source, uint32_t dest, Ptr<NixVector> nixVector) const;
+
   /**
    * \sa Ipv4RoutingProtocol::DoInitialize
    * \sa Ipv6RoutingProtocol::DoInitialize
@@ -465,6 +554,9 @@ private:
   /** Total neighbors used for nix-vector to determine number of bits */
   uint32_t m_totalNeighbors;
 
+  /** How the nix-vectors missing from the cache are computed */
+  RouteComputation_e m_routeComputation;
+
 
   /**
    * Mapping of IP address to ns-3 node.
@@ -479,6 +571,41 @@ private:
   /// Mapping of Ptr<NetDevice> to Ptr<IpInterface>.
   typedef std::unordered_map<Ptr<NetDevice>, Ptr<IpInterface>> NetDeviceToIpInterfaceMap;
   static NetDeviceToIpInterfaceMap g_netdeviceToIpInterfaceMap; //!< NetDevice pointer to IpInterface pointer map
+
+  /// Slot of the destinations whose BFS tree is not built yet
+  static constexpr uint32_t NO_BFS_TREE = std::numeric_limits<uint32_t>::max ();
+
+  /**
+   * Neighbors of the nodes, by node id, in nix-index order: the neighbors
+   * of node n are g_nixNeighbors[g_nixNeighborsOffset[n]] to
+   * g_nixNeighbors[g_nixNeighborsOffset[n + 1] - 1].
+   * Empty when the graph has to be rebuilt.
+   */
+  static std::vector<uint32_t> g_nixNeighborsOffset;
+  static std::vector<uint32_t> g_nixNeighbors; //!< Node ids of the neighbors
+
+  /// Link a BFS may follow to a node: the node it comes from, and the nix index of the link there
+  typedef std::pair<uint32_t, uint32_t> NixInLink;
+
+  /**
+   * Links towards the nodes, by node id, in the order the BFS discovers
+   * them: the links to node n are g_nixInLinks[g_nixInLinksOffset[n]] to
+   * g_nixInLinks[g_nixInLinksOffset[n + 1] - 1].
+   */
+  static std::vector<uint32_t> g_nixInLinksOffset;
+  static std::vector<NixInLink> g_nixInLinks; //!< Links towards the nodes
+
+  /**
+   * BFS trees shared by all the sources, one after the other in the
+   * vector of the nix index type: each tree holds, by node id, the nix
+   * index of the next hop towards its destination.  The nix indexes are
+   * stored in the narrowest of these types which holds the largest
+   * number of neighbors, see g_bfsTreeIndexSize.
+   */
+  static std::tuple<std::vector<uint8_t>, std::vector<uint16_t>, std::vector<uint32_t> > g_bfsTrees;
+  static uint32_t g_bfsTreeIndexSize;             //!< Size in bytes of the nix indexes of the trees
+  static std::vector<uint32_t> g_bfsTreeSlot;     //!< Position of the tree of each destination, or NO_BFS_TREE
+  static uint32_t g_nBfsTrees;                    //!< Number of trees built
 };
 
 
@@ -34,6 +34,11 @@
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/nix-vector-helper.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+
+#include <queue>
 
 using namespace ns3;
 /**
@@ -362,6 +367,333 @@ NixVectorRoutingTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * The topology is a 3x3 grid, in which most of the nodes are joined by
+ * several shortest paths:
+ * \verbatim
+    n0 -- n1 -- n2
+    |     |     |
+    n3 -- n4 -- n5
+    |     |     |
+    n6 -- n7 -- n8
+   \endverbatim
+ *
+ * Every node sends a packet to every other node, before and after the
+ * n4 - n5 link is set down. The test checks that all the packets are
+ * delivered, along a shortest path, for a given way of computing the
+ * nix-vectors.
+ *
+ * \brief IPv4 Nix-Vector Routing Test of the RouteComputation attribute
+ */
+class NixVectorRoutingComputationTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param routeComputation value of the RouteComputation attribute
+   */
+  NixVectorRoutingComputationTest (std::string routeComputation);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send a packet from every node to every other node.
+   */
+  void SendAll (void);
+
+  /**
+   * \brief Receive data, and check the number of hops of the packet.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+
+  /**
+   * \brief Compute the number of hops between the nodes.
+   * \param brokenLink true if the n4 - n5 link is down
+   */
+  void ComputeHops (bool brokenLink);
+
+  static const uint32_t N = 3;              //!< Number of nodes on a side of the grid
+  std::string m_routeComputation;           //!< Value of the RouteComputation attribute
+  std::vector<Ptr<Socket> > m_txSockets;    //!< Sending socket of each node
+  std::vector<Ipv4Address> m_addresses;     //!< Address of each node
+  std::vector<std::vector<uint32_t> > m_hops; //!< Shortest number of hops between the nodes
+  uint32_t m_received {0};                  //!< Number of packets received
+};
+
+NixVectorRoutingComputationTest::NixVectorRoutingComputationTest (std::string routeComputation)
+  : TestCase ("grid test, " + routeComputation),
+    m_routeComputation (routeComputation)
+{
+}
+
+void
+NixVectorRoutingComputationTest::ComputeHops (bool brokenLink)
+{
+  m_hops.assign (N * N, std::vector<uint32_t> (N * N, 0));
+  for (uint32_t src = 0; src < N * N; src++)
+    {
+      std::vector<bool> discovered (N * N, false);
+      std::queue<uint32_t> nodes;
+      nodes.push (src);
+      discovered[src] = true;
+      while (!nodes.empty ())
+        {
+          uint32_t node = nodes.front ();
+          nodes.pop ();
+          std::vector<uint32_t> neighbors;
+          if (node % N > 0)
+            {
+              neighbors.push_back (node - 1);
+            }
+          if (node % N < N - 1)
+            {
+              neighbors.push_back (node + 1);
+            }
+          if (node >= N)
+            {
+              neighbors.push_back (node - N);
+            }
+          if (node < N * (N - 1))
+            {
+              neighbors.push_back (node + N);
+            }
+          for (uint32_t neighbor : neighbors)
+            {
+              if (brokenLink && std::min (node, neighbor) == 4 && std::max (node, neighbor) == 5)
+                {
+                  continue;
+                }
+              if (!discovered[neighbor])
+                {
+                  discovered[neighbor] = true;
+                  m_hops[src][neighbor] = m_hops[src][node] + 1;
+                  nodes.push (neighbor);
+                }
+            }
+        }
+    }
+}
+
+void
+NixVectorRoutingComputationTest::SendAll (void)
+{
+  for (uint32_t src = 0; src < N * N; src++)
+    {
+      for (uint32_t dst = 0; dst < N * N; dst++)
+        {
+          if (src != dst)
+            {
+              // The packet size identifies the source
+              m_txSockets[src]->SendTo (Create<Packet> (100 + src), 0,
+                                        InetSocketAddress (m_addresses[dst], 1234));
+            }
+        }
+    }
+}
+
+void
+NixVectorRoutingComputationTest::ReceivePkt (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      uint32_t src = packet->GetSize () - 100;
+      uint32_t dst = socket->GetNode ()->GetId ();
+      SocketIpTtlTag ttlTag;
+      NS_TEST_ASSERT_MSG_EQ (packet->RemovePacketTag (ttlTag), true, "No TTL tag");
+      // The TTL is decremented by each router on the way
+      NS_TEST_EXPECT_MSG_EQ (64u - ttlTag.GetTtl () + 1, m_hops[src][dst],
+                             "Path from " << src << " to " << dst << " is not a shortest path");
+      m_received++;
+    }
+}
+
+void
+NixVectorRoutingComputationTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (N * N);
+
+  // Build the trees of all the nodes on several threads, whatever the machine
+  Config::SetGlobal ("NixVectorRoutingThreads", UintegerValue (4));
+  Ipv4NixVectorHelper nixRouting;
+  nixRouting.Set ("RouteComputation", StringValue (m_routeComputation));
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (nixRouting);
+  stack.SetIpv6StackInstall (false);
+  stack.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper addressHelper;
+  addressHelper.SetBase ("10.0.0.0", "255.255.255.252");
+  m_addresses.resize (N * N);
+  NetDeviceContainer brokenLink;
+  for (uint32_t node = 0; node < N * N; node++)
+    {
+      std::vector<uint32_t> neighbors;
+      if (node % N < N - 1)
+        {
+          neighbors.push_back (node + 1);
+        }
+      if (node < N * (N - 1))
+        {
+          neighbors.push_back (node + N);
+        }
+      for (uint32_t neighbor : neighbors)
+        {
+          NetDeviceContainer devices = devHelper.Install (NodeContainer (nodes.Get (node), nodes.Get (neighbor)));
+          Ipv4InterfaceContainer interfaces = addressHelper.Assign (devices);
+          addressHelper.NewNetwork ();
+          m_addresses[node] = interfaces.GetAddress (0);
+          m_addresses[neighbor] = interfaces.GetAddress (1);
+          if (node == 4 && neighbor == 5)
+            {
+              brokenLink = devices;
+            }
+        }
+    }
+
+  for (uint32_t node = 0; node < N * N; node++)
+    {
+      Ptr<SocketFactory> socketFactory = nodes.Get (node)->GetObject<UdpSocketFactory> ();
+      Ptr<Socket> rxSocket = socketFactory->CreateSocket ();
+      NS_TEST_EXPECT_MSG_EQ (rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234)), 0, "trivial");
+      rxSocket->SetIpRecvTtl (true);
+      rxSocket->SetRecvCallback (MakeCallback (&NixVectorRoutingComputationTest::ReceivePkt, this));
+      m_txSockets.push_back (socketFactory->CreateSocket ());
+    }
+
+  ComputeHops (false);
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingComputationTest::SendAll, this);
+
+  Ptr<Ipv4> ipv4 = nodes.Get (4)->GetObject<Ipv4> ();
+  Simulator::Schedule (Seconds (2), &Ipv4::SetDown, ipv4, ipv4->GetInterfaceForDevice (brokenLink.Get (0)));
+  Simulator::Schedule (Seconds (2), &NixVectorRoutingComputationTest::ComputeHops, this, true);
+  Simulator::Schedule (Seconds (3), &NixVectorRoutingComputationTest::SendAll, this);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2 * N * N * (N * N - 1), "Packets were lost");
+
+  m_txSockets.clear ();
+  Simulator::Destroy ();
+  Config::SetGlobal ("NixVectorRoutingThreads", UintegerValue (0));
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * All the nodes share one channel, so that each of them has more
+ * neighbors than an 8-bit nix index can number, and each node sends a
+ * packet to the next one.  The test checks that all the packets are
+ * delivered, for a given way of computing the nix-vectors.
+ *
+ * \brief IPv4 Nix-Vector Routing Test of nodes with many neighbors
+ */
+class NixVectorRoutingManyNeighborsTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param routeComputation value of the RouteComputation attribute
+   */
+  NixVectorRoutingManyNeighborsTest (std::string routeComputation);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send a packet from every node to the next one.
+   */
+  void SendAll (void);
+
+  /**
+   * \brief Receive data.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+
+  static const uint32_t N = 300;            //!< Number of nodes
+  std::string m_routeComputation;           //!< Value of the RouteComputation attribute
+  std::vector<Ptr<Socket> > m_txSockets;    //!< Sending socket of each node
+  Ipv4InterfaceContainer m_interfaces;      //!< Interfaces of the nodes
+  uint32_t m_received {0};                  //!< Number of packets received
+};
+
+NixVectorRoutingManyNeighborsTest::NixVectorRoutingManyNeighborsTest (std::string routeComputation)
+  : TestCase ("many neighbors test, " + routeComputation),
+    m_routeComputation (routeComputation)
+{
+}
+
+void
+NixVectorRoutingManyNeighborsTest::SendAll (void)
+{
+  for (uint32_t node = 0; node < N; node++)
+    {
+      m_txSockets[node]->SendTo (Create<Packet> (100), 0,
+                                 InetSocketAddress (m_interfaces.GetAddress ((node + 1) % N), 1234));
+    }
+}
+
+void
+NixVectorRoutingManyNeighborsTest::ReceivePkt (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+NixVectorRoutingManyNeighborsTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (N);
+
+  // Build the trees of all the nodes on several threads, whatever the machine
+  Config::SetGlobal ("NixVectorRoutingThreads", UintegerValue (4));
+  Ipv4NixVectorHelper nixRouting;
+  nixRouting.Set ("RouteComputation", StringValue (m_routeComputation));
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (nixRouting);
+  stack.SetIpv6StackInstall (false);
+  stack.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices = devHelper.Install (nodes);
+  Ipv4AddressHelper addressHelper;
+  addressHelper.SetBase ("10.0.0.0", "255.255.254.0");
+  m_interfaces = addressHelper.Assign (devices);
+
+  for (uint32_t node = 0; node < N; node++)
+    {
+      Ptr<SocketFactory> socketFactory = nodes.Get (node)->GetObject<UdpSocketFactory> ();
+      Ptr<Socket> rxSocket = socketFactory->CreateSocket ();
+      NS_TEST_EXPECT_MSG_EQ (rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234)), 0, "trivial");
+      rxSocket->SetRecvCallback (MakeCallback (&NixVectorRoutingManyNeighborsTest::ReceivePkt, this));
+      m_txSockets.push_back (socketFactory->CreateSocket ());
+    }
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingManyNeighborsTest::SendAll, this);
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, N, "Packets were lost");
+
+  m_txSockets.clear ();
+  Simulator::Destroy ();
+  Config::SetGlobal ("NixVectorRoutingThreads", UintegerValue (0));
+}
+
 /**
  * \ingroup nix-vector-routing-test
  * \ingroup tests
@@ -374,6 +706,11 @@ public:
   NixVectorRoutingTestSuite () : TestSuite ("nix-vector-routing", UNIT)
   {
     AddTestCase (new NixVectorRoutingTest (), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingComputationTest ("PerSourceBfs"), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingComputationTest ("SharedBfsTrees"), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingComputationTest ("AllPairsBfsTrees"), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingManyNeighborsTest ("SharedBfsTrees"), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingManyNeighborsTest ("AllPairsBfsTrees"), TestCase::QUICK);
   }
 };
 
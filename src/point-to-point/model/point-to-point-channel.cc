@@ -19,7 +19,9 @@
 #include "point-to-point-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/boolean.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -40,6 +42,14 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("DeliverTrains",
+                   "If true, deliver each train of packets to the receiving "
+                   "device in a single event, when its last bit arrives, "
+                   "along with the arrival time of each packet; otherwise "
+                   "deliver each packet when its last bit arrives",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::m_deliverTrains),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,6 +67,7 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
+    m_deliverTrains (false),
     m_nDevices (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -106,6 +117,53 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitBurst (
+  Ptr<const PacketBurst> burst,
+  Ptr<PointToPointNetDevice> src,
+  const std::vector<Time> &txEnds)
+{
+  NS_LOG_FUNCTION (this << burst << src);
+  NS_ASSERT (burst->GetNPackets () == txEnds.size () && !txEnds.empty ());
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+
+  if (m_deliverTrains)
+    {
+      // The train is delivered once its last bit has arrived, so that no
+      // packet is seen by the receiver before it is complete.
+      Ptr<PacketBurst> copy = CreateObject<PacketBurst> ();
+      std::vector<Time> arrivals;
+      arrivals.reserve (txEnds.size ());
+      std::vector<Time>::const_iterator txEnd = txEnds.begin ();
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i, ++txEnd)
+        {
+          copy->AddPacket ((*i)->Copy ());
+          arrivals.push_back (Simulator::Now () + *txEnd + m_delay);
+          m_txrxPointToPoint (*i, src, m_link[wire].m_dst, *txEnd, *txEnd + m_delay);
+        }
+      Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+                                      txEnds.back () + m_delay, &PointToPointNetDevice::ReceiveBurst,
+                                      m_link[wire].m_dst, copy, arrivals);
+      return true;
+    }
+
+  // Each packet is received when its last bit arrives, as when it is
+  // sent alone.
+  std::vector<Time>::const_iterator txEnd = txEnds.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i, ++txEnd)
+    {
+      Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+                                      *txEnd + m_delay, &PointToPointNetDevice::Receive,
+                                      m_link[wire].m_dst, (*i)->Copy ());
+      m_txrxPointToPoint (*i, src, m_link[wire].m_dst, *txEnd, *txEnd + m_delay);
+    }
+  return true;
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
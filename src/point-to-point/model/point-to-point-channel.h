@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
@@ -30,6 +31,7 @@ namespace ns3 {
 
 class PointToPointNetDevice;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup point-to-point
@@ -80,6 +82,23 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a train of back-to-back packets over this channel
+   *
+   * The destination device receives each packet when its last bit
+   * arrives or, if the DeliverTrains attribute is set, the whole train in
+   * a single event when its last bit arrives, along with the arrival time
+   * of each packet.  The animation trace fires for each packet, with times
+   * relative to the start of the train.
+   *
+   * \param burst Packets to transmit, in order
+   * \param src Source PointToPointNetDevice
+   * \param txEnds Time, from now, at which each packet is transmitted
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurst (Ptr<const PacketBurst> burst, Ptr<PointToPointNetDevice> src,
+                              const std::vector<Time> &txEnds);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
@@ -150,6 +169,7 @@ private:
   static const std::size_t N_DEVICES = 2;
 
   Time          m_delay;    //!< Propagation delay
+  bool          m_deliverTrains; //!< Deliver trains in a single event
   std::size_t        m_nDevices; //!< Devices of this channel
 
   /**
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -67,6 +68,12 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxBurstSize",
+                   "The maximum number of queued packets sent back-to-back "
+                   "in a single channel event (1 disables packet trains)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_maxBurstSize),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -151,6 +158,12 @@ PointToPointNetDevice::GetTypeId (void)
                      "dropped by the device during reception",
                      MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxDropTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("PhyRxBurst",
+                     "Trace source indicating a train of packets has been "
+                     "completely received by the device, with the arrival "
+                     "time of each packet",
+                     MakeTraceSourceAccessor (&PointToPointNetDevice::m_phyRxBurstTrace),
+                     "ns3::PointToPointNetDevice::BurstTracedCallback")
 
     //
     // Trace sources designed to simulate a packet sniffer facility (tcpdump).
@@ -175,6 +188,7 @@ PointToPointNetDevice::GetTypeId (void)
 PointToPointNetDevice::PointToPointNetDevice () 
   :
     m_txMachineState (READY),
+    m_maxBurstSize (1),
     m_channel (0),
     m_linkUp (false),
     m_currentPkt (0)
@@ -249,6 +263,52 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_phyTxBeginTrace (m_currentPkt);
 
   Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  if (m_maxBurstSize > 1 && !m_queue->IsEmpty ())
+    {
+      //
+      // Send the waiting packets back-to-back with this one, each after
+      // the interframe gap of the previous one, in a single channel event.
+      // The transmit and sniffer traces of each packet still fire when it
+      // starts and ends, at the cost of an event per packet while they
+      // have sinks.
+      //
+      bool traced = !m_snifferTrace.IsEmpty () || !m_promiscSnifferTrace.IsEmpty ()
+        || !m_phyTxBeginTrace.IsEmpty () || !m_phyTxEndTrace.IsEmpty ();
+      Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+      burst->AddPacket (p);
+      std::vector<Time> txEnds (1, txTime);
+      while (burst->GetNPackets () < m_maxBurstSize)
+        {
+          Ptr<Packet> next = m_queue->Dequeue ();
+          if (next == 0)
+            {
+              break;
+            }
+          if (traced)
+            {
+              Simulator::Schedule (txEnds.back () + m_tInterframeGap, &PointToPointNetDevice::TransmitTrainNext,
+                                   this, m_currentPkt, next);
+            }
+          m_currentPkt = next;
+          burst->AddPacket (next);
+          txEnds.push_back (txEnds.back () + m_tInterframeGap + m_bps.CalculateBytesTxTime (next->GetSize ()));
+        }
+
+      Time txCompleteTime = txEnds.back () + m_tInterframeGap;
+      NS_LOG_LOGIC ("Schedule TransmitCompleteEvent of " << txEnds.size () << " packets in " << txCompleteTime.As (Time::S));
+      Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
+
+      bool result = m_channel->TransmitBurst (burst, this, txEnds);
+      if (result == false)
+        {
+          for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+            {
+              m_phyTxDropTrace (*i);
+            }
+        }
+      return result;
+    }
+
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.As (Time::S));
@@ -262,6 +322,16 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+void
+PointToPointNetDevice::TransmitTrainNext (Ptr<Packet> sent, Ptr<Packet> next)
+{
+  NS_LOG_FUNCTION (this << sent << next);
+  m_phyTxEndTrace (sent);
+  m_snifferTrace (next);
+  m_promiscSnifferTrace (next);
+  m_phyTxBeginTrace (next);
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -378,6 +448,17 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
     }
 }
 
+void
+PointToPointNetDevice::ReceiveBurst (Ptr<PacketBurst> burst, std::vector<Time> arrivals)
+{
+  NS_LOG_FUNCTION (this << burst);
+  m_phyRxBurstTrace (burst, arrivals);
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      Receive (*i);
+    }
+}
+
 Ptr<Queue<Packet> >
 PointToPointNetDevice::GetQueue (void) const
 { 
@@ -556,6 +637,53 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+bool
+PointToPointNetDevice::SendBurst (
+  Ptr<PacketBurst> burst,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  std::list<Ptr<Packet> >::const_iterator i;
+  if (IsLinkUp () == false)
+    {
+      for (i = burst->Begin (); i != burst->End (); ++i)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return false;
+    }
+
+  //
+  // Queue the whole train before starting to transmit, so that its packets
+  // can leave back-to-back.
+  //
+  bool result = true;
+  for (i = burst->Begin (); i != burst->End (); ++i)
+    {
+      AddHeader (*i, protocolNumber);
+      m_macTxTrace (*i);
+      if (!m_queue->Enqueue (*i))
+        {
+          m_macTxDropTrace (*i);
+          result = false;
+        }
+    }
+
+  if (m_txMachineState == READY)
+    {
+      Ptr<Packet> packet = m_queue->Dequeue ();
+      if (packet != 0)
+        {
+          m_snifferTrace (packet);
+          m_promiscSnifferTrace (packet);
+          result &= TransmitStart (packet);
+        }
+    }
+  return result;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
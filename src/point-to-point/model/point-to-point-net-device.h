@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -36,6 +37,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class PacketBurst;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -58,6 +60,15 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * When the MaxBurstSize attribute is larger than one, the device sends the
+ * packets waiting in its queue as trains of up to that many back-to-back
+ * packets, with one transmit complete event per train instead of one per
+ * packet.  The transmit and sniffer trace sources still fire when each
+ * packet starts or ends.  The receiving device gets each packet when its
+ * last bit arrives or, if the DeliverTrains attribute of the channel is
+ * set, the whole train when its last bit arrives; the PhyRxBurst trace
+ * source then reports the exact arrival time of each packet.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -149,6 +160,26 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * Receive a train of packets from a connected PointToPointChannel.
+   *
+   * The channel calls this method once the last bit of the last packet
+   * has arrived; each packet is then received as by Receive().
+   *
+   * \param burst the received packets, in order
+   * \param arrivals the time at which the last bit of each packet arrived
+   */
+  void ReceiveBurst (Ptr<PacketBurst> burst, std::vector<Time> arrivals);
+
+  /**
+   * TracedCallback signature for received packet trains.
+   *
+   * \param [in] burst The packets of the train.
+   * \param [in] arrivals The arrival time of each packet.
+   */
+  typedef void (* BurstTracedCallback)
+    (Ptr<const PacketBurst> burst, const std::vector<Time> &arrivals);
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -176,6 +207,7 @@ public:
   virtual bool IsBridge (void) const;
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
 
   virtual Ptr<Node> GetNode (void) const;
@@ -258,7 +290,8 @@ private:
    * the channel.  The corresponding method is called on the channel to let
    * it know that the physical device this class represents has virtually
    * started sending signals.  An event is scheduled for the time at which
-   * the bits have been completely transmitted.
+   * the bits have been completely transmitted.  If trains are enabled, the
+   * packets waiting in the queue are sent along with \pname{p}.
    *
    * \see PointToPointChannel::TransmitStart ()
    * \see TransmitComplete()
@@ -275,6 +308,15 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Fire the transmit and sniffer traces when a packet of a train ends
+   * and the next one starts.
+   *
+   * \param sent the packet which was transmitted
+   * \param next the packet whose transmission begins
+   */
+  void TransmitTrainNext (Ptr<Packet> sent, Ptr<Packet> next);
+
   /**
    * \brief Make the link up and running
    *
@@ -307,6 +349,12 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * The maximum number of packets sent back-to-back in a single channel
+   * event; 1 disables packet trains.
+   */
+  uint32_t       m_maxBurstSize;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
@@ -398,6 +446,12 @@ private:
    */
   TracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
 
+  /**
+   * The trace source fired when a train of packets is received from the
+   * medium, with the arrival time of each packet.
+   */
+  TracedCallback<Ptr<const PacketBurst>, const std::vector<Time> &> m_phyRxBurstTrace;
+
   /**
    * A trace source that emulates a non-promiscuous protocol sniffer connected 
    * to the device.  Unlike your average everyday sniffer, this trace source 
@@ -455,7 +509,7 @@ private:
    */
   uint32_t m_mtu;
 
-  Ptr<Packet> m_currentPkt; //!< Current packet processed
+  Ptr<Packet> m_currentPkt; //!< Current packet processed, or last packet of the current train
 
   /**
    * \brief PPP to Ethernet protocol number mapping
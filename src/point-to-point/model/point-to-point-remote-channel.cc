@@ -23,6 +23,7 @@
 #include "point-to-point-remote-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/mpi-interface.h"
@@ -73,4 +74,28 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitBurst (
+  Ptr<const PacketBurst> burst,
+  Ptr<PointToPointNetDevice> src,
+  const std::vector<Time> &txEnds)
+{
+  NS_LOG_FUNCTION (this << burst << src);
+  NS_ASSERT (burst->GetNPackets () == txEnds.size ());
+
+  IsInitialized ();
+
+  uint32_t wire = src == GetSource (0) ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+
+  // The remote receiver gets each packet at its own time.
+  std::vector<Time>::const_iterator txEnd = txEnds.begin ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i, ++txEnd)
+    {
+      Time rxTime = Simulator::Now () + *txEnd + GetDelay ();
+      MpiInterface::SendPacket ((*i)->Copy (), rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
+    }
+  return true;
+}
+
 } // namespace ns3
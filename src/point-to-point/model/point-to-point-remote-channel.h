@@ -68,6 +68,17 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit a train of packets, each with its own MPI message
+   *
+   * \param burst Packets to transmit, in order
+   * \param src Source PointToPointNetDevice
+   * \param txEnds Time, from now, at which each packet is transmitted
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurst (Ptr<const PacketBurst> burst, Ptr<PointToPointNetDevice> src,
+                              const std::vector<Time> &txEnds);
 };
 
 } // namespace ns3
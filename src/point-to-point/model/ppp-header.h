@@ -105,6 +105,15 @@ private:
   uint16_t m_protocol;
 };
 
+/**
+ * \brief PppHeader is always 2 bytes long.
+ */
+template <>
+struct FixedSizeHeader<PppHeader>
+{
+  static const uint32_t SIZE = 2; //!< The serialized size
+};
+
 } // namespace ns3
 
 
@@ -24,8 +24,12 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/packet-burst.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -130,6 +134,193 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the packet trains of the PointToPoint model
+ *
+ * It sends a train of packets with and without packet trains enabled, and
+ * checks that the packets are transmitted and arrive at the same times in
+ * fewer events.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send packets over a link and record when they arrive
+   *
+   * \param maxBurstSize The MaxBurstSize of the sending device.
+   * \param arrivals The arrival time of each packet.
+   * \param txBegins If not null, where to record the time at which the
+   * transmission of each packet begins.
+   * \param deliverTrains The DeliverTrains attribute of the channel.
+   * \return The number of events executed.
+   */
+  uint32_t SendPackets (uint32_t maxBurstSize, std::vector<Time> &arrivals, std::vector<Time> *txBegins = 0,
+                        bool deliverTrains = false);
+  /**
+   * \brief Record the time of a trace
+   *
+   * \param times The times.
+   * \param p The packet.
+   */
+  static void RecordTime (std::vector<Time> *times, Ptr<const Packet> p);
+  /**
+   * \brief Record the arrival times of a received train
+   *
+   * \param times The times.
+   * \param burst The packets of the train.
+   * \param arrivals The arrival time of each packet.
+   */
+  static void RecordArrivals (std::vector<Time> *times, Ptr<const PacketBurst> burst,
+                              const std::vector<Time> &arrivals);
+  /**
+   * \brief Count the packets handed to the upper layer
+   *
+   * \param dev The receiving device.
+   * \param pkt The received packet.
+   * \param mode The protocol mode used.
+   * \param sender The sender address.
+   *
+   * \return A boolean indicating packet handled properly.
+   */
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+
+  uint32_t m_received;  //!< Number of packets handed to the upper layer
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint packet trains")
+{
+}
+
+void
+PointToPointBurstTest::RecordTime (std::vector<Time> *times, Ptr<const Packet> p)
+{
+  times->push_back (Simulator::Now ());
+}
+
+void
+PointToPointBurstTest::RecordArrivals (std::vector<Time> *times, Ptr<const PacketBurst> burst,
+                                       const std::vector<Time> &arrivals)
+{
+  times->insert (times->end (), arrivals.begin (), arrivals.end ());
+}
+
+bool
+PointToPointBurstTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_received++;
+  return true;
+}
+
+uint32_t
+PointToPointBurstTest::SendPackets (uint32_t maxBurstSize, std::vector<Time> &arrivals, std::vector<Time> *txBegins,
+                                    bool deliverTrains)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  channel->SetAttribute ("DeliverTrains", BooleanValue (deliverTrains));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("10Mb/s"));
+  devA->SetInterframeGap (MicroSeconds (1));
+  devA->SetAttribute ("MaxBurstSize", UintegerValue (maxBurstSize));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBurstTest::RxPacket, this));
+  if (deliverTrains)
+    {
+      devB->TraceConnectWithoutContext ("PhyRxBurst", MakeBoundCallback (&PointToPointBurstTest::RecordArrivals, &arrivals));
+    }
+  else
+    {
+      devB->TraceConnectWithoutContext ("PhyRxEnd", MakeBoundCallback (&PointToPointBurstTest::RecordTime, &arrivals));
+    }
+  if (txBegins != 0)
+    {
+      devA->TraceConnectWithoutContext ("PhyTxBegin", MakeBoundCallback (&PointToPointBurstTest::RecordTime, txBegins));
+    }
+
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      burst->AddPacket (Create<Packet> (100 + 50 * i));
+    }
+
+  m_received = 0;
+  Simulator::Schedule (Seconds (1.0), &PointToPointNetDevice::SendBurst, devA, burst, devA->GetBroadcast (), 0x800);
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Run ();
+  events = Simulator::GetEventCount () - events;
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 20, "Not all the packets were handed up");
+  return events;
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  std::vector<Time> expected;
+  uint32_t singleEvents = SendPackets (1, expected);
+  NS_TEST_ASSERT_MSG_EQ (expected.size (), 20, "Not all the packets were received");
+  Time arrival = Seconds (1.0) + MilliSeconds (1);
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      arrival += DataRate ("10Mb/s").CalculateBytesTxTime (100 + 50 * i + 2);
+      NS_TEST_EXPECT_MSG_EQ (expected[i], arrival, "Bad arrival time of packet " << i);
+      arrival += MicroSeconds (1);
+    }
+
+  std::vector<Time> arrivals;
+  uint32_t burstEvents = SendPackets (8, arrivals);
+  NS_TEST_EXPECT_MSG_EQ ((arrivals == expected), true, "Trains change the arrival times");
+  // One transmit complete event per train of up to 8 packets, instead of
+  // per packet
+  NS_TEST_EXPECT_MSG_EQ (singleEvents - burstEvents, 20 - 3, "Trains do not save events");
+
+  // The channel may deliver each train in a single event, with the
+  // arrival time of each packet
+  arrivals.clear ();
+  uint32_t deliveredEvents = SendPackets (8, arrivals, 0, true);
+  NS_TEST_EXPECT_MSG_EQ ((arrivals == expected), true, "Delivered trains change the arrival times");
+  NS_TEST_EXPECT_MSG_EQ (singleEvents - deliveredEvents, 2 * (20 - 3), "Delivered trains do not save events");
+
+  // A sink on a transmit trace sees each packet at its own time, and
+  // costs an event per packet again on the transmit side only
+  std::vector<Time> expectedTxBegins;
+  arrivals.clear ();
+  SendPackets (1, arrivals, &expectedTxBegins);
+  std::vector<Time> txBegins;
+  arrivals.clear ();
+  uint32_t tracedEvents = SendPackets (8, arrivals, &txBegins, true);
+  NS_TEST_EXPECT_MSG_EQ (txBegins.size (), 20, "Not all the packets were transmitted");
+  NS_TEST_EXPECT_MSG_EQ ((txBegins == expectedTxBegins), true, "Trains change the transmit times");
+  NS_TEST_EXPECT_MSG_EQ ((arrivals == expected), true, "Trains change the arrival times");
+  NS_TEST_EXPECT_MSG_EQ (singleEvents - tracedEvents, 20 - 3, "No trains sent while PhyTxBegin has a sink");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -146,6 +337,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
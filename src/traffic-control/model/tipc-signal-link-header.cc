@@ -116,7 +116,7 @@ TipcSignalLinkHeader::Print (std::ostream &os) const
 uint32_t
 TipcSignalLinkHeader::GetSerializedSize (void) const
 {
-  return 20;
+  return 40;
 }
 
 void
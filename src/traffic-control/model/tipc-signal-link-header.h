@@ -162,6 +162,15 @@ private:
   uint16_t m_linkTolerance;   //!< Link Tolerance
 };
 
+/**
+ * \brief TipcSignalLinkHeader is always 40 bytes long.
+ */
+template <>
+struct FixedSizeHeader<TipcSignalLinkHeader>
+{
+  static const uint32_t SIZE = 40; //!< The serialized size
+};
+
 } // namespace ns3
 
 #endif /* UDP_HEADER */
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the computation of transmission
+// times by DataRate, comparing the integer fast path of
+// DataRate::CalculateBytesTxTime with the int64x64 computation it replaces,
+// for various numbers of packets 'n'.
+// Sample usage:  ./ns3 run 'bench-data-rate --n=10000000'
+
+#include "ns3/command-line.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/system-wall-clock-ms.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Sum of the computed times, so that the loops cannot be optimized away.
+static volatile int64_t g_sink;
+
+/// The rate under test.
+static DataRate g_rate;
+
+/**
+ * Packet sizes cycled through by the benchmarks.
+ * \param i the packet index
+ * \return the packet size, in bytes
+ */
+static inline uint32_t
+PacketSize (uint32_t i)
+{
+  return 40 + (i % 1461);
+}
+
+/**
+ * Transmission time computed with int64x64, as DataRate used to.
+ * \param n the number of packets
+ */
+static void
+benchInt64x64 (uint32_t n)
+{
+  uint64_t bps = g_rate.GetBitRate ();
+  int64_t sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += (Seconds (PacketSize (i) * 8) / bps).GetTimeStep ();
+    }
+  g_sink = sum;
+}
+
+/**
+ * Transmission time computed with DataRate::CalculateBytesTxTime.
+ * \param n the number of packets
+ */
+static void
+benchDataRate (uint32_t n)
+{
+  int64_t sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += g_rate.CalculateBytesTxTime (PacketSize (i)).GetTimeStep ();
+    }
+  g_sink = sum;
+}
+
+/**
+ * Transmission time as a Time scaled by a double, as done by models
+ * which keep the per-byte time as a Time.
+ * \param n the number of packets
+ */
+static void
+benchTimeTimesDouble (uint32_t n)
+{
+  Time perByte = Seconds (8.0 / g_rate.GetBitRate ());
+  int64_t sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += (perByte * static_cast<double> (PacketSize (i))).GetTimeStep ();
+    }
+  g_sink = sum;
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration(bench, n);
+      minDelay = std::min(minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max (minDelay, static_cast<uint64_t> (1));
+  std::cout << ps << " packets/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+  std::string resolution = "NS";
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark DataRate transmission time computation");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("resolution", "Time resolution: NS, PS or FS", resolution);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n=(number of packets)" << std::endl;
+      exit (1);
+    }
+  if (resolution == "PS")
+    {
+      Time::SetResolution (Time::PS);
+    }
+  else if (resolution == "FS")
+    {
+      Time::SetResolution (Time::FS);
+    }
+  std::cout << "Running bench-data-rate with n=" << n
+            << ", resolution " << resolution << std::endl;
+
+  const char *rates[] = {"1Gb/s", "10Gb/s", "3Mb/s"};
+  for (const char *rate : rates)
+    {
+      g_rate = DataRate (rate);
+      std::cout << rate << ":" << std::endl;
+      runBench (&benchInt64x64, n, minIterations, "Seconds (bytes * 8) / bps (int64x64)");
+      runBench (&benchDataRate, n, minIterations, "DataRate::CalculateBytesTxTime");
+      runBench (&benchTimeTimesDouble, n, minIterations, "Time per byte * double (int64x64)");
+    }
+
+  return 0;
+}
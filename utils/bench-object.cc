@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark Object::GetObject on an
+// aggregate shaped like a Node with an internet stack, comparing the
+// lookup table of Object::GetObject with a scan of the aggregates
+// checking the TypeId of each, as GetObject used to do, for various
+// numbers of lookups 'n'.
+// Sample usage:  ./ns3 run 'bench-object --n=10000000'
+
+#include "ns3/command-line.h"
+#include "ns3/object.h"
+#include "ns3/system-wall-clock-ms.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+#include <string>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * An aggregated object of its own type.
+ * \tparam N The index of the type.
+ */
+template <int N>
+class Part : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("BenchObject:Part" + std::to_string (N))
+      .SetParent<Object> ()
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+};
+
+} // unnamed namespace
+
+/// The root of the aggregate.
+static Ptr<Object> g_root;
+
+/// Number of lookups which found an object, so that the loops cannot be
+/// optimized away.
+static volatile uint64_t g_sink;
+
+/**
+ * Find an aggregate by scanning the aggregates and their TypeId parents.
+ * \param tid the TypeId to look for
+ * \return the object found, or 0
+ */
+static Ptr<const Object>
+Scan (TypeId tid)
+{
+  TypeId objectTid = Object::GetTypeId ();
+  Object::AggregateIterator i = g_root->GetAggregateIterator ();
+  while (i.HasNext ())
+    {
+      Ptr<const Object> current = i.Next ();
+      TypeId cur = current->GetInstanceTypeId ();
+      while (cur != tid && cur != objectTid)
+        {
+          cur = cur.GetParent ();
+        }
+      if (cur == tid)
+        {
+          return current;
+        }
+    }
+  return 0;
+}
+
+/**
+ * Look up the aggregates the way per-packet code does, with GetObject.
+ * \param n the number of lookups
+ */
+static void
+benchGetObject (uint32_t n)
+{
+  uint64_t found = 0;
+  for (uint32_t i = 0; i < n; i += 4)
+    {
+      found += g_root->GetObject<Part<2> > () != 0;
+      found += g_root->GetObject<Part<5> > () != 0;
+      found += g_root->GetObject<Part<7> > () != 0;
+      found += g_root->GetObject<Part<9> > () != 0;
+    }
+  g_sink = found;
+}
+
+/**
+ * Look up the same aggregates by scanning them.
+ * \param n the number of lookups
+ */
+static void
+benchScan (uint32_t n)
+{
+  uint64_t found = 0;
+  TypeId tid2 = Part<2>::GetTypeId ();
+  TypeId tid5 = Part<5>::GetTypeId ();
+  TypeId tid7 = Part<7>::GetTypeId ();
+  TypeId tid9 = Part<9>::GetTypeId ();
+  for (uint32_t i = 0; i < n; i += 4)
+    {
+      found += Scan (tid2) != 0;
+      found += Scan (tid5) != 0;
+      found += Scan (tid7) != 0;
+      found += Scan (tid9) != 0;
+    }
+  g_sink = found;
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration(bench, n);
+      minDelay = std::min(minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max (minDelay, static_cast<uint64_t> (1));
+  std::cout << ps << " lookups/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark Object::GetObject");
+  cmd.AddValue ("n", "number of lookups", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of lookups must be specified " <<
+        "by command-line argument --n=(number of lookups)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-object with n=" << n << std::endl;
+
+  // A Node with an internet stack has about ten aggregates; the last
+  // one is never found.
+  g_root = CreateObject<Part<0> > ();
+  g_root->AggregateObject (CreateObject<Part<1> > ());
+  g_root->AggregateObject (CreateObject<Part<2> > ());
+  g_root->AggregateObject (CreateObject<Part<3> > ());
+  g_root->AggregateObject (CreateObject<Part<4> > ());
+  g_root->AggregateObject (CreateObject<Part<5> > ());
+  g_root->AggregateObject (CreateObject<Part<6> > ());
+  g_root->AggregateObject (CreateObject<Part<7> > ());
+  g_root->AggregateObject (CreateObject<Part<8> > ());
+
+  runBench (&benchScan, n, minIterations, "Scan of the aggregate TypeIds");
+  runBench (&benchGetObject, n, minIterations, "Object::GetObject");
+
+  g_root->Dispose ();
+  g_root = 0;
+  return 0;
+}
@@ -328,6 +328,69 @@ benchByteTags (uint32_t n)
     }
 }
 
+// The tags below have the sizes of FlowIdTag, SocketPriorityTag
+// and Ipv4PacketInfoTag, which are added to packets at every hop.
+
+static void
+benchPacketTagsAddRemove (uint32_t n)
+{
+  BenchTag<4> flowId;
+  BenchTag<1> priority;
+  BenchTag<9> info;
+  Ptr<Packet> p = Create<Packet> (1000);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      p->AddPacketTag (flowId);
+      p->AddPacketTag (priority);
+      p->AddPacketTag (info);
+      p->RemovePacketTag (info);
+      p->RemovePacketTag (priority);
+      p->RemovePacketTag (flowId);
+    }
+}
+
+static void
+benchPacketTagsPeek (uint32_t n)
+{
+  BenchTag<4> flowId;
+  BenchTag<1> priority;
+  BenchTag<9> info;
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddPacketTag (flowId);
+  p->AddPacketTag (priority);
+  p->AddPacketTag (info);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      p->PeekPacketTag (flowId);
+      p->PeekPacketTag (priority);
+      p->PeekPacketTag (info);
+    }
+}
+
+static void
+benchPacketTagsCopy (uint32_t n)
+{
+  BenchTag<4> flowId;
+  BenchTag<1> priority;
+  BenchTag<9> info;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddPacketTag (flowId);
+      p->AddPacketTag (priority);
+      // forward a copy over a few hops
+      for (uint32_t hop = 0; hop < 4; hop++)
+        {
+          Ptr<Packet> q = p->Copy ();
+          q->AddPacketTag (info);
+          q->RemovePacketTag (info);
+          q->RemovePacketTag (priority);
+          p = q;
+          p->AddPacketTag (priority);
+        }
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -385,6 +448,9 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchPacketTagsAddRemove, n, minIterations, "Add and remove 3 packet tags");
+  runBench (&benchPacketTagsPeek, n, minIterations, "Peek 3 packet tags");
+  runBench (&benchPacketTagsCopy, n, minIterations, "Copy tagged packets over 4 hops");
 
   return 0;
 }